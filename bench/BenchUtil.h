@@ -0,0 +1,90 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Minimal timing harness shared by the bench/ programs. Each case is run
+// `warmup` times untimed, then `runs` times; the median and min are
+// reported so one noisy run does not move the headline number, along with
+// the interquartile spread as a percentage of the median, which says how
+// far apart two runs must be before the difference means anything.
+// BENCH_RUNS overrides the default number of timed runs.
+namespace bench {
+
+inline int defaultRuns() {
+    const char* env = std::getenv("BENCH_RUNS");
+    int runs = env ? std::atoi(env) : 0;
+    return runs > 0 ? runs : 15;
+}
+
+template <typename T>
+inline void doNotOptimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+    std::string name;
+    double median_ms;
+    double min_ms;
+    double spread_pct;
+};
+
+template <typename Fn>
+Result run(const std::string& name, Fn&& fn, int runs = defaultRuns(), int warmup = 3) {
+    for (int i = 0; i < warmup; ++i) {
+        fn();
+    }
+    std::vector<double> samples;
+    samples.reserve(runs);
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    double median = samples[samples.size() / 2];
+    double iqr = samples[samples.size() * 3 / 4] - samples[samples.size() / 4];
+    Result r{name, median, samples.front(), median > 0 ? 100.0 * iqr / median : 0.0};
+    std::printf("%-44s median %9.3f ms   min %9.3f ms   spread %5.1f%%\n", name.c_str(), r.median_ms, r.min_ms,
+                r.spread_pct);
+    return r;
+}
+
+inline void ratio(const Result& baseline, const Result& candidate) {
+    std::printf("%-44s %.2fx\n", ("speedup " + candidate.name).c_str(),
+                baseline.median_ms / candidate.median_ms);
+}
+
+// Per-operation latency samples (nanoseconds) summarised as percentiles.
+struct Latency {
+    std::vector<double> samples_ns;
+
+    template <typename Fn>
+    void time(Fn&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        samples_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+
+    double percentile(double p) {
+        if (samples_ns.empty()) {
+            return 0.0;
+        }
+        std::sort(samples_ns.begin(), samples_ns.end());
+        size_t i = static_cast<size_t>(p / 100.0 * static_cast<double>(samples_ns.size() - 1));
+        return samples_ns[i];
+    }
+
+    void print(const std::string& name) {
+        std::printf("%-44s p50 %8.2f us   p99 %8.2f us   p999 %8.2f us   (%zu ops)\n", name.c_str(),
+                    percentile(50) / 1000.0, percentile(99) / 1000.0, percentile(99.9) / 1000.0,
+                    samples_ns.size());
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,104 @@
+#pragma once
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// In-memory stand-in for a pqxx result, so row decoding can be benchmarked
+// without a database: text fields with NULL flags, positional access, and
+// access by name costed like pqxx::row::operator[](name) through libpq's
+// PQfnumber (a scan of the name for upper case / quotes, then strcmp
+// against each column in turn).
+namespace bench {
+
+struct FakeResult {
+    std::vector<const char*> columns;
+    std::vector<std::string> cells;  // row-major
+    std::vector<bool> nulls;
+};
+
+class FakeField {
+public:
+    FakeField(const std::string* text, bool null) : text(text), null(null) {}
+
+    bool is_null() const { return null; }
+    const char* c_str() const { return text->c_str(); }
+    size_t size() const { return text->size(); }
+
+    template <typename T>
+    T as() const;
+
+private:
+    const std::string* text;
+    bool null;
+};
+
+template <>
+inline int FakeField::as<int>() const {
+    if (null) {
+        throw std::runtime_error("null");
+    }
+    int v = 0;
+    std::from_chars(text->data(), text->data() + text->size(), v);
+    return v;
+}
+
+template <>
+inline bool FakeField::as<bool>() const {
+    if (null) {
+        throw std::runtime_error("null");
+    }
+    return (*text)[0] == 't';
+}
+
+template <>
+inline int64_t FakeField::as<int64_t>() const {
+    if (null) {
+        throw std::runtime_error("null");
+    }
+    int64_t v = 0;
+    std::from_chars(text->data(), text->data() + text->size(), v);
+    return v;
+}
+
+template <>
+inline std::string FakeField::as<std::string>() const {
+    if (null) {
+        throw std::runtime_error("null");
+    }
+    return *text;
+}
+
+class FakeRow {
+public:
+    FakeRow(const FakeResult* result, size_t row) : result(result), row(row) {}
+
+    FakeField operator[](int column) const {
+        size_t i = row * result->columns.size() + static_cast<size_t>(column);
+        return FakeField(&result->cells[i], result->nulls[i]);
+    }
+
+    // What PQfnumber does for a plain lower-case name
+    FakeField operator[](const char* name) const {
+        for (const char* p = name; *p; ++p) {
+            if (*p == '"' || *p != static_cast<char>(std::tolower(static_cast<unsigned char>(*p)))) {
+                throw std::runtime_error("mixed-case names are not modelled");
+            }
+        }
+        for (size_t c = 0; c < result->columns.size(); ++c) {
+            if (std::strcmp(name, result->columns[c]) == 0) {
+                return (*this)[static_cast<int>(c)];
+            }
+        }
+        throw std::runtime_error(std::string("no column ") + name);
+    }
+
+private:
+    const FakeResult* result;
+    size_t row;
+};
+
+} // namespace bench
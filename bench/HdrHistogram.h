@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace bench {
+
+// High-dynamic-range latency histogram in the style of HdrHistogram:
+// values (nanoseconds) land in log-linear buckets holding 2048 sub-buckets
+// each, so any recorded value is reported within 1/1024 (~0.1%) of the
+// truth from 1 ns up to kMaxValue, in fixed memory and O(1) per record.
+// Histograms of the same shape merge by adding counts, which is how the
+// per-thread histograms of bench_load are combined.
+class HdrHistogram {
+public:
+    static constexpr int kSubBucketBits = 11;
+    static constexpr uint64_t kSubBucketCount = uint64_t(1) << kSubBucketBits;
+    static constexpr uint64_t kSubBucketHalf = kSubBucketCount / 2;
+    // Two minutes; slower responses are clamped (and counted in max_ns)
+    static constexpr uint64_t kMaxValue = 120ull * 1000 * 1000 * 1000;
+
+    HdrHistogram() : counts((bucketOf(kMaxValue) + 2) * kSubBucketHalf, 0) {}
+
+    void record(uint64_t value_ns) {
+        total++;
+        sum_ns += value_ns;
+        min_ns = std::min(min_ns, value_ns);
+        max_ns = std::max(max_ns, value_ns);
+        counts[indexOf(std::min(value_ns, kMaxValue))]++;
+    }
+
+    void merge(const HdrHistogram& other) {
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum_ns += other.sum_ns;
+        min_ns = std::min(min_ns, other.min_ns);
+        max_ns = std::max(max_ns, other.max_ns);
+    }
+
+    // The highest value equivalent to the one at percentile p (0-100)
+    uint64_t percentile(double p) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total) + 0.5);
+        rank = std::min(std::max<uint64_t>(rank, 1), total);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(highestEquivalent(i), max_ns);
+            }
+        }
+        return max_ns;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? min_ns : 0; }
+    uint64_t max() const { return max_ns; }
+    double mean() const { return total ? static_cast<double>(sum_ns) / static_cast<double>(total) : 0.0; }
+
+private:
+    static int bucketOf(uint64_t value) {
+        // Values below kSubBucketCount all fall in bucket 0
+        return 63 - __builtin_clzll(value | (kSubBucketCount - 1)) - (kSubBucketBits - 1);
+    }
+
+    static size_t indexOf(uint64_t value) {
+        int bucket = bucketOf(value);
+        uint64_t sub = value >> bucket;
+        return static_cast<size_t>((static_cast<uint64_t>(bucket) + 1) * kSubBucketHalf + sub - kSubBucketHalf);
+    }
+
+    static uint64_t highestEquivalent(size_t index) {
+        if (index < kSubBucketCount) {
+            return index;
+        }
+        int bucket = static_cast<int>(index / kSubBucketHalf) - 1;
+        uint64_t sub = index % kSubBucketHalf + kSubBucketHalf;
+        return (sub << bucket) + (uint64_t(1) << bucket) - 1;
+    }
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t sum_ns = 0;
+    uint64_t min_ns = UINT64_MAX;
+    uint64_t max_ns = 0;
+};
+
+} // namespace bench
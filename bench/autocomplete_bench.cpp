@@ -0,0 +1,141 @@
+// Autocomplete latency on a 1M-product catalog: PrefixIndex::complete() for
+// 1-4 character prefixes, before and after a burst of incremental writes
+// (which land in the delta set until compaction). Results are checked
+// against a brute-force scan of a sorted copy. Target: p99 < 100 us.
+//
+//   make bench_autocomplete && ./bench_autocomplete
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "BenchUtil.h"
+#include "index/PrefixIndex.h"
+
+static const char* kWords[] = {
+    "Wireless", "Organic", "Stainless", "Ceramic", "Bamboo", "Vintage", "Smart", "Compact",
+    "Deluxe", "Portable", "Classic", "Premium", "Mini", "Ultra", "Eco", "Rugged",
+    "Headphones", "Kettle", "Blender", "Backpack", "Lamp", "Mug", "Charger", "Speaker",
+    "Notebook", "Bottle", "Jacket", "Sneakers", "Keyboard", "Monitor", "Tent", "Pillow",
+};
+
+static std::string randomName(std::mt19937& rng) {
+    std::uniform_int_distribution<size_t> word(0, sizeof(kWords) / sizeof(kWords[0]) - 1);
+    std::uniform_int_distribution<int> sku(0, 999999);
+    return std::string(kWords[word(rng)]) + " " + kWords[word(rng)] + " " + std::to_string(sku(rng));
+}
+
+static std::string lower(std::string s) {
+    for (char& c : s) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return s;
+}
+
+static std::vector<std::string> makePrefixes(std::mt19937& rng, size_t n) {
+    std::vector<std::string> out;
+    for (size_t i = 0; i < n; ++i) {
+        std::string name = randomName(rng);
+        out.push_back(lower(name.substr(0, 1 + i % 4)));
+    }
+    return out;
+}
+
+static size_t verify(const PrefixIndex& index, const std::vector<std::pair<std::string, uint32_t>>& sorted,
+                     const std::vector<std::string>& prefixes, size_t limit) {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < prefixes.size(); i += 97) {
+        const std::string& p = prefixes[i];
+        auto got = index.complete(p, limit);
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(p, uint32_t{0}));
+        size_t k = 0;
+        for (; it != sorted.end() && k < limit && it->first.compare(0, p.size(), p) == 0; ++it, ++k) {
+            if (k >= got.size() || got[k].id != it->second) {
+                ++mismatches;
+                break;
+            }
+        }
+        if (k != got.size()) {
+            ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+int main() {
+    const size_t kProducts = 1000000;
+    const size_t kQueries = 200000;
+    const size_t kLimit = 10;
+    std::mt19937 rng(42);
+
+    std::vector<PrefixIndex::Document> docs;
+    docs.reserve(kProducts);
+    for (size_t i = 0; i < kProducts; ++i) {
+        docs.emplace_back(static_cast<uint32_t>(i + 1), randomName(rng));
+    }
+    std::vector<std::pair<std::string, uint32_t>> sorted;
+    sorted.reserve(kProducts);
+    for (const auto& doc : docs) {
+        sorted.emplace_back(lower(doc.second), doc.first);
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    PrefixIndex index;
+    bench::run("rebuild 1M names", [&] { index.rebuild([&] { return docs; }); }, 3, 0);
+    size_t raw_bytes = 0;
+    for (const auto& entry : sorted) {
+        raw_bytes += entry.first.size();
+    }
+    std::printf("keys %zu   raw %.1f MB   front-coded %.1f MB\n", index.size(), raw_bytes / 1e6,
+                index.encodedBytes() / 1e6);
+
+    std::vector<std::string> prefixes = makePrefixes(rng, kQueries);
+    size_t sink = 0;
+    for (size_t i = 0; i < 10000; ++i) {
+        sink += index.complete(prefixes[i], kLimit).size();
+    }
+
+    bench::Latency base;
+    for (const auto& p : prefixes) {
+        base.time([&] { sink += index.complete(p, kLimit).size(); });
+    }
+    base.print("complete(limit=10), base only");
+    size_t bad = verify(index, sorted, prefixes, kLimit);
+
+    // Incremental writes: renames and inserts stay in the delta until it
+    // reaches the compaction threshold (1M / 16 entries).
+    std::set<std::pair<std::string, uint32_t>> reference(sorted.begin(), sorted.end());
+    std::vector<std::string> key_of(kProducts + 1);
+    for (const auto& entry : sorted) {
+        key_of[entry.second] = entry.first;
+    }
+    std::uniform_int_distribution<uint32_t> pick(1, static_cast<uint32_t>(kProducts));
+    bench::Latency writes;
+    for (size_t i = 0; i < 20000; ++i) {
+        bool rename = i % 2 == 0;
+        uint32_t id = rename ? pick(rng) : static_cast<uint32_t>(kProducts + 1 + i);
+        std::string name = randomName(rng);
+        writes.time([&] { index.update(id, name); });
+        std::string key = lower(name);
+        if (rename) {
+            reference.erase(std::make_pair(key_of[id], id));
+            key_of[id] = key;
+        }
+        reference.emplace(key, id);
+    }
+    sorted.assign(reference.begin(), reference.end());
+    writes.print("update()");
+
+    bench::Latency mixed;
+    for (const auto& p : prefixes) {
+        mixed.time([&] { sink += index.complete(p, kLimit).size(); });
+    }
+    mixed.print("complete(limit=10), base + delta");
+    bad += verify(index, sorted, prefixes, kLimit);
+
+    bench::doNotOptimize(sink);
+    std::printf("verification mismatches: %zu\n", bad);
+    return bad == 0 ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+// Payload size and encode time of the list responses in JSON, MessagePack
+// and CBOR (util/ResponseWriter.h), on a product listing and a
+// notification log listing. For reference it also times the tree path (an
+// nlohmann::json document, then to_msgpack / to_cbor), which is how
+// non-list responses are converted, and a client's parse of each payload
+// (nlohmann's SAX interface, so no document is built).
+//
+//   make bench_binary_format && ./bench_binary_format
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "BenchUtil.h"
+#include "util/ResponseWriter.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+struct ProductRow {
+    int id;
+    std::string name;
+    std::string description;
+    int stock;
+};
+
+struct LogRow {
+    int id;
+    int notification_id;
+    int user_id;
+    int product_id;
+    std::string message;
+    std::string status;
+    int retry_count;
+    std::string created_at;
+};
+
+std::vector<ProductRow> makeProducts(size_t n) {
+    std::vector<ProductRow> rows;
+    rows.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        rows.push_back(ProductRow{static_cast<int>(i + 1), "Product " + std::to_string(i),
+                                  "Description of product " + std::to_string(i) + " with a few more words",
+                                  static_cast<int>(i % 500)});
+    }
+    return rows;
+}
+
+std::vector<LogRow> makeLogs(size_t n) {
+    std::vector<LogRow> rows;
+    rows.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        rows.push_back(LogRow{static_cast<int>(i + 1), static_cast<int>(i + 1), static_cast<int>(1 + i % 20000),
+                              static_cast<int>(1 + i % 5000), "Product back in stock! Check it out now.",
+                              i % 7 == 0 ? "failed" : "sent", i % 7 == 0 ? 1 : 0, "2026-03-10T12:34:56.789012Z"});
+    }
+    return rows;
+}
+
+std::string encodeProducts(const std::vector<ProductRow>& rows, ResponseFormat format) {
+    std::string body;
+    body.reserve(rows.size() * 96 + 2);
+    ResponseWriter w(body, format);
+    w.beginArray();
+    for (const auto& r : rows) {
+        w.beginObject()
+            .field("id", r.id)
+            .field("name", r.name)
+            .field("description", r.description)
+            .field("stock", r.stock)
+            .endObject();
+    }
+    w.endArray();
+    return body;
+}
+
+std::string encodeLogs(const std::vector<LogRow>& rows, ResponseFormat format) {
+    std::string body;
+    body.reserve(rows.size() * 256 + 2);
+    ResponseWriter w(body, format);
+    w.beginArray();
+    for (const auto& r : rows) {
+        w.beginObject()
+            .field("id", r.id)
+            .field("notification_id", r.notification_id)
+            .field("user_id", r.user_id)
+            .field("product_id", r.product_id)
+            .field("type", "restocked")
+            .field("message", r.message)
+            .field("status", r.status)
+            .field("retry_count", r.retry_count)
+            .field("max_retries", 3)
+            .field("error_message", "")
+            .field("created_at", r.created_at)
+            .endObject();
+    }
+    w.endArray();
+    return body;
+}
+
+json productTree(const std::vector<ProductRow>& rows) {
+    json tree = json::array();
+    for (const auto& r : rows) {
+        tree.push_back(json{{"id", r.id}, {"name", r.name}, {"description", r.description}, {"stock", r.stock}});
+    }
+    return tree;
+}
+
+json decode(const std::string& body, ResponseFormat format) {
+    switch (format) {
+        case ResponseFormat::MsgPack: return json::from_msgpack(body);
+        case ResponseFormat::Cbor: return json::from_cbor(body);
+        default: return json::parse(body);
+    }
+}
+
+// Visits every value without building a document, so decoding measures
+// the format's parse cost rather than nlohmann's tree construction
+struct CountingSax : nlohmann::json_sax<json> {
+    size_t values = 0;
+
+    bool null() override { return ++values; }
+    bool boolean(bool) override { return ++values; }
+    bool number_integer(number_integer_t) override { return ++values; }
+    bool number_unsigned(number_unsigned_t) override { return ++values; }
+    bool number_float(number_float_t, const string_t&) override { return ++values; }
+    bool string(string_t&) override { return ++values; }
+    bool binary(binary_t&) override { return ++values; }
+    bool start_object(std::size_t) override { return true; }
+    bool key(string_t&) override { return true; }
+    bool end_object() override { return true; }
+    bool start_array(std::size_t) override { return true; }
+    bool end_array() override { return true; }
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override { return false; }
+};
+
+size_t saxParse(const std::string& body, ResponseFormat format) {
+    CountingSax sax;
+    switch (format) {
+        case ResponseFormat::MsgPack: json::sax_parse(body, &sax, json::input_format_t::msgpack); break;
+        case ResponseFormat::Cbor: json::sax_parse(body, &sax, json::input_format_t::cbor); break;
+        default: json::sax_parse(body, &sax); break;
+    }
+    return sax.values;
+}
+
+const char* name(ResponseFormat format) {
+    switch (format) {
+        case ResponseFormat::MsgPack: return "msgpack";
+        case ResponseFormat::Cbor: return "cbor";
+        default: return "json";
+    }
+}
+
+// Size, encode and client-side decode for one listing in every format
+template <typename Encode>
+bool compareFormats(const char* listing, size_t rows, Encode&& encode) {
+    const ResponseFormat formats[] = {ResponseFormat::Json, ResponseFormat::MsgPack, ResponseFormat::Cbor};
+    const std::string json_body = encode(ResponseFormat::Json);
+    const json reference = json::parse(json_body);
+
+    std::printf("\n%s, %zu rows\n", listing, rows);
+    bench::Result encode_json{};
+    bench::Result decode_json{};
+    for (ResponseFormat format : formats) {
+        std::string body = encode(format);
+        if (decode(body, format) != reference) {
+            std::fprintf(stderr, "%s %s payload does not decode to the JSON document\n", listing, name(format));
+            return false;
+        }
+        std::printf("%-44s %9zu bytes (%.0f%% of json)\n", (std::string("  ") + name(format) + " payload").c_str(),
+                    body.size(), 100.0 * static_cast<double>(body.size()) / static_cast<double>(json_body.size()));
+
+        auto encoded = bench::run(std::string("  encode ") + name(format), [&] {
+            bench::doNotOptimize(encode(format));
+        });
+        auto decoded = bench::run(std::string("  decode ") + name(format) + " (nlohmann SAX)", [&] {
+            bench::doNotOptimize(saxParse(body, format));
+        });
+        if (format == ResponseFormat::Json) {
+            encode_json = encoded;
+            decode_json = decoded;
+        } else {
+            bench::ratio(encode_json, encoded);
+            bench::ratio(decode_json, decoded);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    const size_t kRows = 10000;
+    std::vector<ProductRow> products = makeProducts(kRows);
+    std::vector<LogRow> logs = makeLogs(kRows);
+
+    if (!compareFormats("products", kRows, [&](ResponseFormat f) { return encodeProducts(products, f); }) ||
+        !compareFormats("notification logs", kRows, [&](ResponseFormat f) { return encodeLogs(logs, f); })) {
+        return 1;
+    }
+
+    std::printf("\nproducts through an nlohmann tree, %zu rows\n", kRows);
+    auto direct = bench::run("  ResponseWriter msgpack", [&] {
+        bench::doNotOptimize(encodeProducts(products, ResponseFormat::MsgPack));
+    });
+    auto tree = bench::run("  json tree + to_msgpack", [&] {
+        bench::doNotOptimize(json::to_msgpack(productTree(products)));
+    });
+    bench::ratio(tree, direct);
+    return 0;
+}
@@ -0,0 +1,170 @@
+// Cost of building domain::product and user objects from result rows, as
+// ProductRepo and UserRepo do: decode each column by name into a temporary
+// std::string, then hand it to the constructor. product takes its strings
+// by const reference and copies them; user takes them by value and
+// copy-assigns them in the body. Both are measured against a variant that
+// takes by value and moves (Moved*), which is what either would cost
+// after that change.
+//
+// Heap allocations per object are counted through a global operator new;
+// unlike the timings they are exact, so a change to them is a regression
+// or an improvement, not noise. Rows come from bench/FakeRows.h.
+//
+//   make bench_domain_construction && ./bench_domain_construction
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BenchUtil.h"
+#include "FakeRows.h"
+#include "domain/product.h"
+#include "domain/user.h"
+
+namespace {
+
+size_t g_heap_allocations = 0;
+
+} // namespace
+
+void* operator new(size_t n) {
+    ++g_heap_allocations;
+    if (void* p = std::malloc(n)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using bench::FakeResult;
+using bench::FakeRow;
+
+const size_t kRows = 100000;
+
+class MovedProduct {
+public:
+    MovedProduct(int id, std::string name, std::string description)
+        : id(id), name(std::move(name)), description(std::move(description)) {}
+
+    int get_id() const { return id; }
+
+private:
+    int id;
+    std::string name;
+    std::string description;
+};
+
+class MovedUser {
+public:
+    MovedUser(int id, std::string name, std::string email, std::string role)
+        : user_id(id), email(std::move(email)), name(std::move(name)), role(std::move(role)) {}
+
+    int get_id() const { return user_id; }
+
+private:
+    int user_id;
+    std::string email;
+    std::string name;
+    std::string role;
+};
+
+FakeResult makeProducts(size_t n) {
+    FakeResult r;
+    r.columns = {"id", "name", "description"};
+    for (size_t i = 0; i < n; ++i) {
+        r.cells.push_back(std::to_string(i + 1));
+        r.cells.push_back("Wireless charging phone stand " + std::to_string(i));
+        r.cells.push_back("Fast-charging stand with adjustable angle, model " + std::to_string(i));
+        r.nulls.insert(r.nulls.end(), 3, false);
+    }
+    return r;
+}
+
+FakeResult makeUsers(size_t n) {
+    FakeResult r;
+    r.columns = {"id", "name", "email", "role"};
+    for (size_t i = 0; i < n; ++i) {
+        r.cells.push_back(std::to_string(i + 1));
+        r.cells.push_back("Customer number " + std::to_string(i));
+        r.cells.push_back("customer" + std::to_string(i) + "@example.com");
+        r.cells.push_back(i % 50 == 0 ? "admin" : "user");
+        r.nulls.insert(r.nulls.end(), 4, false);
+    }
+    return r;
+}
+
+template <typename Product>
+std::vector<Product> buildProducts(const FakeResult& r, size_t rows) {
+    std::vector<Product> out;
+    out.reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        FakeRow row(&r, i);
+        out.push_back(Product(row["id"].as<int>(), row["name"].as<std::string>(),
+                              row["description"].as<std::string>()));
+    }
+    return out;
+}
+
+template <typename User>
+std::vector<User> buildUsers(const FakeResult& r, size_t rows) {
+    std::vector<User> out;
+    out.reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        FakeRow row(&r, i);
+        out.push_back(User(row["id"].as<int>(), row["name"].as<std::string>(), row["email"].as<std::string>(),
+                           row["role"].as<std::string>()));
+    }
+    return out;
+}
+
+// Allocations per object, not counting the result vector itself
+template <typename Build>
+double allocationsPerObject(Build&& build) {
+    size_t before = g_heap_allocations;
+    auto out = build();
+    return static_cast<double>(g_heap_allocations - before - 1) / static_cast<double>(out.size());
+}
+
+} // namespace
+
+int main() {
+    FakeResult products = makeProducts(kRows);
+    FakeResult users = makeUsers(kRows);
+    std::printf("%zu rows each\n", kRows);
+
+    std::printf("%-44s %5.2f allocations/object\n", "product (const& + copy)",
+                allocationsPerObject([&] { return buildProducts<product>(products, kRows); }));
+    std::printf("%-44s %5.2f allocations/object\n", "product (by value + move)",
+                allocationsPerObject([&] { return buildProducts<MovedProduct>(products, kRows); }));
+    std::printf("%-44s %5.2f allocations/object\n", "user (by value + assign)",
+                allocationsPerObject([&] { return buildUsers<user>(users, kRows); }));
+    std::printf("%-44s %5.2f allocations/object\n", "user (by value + move)",
+                allocationsPerObject([&] { return buildUsers<MovedUser>(users, kRows); }));
+
+    auto productCopy = bench::run("product (const& + copy)", [&] {
+        bench::doNotOptimize(buildProducts<product>(products, kRows));
+    });
+    auto productMove = bench::run("product (by value + move)", [&] {
+        bench::doNotOptimize(buildProducts<MovedProduct>(products, kRows));
+    });
+    bench::ratio(productCopy, productMove);
+
+    auto userAssign = bench::run("user (by value + assign)", [&] {
+        bench::doNotOptimize(buildUsers<user>(users, kRows));
+    });
+    auto userMove = bench::run("user (by value + move)", [&] {
+        bench::doNotOptimize(buildUsers<MovedUser>(users, kRows));
+    });
+    bench::ratio(userAssign, userMove);
+    return 0;
+}
@@ -0,0 +1,202 @@
+// BM25 full-text index on a synthetic catalog: build time, memory footprint
+// (varint/delta postings vs. raw text) and query latency for 1-3 term
+// queries, top-10. A sample of queries is checked against exhaustive BM25
+// scoring over the same documents.
+//
+//   make bench_fulltext && ./bench_fulltext [products]
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BenchUtil.h"
+#include "index/FullTextIndex.h"
+
+// Zipf-distributed vocabulary, like product copy: a few words everywhere,
+// a long tail of rare ones.
+class Vocabulary {
+public:
+    Vocabulary(size_t size, std::mt19937& rng) : rng(rng) {
+        std::uniform_int_distribution<int> len(3, 9);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        for (size_t i = 0; i < size; ++i) {
+            std::string w;
+            int n = len(rng);
+            for (int k = 0; k < n; ++k) {
+                w.push_back(static_cast<char>(letter(rng)));
+            }
+            words.push_back(w + std::to_string(i));
+        }
+        double total = 0;
+        for (size_t i = 0; i < size; ++i) {
+            total += 1.0 / std::pow(static_cast<double>(i + 1), 1.05);
+            cdf.push_back(total);
+        }
+        for (double& c : cdf) {
+            c /= total;
+        }
+    }
+
+    const std::string& draw() {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        size_t i = static_cast<size_t>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+        return words[std::min(i, words.size() - 1)];
+    }
+
+    const std::string& at(size_t i) const { return words[i]; }
+
+private:
+    std::mt19937& rng;
+    std::vector<std::string> words;
+    std::vector<double> cdf;
+};
+
+static std::string sentence(Vocabulary& vocab, std::mt19937& rng, int min_words, int max_words) {
+    std::string s;
+    int n = std::uniform_int_distribution<int>(min_words, max_words)(rng);
+    for (int i = 0; i < n; ++i) {
+        if (i) {
+            s += (i % 7 == 0) ? ". " : " ";
+        }
+        s += vocab.draw();
+    }
+    return s;
+}
+
+// Exhaustive BM25 with the index's conventions (name terms weighted,
+// N and df over all documents) for verification.
+static std::vector<FullTextIndex::Hit> bruteForce(const std::vector<FullTextIndex::Document>& docs,
+                                                  const std::string& query, size_t limit) {
+    auto terms = FullTextIndex::tokenize(query);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    std::vector<std::unordered_map<std::string, uint32_t>> tfs(docs.size());
+    std::vector<uint32_t> lens(docs.size(), 0);
+    std::map<std::string, uint32_t> df;
+    double total = 0;
+    for (size_t d = 0; d < docs.size(); ++d) {
+        for (auto& t : FullTextIndex::tokenize(docs[d].name)) {
+            tfs[d][t] += FullTextIndex::kNameWeight;
+            lens[d] += FullTextIndex::kNameWeight;
+        }
+        for (auto& t : FullTextIndex::tokenize(docs[d].description)) {
+            tfs[d][t] += 1;
+            lens[d] += 1;
+        }
+        total += lens[d];
+        for (const auto& t : terms) {
+            if (tfs[d].count(t)) {
+                ++df[t];
+            }
+        }
+    }
+    float n = static_cast<float>(docs.size());
+    float avgdl = static_cast<float>(total / docs.size());
+    std::vector<FullTextIndex::Hit> hits;
+    for (size_t d = 0; d < docs.size(); ++d) {
+        float norm = FullTextIndex::kK1 * (1.0f - FullTextIndex::kB + FullTextIndex::kB * lens[d] / avgdl);
+        float score = 0;
+        bool any = false;
+        for (const auto& t : terms) {
+            auto it = tfs[d].find(t);
+            if (it == tfs[d].end()) {
+                continue;
+            }
+            any = true;
+            float f = static_cast<float>(df[t]);
+            float idf = std::log(1.0f + (n - f + 0.5f) / (f + 0.5f));
+            float tf = static_cast<float>(it->second);
+            score += idf * tf * (FullTextIndex::kK1 + 1.0f) / (tf + norm);
+        }
+        if (any) {
+            hits.push_back(FullTextIndex::Hit{docs[d].id, score});
+        }
+    }
+    std::sort(hits.begin(), hits.end(), [](const auto& a, const auto& b) {
+        return a.score != b.score ? a.score > b.score : a.id < b.id;
+    });
+    if (hits.size() > limit) {
+        hits.resize(limit);
+    }
+    return hits;
+}
+
+int main(int argc, char** argv) {
+    const size_t kProducts = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+    const size_t kQueries = 2000;
+    const size_t kLimit = 10;
+    std::mt19937 rng(7);
+    Vocabulary vocab(50000, rng);
+
+    std::vector<FullTextIndex::Document> docs;
+    docs.reserve(kProducts);
+    size_t raw_bytes = 0;
+    for (size_t i = 0; i < kProducts; ++i) {
+        FullTextIndex::Document d{static_cast<uint32_t>(i + 1), sentence(vocab, rng, 2, 5),
+                                  sentence(vocab, rng, 10, 40)};
+        raw_bytes += d.name.size() + d.description.size();
+        docs.push_back(std::move(d));
+    }
+
+    FullTextIndex index;
+    bench::run("rebuild", [&] { index.rebuild([&] { return docs; }); }, 1, 0);
+    std::printf("docs %zu   terms %zu   raw text %.1f MB   postings %.1f MB   index total %.1f MB\n",
+                index.size(), index.termCount(), raw_bytes / 1e6, index.postingBytes() / 1e6,
+                index.memoryBytes() / 1e6);
+
+    // Queries mix frequent and tail words
+    std::vector<std::string> queries;
+    for (size_t i = 0; i < kQueries; ++i) {
+        int terms = 1 + static_cast<int>(i % 3);
+        std::string q;
+        for (int t = 0; t < terms; ++t) {
+            q += (t ? " " : "") + vocab.draw();
+        }
+        queries.push_back(q);
+    }
+
+    size_t sink = 0;
+    for (size_t i = 0; i < 100; ++i) {
+        sink += index.search(queries[i], kLimit).size();
+    }
+    for (int terms = 1; terms <= 3; ++terms) {
+        bench::Latency latency;
+        for (size_t i = static_cast<size_t>(terms - 1); i < queries.size(); i += 3) {
+            latency.time([&] { sink += index.search(queries[i], kLimit).size(); });
+        }
+        latency.print("search top-10, " + std::to_string(terms) + " term(s)");
+    }
+
+    // Updates append new documents; check results still match afterwards
+    std::uniform_int_distribution<size_t> pick(0, docs.size() - 1);
+    bench::Latency writes;
+    for (size_t i = 0; i < 5000; ++i) {
+        auto& d = docs[pick(rng)];
+        d.description = sentence(vocab, rng, 10, 40);
+        writes.time([&] { index.update(d.id, d.name, d.description); });
+    }
+    writes.print("update()");
+
+    // Exhaustive scoring is slow, so verify on a fresh small index
+    std::vector<FullTextIndex::Document> small(docs.begin(), docs.begin() + std::min<size_t>(docs.size(), 20000));
+    FullTextIndex check;
+    check.rebuild([&] { return small; });
+    size_t mismatches = 0;
+    for (size_t i = 0; i < 60; ++i) {
+        auto got = check.search(queries[i], kLimit);
+        auto want = bruteForce(small, queries[i], kLimit);
+        bool same = got.size() == want.size();
+        for (size_t k = 0; same && k < got.size(); ++k) {
+            same = got[k].id == want[k].id && std::fabs(got[k].score - want[k].score) < 1e-3f;
+        }
+        mismatches += same ? 0 : 1;
+    }
+    bench::doNotOptimize(sink);
+    std::printf("verification mismatches: %zu / 60\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,556 @@
+// Fills an empty inventory_db with a benchmark-scale synthetic dataset:
+// users, products, inventory, subscriptions, product_notifications and
+// notification_logs (plus product_subscriber_counts, derived from the
+// notifications), so bench_load and EXPLAIN run against production-like
+// volumes and skew instead of the empty database db/init.sql creates.
+//
+// Shape of the data
+//   - Product popularity is Zipfian (--zipf): product id k has rank k, the
+//     same convention bench_load uses for its request mix, so the load
+//     generator's hot products are the dataset's hot products.
+//   - The first --hot-skus products are launch SKUs: each is watched by
+//     exactly --hot-watchers users (subscription plus pending restock
+//     notification) and is out of stock, ready for a restock fan-out.
+//   - Every user also watches an exponentially distributed number of
+//     other products (mean --watches-per-user) drawn from the Zipf
+//     distribution; product_notifications mirrors subscriptions, with a
+//     share (--sent-ratio) already sent.
+//   - notification_logs (--logs) record deliveries of random notifications,
+//     mostly sent, some failed or retried.
+//   - Timestamps fall in the year before 2026-01-01 UTC.
+//
+// Every row is a pure function of --seed, its table and its row number, so
+// the same seed gives the same database whatever --streams is.
+//
+// Rows are loaded with COPY over --streams connections in parallel, in
+// three phases that respect the foreign keys (users and products; then
+// inventory, subscriptions and notifications; then logs). Sequences are
+// moved past the generated ids and the tables analysed at the end. The
+// target tables must be empty; --truncate empties them first.
+//
+//   make generate_dataset
+//   ./generate_dataset --users=1000000 --products=100000 --streams=8 --truncate
+//   ./bench_load --products=100000 --users=1000000 ...
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <pqxx/pqxx>
+#include "server/Config.h"
+#include "util/IsoTime.h"
+
+namespace {
+
+struct Options {
+    std::string dsn = Config::envString(
+        "DATABASE_DSN", "host=localhost port=5432 dbname=inventory_db user=inventory_user password=inventory_pass");
+    uint64_t users = 1000000;
+    uint64_t products = 100000;
+    double watches_per_user = 4;
+    uint64_t hot_skus = 10;
+    uint64_t hot_watchers = 100000;
+    double zipf = 1.1;
+    double sent_ratio = 0.4;
+    uint64_t logs = 2000000;
+    uint64_t seed = 42;
+    size_t streams = 8;
+    bool truncate = false;
+};
+
+// 2026-01-01T00:00:00Z; generated timestamps fall in the year before it
+const int64_t kEndMicros = 1767225600LL * 1000000;
+const int64_t kYearMicros = 365LL * 86400 * 1000000;
+// No user watches more than this many non-hot products
+const uint64_t kMaxWatches = 200;
+
+const char* const kAdjectives[] = {"Wireless", "Compact", "Premium", "Classic", "Portable", "Smart",
+                                   "Ergonomic", "Vintage", "Foldable", "Rugged", "Slim", "Deluxe"};
+// The nouns bench_load searches and autocompletes
+const char* const kNouns[] = {"phone", "laptop", "cable", "chair", "lamp", "desk",
+                              "shoe", "watch", "camera", "speaker", "bottle", "jacket"};
+const char* const kFirstNames[] = {"Alex", "Sam", "Jordan", "Taylor", "Morgan", "Casey", "Riley", "Jamie",
+                                   "Avery", "Quinn", "Robin", "Drew", "Kai", "Noor", "Ines", "Mateo"};
+const char* const kLastNames[] = {"Smith", "Garcia", "Chen", "Okafor", "Novak", "Silva", "Kim", "Haddad",
+                                  "Rossi", "Patel", "Dubois", "Nielsen", "Ivanova", "Tanaka", "Moreau", "Lopez"};
+
+template <typename T, size_t N>
+const char* pick(const T (&words)[N], uint64_t r) {
+    return words[r % N];
+}
+
+// Per-table tags mixed into each row's random stream
+enum Tag : uint64_t { kUserTag = 1, kProductTag, kInventoryTag, kWatchCountTag, kWatchTag, kPairTag, kLogTag };
+
+// splitmix64 over (seed, table, row): independent, reproducible draws per
+// row without any shared generator state between streams
+class RowRng {
+public:
+    RowRng(uint64_t seed, uint64_t tag, uint64_t row) : state(seed) {
+        state = next() ^ tag;
+        state = next() ^ row;
+    }
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+    uint64_t below(uint64_t n) { return next() % n; }
+
+private:
+    uint64_t state;
+};
+
+// P(rank k) proportional to 1 / k^s over products 1..n
+class Zipf {
+public:
+    Zipf(uint64_t n, double s) : cdf(n) {
+        double total = 0;
+        for (uint64_t k = 0; k < n; ++k) {
+            total += 1.0 / std::pow(static_cast<double>(k + 1), s);
+            cdf[k] = total;
+        }
+        for (double& c : cdf) {
+            c /= total;
+        }
+    }
+
+    uint64_t operator()(RowRng& rng) const {
+        auto it = std::lower_bound(cdf.begin(), cdf.end(), rng.uniform());
+        return std::min<uint64_t>(static_cast<uint64_t>(it - cdf.begin()), cdf.size() - 1) + 1;
+    }
+
+private:
+    std::vector<double> cdf;
+};
+
+// Which products each user watches. The k-th hot SKU is watched by the
+// users u with (u - 1) * stride_k mod users < hot_watchers: exactly
+// hot_watchers of them for a stride coprime with the user count, and a
+// different set per SKU. Subscription and notification ids number the
+// (user, product) pairs in user order, so offsets[u - 1] is the number of
+// pairs before user u.
+class Watches {
+public:
+    Watches(const Options& opt) : opt(opt), zipf(opt.products, opt.zipf) {
+        uint64_t stride = 2654435761ULL % opt.users;
+        for (uint64_t k = 0; k < opt.hot_skus; ++k) {
+            do {
+                stride = stride % opt.users + 1;
+            } while (std::gcd(stride, opt.users) != 1 && opt.users > 1);
+            strides.push_back(stride);
+            stride += 7919;
+        }
+        offsets.resize(opt.users + 1, 0);
+        for (uint64_t u = 1; u <= opt.users; ++u) {
+            offsets[u] = offsets[u - 1] + hotCount(u) + regularCount(u);
+        }
+    }
+
+    uint64_t total() const { return offsets.back(); }
+
+    // Product ids watched by user u, hot SKUs first
+    std::vector<uint64_t> of(uint64_t u) const {
+        std::vector<uint64_t> watched;
+        for (uint64_t k = 0; k < opt.hot_skus; ++k) {
+            if (watchesHot(u, k)) {
+                watched.push_back(k + 1);
+            }
+        }
+        RowRng rng(opt.seed, kWatchTag, u);
+        for (uint64_t n = regularCount(u); n > 0;) {
+            uint64_t product = zipf(rng);
+            if (product > opt.hot_skus && std::find(watched.begin(), watched.end(), product) == watched.end()) {
+                watched.push_back(product);
+                --n;
+            }
+        }
+        return watched;
+    }
+
+    // The (user, product) pair with 0-based subscription index i
+    std::pair<uint64_t, uint64_t> pair(uint64_t i) const {
+        uint64_t u = static_cast<uint64_t>(std::upper_bound(offsets.begin(), offsets.end(), i) - offsets.begin());
+        return {u, of(u)[i - offsets[u - 1]]};
+    }
+
+    uint64_t firstIndex(uint64_t u) const { return offsets[u - 1]; }
+
+    bool isHot(uint64_t product) const { return product <= opt.hot_skus; }
+
+private:
+    bool watchesHot(uint64_t u, uint64_t k) const {
+        return (u - 1) * strides[k] % opt.users < opt.hot_watchers;
+    }
+
+    uint64_t hotCount(uint64_t u) const {
+        uint64_t n = 0;
+        for (uint64_t k = 0; k < opt.hot_skus; ++k) {
+            n += watchesHot(u, k) ? 1 : 0;
+        }
+        return n;
+    }
+
+    // Exponential with mean watches_per_user, capped so rejection sampling
+    // of distinct products always finishes quickly
+    uint64_t regularCount(uint64_t u) const {
+        uint64_t cold = opt.products - opt.hot_skus;
+        uint64_t cap = std::min<uint64_t>(kMaxWatches, cold / 2);
+        RowRng rng(opt.seed, kWatchCountTag, u);
+        double n = -opt.watches_per_user * std::log(1.0 - rng.uniform());
+        return std::min<uint64_t>(static_cast<uint64_t>(n), cap);
+    }
+
+    const Options& opt;
+    Zipf zipf;
+    std::vector<uint64_t> strides;
+    std::vector<uint64_t> offsets;
+};
+
+// COPY text format; generated text never contains tabs, newlines or
+// backslashes, so only NULL needs spelling out
+class Line {
+public:
+    explicit Line(std::string& out) : out(out) { out.clear(); }
+
+    Line& operator()(uint64_t v) { return text(std::to_string(v)); }
+    Line& operator()(std::string_view v) { return text(v); }
+    Line& boolean(bool v) { return text(v ? "t" : "f"); }
+    Line& timestamp(int64_t micros) { return text(isotime::format(micros).view()); }
+    Line& null() { return text("\\N"); }
+
+private:
+    Line& text(std::string_view v) {
+        if (!out.empty()) {
+            out += '\t';
+        }
+        out.append(v.data(), v.size());
+        return *this;
+    }
+
+    std::string& out;
+};
+
+int64_t timeInYear(RowRng& rng) {
+    return kEndMicros - static_cast<int64_t>(rng.below(static_cast<uint64_t>(kYearMicros)));
+}
+
+// Random draws are taken into locals in a fixed order, never inside one
+// expression, so rows do not depend on the compiler's evaluation order
+void userRow(const Options& opt, uint64_t id, std::string& out) {
+    RowRng rng(opt.seed, kUserTag, id);
+    const char* first = pick(kFirstNames, rng.next());
+    const char* last = pick(kLastNames, rng.next());
+    bool admin = rng.below(1000) == 0;
+    int64_t created = timeInYear(rng);
+    Line row(out);
+    row(id)(std::string(first) + " " + last)("user" + std::to_string(id) + "@example.com")(admin ? "ADMIN" : "USER")
+        .timestamp(created);
+}
+
+void productRow(const Options& opt, uint64_t id, std::string& out) {
+    RowRng rng(opt.seed, kProductTag, id);
+    std::string item = std::string(pick(kAdjectives, rng.next())) + " " + pick(kNouns, rng.next());
+    uint64_t model = rng.below(10000);
+    uint64_t ships_in = 1 + rng.below(10);
+    int64_t created = timeInYear(rng);
+    Line row(out);
+    row(id)(item + " " + std::to_string(id))(item + ", model " + std::to_string(model) + ". Ships in " +
+                                             std::to_string(ships_in) + " days.")
+        .timestamp(created);
+}
+
+void inventoryRow(const Options& opt, const Watches& watches, uint64_t product, std::string& out) {
+    RowRng rng(opt.seed, kInventoryTag, product);
+    // Launch SKUs are sold out; a sixth of the rest too, most others well
+    // stocked with a long tail below their reorder point
+    uint64_t stock = 0;
+    if (!watches.isHot(product) && rng.below(6) != 0) {
+        stock = std::min<uint64_t>(static_cast<uint64_t>(-60.0 * std::log(1.0 - rng.uniform())) + 1, 5000);
+    }
+    uint64_t reorder_point = 5 + rng.below(46);
+    int64_t updated = timeInYear(rng);
+    Line row(out);
+    row(product)(stock)(reorder_point).timestamp(updated);
+}
+
+// User u's subscriptions or product_notifications, one line per watched
+// product; both tables share ids and creation times for the same pair
+void watchRows(const Options& opt, const Watches& watches, uint64_t u, bool subscriptions, std::string& out) {
+    out.clear();
+    std::string line;
+    uint64_t id = watches.firstIndex(u) + 1;
+    for (uint64_t product : watches.of(u)) {
+        RowRng rng(opt.seed, kPairTag, id);
+        int64_t created = timeInYear(rng);
+        Line row(line);
+        if (subscriptions) {
+            bool active = watches.isHot(product) || rng.below(20) != 0;
+            row(id)(u)(product).boolean(active).timestamp(created);
+        } else {
+            // Launch SKUs have only pending watchers
+            bool sent = !watches.isHot(product) && rng.uniform() < opt.sent_ratio;
+            int64_t updated = sent ? created + static_cast<int64_t>(rng.below(30ULL * 86400 * 1000000)) : created;
+            row(id)(product)(u)("restocked").boolean(sent);
+            sent ? row.timestamp(updated) : row.null();
+            row.timestamp(created).timestamp(updated);
+        }
+        if (!out.empty()) {
+            out += '\n';
+        }
+        out += line;
+        ++id;
+    }
+}
+
+void logRow(const Options& opt, const Watches& watches, uint64_t id, std::string& out) {
+    RowRng rng(opt.seed, kLogTag, id);
+    uint64_t notification = rng.below(watches.total());
+    auto [user, product] = watches.pair(notification);
+    int64_t created = timeInYear(rng);
+    uint64_t roll = rng.below(100);
+    bool sent = roll < 85;
+    bool failed = roll >= 85 && roll < 93;
+    bool retried = roll >= 98;
+    const char* status = sent ? "sent" : failed ? "failed" : retried ? "retried" : "pending";
+    uint64_t retries = failed ? 1 + rng.below(3) : retried ? 1 : 0;
+    int64_t delivered = created + 1000000;
+
+    Line row(out);
+    row(id)(notification + 1)(user)(product)("restocked")("Product " + std::to_string(product) + " is back in stock")(
+        status)(retries)(3);
+    failed ? row(rng.below(2) ? "SMTP timeout" : "Mailbox unavailable") : row.null();
+    sent || retried ? row.timestamp(delivered) : row.null();
+    row.timestamp(created).timestamp(sent || retried ? delivered : created);
+}
+
+// Runs jobs on `streams` threads, each job one COPY on its own connection
+struct Job {
+    std::string table;
+    std::string columns;
+    uint64_t begin;  // row numbers [begin, end)
+    uint64_t end;
+    std::function<void(uint64_t, std::string&)> row;
+};
+
+// Returns the number of rows written
+uint64_t copyRows(const Options& opt, const Job& job) {
+    pqxx::connection conn(opt.dsn);
+    pqxx::work txn(conn);
+    auto stream = pqxx::stream_to::raw_table(txn, job.table, job.columns);
+    std::string line;
+    uint64_t rows = 0;
+    for (uint64_t i = job.begin; i < job.end; ++i) {
+        job.row(i, line);
+        // A user watching nothing has no lines
+        if (!line.empty()) {
+            stream.write_raw_line(line);
+            rows += 1 + static_cast<uint64_t>(std::count(line.begin(), line.end(), '\n'));
+        }
+    }
+    stream.complete();
+    txn.commit();
+    return rows;
+}
+
+bool runPhase(const Options& opt, const char* name, const std::vector<Job>& jobs) {
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::atomic<uint64_t> rows{0};
+    std::mutex log;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < std::min(opt.streams, jobs.size()); ++t) {
+        threads.emplace_back([&] {
+            for (size_t j; !failed && (j = next.fetch_add(1)) < jobs.size();) {
+                try {
+                    rows += copyRows(opt, jobs[j]);
+                } catch (const std::exception& e) {
+                    failed = true;
+                    std::lock_guard<std::mutex> lock(log);
+                    std::cerr << "❌ COPY " << jobs[j].table << " rows " << jobs[j].begin << "-" << jobs[j].end
+                              << " failed: " << e.what() << std::endl;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (failed) {
+        std::cerr << "⚠️ Other streams may have committed; rerun with --truncate" << std::endl;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!failed) {
+        std::cout << "✅ " << name << ": " << rows.load() << " rows in " << seconds << " s ("
+                  << static_cast<uint64_t>(static_cast<double>(rows.load()) / std::max(seconds, 1e-9)) << " rows/s)"
+                  << std::endl;
+    }
+    return !failed;
+}
+
+// Splits rows [first, first + count) into about 4 jobs per stream, so
+// streams that finish early pick up the remainder
+void addJobs(std::vector<Job>& jobs, const Options& opt, const std::string& table, const std::string& columns,
+             uint64_t first, uint64_t count, std::function<void(uint64_t, std::string&)> row) {
+    uint64_t parts = std::max<uint64_t>(1, std::min<uint64_t>(count, opt.streams * 4));
+    for (uint64_t p = 0; p < parts; ++p) {
+        uint64_t begin = first + count * p / parts;
+        uint64_t end = first + count * (p + 1) / parts;
+        if (begin < end) {
+            jobs.push_back(Job{table, columns, begin, end, row});
+        }
+    }
+}
+
+const char* const kTables = "users, products, inventory, inventory_events, subscriptions, product_notifications, "
+                            "notification_logs, product_subscriber_counts, notification_preferences";
+
+bool prepare(const Options& opt) {
+    pqxx::connection conn(opt.dsn);
+    pqxx::work txn(conn);
+    if (opt.truncate) {
+        txn.exec(std::string("TRUNCATE ") + kTables + " RESTART IDENTITY CASCADE");
+        std::cout << "🧹 Truncated " << kTables << std::endl;
+    } else if (txn.exec("SELECT EXISTS (SELECT 1 FROM users) OR EXISTS (SELECT 1 FROM products)")[0][0].as<bool>()) {
+        std::cerr << "❌ users or products is not empty; rerun with --truncate to replace the data" << std::endl;
+        return false;
+    }
+    txn.commit();
+    return true;
+}
+
+void finish(const Options& opt) {
+    pqxx::connection conn(opt.dsn);
+    pqxx::work txn(conn);
+    for (const char* table : {"users", "products", "subscriptions", "product_notifications", "notification_logs"}) {
+        txn.exec(std::string("SELECT setval(pg_get_serial_sequence('") + table + "', 'id'), "
+                 "GREATEST((SELECT MAX(id) FROM " + table + "), 1))");
+    }
+    txn.exec("INSERT INTO product_subscriber_counts (product_id, pending) "
+             "SELECT product_id, COUNT(*) FROM product_notifications WHERE is_sent = FALSE GROUP BY product_id");
+    txn.exec("ANALYZE users, products, inventory, subscriptions, product_notifications, notification_logs, "
+             "product_subscriber_counts");
+    txn.commit();
+    std::cout << "✅ Sequences advanced, subscriber counts built, tables analysed" << std::endl;
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--truncate") {
+            opt.truncate = true;
+            continue;
+        }
+        size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            return false;
+        }
+        std::string key = arg.substr(2, eq - 2);
+        const char* value = arg.c_str() + eq + 1;
+        if (key == "dsn") {
+            opt.dsn = value;
+        } else if (key == "users") {
+            opt.users = std::strtoull(value, nullptr, 10);
+        } else if (key == "products") {
+            opt.products = std::strtoull(value, nullptr, 10);
+        } else if (key == "watches-per-user") {
+            opt.watches_per_user = std::atof(value);
+        } else if (key == "hot-skus") {
+            opt.hot_skus = std::strtoull(value, nullptr, 10);
+        } else if (key == "hot-watchers") {
+            opt.hot_watchers = std::strtoull(value, nullptr, 10);
+        } else if (key == "zipf") {
+            opt.zipf = std::atof(value);
+        } else if (key == "sent-ratio") {
+            opt.sent_ratio = std::atof(value);
+        } else if (key == "logs") {
+            opt.logs = std::strtoull(value, nullptr, 10);
+        } else if (key == "seed") {
+            opt.seed = std::strtoull(value, nullptr, 10);
+        } else if (key == "streams") {
+            opt.streams = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else {
+            return false;
+        }
+    }
+    opt.hot_watchers = std::min(opt.hot_watchers, opt.users);
+    return opt.users > 0 && opt.products > opt.hot_skus && opt.watches_per_user >= 0 && opt.sent_ratio >= 0 &&
+           opt.sent_ratio <= 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "usage: generate_dataset [--dsn=...] [--users=1000000] [--products=100000]\n"
+                     "                        [--watches-per-user=4] [--hot-skus=10] [--hot-watchers=100000]\n"
+                     "                        [--zipf=1.1] [--sent-ratio=0.4] [--logs=2000000] [--seed=42]\n"
+                     "                        [--streams=8] [--truncate]\n";
+        return 2;
+    }
+
+    try {
+        Watches watches(opt);
+        std::cout << "Generating " << opt.users << " users, " << opt.products << " products, " << watches.total()
+                  << " subscriptions and notifications, " << opt.logs << " logs (seed " << opt.seed << ", "
+                  << opt.streams << " streams)" << std::endl;
+        if (!prepare(opt)) {
+            return 1;
+        }
+
+        std::vector<Job> catalog;
+        addJobs(catalog, opt, "users", "id, name, email, role, created_at", 1, opt.users,
+                [&](uint64_t id, std::string& out) { userRow(opt, id, out); });
+        addJobs(catalog, opt, "products", "id, name, description, created_at", 1, opt.products,
+                [&](uint64_t id, std::string& out) { productRow(opt, id, out); });
+        if (!runPhase(opt, "users, products", catalog)) {
+            return 1;
+        }
+
+        std::vector<Job> watching;
+        addJobs(watching, opt, "inventory", "product_id, stock, reorder_point, updated_at", 1, opt.products,
+                [&](uint64_t id, std::string& out) { inventoryRow(opt, watches, id, out); });
+        // Subscriptions and notifications are generated a user at a time:
+        // jobs cover user ranges and each "row" is all of a user's lines
+        addJobs(watching, opt, "subscriptions", "id, user_id, product_id, active, created_at", 1, opt.users,
+                [&](uint64_t u, std::string& out) { watchRows(opt, watches, u, true, out); });
+        addJobs(watching, opt, "product_notifications",
+                "id, product_id, user_id, notification_type, is_sent, sent_at, created_at, updated_at", 1, opt.users,
+                [&](uint64_t u, std::string& out) { watchRows(opt, watches, u, false, out); });
+        if (!runPhase(opt, "inventory, subscriptions, product_notifications", watching)) {
+            return 1;
+        }
+
+        std::vector<Job> logs;
+        if (watches.total() > 0) {
+            addJobs(logs, opt, "notification_logs",
+                    "id, notification_id, user_id, product_id, notification_type, message, status, retry_count, "
+                    "max_retries, error_message, sent_at, created_at, updated_at",
+                    1, opt.logs, [&](uint64_t id, std::string& out) { logRow(opt, watches, id, out); });
+        }
+        if (!runPhase(opt, "notification_logs", logs)) {
+            return 1;
+        }
+
+        finish(opt);
+    } catch (const std::exception& e) {
+        std::cerr << "❌ " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,477 @@
+// HTTP load generator for a running inventory_api, for measuring a change
+// end to end against a local Postgres rather than one function at a time.
+//
+// Each thread keeps one keep-alive connection and sends requests drawn from
+// a weighted mix of workloads:
+//
+//   browse   catalog browsing: product and inventory by id, name search,
+//            autocomplete, the low-stock page, the dashboard summary and
+//            a user's subscriptions (users uniform over --users)
+//   stock    stock-update bursts: runs of --burst PUT /api/inventory/:id on
+//            one hot product, with inventory reads in between
+//   restock  restock fan-out: hot products sold out (stock 0) and restocked,
+//            while others read the restocked feed and the watcher lists
+//
+// Product ids follow a Zipf distribution (--zipf, rank 1 = product id 1),
+// so a few SKUs take most of the traffic, as on a launch day.
+//
+// --rate=0 (default) runs closed loop: every thread sends its next request
+// when the previous one answers. --rate=N runs open loop at N requests/s
+// over all threads; latency is then measured from when each request was
+// due, not when it was sent, so a stalled server shows up as latency
+// rather than as fewer requests (no coordinated omission).
+//
+// Latencies go into one HdrHistogram per operation per thread and are
+// reported as p50/p99/p999. --out=FILE writes the results as JSON (--out=-
+// to stdout) so runs can be compared by script.
+//
+//   make bench_load
+//   ./bench_load --mix=browse:80,stock:15,restock:5 --threads=32 --duration=30 --out=load.json
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "HdrHistogram.h"
+#include "external/httplib.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string host = "localhost";
+    int port = 8080;
+    size_t threads = 16;
+    double duration_s = 30;
+    double warmup_s = 5;
+    double rate = 0;  // requests/s over all threads; 0 = closed loop
+    std::string mix = "browse";
+    int products = 1000;
+    int users = 1000;
+    double zipf = 1.1;
+    int burst = 8;
+    uint64_t seed = 42;
+    std::string out;
+};
+
+// Search and autocomplete terms: the nouns bench/generate_dataset.cpp
+// builds product names from, so the queries match products
+const char* const kSearchWords[] = {"phone", "laptop", "cable", "chair", "lamp", "desk",
+                                    "shoe", "watch", "camera", "speaker", "bottle", "jacket"};
+const size_t kSearchWordCount = sizeof(kSearchWords) / sizeof(kSearchWords[0]);
+
+enum class Workload { Browse, Stock, Restock };
+
+struct WeightedWorkload {
+    Workload workload;
+    double weight;
+};
+
+struct Request {
+    const char* op;
+    const char* method;
+    std::string path;
+    std::string body;
+};
+
+// P(rank k) proportional to 1 / k^s, sampled by binary search of the CDF
+class ZipfSampler {
+public:
+    ZipfSampler(int n, double s) : cdf(static_cast<size_t>(std::max(n, 1))) {
+        double total = 0;
+        for (size_t k = 0; k < cdf.size(); ++k) {
+            total += 1.0 / std::pow(static_cast<double>(k + 1), s);
+            cdf[k] = total;
+        }
+        for (double& c : cdf) {
+            c /= total;
+        }
+    }
+
+    // 1-based rank
+    int operator()(std::mt19937_64& rng) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        size_t k = static_cast<size_t>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+        return static_cast<int>(std::min(k, cdf.size() - 1)) + 1;
+    }
+
+private:
+    std::vector<double> cdf;
+};
+
+struct ThreadResult {
+    std::map<std::string, bench::HdrHistogram> ops;
+    bench::HdrHistogram all;
+    std::map<int, uint64_t> statuses;
+    uint64_t transport_errors = 0;
+    uint64_t unsent = 0;  // open loop: requests due before the end but never sent
+};
+
+class Worker {
+public:
+    Worker(const Options& opt, const ZipfSampler& zipf, const std::vector<WeightedWorkload>& mix, size_t index)
+        : opt(opt), zipf(zipf), mix(mix), rng(opt.seed + index) {}
+
+    Request next() {
+        if (burst_left > 0) {
+            --burst_left;
+            return stockUpdate(burst_product);
+        }
+        switch (pickWorkload()) {
+        case Workload::Browse:
+            return browse();
+        case Workload::Stock:
+            return stock();
+        case Workload::Restock:
+            return restock();
+        }
+        return browse();
+    }
+
+private:
+    Workload pickWorkload() {
+        double total = 0;
+        for (const auto& w : mix) {
+            total += w.weight;
+        }
+        double u = uniform() * total;
+        for (const auto& w : mix) {
+            if (u < w.weight) {
+                return w.workload;
+            }
+            u -= w.weight;
+        }
+        return mix.back().workload;
+    }
+
+    Request browse() {
+        double u = uniform();
+        int id = zipf(rng);
+        if (u < 0.50) {
+            return {"product_by_id", "GET", "/api/products/" + std::to_string(id), ""};
+        }
+        if (u < 0.70) {
+            return {"inventory_by_id", "GET", "/api/inventory/" + std::to_string(id), ""};
+        }
+        const char* word = kSearchWords[rng() % kSearchWordCount];
+        if (u < 0.80) {
+            return {"search", "GET", std::string("/api/products/search?name=") + word + "&limit=20", ""};
+        }
+        if (u < 0.90) {
+            return {"autocomplete", "GET", std::string("/api/products/autocomplete?prefix=") + std::string(word, 3) + "&limit=10", ""};
+        }
+        if (u < 0.93) {
+            return {"low_stock", "GET", "/api/inventory/low-stock?limit=50", ""};
+        }
+        if (u < 0.96) {
+            return {"dashboard", "GET", "/api/dashboard/summary?top=5", ""};
+        }
+        int user = 1 + static_cast<int>(rng() % static_cast<uint64_t>(opt.users));
+        return {"user_subscriptions", "GET", "/api/users/" + std::to_string(user) + "/subscriptions", ""};
+    }
+
+    Request stock() {
+        if (uniform() < 0.3) {
+            return {"inventory_by_id", "GET", "/api/inventory/" + std::to_string(zipf(rng)), ""};
+        }
+        burst_product = zipf(rng);
+        burst_left = std::max(opt.burst, 1) - 1;
+        return stockUpdate(burst_product);
+    }
+
+    Request stockUpdate(int id) {
+        int stock = 1 + static_cast<int>(rng() % 500);
+        return {"stock_update", "PUT", "/api/inventory/" + std::to_string(id),
+                "{\"stock\":" + std::to_string(stock) + "}"};
+    }
+
+    Request restock() {
+        double u = uniform();
+        int id = zipf(rng);
+        if (u < 0.35) {
+            return {"sell_out", "PUT", "/api/inventory/" + std::to_string(id), "{\"stock\":0}"};
+        }
+        if (u < 0.70) {
+            int stock = 25 + static_cast<int>(rng() % 76);
+            return {"restock", "PUT", "/api/inventory/" + std::to_string(id),
+                    "{\"stock\":" + std::to_string(stock) + "}"};
+        }
+        if (u < 0.85) {
+            return {"restocked_feed", "GET", "/api/notifications/restocked?limit=50", ""};
+        }
+        return {"watchers", "GET", "/api/notifications/product/" + std::to_string(id), ""};
+    }
+
+    double uniform() { return std::uniform_real_distribution<double>(0.0, 1.0)(rng); }
+
+    const Options& opt;
+    const ZipfSampler& zipf;
+    const std::vector<WeightedWorkload>& mix;
+    std::mt19937_64 rng;
+    int burst_left = 0;
+    int burst_product = 0;
+};
+
+void runThread(const Options& opt, const ZipfSampler& zipf, const std::vector<WeightedWorkload>& mix,
+               size_t index, Clock::time_point start, ThreadResult& result) {
+    httplib::Client client(opt.host, opt.port);
+    client.set_keep_alive(true);
+    client.set_tcp_nodelay(true);
+    client.set_connection_timeout(5);
+    client.set_read_timeout(30);
+    // One client per thread, so per-client rate limits and read-your-writes
+    // treat threads as separate users (the server believes the header only
+    // from RATE_LIMIT_TRUSTED_PROXIES, e.g. 127.0.0.1 for a local run)
+    httplib::Headers headers{{"X-Client-Id", "bench-" + std::to_string(index)}};
+
+    Worker worker(opt, zipf, mix, index);
+    auto record_from = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt.warmup_s));
+    auto stop = record_from + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt.duration_s));
+
+    // Open loop: this thread's share of --rate, offset so threads interleave
+    Clock::duration interval{0};
+    Clock::time_point due = start;
+    if (opt.rate > 0) {
+        interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(opt.threads) / opt.rate));
+        due += interval * static_cast<long>(index) / static_cast<long>(opt.threads);
+    }
+
+    while (true) {
+        Clock::time_point sent;
+        if (opt.rate > 0) {
+            if (due >= stop) {
+                break;
+            }
+            // A server slower than the schedule would stretch the run
+            // without bound; stop on time and count what was never sent
+            if (Clock::now() >= stop) {
+                result.unsent += static_cast<uint64_t>((stop - due) / interval) + 1;
+                break;
+            }
+            std::this_thread::sleep_until(due);
+            sent = due;
+            due += interval;
+        } else {
+            sent = Clock::now();
+            if (sent >= stop) {
+                break;
+            }
+        }
+
+        Request r = worker.next();
+        httplib::Result res = r.method[0] == 'G'
+                                  ? client.Get(r.path, headers)
+                                  : client.Put(r.path, headers, r.body, "application/json");
+        auto done = Clock::now();
+        if (sent < record_from) {
+            continue;
+        }
+        if (!res) {
+            result.transport_errors++;
+            continue;
+        }
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(done - sent).count());
+        result.ops[r.op].record(ns);
+        result.all.record(ns);
+        result.statuses[res->status]++;
+    }
+}
+
+json summarise(const bench::HdrHistogram& h, double seconds) {
+    auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+    return json{
+        {"count", h.count()},
+        {"throughput_rps", static_cast<double>(h.count()) / seconds},
+        {"mean_us", h.mean() / 1000.0},
+        {"p50_us", us(h.percentile(50))},
+        {"p90_us", us(h.percentile(90))},
+        {"p99_us", us(h.percentile(99))},
+        {"p999_us", us(h.percentile(99.9))},
+        {"max_us", us(h.max())}
+    };
+}
+
+void printRow(const std::string& name, const bench::HdrHistogram& h, double seconds) {
+    std::printf("%-18s %9llu %9.0f/s   p50 %9.2f ms   p99 %9.2f ms   p999 %9.2f ms   max %9.2f ms\n",
+                name.c_str(), static_cast<unsigned long long>(h.count()),
+                static_cast<double>(h.count()) / seconds, static_cast<double>(h.percentile(50)) / 1e6,
+                static_cast<double>(h.percentile(99)) / 1e6, static_cast<double>(h.percentile(99.9)) / 1e6,
+                static_cast<double>(h.max()) / 1e6);
+}
+
+bool parseMix(const std::string& spec, std::vector<WeightedWorkload>& mix) {
+    size_t i = 0;
+    while (i <= spec.size()) {
+        size_t end = spec.find(',', i);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        std::string item = spec.substr(i, end - i);
+        double weight = 1;
+        size_t colon = item.find(':');
+        if (colon != std::string::npos) {
+            weight = std::atof(item.c_str() + colon + 1);
+            item.resize(colon);
+        }
+        if (item == "browse") {
+            mix.push_back({Workload::Browse, weight});
+        } else if (item == "stock") {
+            mix.push_back({Workload::Stock, weight});
+        } else if (item == "restock") {
+            mix.push_back({Workload::Restock, weight});
+        } else {
+            return false;
+        }
+        if (weight <= 0) {
+            return false;
+        }
+        i = end + 1;
+    }
+    return !mix.empty();
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eq == std::string::npos) {
+            return false;
+        }
+        std::string key = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+        if (key == "host") {
+            opt.host = value;
+        } else if (key == "port") {
+            opt.port = std::atoi(value.c_str());
+        } else if (key == "threads") {
+            opt.threads = std::max<size_t>(1, std::strtoul(value.c_str(), nullptr, 10));
+        } else if (key == "duration") {
+            opt.duration_s = std::atof(value.c_str());
+        } else if (key == "warmup") {
+            opt.warmup_s = std::atof(value.c_str());
+        } else if (key == "rate") {
+            opt.rate = std::atof(value.c_str());
+        } else if (key == "mix") {
+            opt.mix = value;
+        } else if (key == "products") {
+            opt.products = std::max(1, std::atoi(value.c_str()));
+        } else if (key == "users") {
+            opt.users = std::max(1, std::atoi(value.c_str()));
+        } else if (key == "zipf") {
+            opt.zipf = std::atof(value.c_str());
+        } else if (key == "burst") {
+            opt.burst = std::atoi(value.c_str());
+        } else if (key == "seed") {
+            opt.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (key == "out") {
+            opt.out = value;
+        } else {
+            return false;
+        }
+    }
+    return opt.duration_s > 0 && opt.warmup_s >= 0 && opt.rate >= 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    std::vector<WeightedWorkload> mix;
+    if (!parseArgs(argc, argv, opt) || !parseMix(opt.mix, mix)) {
+        std::fprintf(stderr,
+                     "usage: bench_load [--host=localhost] [--port=8080] [--threads=16] [--duration=30]\n"
+                     "                  [--warmup=5] [--rate=0] [--mix=browse:80,stock:15,restock:5]\n"
+                     "                  [--products=1000] [--users=1000] [--zipf=1.1] [--burst=8]\n"
+                     "                  [--seed=42] [--out=results.json|-]\n");
+        return 2;
+    }
+
+    ZipfSampler zipf(opt.products, opt.zipf);
+    std::vector<ThreadResult> results(opt.threads);
+    std::vector<std::thread> threads;
+    std::fprintf(stderr, "%s:%d  mix %s  %zu threads  %s  %.0f s (+%.0f s warm-up)\n", opt.host.c_str(), opt.port,
+                 opt.mix.c_str(), opt.threads,
+                 opt.rate > 0 ? ("open loop " + std::to_string(static_cast<long>(opt.rate)) + " req/s").c_str()
+                              : "closed loop",
+                 opt.duration_s, opt.warmup_s);
+
+    auto start = Clock::now();
+    for (size_t t = 0; t < opt.threads; ++t) {
+        threads.emplace_back(runThread, std::cref(opt), std::cref(zipf), std::cref(mix), t, start,
+                             std::ref(results[t]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::map<std::string, bench::HdrHistogram> ops;
+    bench::HdrHistogram all;
+    std::map<int, uint64_t> statuses;
+    uint64_t transport_errors = 0;
+    uint64_t unsent = 0;
+    for (const auto& r : results) {
+        for (const auto& [name, h] : r.ops) {
+            ops[name].merge(h);
+        }
+        all.merge(r.all);
+        for (const auto& [status, n] : r.statuses) {
+            statuses[status] += n;
+        }
+        transport_errors += r.transport_errors;
+        unsent += r.unsent;
+    }
+
+    for (const auto& [name, h] : ops) {
+        printRow(name, h, opt.duration_s);
+    }
+    printRow("all", all, opt.duration_s);
+    std::printf("statuses:");
+    for (const auto& [status, n] : statuses) {
+        std::printf(" %d=%llu", status, static_cast<unsigned long long>(n));
+    }
+    std::printf("  transport errors: %llu", static_cast<unsigned long long>(transport_errors));
+    if (opt.rate > 0) {
+        std::printf("  unsent (server behind schedule): %llu", static_cast<unsigned long long>(unsent));
+    }
+    std::printf("\n");
+
+    if (!opt.out.empty()) {
+        json report{
+            {"config", {
+                {"host", opt.host}, {"port", opt.port}, {"threads", opt.threads},
+                {"duration_s", opt.duration_s}, {"warmup_s", opt.warmup_s},
+                {"mode", opt.rate > 0 ? "open" : "closed"}, {"rate", opt.rate}, {"mix", opt.mix},
+                {"products", opt.products}, {"users", opt.users}, {"zipf", opt.zipf},
+                {"burst", opt.burst}, {"seed", opt.seed}
+            }},
+            {"overall", summarise(all, opt.duration_s)},
+            {"transport_errors", transport_errors},
+            {"unsent", unsent}
+        };
+        for (const auto& [name, h] : ops) {
+            report["operations"][name] = summarise(h, opt.duration_s);
+        }
+        for (const auto& [status, n] : statuses) {
+            report["statuses"][std::to_string(status)] = n;
+        }
+        if (opt.out == "-") {
+            std::cout << report.dump(2) << std::endl;
+        } else {
+            std::ofstream(opt.out) << report.dump(2) << std::endl;
+        }
+    }
+    return transport_errors > 0 && all.count() == 0 ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+// Low-stock report over 1M SKUs: LowStockIndex page reads (first and deep
+// keyset pages) and O(log n) stock updates, against re-sorting the whole
+// inventory per refresh (what `ORDER BY stock LIMIT n` amounts to without
+// an index on the sort key). Pages are checked against the re-sort.
+//
+//   make bench_low_stock && ./bench_low_stock
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <tuple>
+#include <vector>
+#include "BenchUtil.h"
+#include "index/LowStockIndex.h"
+
+int main() {
+    const size_t kSkus = 1000000;
+    const size_t kPage = 50;
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> stock(0, 500);
+    std::uniform_int_distribution<int> reorder(5, 40);
+
+    std::vector<LowStockIndex::Item> items;
+    items.reserve(kSkus);
+    for (size_t i = 0; i < kSkus; ++i) {
+        items.push_back(LowStockIndex::Item{static_cast<uint32_t>(i + 1), stock(rng), reorder(rng)});
+    }
+
+    LowStockIndex index;
+    bench::run("rebuild 1M", [&] { index.rebuild([&] { return items; }); }, 3, 0);
+    std::printf("below reorder point: %zu of %zu\n", index.belowReorderPointCount(), index.size());
+
+    // Baseline: re-sort per refresh
+    auto resort = [&](bool reorder_view) {
+        std::vector<std::tuple<long long, uint32_t>> keys;
+        keys.reserve(items.size());
+        for (const auto& it : items) {
+            if (!reorder_view) {
+                keys.emplace_back(it.stock, it.id);
+            } else if (it.stock <= it.reorder_point) {
+                keys.emplace_back(static_cast<long long>(it.stock) - it.reorder_point, it.id);
+            }
+        }
+        size_t n = std::min(kPage, keys.size());
+        std::partial_sort(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(n), keys.end());
+        keys.resize(n);
+        return keys;
+    };
+    auto base = bench::run("partial_sort 1M for first page (reorder)", [&] { bench::doNotOptimize(resort(true)); });
+    auto idx = bench::run("index first page (reorder)", [&] {
+        bench::doNotOptimize(index.belowReorderPoint(kPage, std::nullopt));
+    });
+    bench::ratio(base, idx);
+
+    size_t mismatches = 0;
+    for (bool reorder_view : {true, false}) {
+        auto want = resort(reorder_view);
+        auto got = reorder_view ? index.belowReorderPoint(kPage, std::nullopt) : index.lowest(kPage, std::nullopt);
+        for (size_t i = 0; i < want.size(); ++i) {
+            if (i >= got.items.size() || got.items[i].id != std::get<1>(want[i])) {
+                ++mismatches;
+                break;
+            }
+        }
+    }
+
+    // Walk deep into the lowest-stock view by cursor
+    bench::Latency pages;
+    std::optional<LowStockIndex::Cursor> cursor;
+    for (int i = 0; i < 2000; ++i) {
+        pages.time([&] { cursor = index.lowest(kPage, cursor).next; });
+    }
+    pages.print("keyset page (lowest), 2000 consecutive");
+
+    std::uniform_int_distribution<uint32_t> pick(1, static_cast<uint32_t>(kSkus));
+    bench::Latency updates;
+    for (int i = 0; i < 200000; ++i) {
+        uint32_t id = pick(rng);
+        int s = stock(rng);
+        int r = reorder(rng);
+        updates.time([&] { index.set(id, s, r, i + 1); });
+        items[id - 1].stock = s;
+        items[id - 1].reorder_point = r;
+    }
+    updates.print("set(stock, reorder_point)");
+
+    for (bool reorder_view : {true, false}) {
+        auto want = resort(reorder_view);
+        auto got = reorder_view ? index.belowReorderPoint(kPage, std::nullopt) : index.lowest(kPage, std::nullopt);
+        for (size_t i = 0; i < want.size(); ++i) {
+            if (i >= got.items.size() || got.items[i].id != std::get<1>(want[i])) {
+                ++mismatches;
+                break;
+            }
+        }
+    }
+    std::printf("verification mismatches: %zu\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
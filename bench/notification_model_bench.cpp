@@ -0,0 +1,290 @@
+// Memory per record and bulk log-listing throughput for the compact
+// notification model (int64 epoch-microsecond timestamps, one-byte enums)
+// against the previous all-std::string model, kept here as Legacy*.
+//
+// Memory is sizeof(record) plus the heap bytes its fields allocate, counted
+// by a global operator new. The listing benchmark is what GET
+// /api/notifications/logs/user/:id does per row: decode a result row, then
+// write the JSON object; the compact model formats its timestamps to
+// ISO-8601 at that point (util/IsoTime.h). Both sides decode positionally
+// with rowmap, so only the model differs. Rows come from bench/FakeRows.h.
+//
+//   make bench_notification_model && ./bench_notification_model
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "BenchUtil.h"
+#include "FakeRows.h"
+#include "repository/postgres/NotificationRows.h"
+#include "util/IsoTime.h"
+#include "util/JsonWriter.h"
+
+namespace {
+
+size_t g_heap_bytes = 0;
+size_t g_heap_allocations = 0;
+
+} // namespace
+
+void* operator new(size_t n) {
+    g_heap_bytes += n;
+    ++g_heap_allocations;
+    if (void* p = std::malloc(n)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// std::pmr strings on the default resource allocate through the aligned forms
+void* operator new(size_t n, std::align_val_t alignment) {
+    g_heap_bytes += n;
+    ++g_heap_allocations;
+    size_t align = static_cast<size_t>(alignment);
+    if (void* p = std::aligned_alloc(align, (n + align - 1) / align * align)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// domain::Notification / NotificationLog before the compact model
+struct LegacyNotification {
+    int id = 0;
+    int product_id = 0;
+    int user_id = 0;
+    domain::NotificationType type = domain::NotificationType::RESTOCKED;
+    std::string type_str;
+    bool is_sent = false;
+    std::string created_at;
+    std::string updated_at;
+    std::string sent_at;
+};
+
+struct LegacyNotificationLog {
+    int id = 0;
+    int notification_id = 0;
+    int user_id = 0;
+    int product_id = 0;
+    std::string notification_type;
+    std::string message;
+    std::string status;
+    int retry_count = 0;
+    int max_retries = 3;
+    std::string error_message;
+    std::string sent_at;
+    std::string created_at;
+    std::string updated_at;
+};
+
+} // namespace
+
+namespace rowmap {
+
+template <>
+struct Columns<LegacyNotification> {
+    using N = LegacyNotification;
+    static constexpr auto value = std::make_tuple(
+        column("id", &N::id), column("product_id", &N::product_id), column("user_id", &N::user_id),
+        column("notification_type", &N::type_str), column("is_sent", &N::is_sent),
+        column("created_at", &N::created_at), column("updated_at", &N::updated_at), column("sent_at", &N::sent_at));
+};
+
+template <>
+struct Columns<LegacyNotificationLog> {
+    using L = LegacyNotificationLog;
+    static constexpr auto value = std::make_tuple(
+        column("id", &L::id), column("notification_id", &L::notification_id), column("user_id", &L::user_id),
+        column("product_id", &L::product_id), column("notification_type", &L::notification_type),
+        column("message", &L::message), column("status", &L::status), column("retry_count", &L::retry_count),
+        column("max_retries", &L::max_retries), column("error_message", &L::error_message),
+        column("sent_at", &L::sent_at), column("created_at", &L::created_at), column("updated_at", &L::updated_at));
+};
+
+} // namespace rowmap
+
+namespace {
+
+using bench::FakeResult;
+using bench::FakeRow;
+
+const int64_t kBaseMicros = 1773146096789012LL;  // 2026-03-10T12:34:56.789012Z
+
+// Postgres' text for a TIMESTAMP, as the legacy model stored it
+std::string pgTimestamp(int64_t micros) {
+    std::string iso = isotime::format(micros).str();
+    iso[10] = ' ';
+    iso.pop_back();  // 'Z'
+    return iso;
+}
+
+FakeResult makeNotifications(size_t n, bool legacy) {
+    FakeResult r;
+    r.columns = {"id", "product_id", "user_id", "notification_type", "is_sent", "created_at", "updated_at", "sent_at"};
+    for (size_t i = 0; i < n; ++i) {
+        bool sent = i % 4 == 0;
+        int64_t at = kBaseMicros + static_cast<int64_t>(i) * 1000;
+        std::string stamp = legacy ? pgTimestamp(at) : std::to_string(at);
+        const std::string cells[] = {std::to_string(i + 1), std::to_string(1 + i % 5000), std::to_string(1 + i % 20000),
+                                     i % 10 == 0 ? "out_of_stock" : "restocked", sent ? "t" : "f",
+                                     stamp, stamp, sent ? stamp : ""};
+        for (size_t c = 0; c < 8; ++c) {
+            r.cells.push_back(cells[c]);
+            r.nulls.push_back(c == 7 && !sent);
+        }
+    }
+    return r;
+}
+
+FakeResult makeLogs(size_t n, bool legacy) {
+    FakeResult r;
+    r.columns = {"id", "notification_id", "user_id", "product_id", "notification_type", "message", "status",
+                 "retry_count", "max_retries", "error_message", "sent_at", "created_at", "updated_at"};
+    for (size_t i = 0; i < n; ++i) {
+        bool failed = i % 7 == 0;
+        int64_t at = kBaseMicros + static_cast<int64_t>(i) * 1000;
+        std::string stamp = legacy ? pgTimestamp(at) : std::to_string(at);
+        const std::string cells[] = {std::to_string(i + 1), std::to_string(i + 1), std::to_string(1 + i % 20000),
+                                     std::to_string(1 + i % 5000), "restocked",
+                                     "Product back in stock! Check it out now.", failed ? "failed" : "sent",
+                                     failed ? "1" : "0", "3", failed ? "Failed to send notification" : "",
+                                     failed ? "" : stamp, stamp, stamp};
+        for (size_t c = 0; c < 13; ++c) {
+            r.cells.push_back(cells[c]);
+            r.nulls.push_back((c == 9 && !failed) || (c == 10 && failed));
+        }
+    }
+    return r;
+}
+
+template <typename T>
+std::vector<T> decodeAll(const FakeResult& r, size_t rows) {
+    std::vector<T> out;
+    out.reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        out.push_back(rowmap::decode<T>(FakeRow(&r, i)));
+    }
+    return out;
+}
+
+// sizeof plus the heap bytes / allocations one decoded record owns
+template <typename T>
+void reportMemory(const char* name, const FakeResult& r, size_t rows) {
+    std::vector<T> records;
+    records.reserve(rows);
+    size_t bytes_before = g_heap_bytes;
+    size_t allocations_before = g_heap_allocations;
+    for (size_t i = 0; i < rows; ++i) {
+        records.push_back(rowmap::decode<T>(FakeRow(&r, i)));
+    }
+    double heap = static_cast<double>(g_heap_bytes - bytes_before) / static_cast<double>(rows);
+    double allocations = static_cast<double>(g_heap_allocations - allocations_before) / static_cast<double>(rows);
+    std::printf("%-32s sizeof %4zu B + heap %6.1f B = %6.1f B/record, %.2f allocations/record\n", name, sizeof(T),
+                heap, static_cast<double>(sizeof(T)) + heap, allocations);
+}
+
+JsonWriter& timeField(JsonWriter& w, std::string_view key, int64_t micros) {
+    if (micros == 0) {
+        return w.field(key, std::string_view());
+    }
+    return w.field(key, isotime::format(micros).view());
+}
+
+// Decode + serialize, as the log listing handler does
+std::string listLegacyLogs(const FakeResult& r, size_t rows) {
+    std::vector<LegacyNotificationLog> logs = decodeAll<LegacyNotificationLog>(r, rows);
+    std::string body;
+    body.reserve(logs.size() * 256 + 2);
+    JsonWriter w(body);
+    w.beginArray();
+    for (const auto& log : logs) {
+        w.beginObject()
+            .field("id", log.id)
+            .field("notification_id", log.notification_id)
+            .field("user_id", log.user_id)
+            .field("product_id", log.product_id)
+            .field("type", log.notification_type)
+            .field("message", log.message)
+            .field("status", log.status)
+            .field("retry_count", log.retry_count)
+            .field("max_retries", log.max_retries)
+            .field("error_message", log.error_message)
+            .field("sent_at", log.sent_at)
+            .field("created_at", log.created_at)
+            .endObject();
+    }
+    w.endArray();
+    return body;
+}
+
+std::string listLogs(const FakeResult& r, size_t rows) {
+    std::vector<domain::NotificationLog> logs = decodeAll<domain::NotificationLog>(r, rows);
+    std::string body;
+    body.reserve(logs.size() * 256 + 2);
+    JsonWriter w(body);
+    w.beginArray();
+    for (const auto& log : logs) {
+        w.beginObject()
+            .field("id", log.id)
+            .field("notification_id", log.notification_id)
+            .field("user_id", log.user_id)
+            .field("product_id", log.product_id)
+            .field("type", domain::toString(log.notification_type))
+            .field("message", log.message)
+            .field("status", domain::toString(log.status))
+            .field("retry_count", log.retry_count)
+            .field("max_retries", log.max_retries)
+            .field("error_message", log.error_message);
+        timeField(w, "sent_at", log.sent_at_us);
+        timeField(w, "created_at", log.created_at_us).endObject();
+    }
+    w.endArray();
+    return body;
+}
+
+} // namespace
+
+int main() {
+    const size_t kRows = 200000;
+    FakeResult legacy_notifications = makeNotifications(kRows, true);
+    FakeResult notifications = makeNotifications(kRows, false);
+    FakeResult legacy_logs = makeLogs(kRows, true);
+    FakeResult logs = makeLogs(kRows, false);
+
+    std::printf("Memory per record (%zu records)\n", kRows);
+    reportMemory<LegacyNotification>("Notification (strings)", legacy_notifications, kRows);
+    reportMemory<domain::Notification>("Notification (compact)", notifications, kRows);
+    reportMemory<LegacyNotificationLog>("NotificationLog (strings)", legacy_logs, kRows);
+    reportMemory<domain::NotificationLog>("NotificationLog (compact)", logs, kRows);
+
+    std::printf("\nLog listing (decode + JSON), %zu rows per run\n", kRows);
+    auto before = bench::run("log listing, string model", [&] {
+        bench::doNotOptimize(listLegacyLogs(legacy_logs, kRows));
+    });
+    auto after = bench::run("log listing, compact model", [&] {
+        bench::doNotOptimize(listLogs(logs, kRows));
+    });
+    std::printf("%-44s %9.2f M rows/s\n", "  string model", kRows / before.median_ms / 1000.0);
+    std::printf("%-44s %9.2f M rows/s\n", "  compact model", kRows / after.median_ms / 1000.0);
+    bench::ratio(before, after);
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Handler temporaries from the per-request arena (server/RequestArena.h)
+// against the global allocator, for the notification log listing: decode a
+// page of log rows into a NotificationLogList, then serialize it. Each
+// worker thread runs requests back to back between RequestArena::begin()
+// and end(), as the server does, so the heap allocation counts per request
+// are the ones GET /metrics/allocations reports in a COUNT_HEAP_ALLOCATIONS=1
+// build. The Makefile always builds this benchmark with the counting hooks.
+//
+// Rows come from bench/FakeRows.h. The thread count defaults to the number
+// of hardware threads; contention on the global allocator only shows with
+// more than one.
+//
+//   make bench_request_arena && ./bench_request_arena [threads]
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BenchUtil.h"
+#include "FakeRows.h"
+#include "repository/postgres/NotificationRows.h"
+#include "server/RequestArena.h"
+#include "util/IsoTime.h"
+#include "util/JsonWriter.h"
+
+static_assert(RequestArena::kCountsHeapAllocations, "build with -DREQUEST_ARENA_COUNT_HEAP (make bench_request_arena)");
+
+namespace {
+
+using bench::FakeResult;
+using bench::FakeRow;
+
+const size_t kRowsPerRequest = 100;
+const size_t kRequestsPerThread = 2000;
+
+FakeResult makeLogs(size_t n) {
+    FakeResult r;
+    r.columns = {"id", "notification_id", "user_id", "product_id", "notification_type", "message", "status",
+                 "retry_count", "max_retries", "error_message", "sent_at", "created_at", "updated_at"};
+    for (size_t i = 0; i < n; ++i) {
+        bool failed = i % 7 == 0;
+        const std::string stamp = std::to_string(1773146096789012LL + static_cast<long long>(i) * 1000);
+        const std::string cells[] = {std::to_string(i + 1), std::to_string(i + 1), std::to_string(1 + i % 20000),
+                                     std::to_string(1 + i % 5000), "restocked",
+                                     "Product back in stock! Check it out now.", failed ? "failed" : "sent",
+                                     failed ? "1" : "0", "3", failed ? "Failed to send notification" : "",
+                                     failed ? "" : stamp, stamp, stamp};
+        for (size_t c = 0; c < 13; ++c) {
+            r.cells.push_back(cells[c]);
+            r.nulls.push_back((c == 9 && !failed) || (c == 10 && failed));
+        }
+    }
+    return r;
+}
+
+// The repository's decode and the controller's serialization, with the
+// list allocating from `resource`
+std::string listLogs(const FakeResult& r, std::pmr::memory_resource* resource) {
+    domain::NotificationLogList logs(resource);
+    logs.reserve(kRowsPerRequest);
+    for (size_t i = 0; i < kRowsPerRequest; ++i) {
+        rowmap::decodeInto(FakeRow(&r, i), logs.emplace_back());
+    }
+
+    std::string body;
+    body.reserve(logs.size() * 256 + 2);
+    JsonWriter w(body);
+    w.beginArray();
+    for (const auto& log : logs) {
+        w.beginObject()
+            .field("id", log.id)
+            .field("message", log.message)
+            .field("status", domain::toString(log.status))
+            .field("error_message", log.error_message)
+            .field("created_at", isotime::format(log.created_at_us).view())
+            .endObject();
+    }
+    w.endArray();
+    return body;
+}
+
+struct Totals {
+    uint64_t requests = 0;
+    uint64_t heap_allocations = 0;
+    uint64_t arena_bytes = 0;
+};
+
+void runRequests(const FakeResult& r, bool use_arena, Totals& totals) {
+    for (size_t i = 0; i < kRequestsPerThread; ++i) {
+        RequestArena::begin();
+        std::pmr::memory_resource* resource =
+            use_arena ? RequestArena::resource() : std::pmr::new_delete_resource();
+        bench::doNotOptimize(listLogs(r, resource));
+        RequestArena::Usage usage = RequestArena::end();
+        ++totals.requests;
+        totals.heap_allocations += usage.heap_allocations;
+        totals.arena_bytes += usage.arena_bytes;
+    }
+}
+
+bench::Result runThreads(const std::string& name, const FakeResult& r, size_t threads, bool use_arena) {
+    std::vector<Totals> totals(threads);
+    auto result = bench::run(name, [&] {
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&r, use_arena, &total = totals[t]] { runRequests(r, use_arena, total); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }, 7, 1);
+
+    Totals sum;
+    for (const auto& t : totals) {
+        sum.requests += t.requests;
+        sum.heap_allocations += t.heap_allocations;
+        sum.arena_bytes += t.arena_bytes;
+    }
+    double requests = static_cast<double>(sum.requests);
+    std::printf("%-44s %9.1f heap allocations/request, %.0f arena bytes/request, %.0f requests/s\n", "",
+                static_cast<double>(sum.heap_allocations) / requests,
+                static_cast<double>(sum.arena_bytes) / requests,
+                static_cast<double>(threads * kRequestsPerThread) / result.median_ms * 1000.0);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    if (threads == 0) {
+        threads = 1;
+    }
+    FakeResult logs = makeLogs(kRowsPerRequest);
+
+    std::printf("Log listing, %zu rows per request, %zu threads x %zu requests\n", kRowsPerRequest, threads,
+                kRequestsPerThread);
+    auto global = runThreads("global allocator", logs, threads, false);
+    auto arena = runThreads("request arena", logs, threads, true);
+    bench::ratio(global, arena);
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Cost of finding the handler for a request path. httplib tries a method's
+// routes in registration order and runs std::regex_match against each
+// pattern until one matches, so the cost of a request grows with the
+// number of routes registered before its own, and a 404 pays for all of
+// them.
+//
+// The table below is the server's GET routes in the order main.cpp
+// registers them (keep it in step when routes are added). Each path is
+// timed on its own, then a browsing mix weighted like bench_load's.
+// The same table with ":id" path parameters (httplib's PathParamsMatcher,
+// no regex) is timed alongside for comparison.
+//
+//   make bench_route_match && ./bench_route_match
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BenchUtil.h"
+#include "external/httplib.h"
+
+namespace {
+
+using Matchers = std::vector<std::unique_ptr<httplib::detail::MatcherBase>>;
+
+const int kLookups = 100000;
+
+// Registration order: products, users, subscriptions, notifications,
+// health, export, dashboard
+const char* const kGetRoutes[] = {
+    R"(/api/products/search)",
+    R"(/api/products/autocomplete)",
+    "/api/products",
+    R"(/api/products/(\d+))",
+    R"(/api/inventory/stock-states)",
+    R"(/api/inventory/low-stock)",
+    "/api/inventory",
+    R"(/api/inventory/(\d+))",
+    R"(/api/inventory/(\d+)/history)",
+    "/api/users",
+    R"(/api/users/(\d+))",
+    "/api/subscriptions",
+    R"(/api/users/(\d+)/subscriptions)",
+    R"(/api/subscriptions/(\d+))",
+    "/api/notifications/user/(\\d+)",
+    "/api/notifications/product/(\\d+)",
+    "/api/notifications/logs/user/(\\d+)",
+    "/api/notifications/logs/status/failed",
+    "/api/notifications/preferences/(\\d+)",
+    "/api/notifications/restocked",
+    "/ready",
+    "/metrics/allocations",
+    "/metrics/idempotency",
+    "/metrics/admission",
+    "/metrics/coalescing",
+    "/metrics/replica",
+    "/api/export/inventory.snapshot",
+    "/api/dashboard/summary",
+};
+
+struct Probe {
+    const char* path;
+    int weight;  // share of the browsing mix in percent; 0 = timed alone only
+};
+
+const Probe kProbes[] = {
+    {"/api/products/search", 10},
+    {"/api/products/4711", 50},
+    {"/api/inventory/4711", 20},
+    {"/api/users/42/subscriptions", 4},
+    {"/api/notifications/product/4711", 0},
+    {"/api/dashboard/summary", 3},
+    {"/api/inventory/low-stock", 3},
+    {"/api/products/autocomplete", 10},
+    {"/no/such/route", 0},
+};
+
+// "(\d+)" -> ":p0", ":p1", ... for the PathParamsMatcher table
+std::string withParams(std::string pattern) {
+    const std::string capture = R"((\d+))";
+    size_t at = 0;
+    int n = 0;
+    while ((at = pattern.find(capture, at)) != std::string::npos) {
+        std::string name = ":p" + std::to_string(n++);
+        pattern.replace(at, capture.size(), name);
+        at += name.size();
+    }
+    return pattern;
+}
+
+Matchers regexTable() {
+    Matchers m;
+    for (const char* route : kGetRoutes) {
+        m.push_back(std::make_unique<httplib::detail::RegexMatcher>(route));
+    }
+    return m;
+}
+
+Matchers paramTable() {
+    Matchers m;
+    for (const char* route : kGetRoutes) {
+        std::string pattern = withParams(route);
+        if (pattern.find("/:") != std::string::npos) {
+            m.push_back(std::make_unique<httplib::detail::PathParamsMatcher>(pattern));
+        } else {
+            // Static paths: what make_matcher would build, still a regex
+            m.push_back(std::make_unique<httplib::detail::RegexMatcher>(pattern));
+        }
+    }
+    return m;
+}
+
+// Index of the first matching route, as Server::dispatch_request finds it
+int route(const Matchers& table, httplib::Request& req) {
+    for (size_t i = 0; i < table.size(); ++i) {
+        if (table[i]->match(req)) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int matchAll(const Matchers& table, const std::vector<std::string>& paths) {
+    httplib::Request req;
+    int sum = 0;
+    for (const auto& path : paths) {
+        req.path = path;
+        sum += route(table, req);
+    }
+    return sum;
+}
+
+std::vector<std::string> repeat(const char* path) {
+    return std::vector<std::string>(kLookups, path);
+}
+
+std::vector<std::string> browsingMix() {
+    std::vector<std::string> paths;
+    paths.reserve(kLookups);
+    while (paths.size() < static_cast<size_t>(kLookups)) {
+        for (const auto& probe : kProbes) {
+            for (int i = 0; i < probe.weight && paths.size() < static_cast<size_t>(kLookups); ++i) {
+                paths.push_back(probe.path);
+            }
+        }
+    }
+    return paths;
+}
+
+} // namespace
+
+int main() {
+    Matchers regex = regexTable();
+    Matchers params = paramTable();
+    std::printf("%zu GET routes, %d lookups per case\n", regex.size(), kLookups);
+
+    for (const auto& probe : kProbes) {
+        httplib::Request req;
+        req.path = probe.path;
+        int index = route(regex, req);
+        std::vector<std::string> paths = repeat(probe.path);
+        std::string label = std::string(probe.path) + " (route " +
+                            (index < 0 ? std::string("none") : std::to_string(index + 1)) + ")";
+        bench::run("regex " + label, [&] { bench::doNotOptimize(matchAll(regex, paths)); });
+    }
+
+    std::vector<std::string> mix = browsingMix();
+    auto base = bench::run("browsing mix, regex routes", [&] { bench::doNotOptimize(matchAll(regex, mix)); });
+    auto alt = bench::run("browsing mix, :id routes", [&] { bench::doNotOptimize(matchAll(params, mix)); });
+    bench::ratio(base, alt);
+    return 0;
+}
@@ -0,0 +1,193 @@
+// Decode cost per row for NotificationRepo's result sets: the name-based
+// row["column"] decoding the repository used to copy into each method
+// (including its copy of every decoded struct into the result vector),
+// against rowmap's positional decode (NotificationRows.h) as the methods
+// now use it. Both fill the same structs; only the field access differs.
+//
+// Rows come from bench/FakeRows.h, so no database is needed.
+//
+//   make bench_row_decode && ./bench_row_decode
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BenchUtil.h"
+#include "FakeRows.h"
+#include "repository/postgres/NotificationRows.h"
+
+namespace {
+
+using bench::FakeField;
+using bench::FakeResult;
+using bench::FakeRow;
+
+FakeResult makeNotifications(size_t n) {
+    FakeResult r;
+    r.columns = {"id", "product_id", "user_id", "notification_type", "is_sent", "created_at", "updated_at", "sent_at"};
+    for (size_t i = 0; i < n; ++i) {
+        bool sent = i % 4 == 0;
+        const std::string stamp = std::to_string(1773146096789012LL + static_cast<long long>(i) * 1000);
+        const std::string cells[] = {std::to_string(i + 1), std::to_string(1 + i % 5000), std::to_string(1 + i % 20000),
+                                     i % 10 == 0 ? "out_of_stock" : "restocked", sent ? "t" : "f",
+                                     stamp, stamp, sent ? stamp : ""};
+        for (size_t c = 0; c < 8; ++c) {
+            r.cells.push_back(cells[c]);
+            r.nulls.push_back(c == 7 && !sent);
+        }
+    }
+    return r;
+}
+
+FakeResult makeLogs(size_t n) {
+    FakeResult r;
+    r.columns = {"id", "notification_id", "user_id", "product_id", "notification_type", "message", "status",
+                 "retry_count", "max_retries", "error_message", "sent_at", "created_at", "updated_at"};
+    for (size_t i = 0; i < n; ++i) {
+        bool failed = i % 7 == 0;
+        const std::string stamp = std::to_string(1773146096789012LL + static_cast<long long>(i) * 1000);
+        const std::string cells[] = {std::to_string(i + 1), std::to_string(i + 1), std::to_string(1 + i % 20000),
+                                     std::to_string(1 + i % 5000), "restocked",
+                                     "Product back in stock! Check it out now.", failed ? "failed" : "sent",
+                                     failed ? "1" : "0", "3", failed ? "Failed to send notification" : "",
+                                     failed ? "" : stamp, stamp, stamp};
+        for (size_t c = 0; c < 13; ++c) {
+            r.cells.push_back(cells[c]);
+            r.nulls.push_back((c == 9 && !failed) || (c == 10 && failed));
+        }
+    }
+    return r;
+}
+
+std::string_view text(const FakeField& f) {
+    return std::string_view(f.c_str(), f.size());
+}
+
+// The per-method decoding NotificationRepo used before rowmap
+std::vector<domain::Notification> notificationsByName(const FakeResult& r, size_t rows) {
+    std::vector<domain::Notification> notifications;
+    for (size_t i = 0; i < rows; ++i) {
+        FakeRow row(&r, i);
+        domain::Notification notif;
+        notif.id = row["id"].as<int>();
+        notif.product_id = row["product_id"].as<int>();
+        notif.user_id = row["user_id"].as<int>();
+        domain::parse(text(row["notification_type"]), notif.type);
+        notif.is_sent = row["is_sent"].as<bool>();
+        notif.created_at_us = row["created_at"].as<int64_t>();
+        notif.updated_at_us = row["updated_at"].as<int64_t>();
+
+        if (!row["sent_at"].is_null()) {
+            notif.sent_at_us = row["sent_at"].as<int64_t>();
+        }
+
+        notifications.push_back(notif);
+    }
+    return notifications;
+}
+
+std::vector<domain::NotificationLog> logsByName(const FakeResult& r, size_t rows) {
+    std::vector<domain::NotificationLog> logs;
+    for (size_t i = 0; i < rows; ++i) {
+        FakeRow row(&r, i);
+        domain::NotificationLog log;
+        log.id = row["id"].as<int>();
+        if (!row["notification_id"].is_null()) {
+            log.notification_id = row["notification_id"].as<int>();
+        }
+        log.user_id = row["user_id"].as<int>();
+        log.product_id = row["product_id"].as<int>();
+        domain::parse(text(row["notification_type"]), log.notification_type);
+        log.message = row["message"].as<std::string>();
+        domain::parse(text(row["status"]), log.status);
+        log.retry_count = row["retry_count"].as<int>();
+        log.max_retries = row["max_retries"].as<int>();
+        if (!row["error_message"].is_null()) {
+            log.error_message = row["error_message"].as<std::string>();
+        }
+        if (!row["sent_at"].is_null()) {
+            log.sent_at_us = row["sent_at"].as<int64_t>();
+        }
+        log.created_at_us = row["created_at"].as<int64_t>();
+        log.updated_at_us = row["updated_at"].as<int64_t>();
+
+        logs.push_back(log);
+    }
+    return logs;
+}
+
+template <typename T>
+std::vector<T> byPosition(const FakeResult& r, size_t rows) {
+    std::vector<T> out;
+    out.reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        out.push_back(rowmap::decode<T>(FakeRow(&r, i)));
+    }
+    return out;
+}
+
+bool same(const domain::Notification& a, const domain::Notification& b) {
+    return a.id == b.id && a.product_id == b.product_id && a.user_id == b.user_id && a.type == b.type &&
+           a.is_sent == b.is_sent && a.created_at_us == b.created_at_us && a.updated_at_us == b.updated_at_us &&
+           a.sent_at_us == b.sent_at_us;
+}
+
+bool same(const domain::NotificationLog& a, const domain::NotificationLog& b) {
+    return a.id == b.id && a.notification_id == b.notification_id && a.user_id == b.user_id &&
+           a.product_id == b.product_id && a.notification_type == b.notification_type && a.message == b.message &&
+           a.status == b.status && a.retry_count == b.retry_count && a.max_retries == b.max_retries &&
+           a.error_message == b.error_message && a.sent_at_us == b.sent_at_us &&
+           a.created_at_us == b.created_at_us && a.updated_at_us == b.updated_at_us;
+}
+
+template <typename T>
+bool sameAll(const std::vector<T>& a, const std::vector<T>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!same(a[i], b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void perRow(const bench::Result& result, size_t rows) {
+    std::printf("%-44s %9.1f ns/row\n", ("  " + result.name).c_str(), result.median_ms * 1e6 / static_cast<double>(rows));
+}
+
+} // namespace
+
+int main() {
+    const size_t kRows = 200000;
+    FakeResult notifications = makeNotifications(kRows);
+    FakeResult logs = makeLogs(kRows);
+
+    if (!sameAll(notificationsByName(notifications, kRows), byPosition<domain::Notification>(notifications, kRows)) ||
+        !sameAll(logsByName(logs, kRows), byPosition<domain::NotificationLog>(logs, kRows))) {
+        std::fprintf(stderr, "positional decode does not match the name-based decode\n");
+        return 1;
+    }
+
+    std::printf("Row decode, %zu rows per run\n", kRows);
+    auto notifByName = bench::run("notifications by name", [&] {
+        bench::doNotOptimize(notificationsByName(notifications, kRows));
+    });
+    auto notifByPos = bench::run("notifications by position", [&] {
+        bench::doNotOptimize(byPosition<domain::Notification>(notifications, kRows));
+    });
+    perRow(notifByName, kRows);
+    perRow(notifByPos, kRows);
+    bench::ratio(notifByName, notifByPos);
+
+    auto logByName = bench::run("notification logs by name", [&] {
+        bench::doNotOptimize(logsByName(logs, kRows));
+    });
+    auto logByPos = bench::run("notification logs by position", [&] {
+        bench::doNotOptimize(byPosition<domain::NotificationLog>(logs, kRows));
+    });
+    perRow(logByName, kRows);
+    perRow(logByPos, kRows);
+    bench::ratio(logByName, logByPos);
+    return 0;
+}
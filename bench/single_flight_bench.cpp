@@ -0,0 +1,111 @@
+// Concurrent lookups of a few hot ids through util/SingleFlight.h against
+// running every lookup on its own, as GET /api/products/:id and
+// /api/inventory/:id do on a cache miss during a launch.
+//
+// The database is modelled as a pool of 4 connections that each take 2 ms
+// per query, so the numbers are wall time and query counts, not CPU.
+// Threads pick one of kHotIds ids per lookup.
+//
+//   make bench_single_flight && ./bench_single_flight [threads]
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BenchUtil.h"
+#include "util/SingleFlight.h"
+
+namespace {
+
+const int kHotIds = 4;
+const int kLookupsPerThread = 50;
+
+class FakeDatabase {
+public:
+    explicit FakeDatabase(int connections) : free(connections) {}
+
+    int query(int id) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [&] { return free > 0; });
+            --free;
+            ++queries;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++free;
+        }
+        released.notify_one();
+        return id * 10;
+    }
+
+    long long queries = 0;
+
+private:
+    std::mutex mutex;
+    std::condition_variable released;
+    int free;
+};
+
+struct Outcome {
+    double seconds;
+    long long lookups;
+    long long queries;
+};
+
+template <typename Lookup>
+Outcome runThreads(size_t threads, Lookup&& lookup) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&lookup, t] {
+            for (int i = 0; i < kLookupsPerThread; ++i) {
+                int id = static_cast<int>((t + static_cast<size_t>(i)) % kHotIds) + 1;
+                bench::doNotOptimize(lookup(id));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return Outcome{seconds, static_cast<long long>(threads) * kLookupsPerThread, 0};
+}
+
+void report(const char* name, const Outcome& o) {
+    std::printf("%-28s %8.3f s  %7.0f lookups/s  %6lld queries  %5.1f lookups/query\n", name, o.seconds,
+                static_cast<double>(o.lookups) / o.seconds, o.queries,
+                static_cast<double>(o.lookups) / static_cast<double>(o.queries));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    if (threads == 0) {
+        threads = 1;
+    }
+    std::printf("%zu threads x %d lookups over %d ids, 4 connections x 2 ms/query\n", threads, kLookupsPerThread,
+                kHotIds);
+
+    FakeDatabase direct_db(4);
+    Outcome direct = runThreads(threads, [&](int id) { return direct_db.query(id); });
+    direct.queries = direct_db.queries;
+    report("every lookup queries", direct);
+
+    FakeDatabase coalesced_db(4);
+    SingleFlight<int, std::optional<int>> group("bench", 1000);
+    Outcome coalesced = runThreads(threads, [&](int id) {
+        return group.run(id, [&] { return std::optional<int>(coalesced_db.query(id)); });
+    });
+    coalesced.queries = coalesced_db.queries;
+    report("single-flight", coalesced);
+
+    std::printf("%-28s %.2fx\n", "speedup single-flight", direct.seconds / coalesced.seconds);
+    return 0;
+}
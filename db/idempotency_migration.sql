@@ -0,0 +1,21 @@
+-- Idempotency-Key responses for POST /api/products and PUT /api/inventory/:id
+-- Run this script against inventory_db created from an init.sql older than this table
+
+CREATE SEQUENCE IF NOT EXISTS idempotency_claim_tokens;
+
+CREATE TABLE IF NOT EXISTS idempotency_keys (
+    client TEXT NOT NULL,       -- X-Client-Id, else the peer address
+    key VARCHAR(255) NOT NULL,
+    fingerprint TEXT NOT NULL,
+    claim_token BIGINT NOT NULL DEFAULT nextval('idempotency_claim_tokens'),  -- redrawn on takeover
+    status SMALLINT,            -- NULL while the request is in flight
+    content_type TEXT,
+    body TEXT,
+    created_at TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    expires_at TIMESTAMPTZ NOT NULL,
+    PRIMARY KEY (client, key)
+);
+
+CREATE INDEX IF NOT EXISTS idx_idempotency_keys_expires ON idempotency_keys(expires_at);
+
+COMMIT;
@@ -12,19 +12,50 @@ CREATE TABLE products (
     id SERIAL PRIMARY KEY,
     name VARCHAR(150) NOT NULL,
     description TEXT,
-    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    version BIGINT NOT NULL DEFAULT 1  -- bumped by every update
 );
 
 -- INVENTORY
 CREATE TABLE inventory (
     product_id INT PRIMARY KEY,
     stock INT NOT NULL CHECK (stock >= 0),
+    reorder_point INT NOT NULL DEFAULT 10 CHECK (reorder_point >= 0),
     updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    version BIGINT NOT NULL DEFAULT 1,  -- bumped by every stock write
     FOREIGN KEY (product_id)
         REFERENCES products(id)
         ON DELETE CASCADE
 );
 
+-- INVENTORY EVENTS (append-only stock movement log, written in batches by the API)
+CREATE TABLE inventory_events (
+    id BIGSERIAL PRIMARY KEY,
+    product_id INT NOT NULL,
+    delta INT NOT NULL,
+    stock_after INT NOT NULL,
+    occurred_at TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    FOREIGN KEY (product_id)
+        REFERENCES products(id)
+        ON DELETE CASCADE
+);
+
+-- IDEMPOTENCY KEYS (responses to retried writes, kept for IDEMPOTENCY_TTL_SECONDS)
+CREATE SEQUENCE idempotency_claim_tokens;
+
+CREATE TABLE idempotency_keys (
+    client TEXT NOT NULL,       -- X-Client-Id, else the peer address
+    key VARCHAR(255) NOT NULL,
+    fingerprint TEXT NOT NULL,
+    claim_token BIGINT NOT NULL DEFAULT nextval('idempotency_claim_tokens'),  -- redrawn on takeover
+    status SMALLINT,            -- NULL while the request is in flight
+    content_type TEXT,
+    body TEXT,
+    created_at TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    expires_at TIMESTAMPTZ NOT NULL,
+    PRIMARY KEY (client, key)
+);
+
 -- SUBSCRIPTIONS
 CREATE TABLE subscriptions (
     id SERIAL PRIMARY KEY,
@@ -44,4 +75,7 @@ CREATE TABLE subscriptions (
 -- INDEXES
 CREATE INDEX idx_products_name ON products(name);
 CREATE INDEX idx_inventory_stock ON inventory(stock);
+CREATE INDEX idx_inventory_events_product_time ON inventory_events(product_id, occurred_at);
+CREATE INDEX idx_inventory_events_time ON inventory_events(occurred_at);
+CREATE INDEX idx_idempotency_keys_expires ON idempotency_keys(expires_at);
 CREATE INDEX idx_subscriptions_product ON subscriptions(product_id);
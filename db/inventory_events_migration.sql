@@ -0,0 +1,21 @@
+-- Append-only stock movement log for GET /api/inventory/:id/history
+-- Run this script against inventory_db created from an init.sql older than this table
+
+CREATE TABLE IF NOT EXISTS inventory_events (
+    id BIGSERIAL PRIMARY KEY,
+    product_id INT NOT NULL,
+    delta INT NOT NULL,
+    stock_after INT NOT NULL,
+    occurred_at TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    FOREIGN KEY (product_id)
+        REFERENCES products(id)
+        ON DELETE CASCADE
+);
+
+CREATE INDEX IF NOT EXISTS idx_inventory_events_product_time ON inventory_events(product_id, occurred_at);
+CREATE INDEX IF NOT EXISTS idx_inventory_events_time ON inventory_events(occurred_at);
+
+-- Bumped by every stock write; orders them for the in-memory views
+ALTER TABLE inventory ADD COLUMN IF NOT EXISTS version BIGINT NOT NULL DEFAULT 1;
+
+COMMIT;
@@ -36,7 +36,17 @@ CREATE TABLE IF NOT EXISTS notification_logs (
     FOREIGN KEY (product_id) REFERENCES products(id) ON DELETE CASCADE
 );
 
--- Table 3: User Notification Preferences
+-- Table 3: Pending subscriber counts per product (product_notifications rows
+-- with is_sent = FALSE), maintained by the API in the same transactions that
+-- change product_notifications; `version` orders updates for in-memory mirrors
+CREATE TABLE IF NOT EXISTS product_subscriber_counts (
+    product_id INT PRIMARY KEY,
+    pending INT NOT NULL DEFAULT 0 CHECK (pending >= 0),
+    version BIGINT NOT NULL DEFAULT 1,
+    FOREIGN KEY (product_id) REFERENCES products(id) ON DELETE CASCADE
+);
+
+-- Table 4: User Notification Preferences
 CREATE TABLE IF NOT EXISTS notification_preferences (
     id SERIAL PRIMARY KEY,
     user_id INT NOT NULL UNIQUE,
@@ -79,18 +89,18 @@ JOIN users u ON u.id = pn.user_id
 LEFT JOIN inventory i ON i.product_id = pn.product_id
 WHERE pn.is_sent = FALSE AND i.stock = 0;
 
--- View for finding products that were just restocked
+-- View for finding products that were just restocked (subscriber counts come
+-- from product_subscriber_counts, not a GROUP BY over product_notifications)
 CREATE OR REPLACE VIEW v_restocked_products AS
 SELECT 
     p.id,
     p.name,
     i.stock,
     i.updated_at,
-    COUNT(pn.id) as subscriber_count
+    COALESCE(c.pending, 0)::BIGINT as subscriber_count
 FROM products p
 JOIN inventory i ON i.product_id = p.id
-LEFT JOIN product_notifications pn ON pn.product_id = p.id AND pn.is_sent = FALSE
-WHERE i.stock > 0
-GROUP BY p.id, p.name, i.stock, i.updated_at;
+LEFT JOIN product_subscriber_counts c ON c.product_id = p.id
+WHERE i.stock > 0;
 
 COMMIT;
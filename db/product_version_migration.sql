@@ -0,0 +1,6 @@
+-- Per-product write counter the in-memory catalog orders product updates by
+-- Run this script against inventory_db created from an init.sql older than this column
+
+ALTER TABLE products ADD COLUMN IF NOT EXISTS version BIGINT NOT NULL DEFAULT 1;
+
+COMMIT;
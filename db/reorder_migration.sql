@@ -0,0 +1,7 @@
+-- Per-product reorder points for the low-stock report (GET /api/inventory/low-stock)
+-- Run this script against inventory_db created from an init.sql older than this column
+
+ALTER TABLE inventory
+    ADD COLUMN IF NOT EXISTS reorder_point INT NOT NULL DEFAULT 10 CHECK (reorder_point >= 0);
+
+COMMIT;
@@ -0,0 +1,13 @@
+-- Database-side product search (SEARCH_BACKEND=postgres)
+-- Run this script against inventory_db after init.sql
+
+-- Trigram matching for leading-wildcard ILIKE and similarity ranking
+CREATE EXTENSION IF NOT EXISTS pg_trgm;
+
+-- GIN trigram index: serves both `name ILIKE '%q%'` and `name % q`.
+-- The btree idx_products_name cannot be used for either.
+CREATE INDEX IF NOT EXISTS idx_products_name_trgm ON products USING GIN (name gin_trgm_ops);
+
+ANALYZE products;
+
+COMMIT;
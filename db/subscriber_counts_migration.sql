@@ -0,0 +1,38 @@
+-- Materialized pending-subscriber counts for restock dashboards
+-- Run this script against inventory_db set up with an older notification_migration.sql
+
+BEGIN;
+
+CREATE TABLE IF NOT EXISTS product_subscriber_counts (
+    product_id INT PRIMARY KEY,
+    pending INT NOT NULL DEFAULT 0 CHECK (pending >= 0),
+    version BIGINT NOT NULL DEFAULT 1,
+    FOREIGN KEY (product_id) REFERENCES products(id) ON DELETE CASCADE
+);
+
+-- Backfill from the existing subscriptions; blocks writers to
+-- product_notifications meanwhile so no change is missed
+LOCK TABLE product_notifications IN SHARE MODE;
+
+INSERT INTO product_subscriber_counts (product_id, pending)
+SELECT product_id, COUNT(*)
+FROM product_notifications
+WHERE is_sent = FALSE
+GROUP BY product_id
+ON CONFLICT (product_id) DO UPDATE
+    SET pending = EXCLUDED.pending,
+        version = product_subscriber_counts.version + 1;
+
+CREATE OR REPLACE VIEW v_restocked_products AS
+SELECT 
+    p.id,
+    p.name,
+    i.stock,
+    i.updated_at,
+    COALESCE(c.pending, 0)::BIGINT as subscriber_count
+FROM products p
+JOIN inventory i ON i.product_id = p.id
+LEFT JOIN product_subscriber_counts c ON c.product_id = p.id
+WHERE i.stock > 0;
+
+COMMIT;
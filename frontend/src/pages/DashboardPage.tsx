@@ -1,11 +1,11 @@
 import React, { useState, useEffect } from 'react';
-import { productAPI, userAPI, subscriptionAPI, inventoryAPI } from '../services/api';
+import { dashboardAPI, inventoryAPI } from '../services/api';
 
 interface DashboardStats {
   totalProducts: number;
   totalUsers: number;
   totalSubscriptions: number;
-  lowStockProducts: number;
+  outOfStockProducts: number;
   activeSubscriptions: number;
 }
 
@@ -14,12 +14,12 @@ const DashboardPage: React.FC = () => {
     totalProducts: 0,
     totalUsers: 0,
     totalSubscriptions: 0,
-    lowStockProducts: 0,
+    outOfStockProducts: 0,
     activeSubscriptions: 0,
   });
   const [loading, setLoading] = useState(false);
   const [error, setError] = useState('');
-  const [recentProducts, setRecentProducts] = useState<any[]>([]);
+  const [topWatched, setTopWatched] = useState<any[]>([]);
   const [lowStockAlerts, setLowStockAlerts] = useState<any[]>([]);
 
   useEffect(() => {
@@ -31,45 +31,27 @@ const DashboardPage: React.FC = () => {
     setError('');
 
     try {
-      const [products, users, subscriptions] = await Promise.all([
-        productAPI.getAll(),
-        userAPI.getAll(),
-        subscriptionAPI.getAll(),
+      // One aggregated call instead of downloading every product, user and
+      // subscription; low-stock alerts come from the server's low-stock report
+      const [summary, lowest] = await Promise.all([
+        dashboardAPI.getSummary(5),
+        inventoryAPI.getLowest(5),
       ]);
 
-      const productArray = Array.isArray(products) ? products : [];
-      const userArray = Array.isArray(users) ? users : [];
-      const subscriptionArray = Array.isArray(subscriptions) ? subscriptions : [];
-
-      // Get inventory details for low stock check (with error handling)
-      const lowStockProducts: any[] = [];
-      for (const product of productArray) {
-        try {
-          const inventory = await inventoryAPI.getStock(product.id);
-          if (inventory && inventory.stock < 50) {
-            lowStockProducts.push({
-              ...product,
-              quantity: inventory.stock,
-            });
-          }
-        } catch {
-          // Silently continue if inventory doesn't exist for this product
-          console.log(`No inventory found for product ${product.id}`);
-        }
-      }
-
-      const activeSubscriptions = subscriptionArray.filter((s: any) => s.active).length;
-
       setStats({
-        totalProducts: productArray.length,
-        totalUsers: userArray.length,
-        totalSubscriptions: subscriptionArray.length,
-        lowStockProducts: lowStockProducts.length,
-        activeSubscriptions: activeSubscriptions,
+        totalProducts: summary.products,
+        totalUsers: summary.users,
+        totalSubscriptions: summary.subscriptions.total,
+        outOfStockProducts: summary.out_of_stock,
+        activeSubscriptions: summary.subscriptions.active,
       });
 
-      setRecentProducts(productArray.slice(0, 5));
-      setLowStockAlerts(lowStockProducts.slice(0, 5));
+      setTopWatched(summary.top_watched || []);
+      setLowStockAlerts(
+        (lowest.items || [])
+          .filter((item: any) => item.stock < 50)
+          .map((item: any) => ({ id: item.product_id, name: item.name, quantity: item.stock }))
+      );
     } catch (err: any) {
       console.error('Dashboard error:', err);
       setError(`Failed to load dashboard: ${err.message}`);
@@ -142,27 +124,27 @@ const DashboardPage: React.FC = () => {
             />
             <StatCard
               icon="⚠️"
-              label="Low Stock Products"
-              value={stats.lowStockProducts}
+              label="Out of Stock Products"
+              value={stats.outOfStockProducts}
               color="#e74c3c"
             />
           </div>
 
-          {/* Recent Products Section */}
+          {/* Most Watched Products Section */}
           <div style={{ marginTop: '3rem' }}>
-            <h2>📦 Recent Products</h2>
-            {recentProducts.length === 0 ? (
+            <h2>👀 Most Watched Products</h2>
+            {topWatched.length === 0 ? (
               <div className="empty-state">
                 <div className="empty-state-icon">📭</div>
-                <p>No products found</p>
+                <p>No active subscriptions yet</p>
               </div>
             ) : (
               <div className="products-preview">
-                {recentProducts.map((product) => (
-                  <div key={product.id} className="product-preview-card">
-                    <div className="product-preview-id">#{product.id}</div>
+                {topWatched.map((product) => (
+                  <div key={product.product_id} className="product-preview-card">
+                    <div className="product-preview-id">#{product.product_id}</div>
                     <h3>{product.name}</h3>
-                    <p className="product-preview-desc">{product.description || 'No description'}</p>
+                    <p className="product-preview-desc">{product.watchers} watchers</p>
                   </div>
                 ))}
               </div>
@@ -36,12 +36,17 @@ const ProductPage: React.FC = () => {
       const data = await productAPI.getAll();
       setProducts(Array.isArray(data) ? data : []);
       
-      // Load inventory for each product
+      // Load inventory for all products, a batch of ids per request
       if (Array.isArray(data)) {
-        for (const product of data) {
+        const ids = data.map((product: any) => product.id);
+        for (let i = 0; i < ids.length; i += 500) {
           try {
-            const inv = await inventoryAPI.getStock(product.id);
-            setInventory(prev => ({ ...prev, [product.id]: inv.stock || 0 }));
+            const rows = await inventoryAPI.getStocks(ids.slice(i, i + 500));
+            const stock: { [key: number]: number } = {};
+            for (const inv of Array.isArray(rows) ? rows : []) {
+              stock[inv.product_id] = inv.stock || 0;
+            }
+            setInventory(prev => ({ ...prev, ...stock }));
           } catch (err) {
             // Continue if stock not found
           }
@@ -108,6 +108,18 @@ export const inventoryAPI = {
     }
   },
 
+  // Stock levels for many products in one request (at most 500 ids)
+  getStocks: async (productIds: number[]) => {
+    try {
+      const response = await fetch(`${API_URL}/inventory?ids=${productIds.join(',')}`);
+      if (!response.ok) throw new Error(`HTTP ${response.status}`);
+      return response.json();
+    } catch (error) {
+      console.error('❌ Get stocks failed:', error);
+      throw error;
+    }
+  },
+
   // Update stock
   updateStock: async (productId: number, stock: number) => {
     try {
@@ -125,6 +137,18 @@ export const inventoryAPI = {
       throw error;
     }
   },
+
+  // Lowest-stock products first (keyset-paged low-stock report)
+  getLowest: async (limit: number) => {
+    try {
+      const response = await fetch(`${API_URL}/inventory/low-stock?view=lowest&limit=${limit}`);
+      if (!response.ok) throw new Error(`HTTP ${response.status}`);
+      return response.json();
+    } catch (error) {
+      console.error('❌ Get low stock failed:', error);
+      throw error;
+    }
+  },
 };
 
 // ============================================
@@ -302,3 +326,21 @@ export const subscriptionAPI = {
     }
   },
 };
+
+// ============================================
+// DASHBOARD API
+// ============================================
+
+export const dashboardAPI = {
+  // Totals and most-watched products, from server-side counters
+  getSummary: async (top: number = 5) => {
+    try {
+      const response = await fetch(`${API_URL}/dashboard/summary?top=${top}`);
+      if (!response.ok) throw new Error(`HTTP ${response.status}`);
+      return response.json();
+    } catch (error) {
+      console.error('❌ Get dashboard summary failed:', error);
+      throw error;
+    }
+  },
+};
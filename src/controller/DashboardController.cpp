@@ -0,0 +1,122 @@
+#include "DashboardRoutes.h"
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+#include "../repository/postgres/PostgresConnection.h"
+#include "../repository/postgres/CacheLoader.h"
+#include "../repository/cache/CatalogCache.h"
+#include "../repository/cache/DashboardCounters.h"
+#include "../util/ResponseWriter.h"
+#include <pqxx/pqxx>
+
+using json = nlohmann::json;
+
+static const size_t kDefaultTopWatched = 5;
+static const size_t kMaxTopWatched = 50;
+
+// ISO-8601 UTC, second precision
+static std::string formatUtc(int64_t micros) {
+    std::time_t seconds = static_cast<std::time_t>(micros / 1000000);
+    std::tm utc;
+    gmtime_r(&seconds, &utc);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return buf;
+}
+
+// Names for the top-watched list: from the catalog cache when it is warm,
+// otherwise one lookup for all of them
+static std::unordered_map<int, std::string> productNames(const std::vector<DashboardCounters::Watched>& products) {
+    std::unordered_map<int, std::string> names;
+    if (products.empty()) {
+        return names;
+    }
+    CatalogCache& catalog = CatalogCache::instance();
+    if (catalog.isLoaded()) {
+        for (const auto& p : products) {
+            if (auto cached = catalog.findProduct(p.product_id)) {
+                names.emplace(p.product_id, cached->get_name());
+            }
+        }
+        return names;
+    }
+    std::string ids = "{";
+    for (size_t i = 0; i < products.size(); ++i) {
+        ids += (i > 0 ? "," : "") + std::to_string(products[i].product_id);
+    }
+    ids += "}";
+    pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+        return txn.exec_params("SELECT id, name FROM products WHERE id = ANY($1::int[])", ids);
+    });
+    for (const auto& row : r) {
+        names.emplace(row[0].as<int>(), row[1].as<std::string>());
+    }
+    return names;
+}
+
+void registerDashboardRoutes(httplib::Server& server) {
+
+    // DASHBOARD SUMMARY - GET /api/dashboard/summary?top=5
+    // Totals for the dashboard tiles plus the `top` most watched products
+    // (most active subscriptions). Served from DashboardCounters, which the
+    // write paths keep current and which is reconciled with the database
+    // every DASHBOARD_RECONCILE_SECONDS; until its first reconcile the
+    // counts are read from the database directly.
+    server.Get("/api/dashboard/summary", [](const httplib::Request& req, httplib::Response& res) {
+        try {
+            size_t top = kDefaultTopWatched;
+            if (req.has_param("top")) {
+                int requested = std::stoi(req.get_param_value("top"));
+                if (requested < 0) {
+                    res.set_content(json{{"error", "top must be >= 0"}}.dump(), "application/json");
+                    res.status = 400;
+                    return;
+                }
+                top = std::min(static_cast<size_t>(requested), kMaxTopWatched);
+            }
+            
+            DashboardCounters& counters = DashboardCounters::instance();
+            DashboardCounters::Summary summary = counters.isLoaded()
+                ? counters.summary(top)
+                : DashboardCounters::summarize(CacheLoader::loadDashboardCounts(), top);
+            std::unordered_map<int, std::string> names = productNames(summary.top_watched);
+            
+            const DashboardCounters::Totals& t = summary.totals;
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(384 + summary.top_watched.size() * 96);
+            ResponseWriter w(body, format);
+            w.beginObject()
+                .field("products", t.products)
+                .field("users", t.users);
+            w.key("subscriptions").beginObject()
+                .field("total", t.subscriptions)
+                .field("active", t.active_subscriptions)
+                .endObject();
+            w.field("out_of_stock", t.out_of_stock);
+            w.key("notifications").beginObject()
+                .field("pending", t.pending_notifications)
+                .field("failed", t.failed_notifications)
+                .endObject();
+            w.key("top_watched").beginArray();
+            for (const auto& p : summary.top_watched) {
+                auto name = names.find(p.product_id);
+                w.beginObject()
+                    .field("product_id", p.product_id)
+                    .field("name", name != names.end() ? name->second : std::string())
+                    .field("watchers", p.watchers)
+                    .endObject();
+            }
+            w.endArray();
+            w.field("as_of", formatUtc(summary.reconciled_at_us));
+            w.endObject();
+            res.set_content(std::move(body), responseformat::contentType(format));
+            res.status = 200;
+        } catch (const std::exception& e) {
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            res.status = 500;
+        }
+    });
+}
@@ -0,0 +1,81 @@
+#include "ExportRoutes.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "../repository/postgres/InventoryExport.h"
+#include "../server/Config.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// One snapshot file is shared by all requests and rebuilt once it is older
+// than SNAPSHOT_MAX_AGE_SECONDS, so hourly pulls from several jobs cost one
+// table scan. Rebuilds replace the file by rename, so responses still
+// sending the previous file are unaffected.
+std::mutex snapshotMutex;
+std::chrono::steady_clock::time_point snapshotBuiltAt;
+bool snapshotBuilt = false;
+
+// SNAPSHOT_DIR, else a directory of our own (mode 0700) under /tmp: the
+// snapshot holds the whole catalog and must not sit where anyone can read
+// or replace it.
+std::string snapshotDir() {
+    std::string dir = Config::envString("SNAPSHOT_DIR", "");
+    if (!dir.empty()) {
+        return dir;
+    }
+    std::string tmpl = "/tmp/inventory-snapshot.XXXXXX";
+    if (!::mkdtemp(&tmpl[0])) {
+        throw std::runtime_error(std::string("cannot create snapshot directory: ") + std::strerror(errno));
+    }
+    return tmpl;
+}
+
+std::string snapshotPath() {
+    static const std::string path = snapshotDir() + "/inventory.snapshot";
+    return path;
+}
+
+void ensureFreshSnapshot() {
+    static const auto maxAge = std::chrono::seconds(Config::envSize("SNAPSHOT_MAX_AGE_SECONDS", 60));
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    auto now = std::chrono::steady_clock::now();
+    if (snapshotBuilt && now - snapshotBuiltAt < maxAge) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t rows = InventoryExport::writeSnapshot(snapshotPath());
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "✅ Inventory snapshot written: " << rows << " rows in " << millis << " ms" << std::endl;
+    snapshotBuilt = true;
+    snapshotBuiltAt = now;
+}
+
+} // namespace
+
+void registerExportRoutes(httplib::Server& server) {
+
+    // INVENTORY SNAPSHOT - GET /api/export/inventory.snapshot
+    // Columnar binary file (export/InventorySnapshot.h; read it with
+    // SnapshotReader). Sent straight from the mmapped file.
+    server.Get("/api/export/inventory.snapshot", [](const httplib::Request&, httplib::Response& res) {
+        try {
+            ensureFreshSnapshot();
+            res.set_header("Content-Disposition", "attachment; filename=\"inventory.snapshot\"");
+            res.set_header("Cache-Control", "no-cache");
+            res.set_file_content(snapshotPath(), "application/octet-stream");
+            res.status = 200;
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Inventory snapshot failed: " << e.what() << std::endl;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            res.status = 500;
+        }
+    });
+}
@@ -0,0 +1,4 @@
+#pragma once
+#include "external/httplib.h"
+
+void registerExportRoutes(httplib::Server& server);
@@ -0,0 +1,138 @@
+#include "HealthRoutes.h"
+#include <nlohmann/json.hpp>
+#include "../server/Warmup.h"
+#include "../server/RequestArena.h"
+#include "../server/Admission.h"
+#include "../server/ConcurrencyLimit.h"
+#include "../repository/cache/IdempotencyCache.h"
+#include "../util/SingleFlight.h"
+#include "../repository/postgres/ReplicaRouter.h"
+
+using json = nlohmann::json;
+
+void registerHealthRoutes(httplib::Server& server) {
+
+    // READINESS - GET /ready (503 until startup warm-up has finished)
+    server.Get("/ready", [](const httplib::Request&, httplib::Response& res) {
+        Warmup& warmup = Warmup::instance();
+
+        json phases = json::array();
+        for (const auto& phase : warmup.results()) {
+            json entry = json{
+                {"name", phase.name},
+                {"duration_ms", phase.millis},
+                {"ok", phase.ok}
+            };
+            if (!phase.ok) {
+                entry["error"] = phase.error;
+            }
+            phases.push_back(entry);
+        }
+
+        bool ready = warmup.isReady();
+        json response = json{
+            {"status", ready ? "ready" : "warming_up"},
+            {"warmup_ms", warmup.totalMillis()},
+            {"phases", phases}
+        };
+        res.set_content(response.dump(), "application/json");
+        res.status = ready ? 200 : 503;
+    });
+
+    // ALLOCATIONS - GET /metrics/allocations (per-route averages since start;
+    // compare against a run with REQUEST_ARENA_KB=0 to see the arena's effect).
+    // Heap allocations are only counted in a COUNT_HEAP_ALLOCATIONS=1 build.
+    server.Get("/metrics/allocations", [](const httplib::Request&, httplib::Response& res) {
+        json routes = json::array();
+        for (const auto& route : RouteAllocations::instance().snapshot()) {
+            const auto& t = route.totals;
+            double requests = static_cast<double>(t.requests);
+            json entry = json{
+                {"method", route.method},
+                {"route", route.pattern.empty() ? "(unmatched)" : route.pattern},
+                {"requests", t.requests},
+                {"arena_allocations_per_request", static_cast<double>(t.arena_allocations) / requests},
+                {"arena_bytes_per_request", static_cast<double>(t.arena_bytes) / requests},
+                {"overflow_blocks", t.overflow_blocks}
+            };
+            if (RequestArena::kCountsHeapAllocations) {
+                entry["heap_allocations_per_request"] = static_cast<double>(t.heap_allocations) / requests;
+            }
+            routes.push_back(std::move(entry));
+        }
+
+        json response = json{
+            {"arena_block_bytes", RequestArena::blockBytes()},
+            {"heap_allocations_counted", RequestArena::kCountsHeapAllocations},
+            {"routes", routes}
+        };
+        res.set_content(response.dump(), "application/json");
+    });
+
+    // IDEMPOTENCY - GET /metrics/idempotency (Idempotency-Key outcomes since
+    // start, from the in-memory cache's point of view)
+    server.Get("/metrics/idempotency", [](const httplib::Request&, httplib::Response& res) {
+        IdempotencyCache::Stats s = IdempotencyCache::instance().stats();
+        json response = json{
+            {"claims", s.claims},
+            {"replays", s.replays},
+            {"in_flight_conflicts", s.in_flight},
+            {"mismatches", s.mismatches},
+            {"evictions", s.evictions},
+            {"entries", s.entries},
+            {"capacity", s.capacity}
+        };
+        res.set_content(response.dump(), "application/json");
+    });
+
+    // ADMISSION - GET /metrics/admission (current database concurrency limit
+    // and how many requests were rate limited or shed since start)
+    server.Get("/metrics/admission", [](const httplib::Request&, httplib::Response& res) {
+        ConcurrencyLimit::Stats limit = ConcurrencyLimit::instance().stats();
+        AdmissionStats admission = admissionStats();
+        json response = json{
+            {"concurrency_limit", limit.limit},
+            {"database_in_flight", limit.in_flight},
+            {"database_admitted", limit.admitted},
+            {"shed_503", admission.shed},
+            {"client_limited_429", admission.client_limited},
+            {"route_limited_429", admission.route_limited}
+        };
+        res.set_content(response.dump(), "application/json");
+    });
+
+    // COALESCING - GET /metrics/coalescing (per single-flight group since
+    // start, listed from their first lookup; collapse_ratio is callers per
+    // query actually run)
+    server.Get("/metrics/coalescing", [](const httplib::Request&, httplib::Response& res) {
+        json groups = json::array();
+        for (const auto& g : SingleFlightStats::all()) {
+            uint64_t callers = g.queries + g.coalesced;
+            groups.push_back(json{
+                {"name", g.name},
+                {"callers", callers},
+                {"queries", g.queries},
+                {"coalesced", g.coalesced},
+                {"over_waiter_limit", g.over_limit},
+                {"collapse_ratio", g.queries > 0 ? static_cast<double>(callers) / static_cast<double>(g.queries) : 1.0}
+            });
+        }
+        res.set_content(json{{"groups", groups}}.dump(), "application/json");
+    });
+
+    // REPLICA - GET /metrics/replica (read routing since start: reads sent to
+    // the replica, reads kept on the primary because the replica was
+    // lagging or down, and reads pinned there by read-your-writes)
+    server.Get("/metrics/replica", [](const httplib::Request&, httplib::Response& res) {
+        ReplicaRouter::Stats s = ReplicaRouter::instance().stats();
+        json response = json{
+            {"configured", s.configured},
+            {"healthy", s.healthy},
+            {"replica_reads", s.replica_reads},
+            {"unhealthy_fallbacks", s.unhealthy_fallbacks},
+            {"read_your_writes", s.read_your_writes}
+        };
+        response["lag_ms"] = s.lag_ms >= 0 ? json(s.lag_ms) : json(nullptr);
+        res.set_content(response.dump(), "application/json");
+    });
+}
@@ -1,10 +1,44 @@
 #include "NotificationController.h"
 #include "service/implementations/NotificationService.h"
+#include "util/ResponseWriter.h"
+#include "util/IsoTime.h"
+#include "index/StockIndex.h"
+#include "repository/cache/CatalogCache.h"
+#include "repository/cache/SubscriberCounts.h"
+#include "repository/postgres/PostgresConnection.h"
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <iostream>
+#include <utility>
 
 using json = nlohmann::json;
 
+static const size_t kDefaultRestockedPageSize = 50;
+static const size_t kMaxRestockedPageSize = 500;
+
+// A timestamp field as ISO-8601 UTC, or "" when unset (0)
+static ResponseWriter& timeField(ResponseWriter& w, std::string_view key, int64_t micros) {
+    if (micros == 0) {
+        return w.field(key, std::string_view());
+    }
+    return w.field(key, isotime::format(micros).view());
+}
+
+// Common leading fields of a notification log entry; callers append the
+// timestamp fields they expose and close the object.
+static ResponseWriter& writeLogFields(ResponseWriter& w, const domain::NotificationLog& log) {
+    return w.field("id", log.id)
+        .field("notification_id", log.notification_id)
+        .field("user_id", log.user_id)
+        .field("product_id", log.product_id)
+        .field("type", domain::toString(log.notification_type))
+        .field("message", log.message)
+        .field("status", domain::toString(log.status))
+        .field("retry_count", log.retry_count)
+        .field("max_retries", log.max_retries)
+        .field("error_message", log.error_message);
+}
+
 void NotificationController::registerRoutes(httplib::Server& svr) {
     auto notification_service = std::make_shared<NotificationService>();
     
@@ -127,20 +161,24 @@ void NotificationController::registerRoutes(httplib::Server& svr) {
                 res.set_header("Access-Control-Allow-Origin", "http://localhost:3001");
             }
             
-            json response = json::array();
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(notifications.size() * 160 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
             for (const auto& notif : notifications) {
-                response.push_back({
-                    {"id", notif.id},
-                    {"product_id", notif.product_id},
-                    {"user_id", notif.user_id},
-                    {"type", notif.type_str},
-                    {"is_sent", notif.is_sent},
-                    {"created_at", notif.created_at},
-                    {"sent_at", notif.sent_at}
-                });
+                w.beginObject()
+                    .field("id", notif.id)
+                    .field("product_id", notif.product_id)
+                    .field("user_id", notif.user_id)
+                    .field("type", domain::toString(notif.type))
+                    .field("is_sent", notif.is_sent);
+                timeField(w, "created_at", notif.created_at_us);
+                timeField(w, "sent_at", notif.sent_at_us).endObject();
             }
+            w.endArray();
             
-            res.set_content(response.dump(), "application/json");
+            res.set_content(std::move(body), responseformat::contentType(format));
             res.status = 200;
         } catch (const std::exception& e) {
             if (!res.has_header("Access-Control-Allow-Origin")) {
@@ -168,19 +206,23 @@ void NotificationController::registerRoutes(httplib::Server& svr) {
                 res.set_header("Access-Control-Allow-Origin", "http://localhost:3001");
             }
             
-            json response = json::array();
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(subscribers.size() * 128 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
             for (const auto& sub : subscribers) {
-                response.push_back({
-                    {"id", sub.id},
-                    {"product_id", sub.product_id},
-                    {"user_id", sub.user_id},
-                    {"type", sub.type_str},
-                    {"is_sent", sub.is_sent},
-                    {"subscribed_at", sub.created_at}
-                });
+                w.beginObject()
+                    .field("id", sub.id)
+                    .field("product_id", sub.product_id)
+                    .field("user_id", sub.user_id)
+                    .field("type", domain::toString(sub.type))
+                    .field("is_sent", sub.is_sent);
+                timeField(w, "subscribed_at", sub.created_at_us).endObject();
             }
+            w.endArray();
             
-            res.set_content(response.dump(), "application/json");
+            res.set_content(std::move(body), responseformat::contentType(format));
             res.status = 200;
         } catch (const std::exception& e) {
             if (!res.has_header("Access-Control-Allow-Origin")) {
@@ -208,25 +250,19 @@ void NotificationController::registerRoutes(httplib::Server& svr) {
                 res.set_header("Access-Control-Allow-Origin", "http://localhost:3001");
             }
             
-            json response = json::array();
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(logs.size() * 256 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
             for (const auto& log : logs) {
-                response.push_back({
-                    {"id", log.id},
-                    {"notification_id", log.notification_id},
-                    {"user_id", log.user_id},
-                    {"product_id", log.product_id},
-                    {"type", log.notification_type},
-                    {"message", log.message},
-                    {"status", log.status},
-                    {"retry_count", log.retry_count},
-                    {"max_retries", log.max_retries},
-                    {"error_message", log.error_message},
-                    {"sent_at", log.sent_at},
-                    {"created_at", log.created_at}
-                });
+                writeLogFields(w.beginObject(), log);
+                timeField(w, "sent_at", log.sent_at_us);
+                timeField(w, "created_at", log.created_at_us).endObject();
             }
+            w.endArray();
             
-            res.set_content(response.dump(), "application/json");
+            res.set_content(std::move(body), responseformat::contentType(format));
             res.status = 200;
         } catch (const std::exception& e) {
             if (!res.has_header("Access-Control-Allow-Origin")) {
@@ -252,24 +288,18 @@ void NotificationController::registerRoutes(httplib::Server& svr) {
                 res.set_header("Access-Control-Allow-Origin", "http://localhost:3001");
             }
             
-            json response = json::array();
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(logs.size() * 256 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
             for (const auto& log : logs) {
-                response.push_back({
-                    {"id", log.id},
-                    {"notification_id", log.notification_id},
-                    {"user_id", log.user_id},
-                    {"product_id", log.product_id},
-                    {"type", log.notification_type},
-                    {"message", log.message},
-                    {"status", log.status},
-                    {"retry_count", log.retry_count},
-                    {"max_retries", log.max_retries},
-                    {"error_message", log.error_message},
-                    {"created_at", log.created_at}
-                });
+                writeLogFields(w.beginObject(), log);
+                timeField(w, "created_at", log.created_at_us).endObject();
             }
+            w.endArray();
             
-            res.set_content(response.dump(), "application/json");
+            res.set_content(std::move(body), responseformat::contentType(format));
             res.status = 200;
         } catch (const std::exception& e) {
             if (!res.has_header("Access-Control-Allow-Origin")) {
@@ -421,4 +451,98 @@ void NotificationController::registerRoutes(httplib::Server& svr) {
             res.status = 500;
         }
     });
+    
+    // GET /api/notifications/restocked?limit=50&offset=0 - In-stock products with pending subscribers
+    // Ordered by product id. Served by intersecting the StockIndex "stock > 0"
+    // bitmap with SubscriberCounts' pending bitmap once both are loaded;
+    // otherwise from v_restocked_products, whose counts also come from
+    // product_subscriber_counts rather than a GROUP BY.
+    svr.Get("/api/notifications/restocked", [](const httplib::Request& req, httplib::Response& res) {
+        try {
+            size_t limit = kDefaultRestockedPageSize;
+            size_t offset = 0;
+            if (req.has_param("limit")) {
+                int requested = std::stoi(req.get_param_value("limit"));
+                if (requested <= 0) {
+                    res.set_content(json({{"status", "error"}, {"message", "limit must be positive"}}).dump(), "application/json");
+                    res.status = 400;
+                    return;
+                }
+                limit = std::min(static_cast<size_t>(requested), kMaxRestockedPageSize);
+            }
+            if (req.has_param("offset")) {
+                int requested = std::stoi(req.get_param_value("offset"));
+                if (requested < 0) {
+                    res.set_content(json({{"status", "error"}, {"message", "offset must be >= 0"}}).dump(), "application/json");
+                    res.status = 400;
+                    return;
+                }
+                offset = static_cast<size_t>(requested);
+            }
+            
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(limit * 128 + 32);
+            ResponseWriter w(body, format);
+            w.beginObject();
+            
+            SubscriberCounts& counts = SubscriberCounts::instance();
+            StockIndex& stock = StockIndex::products();
+            CatalogCache& catalog = CatalogCache::instance();
+            if (counts.isLoaded() && stock.isLoaded() && catalog.isLoaded()) {
+                RoaringBitmap restocked = stock.select(StockIndex::State::In, 0);
+                restocked &= counts.withPending();
+                w.field("total", restocked.cardinality());
+                w.key("items").beginArray();
+                for (uint32_t id : restocked.toVector(offset, limit)) {
+                    auto entry = catalog.findEntry(static_cast<int>(id));
+                    if (!entry) {
+                        continue;
+                    }
+                    w.beginObject()
+                        .field("product_id", id)
+                        .field("name", entry->name)
+                        .field("stock", entry->stock)
+                        .field("updated_at", entry->stock_updated_at)
+                        .field("subscriber_count", counts.pending(static_cast<int>(id)).value_or(0))
+                        .endObject();
+                }
+                w.endArray();
+            } else {
+                auto [total, r] = PostgresConnection::read([&](pqxx::work& txn) {
+                    pqxx::row count = txn.exec1("SELECT count(*) FROM v_restocked_products WHERE subscriber_count > 0");
+                    pqxx::result page = txn.exec_params(
+                        "SELECT id, name, stock, updated_at, subscriber_count FROM v_restocked_products "
+                        "WHERE subscriber_count > 0 ORDER BY id LIMIT $1 OFFSET $2",
+                        static_cast<long long>(limit), static_cast<long long>(offset));
+                    return std::make_pair(count, page);
+                });
+                w.field("total", total[0].as<long long>());
+                w.key("items").beginArray();
+                for (const auto& row : r) {
+                    w.beginObject()
+                        .field("product_id", row[0].as<int>())
+                        .field("name", row[1].as<std::string>())
+                        .field("stock", row[2].as<int>())
+                        .field("updated_at", row[3].as<std::string>(std::string()))
+                        .field("subscriber_count", row[4].as<long long>())
+                        .endObject();
+                }
+                w.endArray();
+            }
+            w.endObject();
+            
+            res.set_content(std::move(body), responseformat::contentType(format));
+            res.status = 200;
+        } catch (const std::exception& e) {
+            res.set_content(
+                json({
+                    {"status", "error"},
+                    {"message", std::string(e.what())}
+                }).dump(),
+                "application/json"
+            );
+            res.status = 500;
+        }
+    });
 }
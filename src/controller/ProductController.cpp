@@ -1,8 +1,33 @@
 #include "ProductRoutes.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <optional>
 #include <string>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <nlohmann/json.hpp>
 #include "../repository/postgres/PostgresConnection.h"
+#include "../repository/postgres/PgJson.h"
+#include "../repository/postgres/PgArray.h"
+#include "../repository/postgres/ReplicaRouter.h"
+#include "../repository/cache/CatalogCache.h"
+#include "../repository/cache/DashboardCounters.h"
+#include "../index/TrigramIndex.h"
+#include "../index/PrefixIndex.h"
+#include "../index/FullTextIndex.h"
+#include "../index/StockIndex.h"
+#include "../index/LowStockIndex.h"
+#include "../index/StockHistory.h"
+#include "../repository/postgres/InventoryEventLog.h"
+#include "../server/Config.h"
+#include "../server/Idempotency.h"
+#include "../server/ConcurrencyLimit.h"
+#include "../util/SingleFlight.h"
+#include "../util/IsoTime.h"
 #include "../repository/postgres/ProductRepo.cpp"
 #include "../service/implementations/InventoryService.cpp"
 #include <pqxx/pqxx>
@@ -10,11 +35,231 @@
 
 using json = nlohmann::json;
 
+static const size_t kDefaultSearchLimit = 50;
+static const size_t kMaxSearchLimit = 500;
+// pg_trgm's own default for the `%` operator
+static const double kDefaultMinSimilarity = 0.3;
+static const size_t kDefaultAutocompleteLimit = 10;
+static const size_t kMaxAutocompleteLimit = 50;
+static const int kDefaultLowStockThreshold = 10;
+static const size_t kDefaultLowStockPageSize = 50;
+static const size_t kMaxLowStockPageSize = 500;
+static const size_t kDefaultHistoryLimit = 20;
+static const size_t kMaxHistoryLimit = 500;
+// Most ids one ?ids= batch lookup accepts
+static const size_t kMaxBatchIds = 500;
+// RETURNING columns for stock writes: updated_at as text and reorder_point;
+// version, which the in-memory views compare to drop a write that reaches
+// them after a newer one; and updated_at as epoch microseconds, the
+// timestamp their inventory_events row is stamped with
+static const char* const kStockWriteReturning =
+    " RETURNING updated_at, reorder_point, version, (extract(epoch FROM updated_at::timestamptz) * 1000000)::bigint";
+
+// One product's inventory row as GET /api/inventory/:id reads it on a
+// catalog cache miss
+struct InventoryRow {
+    int product_id;
+    int stock;
+    int reorder_point;
+    std::string updated_at;
+};
+
+// Cache misses of GET /api/inventory/:id: concurrent lookups of one id share
+// a query. nullopt when the product has no inventory row.
+static SingleFlight<int, std::optional<InventoryRow>>& inventoryLookups() {
+    static SingleFlight<int, std::optional<InventoryRow>> group(
+        "inventory_by_product", Config::envSize("SINGLE_FLIGHT_MAX_WAITERS", 64));
+    return group;
+}
+
+// Logs a committed stock change to inventory_events (batched) and to the
+// product's in-memory history ring
+static void recordStockMovement(int productId, int delta, int stockAfter, long long atMicros, bool first) {
+    InventoryEventLog::instance().append(InventoryEventLog::Event{productId, delta, stockAfter, atMicros});
+    StockHistory::products().record(static_cast<uint32_t>(productId),
+                                     StockHistory::Movement{atMicros, delta, stockAfter}, first);
+}
+
+// Parses ?threshold= for the stock-state endpoints; false (and a 400) when invalid
+static bool parseStockThreshold(const httplib::Request& req, httplib::Response& res, int& threshold) {
+    threshold = kDefaultLowStockThreshold;
+    if (req.has_param("threshold")) {
+        threshold = std::stoi(req.get_param_value("threshold"));
+        if (threshold < 0) {
+            res.set_content(json{{"error", "threshold must be >= 0"}}.dump(), "application/json");
+            res.status = 400;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Parses ?ids=1,2,3 for the batch lookups: positive ids, duplicates dropped
+// (first occurrence kept), at most kMaxBatchIds; false (and a 400) otherwise
+static bool parseIdList(const httplib::Request& req, httplib::Response& res, std::vector<int>& ids) {
+    const std::string list = req.get_param_value("ids");
+    std::unordered_set<int> seen;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        const std::string token = list.substr(start, end - start);
+        size_t used = 0;
+        long long id = 0;
+        try {
+            id = std::stoll(token, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (token.empty() || used != token.size() || id <= 0 || id > std::numeric_limits<int>::max()) {
+            res.set_content(json{{"error", "ids must be a comma-separated list of positive integers"}}.dump(), "application/json");
+            res.status = 400;
+            return false;
+        }
+        if (seen.insert(static_cast<int>(id)).second) {
+            ids.push_back(static_cast<int>(id));
+        }
+        start = end + 1;
+    }
+    if (ids.size() > kMaxBatchIds) {
+        res.set_content(json{{"error", "at most " + std::to_string(kMaxBatchIds) + " ids per request"}}.dump(), "application/json");
+        res.status = 400;
+        return false;
+    }
+    return true;
+}
+
+// GET /api/products?ids=1,2,3 - the products among `ids`, in the order
+// requested; ids that do not exist are left out. Cached products come from
+// memory, the rest from one query (ProductRepo::find_by_ids).
+static void listByIds(const httplib::Request& req, httplib::Response& res) {
+    std::vector<int> ids;
+    if (!parseIdList(req, res, ids)) {
+        return;
+    }
+    ProductRepo repo;
+    std::vector<product> products = repo.find_by_ids(ids);
+    
+    ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+    std::string body;
+    body.reserve(products.size() * 96 + 2);
+    ResponseWriter w(body, format);
+    w.beginArray();
+    for (const auto& p : products) {
+        w.beginObject()
+            .field("id", p.get_id())
+            .field("name", p.get_name())
+            .field("description", p.get_description())
+            .endObject();
+    }
+    w.endArray();
+    res.set_content(std::move(body), responseformat::contentType(format));
+    res.status = 200;
+}
+
+// GET /api/products?stock_state=out|low|in&threshold=10&limit=&offset=
+// out: stock = 0, low: 0 < stock <= threshold, in: stock > threshold; products
+// without an inventory row match no state. Ordered by id. Served from the
+// StockIndex bitmaps once warm-up has built them, otherwise from the database.
+static void listByStockState(const httplib::Request& req, httplib::Response& res) {
+    std::string state = req.get_param_value("stock_state");
+    if (state != "out" && state != "low" && state != "in") {
+        res.set_content(json{{"error", "stock_state must be out, low or in"}}.dump(), "application/json");
+        res.status = 400;
+        return;
+    }
+    int threshold;
+    if (!parseStockThreshold(req, res, threshold)) {
+        return;
+    }
+    size_t limit = SIZE_MAX;
+    size_t offset = 0;
+    if (req.has_param("limit")) {
+        int requested = std::stoi(req.get_param_value("limit"));
+        if (requested <= 0) {
+            res.set_content(json{{"error", "limit must be positive"}}.dump(), "application/json");
+            res.status = 400;
+            return;
+        }
+        limit = static_cast<size_t>(requested);
+    }
+    if (req.has_param("offset")) {
+        int requested = std::stoi(req.get_param_value("offset"));
+        if (requested < 0) {
+            res.set_content(json{{"error", "offset must be >= 0"}}.dump(), "application/json");
+            res.status = 400;
+            return;
+        }
+        offset = static_cast<size_t>(requested);
+    }
+    
+    ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+    std::string body;
+    ResponseWriter w(body, format);
+    w.beginArray();
+    StockIndex& index = StockIndex::products();
+    if (index.isLoaded() && CatalogCache::instance().isLoaded()) {
+        StockIndex::State selected = state == "out" ? StockIndex::State::Out
+                                   : state == "low" ? StockIndex::State::Low
+                                                    : StockIndex::State::In;
+        std::vector<uint32_t> ids = index.select(selected, threshold).toVector(offset, limit);
+        body.reserve(ids.size() * 112 + 2);
+        for (uint32_t id : ids) {
+            auto entry = CatalogCache::instance().findEntry(static_cast<int>(id));
+            if (!entry) {
+                continue;
+            }
+            w.beginObject()
+                .field("id", entry->id)
+                .field("name", entry->name)
+                .field("description", entry->description)
+                .field("stock", entry->stock)
+                .endObject();
+        }
+    } else {
+        // Each state is a stock range [lo, hi]
+        long long lo = state == "out" ? 0 : state == "low" ? 1 : threshold + 1LL;
+        long long hi = state == "out" ? 0 : state == "low" ? threshold : std::numeric_limits<int>::max();
+        // LIMIT NULL means no limit
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT p.id, p.name, p.description, i.stock "
+                "FROM products p JOIN inventory i ON i.product_id = p.id "
+                "WHERE i.stock BETWEEN $1 AND $2 "
+                "ORDER BY p.id LIMIT $3 OFFSET $4",
+                lo, hi,
+                limit == SIZE_MAX ? std::optional<long long>() : std::optional<long long>(static_cast<long long>(limit)),
+                static_cast<long long>(offset)
+            );
+        });
+        body.reserve(r.size() * 112 + 2);
+        for (const auto& row : r) {
+            w.beginObject();
+            pgjson::integer(w, "id", row[0]);
+            pgjson::text(w, "name", row[1]);
+            pgjson::textOrEmpty(w, "description", row[2]);
+            pgjson::integer(w, "stock", row[3]);
+            w.endObject();
+        }
+    }
+    w.endArray();
+    res.set_content(std::move(body), responseformat::contentType(format));
+    res.status = 200;
+}
+
 void registerProductRoutes(httplib::Server& server) {
     // Create repositories and services
     static ProductRepo productRepo;
 
-    // SEARCH products by name - GET /api/products/search?name=xyz (MUST come before :id pattern)
+    // SEARCH products by name - GET /api/products/search?name=xyz&limit=50&min_similarity=0.3 (MUST come before :id pattern)
+    // Served from the in-memory trigram index once warm-up has built it, or from
+    // pg_trgm when SEARCH_BACKEND=postgres (which also honours min_similarity for
+    // fuzzy matches); either way ranked by relevance.
+    // mode=fulltext instead matches any word of `name` against product names and
+    // descriptions, ranked by BM25 (in-memory FullTextIndex, Postgres tsvector
+    // until it is built); each hit then carries its score.
     server.Get(R"(/api/products/search)", [](const httplib::Request& req, httplib::Response& res) {
         try {
             std::string searchName = req.get_param_value("name");
@@ -24,18 +269,157 @@ void registerProductRoutes(httplib::Server& server) {
                 return;
             }
             
-            ProductRepo repo;
-            auto products = repo.find_by_name(searchName);
+            size_t limit = kDefaultSearchLimit;
+            if (req.has_param("limit")) {
+                int requested = std::stoi(req.get_param_value("limit"));
+                if (requested <= 0) {
+                    res.set_content(json{{"error", "limit must be positive"}}.dump(), "application/json");
+                    res.status = 400;
+                    return;
+                }
+                limit = std::min(static_cast<size_t>(requested), kMaxSearchLimit);
+            }
+            
+            double minSimilarity = kDefaultMinSimilarity;
+            if (req.has_param("min_similarity")) {
+                minSimilarity = std::stod(req.get_param_value("min_similarity"));
+                if (minSimilarity < 0.0 || minSimilarity > 1.0) {
+                    res.set_content(json{{"error", "min_similarity must be between 0 and 1"}}.dump(), "application/json");
+                    res.status = 400;
+                    return;
+                }
+            }
+            
+            std::string mode = req.has_param("mode") ? req.get_param_value("mode") : "name";
+            if (mode != "name" && mode != "fulltext") {
+                res.set_content(json{{"error", "mode must be name or fulltext"}}.dump(), "application/json");
+                res.status = 400;
+                return;
+            }
             
-            json response = json::array();
+            if (mode == "fulltext") {
+                ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+                std::string body;
+                body.reserve(limit * 128 + 2);
+                ResponseWriter w(body, format);
+                w.beginArray();
+                FullTextIndex& fulltext = FullTextIndex::products();
+                if (fulltext.isLoaded() && !Config::useDatabaseSearch()) {
+                    for (const auto& hit : fulltext.search(searchName, limit)) {
+                        if (auto p = CatalogCache::instance().findProduct(static_cast<int>(hit.id))) {
+                            w.beginObject()
+                                .field("id", p->get_id())
+                                .field("name", p->get_name())
+                                .field("description", p->get_description())
+                                .field("score", static_cast<double>(hit.score))
+                                .endObject();
+                        }
+                    }
+                } else {
+                    ProductRepo repo;
+                    for (const auto& product : repo.search_fulltext(searchName, limit)) {
+                        w.beginObject()
+                            .field("id", product.get_id())
+                            .field("name", product.get_name())
+                            .field("description", product.get_description())
+                            .endObject();
+                    }
+                }
+                w.endArray();
+                res.set_content(std::move(body), responseformat::contentType(format));
+                res.status = 200;
+                return;
+            }
+            
+            std::vector<product> products;
+            TrigramIndex& index = TrigramIndex::products();
+            if (Config::useDatabaseSearch()) {
+                ProductRepo repo;
+                products = repo.search_ranked(searchName, limit, minSimilarity);
+            } else if (index.isLoaded()) {
+                for (uint32_t id : index.search(searchName, limit)) {
+                    if (auto p = CatalogCache::instance().findProduct(static_cast<int>(id))) {
+                        products.push_back(std::move(*p));
+                    }
+                }
+            } else {
+                ProductRepo repo;
+                products = repo.find_by_name(searchName);
+                if (products.size() > limit) {
+                    products.erase(products.begin() + static_cast<std::ptrdiff_t>(limit), products.end());
+                }
+            }
+            
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(products.size() * 96 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
             for (const auto& product : products) {
-                response.push_back(json{
-                    {"id", product.get_id()},
-                    {"name", product.get_name()},
-                    {"description", product.get_description()}
-                });
+                w.beginObject()
+                    .field("id", product.get_id())
+                    .field("name", product.get_name())
+                    .field("description", product.get_description())
+                    .endObject();
             }
-            res.set_content(response.dump(), "application/json");
+            w.endArray();
+            res.set_content(std::move(body), responseformat::contentType(format));
+            res.status = 200;
+        } catch (const std::exception& e) {
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            res.status = 500;
+        }
+    });
+
+    // AUTOCOMPLETE product names - GET /api/products/autocomplete?prefix=ab&limit=10 (MUST come before :id pattern)
+    // Case-insensitive prefix match, alphabetical by name (ties by id). Served from the
+    // front-coded PrefixIndex once warm-up has built it, otherwise from the database.
+    server.Get(R"(/api/products/autocomplete)", [](const httplib::Request& req, httplib::Response& res) {
+        try {
+            std::string prefix = req.get_param_value("prefix");
+            if (prefix.empty()) {
+                res.set_content(json{{"error", "prefix parameter required"}}.dump(), "application/json");
+                res.status = 400;
+                return;
+            }
+            
+            size_t limit = kDefaultAutocompleteLimit;
+            if (req.has_param("limit")) {
+                int requested = std::stoi(req.get_param_value("limit"));
+                if (requested <= 0) {
+                    res.set_content(json{{"error", "limit must be positive"}}.dump(), "application/json");
+                    res.status = 400;
+                    return;
+                }
+                limit = std::min(static_cast<size_t>(requested), kMaxAutocompleteLimit);
+            }
+            
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(limit * 48 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
+            PrefixIndex& index = PrefixIndex::products();
+            if (index.isLoaded()) {
+                for (const auto& match : index.complete(prefix, limit)) {
+                    if (auto p = CatalogCache::instance().findProduct(static_cast<int>(match.id))) {
+                        w.beginObject()
+                            .field("id", p->get_id())
+                            .field("name", p->get_name())
+                            .endObject();
+                    }
+                }
+            } else {
+                ProductRepo repo;
+                for (const auto& product : repo.find_by_prefix(prefix, limit)) {
+                    w.beginObject()
+                        .field("id", product.get_id())
+                        .field("name", product.get_name())
+                        .endObject();
+                }
+            }
+            w.endArray();
+            res.set_content(std::move(body), responseformat::contentType(format));
             res.status = 200;
         } catch (const std::exception& e) {
             res.set_content(json{{"error", e.what()}}.dump(), "application/json");
@@ -43,26 +427,42 @@ void registerProductRoutes(httplib::Server& server) {
         }
     });
 
-    // GET all products
-    server.Get("/api/products", [](const httplib::Request&, httplib::Response& res) {
+    // GET all products (or one stock state - see listByStockState, or the
+    // given ids - see listByIds)
+    server.Get("/api/products", [](const httplib::Request& req, httplib::Response& res) {
         try {
+            if (req.has_param("stock_state")) {
+                listByStockState(req, res);
+                return;
+            }
+            if (req.has_param("ids")) {
+                listByIds(req, res);
+                return;
+            }
+            
             ProductRepo repo;
             
             // Query all products from database
-            pqxx::work txn(PostgresConnection::getConnection());
-            pqxx::result r = txn.exec("SELECT id, name, description FROM products");
+            pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                return txn.exec("SELECT id, name, description FROM products");
+            });
             
-            json response = json::array();
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            // Columns are read positionally: 0=id, 1=name, 2=description
+            std::string body;
+            body.reserve(r.size() * 96 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
             for (const auto& row : r) {
-                response.push_back(json{
-                    {"id", row["id"].as<int>()},
-                    {"name", row["name"].as<std::string>()},
-                    {"description", row["description"].as<std::string>()}
-                });
+                w.beginObject();
+                pgjson::integer(w, "id", row[0]);
+                pgjson::text(w, "name", row[1]);
+                pgjson::textOrEmpty(w, "description", row[2]);
+                w.endObject();
             }
-            txn.commit();
+            w.endArray();
             
-            res.set_content(response.dump(), "application/json");
+            res.set_content(std::move(body), responseformat::contentType(format));
             res.status = 200;
         } catch (const std::exception& e) {
             res.set_content(json{{"error", e.what()}}.dump(), "application/json");
@@ -91,8 +491,8 @@ void registerProductRoutes(httplib::Server& server) {
         }
     });
 
-    // CREATE product - POST /api/products
-    server.Post("/api/products", [](const httplib::Request& req, httplib::Response& res) {
+    // CREATE product - POST /api/products (honours Idempotency-Key)
+    server.Post("/api/products", idempotent([](const httplib::Request& req, httplib::Response& res) {
         try {
             json body = json::parse(req.body);
             
@@ -106,6 +506,10 @@ void registerProductRoutes(httplib::Server& server) {
             std::string name = body["name"];
             std::string description = body["description"];
             int initialStock = body["initial_stock"];
+            std::optional<int> reorderPoint;
+            if (body.contains("reorder_point")) {
+                reorderPoint = body["reorder_point"].get<int>();
+            }
             
             // Create product and inventory in database
             ProductRepo productRepo;
@@ -114,11 +518,25 @@ void registerProductRoutes(httplib::Server& server) {
             // Create inventory record for the product
             pqxx::work txn(PostgresConnection::getConnection());
             try {
-                txn.exec_params(
-                    "INSERT INTO inventory (product_id, stock) VALUES ($1, $2)",
-                    productId, initialStock
-                );
+                // Without reorder_point the column default applies
+                pqxx::result inv = reorderPoint
+                    ? txn.exec_params(
+                          "INSERT INTO inventory (product_id, stock, reorder_point) VALUES ($1, $2, $3)" +
+                              std::string(kStockWriteReturning),
+                          productId, initialStock, *reorderPoint)
+                    : txn.exec_params(
+                          "INSERT INTO inventory (product_id, stock) VALUES ($1, $2)" + std::string(kStockWriteReturning),
+                          productId, initialStock);
                 txn.commit();
+                inventoryLookups().forget(productId);
+                int storedReorderPoint = inv[0][1].as<int>();
+                long long version = inv[0][2].as<long long>();
+                CatalogCache::instance().putStock(productId, initialStock, storedReorderPoint, inv[0][0].as<std::string>(),
+                                                  version);
+                StockIndex::products().set(static_cast<uint32_t>(productId), initialStock, version);
+                LowStockIndex::products().set(static_cast<uint32_t>(productId), initialStock, storedReorderPoint, version);
+                recordStockMovement(productId, initialStock, initialStock, inv[0][3].as<long long>(), true);
+                DashboardCounters::instance().stockChanged(productId, std::nullopt, initialStock, version);
             } catch (const std::exception& e) {
                 // Inventory creation failed, but product was created
                 std::cerr << "Warning: Failed to create inventory for product " << productId << ": " << e.what() << "\n";
@@ -141,7 +559,7 @@ void registerProductRoutes(httplib::Server& server) {
             res.set_content(json{{"error", e.what()}}.dump(), "application/json");
             res.status = 500;
         }
-    });
+    }));
 
     // UPDATE product - PUT /api/products/:id
     server.Put(R"(/api/products/(\d+))", [](const httplib::Request& req, httplib::Response& res) {
@@ -189,6 +607,7 @@ void registerProductRoutes(httplib::Server& server) {
             // Delete product from database
             ProductRepo repo;
             repo.remove(productId);
+            inventoryLookups().forget(productId);
             
             json response = json{
                 {"id", productId},
@@ -204,31 +623,292 @@ void registerProductRoutes(httplib::Server& server) {
         }
     });
 
+    // COUNT products per stock state - GET /api/inventory/stock-states?threshold=10
+    server.Get(R"(/api/inventory/stock-states)", [](const httplib::Request& req, httplib::Response& res) {
+        try {
+            int threshold;
+            if (!parseStockThreshold(req, res, threshold)) {
+                return;
+            }
+            
+            json response;
+            StockIndex& index = StockIndex::products();
+            if (index.isLoaded()) {
+                StockIndex::Counts counts = index.counts(threshold);
+                response = json{
+                    {"threshold", threshold},
+                    {"out", counts.out},
+                    {"low", counts.low},
+                    {"in", counts.in}
+                };
+            } else {
+                pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                    return txn.exec_params(
+                        "SELECT count(*) FILTER (WHERE stock = 0), "
+                        "count(*) FILTER (WHERE stock > 0 AND stock <= $1), "
+                        "count(*) FILTER (WHERE stock > $1) "
+                        "FROM inventory",
+                        threshold
+                    );
+                });
+                response = json{
+                    {"threshold", threshold},
+                    {"out", r[0][0].as<long long>()},
+                    {"low", r[0][1].as<long long>()},
+                    {"in", r[0][2].as<long long>()}
+                };
+            }
+            res.set_content(response.dump(), "application/json");
+            res.status = 200;
+        } catch (const std::exception& e) {
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            res.status = 500;
+        }
+    });
+
+    // LOW-STOCK report - GET /api/inventory/low-stock?view=reorder|lowest&limit=50&cursor=...
+    // view=reorder (default): products at or below their reorder point, largest
+    // shortfall first. view=lowest: every product by ascending stock. Pages are
+    // keyset-based: pass back `next_cursor` to continue. Served from LowStockIndex
+    // once warm-up has built it, otherwise from the database.
+    server.Get(R"(/api/inventory/low-stock)", [](const httplib::Request& req, httplib::Response& res) {
+        try {
+            std::string view = req.has_param("view") ? req.get_param_value("view") : "reorder";
+            if (view != "reorder" && view != "lowest") {
+                res.set_content(json{{"error", "view must be reorder or lowest"}}.dump(), "application/json");
+                res.status = 400;
+                return;
+            }
+            
+            size_t limit = kDefaultLowStockPageSize;
+            if (req.has_param("limit")) {
+                int requested = std::stoi(req.get_param_value("limit"));
+                if (requested <= 0) {
+                    res.set_content(json{{"error", "limit must be positive"}}.dump(), "application/json");
+                    res.status = 400;
+                    return;
+                }
+                limit = std::min(static_cast<size_t>(requested), kMaxLowStockPageSize);
+            }
+            
+            // Cursor: "<sort key>:<product id>" of the last item of the previous page
+            std::optional<LowStockIndex::Cursor> after;
+            if (req.has_param("cursor")) {
+                std::string cursor = req.get_param_value("cursor");
+                size_t colon = cursor.find(':');
+                if (colon == std::string::npos) {
+                    res.set_content(json{{"error", "invalid cursor"}}.dump(), "application/json");
+                    res.status = 400;
+                    return;
+                }
+                after = LowStockIndex::Cursor{std::stoll(cursor.substr(0, colon)),
+                                              static_cast<uint32_t>(std::stoul(cursor.substr(colon + 1)))};
+            }
+            
+            bool reorder = view == "reorder";
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(limit * 96 + 128);
+            ResponseWriter w(body, format);
+            w.beginObject().field("view", view);
+            
+            LowStockIndex& index = LowStockIndex::products();
+            std::optional<LowStockIndex::Cursor> next;
+            if (index.isLoaded() && CatalogCache::instance().isLoaded()) {
+                w.field("total", reorder ? index.belowReorderPointCount() : index.size());
+                LowStockIndex::Page page = reorder ? index.belowReorderPoint(limit, after) : index.lowest(limit, after);
+                w.key("items").beginArray();
+                for (const auto& item : page.items) {
+                    auto entry = CatalogCache::instance().findEntry(static_cast<int>(item.id));
+                    w.beginObject()
+                        .field("product_id", item.id)
+                        .field("name", entry ? entry->name : std::string())
+                        .field("stock", item.stock)
+                        .field("reorder_point", item.reorder_point)
+                        .endObject();
+                }
+                w.endArray();
+                next = page.next;
+            } else {
+                // Same ordering and keyset as the index; the first page starts below every key
+                long long afterKey = after ? after->key : std::numeric_limits<long long>::min();
+                long long afterId = after ? static_cast<long long>(after->id) : 0;
+                std::string key = reorder ? "(i.stock - i.reorder_point)" : "i.stock";
+                std::string filter = reorder ? "i.stock <= i.reorder_point" : "true";
+                
+                auto [total, r] = PostgresConnection::read([&](pqxx::work& txn) {
+                    pqxx::result count = txn.exec("SELECT count(*) FROM inventory i WHERE " + filter);
+                    pqxx::result page = txn.exec_params(
+                        "SELECT i.product_id, p.name, i.stock, i.reorder_point, " + key + " "
+                        "FROM inventory i JOIN products p ON p.id = i.product_id "
+                        "WHERE " + filter + " AND (" + key + ", i.product_id) > ($1, $2) "
+                        "ORDER BY " + key + ", i.product_id "
+                        "LIMIT $3",
+                        afterKey, afterId, static_cast<long long>(limit + 1)
+                    );
+                    return std::make_pair(count, page);
+                });
+                
+                w.field("total", total[0][0].as<long long>());
+                w.key("items").beginArray();
+                size_t shown = std::min(r.size(), limit);
+                for (size_t i = 0; i < shown; ++i) {
+                    w.beginObject();
+                    pgjson::integer(w, "product_id", r[i][0]);
+                    pgjson::text(w, "name", r[i][1]);
+                    pgjson::integer(w, "stock", r[i][2]);
+                    pgjson::integer(w, "reorder_point", r[i][3]);
+                    w.endObject();
+                }
+                w.endArray();
+                if (r.size() > limit) {
+                    next = LowStockIndex::Cursor{r[limit - 1][4].as<long long>(), r[limit - 1][0].as<uint32_t>()};
+                }
+            }
+            
+            if (next) {
+                w.field("next_cursor", std::to_string(next->key) + ":" + std::to_string(next->id));
+            } else {
+                w.nullField("next_cursor");
+            }
+            w.endObject();
+            res.set_content(std::move(body), responseformat::contentType(format));
+            res.status = 200;
+        } catch (const std::exception& e) {
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            res.status = 500;
+        }
+    });
+
+    // BATCH inventory - GET /api/inventory?ids=1,2,3
+    // The inventory rows of the given products, in the order requested, each
+    // shaped like GET /api/inventory/:product_id; products without a row are
+    // left out. Stock held by the catalog cache is served from memory and
+    // the rest read with one query.
+    server.Get("/api/inventory", [](const httplib::Request& req, httplib::Response& res) {
+        try {
+            if (!req.has_param("ids")) {
+                res.set_content(json{{"error", "ids is required"}}.dump(), "application/json");
+                res.status = 400;
+                return;
+            }
+            std::vector<int> ids;
+            if (!parseIdList(req, res, ids)) {
+                return;
+            }
+            
+            struct Row {
+                int stock;
+                int reorder_point;
+                std::string updated_at;
+            };
+            std::unordered_map<int, Row> found;
+            std::vector<int> misses;
+            for (int id : ids) {
+                auto cached = CatalogCache::instance().findEntry(id);
+                if (cached && cached->has_stock) {
+                    found.emplace(id, Row{cached->stock, cached->reorder_point, std::move(cached->stock_updated_at)});
+                } else {
+                    misses.push_back(id);
+                }
+            }
+            if (!misses.empty()) {
+                pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                    return txn.exec_params(
+                        "SELECT product_id, stock, reorder_point, updated_at "
+                        "FROM inventory WHERE product_id = ANY($1::int[])",
+                        pgarray::ints(misses)
+                    );
+                });
+                for (const auto& row : r) {
+                    found.emplace(row[0].as<int>(),
+                                  Row{row[1].as<int>(), row[2].as<int>(), row[3].as<std::string>()});
+                }
+            }
+            
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(found.size() * 112 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
+            for (int id : ids) {
+                auto it = found.find(id);
+                if (it == found.end()) {
+                    continue;
+                }
+                const Row& row = it->second;
+                w.beginObject()
+                    .field("product_id", id)
+                    .field("stock", row.stock)
+                    .field("reorder_point", row.reorder_point)
+                    .field("updated_at", row.updated_at)
+                    .field("status", row.stock > 0 ? "in_stock" : "out_of_stock")
+                    .endObject();
+            }
+            w.endArray();
+            
+            res.set_content(std::move(body), responseformat::contentType(format));
+            res.status = 200;
+        } catch (const std::exception& e) {
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            res.status = 500;
+        }
+    });
+
     // TRACK/GET inventory - GET /api/inventory/:product_id
     server.Get(R"(/api/inventory/(\d+))", [](const httplib::Request& req, httplib::Response& res) {
         try {
             int productId = std::stoi(req.matches[1]);
             
+            // Served from the warm catalog cache when it holds this product's stock
+            auto cached = CatalogCache::instance().findEntry(productId);
+            if (cached && cached->has_stock) {
+                json response = json{
+                    {"product_id", productId},
+                    {"stock", cached->stock},
+                    {"reorder_point", cached->reorder_point},
+                    {"updated_at", cached->stock_updated_at},
+                    {"status", cached->stock > 0 ? "in_stock" : "out_of_stock"}
+                };
+                res.set_content(response.dump(), "application/json");
+                res.status = 200;
+                return;
+            }
+            
             // Query inventory from database
-            pqxx::work txn(PostgresConnection::getConnection());
-            pqxx::result r = txn.exec_params(
-                "SELECT product_id, stock, updated_at FROM inventory WHERE product_id = $1",
-                productId
-            );
+            auto query = [productId]() -> std::optional<InventoryRow> {
+                pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                    return txn.exec_prepared("inventory_by_product", productId);
+                });
+                if (r.empty()) {
+                    return std::nullopt;
+                }
+                return InventoryRow{r[0]["product_id"].as<int>(), r[0]["stock"].as<int>(),
+                                    r[0]["reorder_point"].as<int>(), r[0]["updated_at"].as<std::string>()};
+            };
+            std::optional<InventoryRow> row;
+            try {
+                // A client reading its own write must not share a replica read
+                row = ReplicaRouter::pinnedToPrimary() ? query() : inventoryLookups().run(productId, query);
+            } catch (const Overloaded&) {
+                // Possibly the leader's; shed this request as well
+                ConcurrencyLimit::shed();
+                throw;
+            }
             
-            if (r.empty()) {
+            if (!row) {
                 res.set_content(json{{"error", "Inventory not found"}}.dump(), "application/json");
                 res.status = 404;
                 return;
             }
             
             json response = json{
-                {"product_id", r[0]["product_id"].as<int>()},
-                {"stock", r[0]["stock"].as<int>()},
-                {"updated_at", r[0]["updated_at"].as<std::string>()},
-                {"status", r[0]["stock"].as<int>() > 0 ? "in_stock" : "out_of_stock"}
+                {"product_id", row->product_id},
+                {"stock", row->stock},
+                {"reorder_point", row->reorder_point},
+                {"updated_at", row->updated_at},
+                {"status", row->stock > 0 ? "in_stock" : "out_of_stock"}
             };
-            txn.commit();
             
             res.set_content(response.dump(), "application/json");
             res.status = 200;
@@ -238,8 +918,115 @@ void registerProductRoutes(httplib::Server& server) {
         }
     });
 
-    // UPDATE inventory/stock - PUT /api/inventory/:product_id
-    server.Put(R"(/api/inventory/(\d+))", [](const httplib::Request& req, httplib::Response& res) {
+    // STOCK HISTORY - GET /api/inventory/:product_id/history?limit=20
+    // Newest movements first, plus sell-through (units sold per hour, i.e.
+    // stock decreases) over the last 15 minutes, hour and day. Served from
+    // the product's StockHistory ring when it holds enough movements;
+    // otherwise from inventory_events via its (product_id, occurred_at)
+    // index, which may trail memory by one event-log flush.
+    server.Get(R"(/api/inventory/(\d+)/history)", [](const httplib::Request& req, httplib::Response& res) {
+        try {
+            int productId = std::stoi(req.matches[1]);
+            size_t limit = kDefaultHistoryLimit;
+            if (req.has_param("limit")) {
+                int requested = std::stoi(req.get_param_value("limit"));
+                if (requested <= 0) {
+                    res.set_content(json{{"error", "limit must be positive"}}.dump(), "application/json");
+                    res.status = 400;
+                    return;
+                }
+                limit = std::min(static_cast<size_t>(requested), kMaxHistoryLimit);
+            }
+            
+            StockHistory& history = StockHistory::products();
+            auto id = static_cast<uint32_t>(productId);
+            long long now = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            std::optional<std::vector<StockHistory::Movement>> events = history.recent(id, limit);
+            std::optional<std::array<double, StockHistory::kWindowCount>> velocity = history.velocity(id, now);
+            
+            if (!events || !velocity) {
+                if (CatalogCache::instance().isLoaded() && !CatalogCache::instance().findProduct(productId)) {
+                    res.set_content(json{{"error", "Product not found"}}.dump(), "application/json");
+                    res.status = 404;
+                    return;
+                }
+                // Event and velocity rows, each left empty when the index had it;
+                // nullopt when the product does not exist
+                using HistoryRows = std::optional<std::pair<pqxx::result, pqxx::result>>;
+                HistoryRows rows = PostgresConnection::read([&](pqxx::work& txn) -> HistoryRows {
+                    if (!CatalogCache::instance().isLoaded() &&
+                        txn.exec_params("SELECT 1 FROM products WHERE id = $1", productId).empty()) {
+                        return std::nullopt;
+                    }
+                    pqxx::result eventRows;
+                    pqxx::result velocityRows;
+                    if (!events) {
+                        eventRows = txn.exec_params(
+                            "SELECT (extract(epoch FROM occurred_at) * 1000000)::bigint, delta, stock_after "
+                            "FROM inventory_events WHERE product_id = $1 "
+                            "ORDER BY occurred_at DESC, id DESC LIMIT $2",
+                            productId, static_cast<long long>(limit));
+                    }
+                    if (!velocity) {
+                        velocityRows = txn.exec_params(
+                            "SELECT COALESCE(-SUM(delta) FILTER (WHERE occurred_at > now() - interval '15 minutes'), 0), "
+                            "       COALESCE(-SUM(delta) FILTER (WHERE occurred_at > now() - interval '1 hour'), 0), "
+                            "       COALESCE(-SUM(delta), 0) "
+                            "FROM inventory_events "
+                            "WHERE product_id = $1 AND delta < 0 AND occurred_at > now() - interval '24 hours'",
+                            productId);
+                    }
+                    return std::make_pair(eventRows, velocityRows);
+                });
+                if (!rows) {
+                    res.set_content(json{{"error", "Product not found"}}.dump(), "application/json");
+                    res.status = 404;
+                    return;
+                }
+                if (!events) {
+                    events.emplace();
+                    for (const auto& row : rows->first) {
+                        events->push_back(StockHistory::Movement{row[0].as<long long>(), row[1].as<int>(), row[2].as<int>()});
+                    }
+                }
+                if (!velocity) {
+                    const pqxx::result& r = rows->second;
+                    velocity = std::array<double, StockHistory::kWindowCount>{
+                        r[0][0].as<double>() * 4.0, r[0][1].as<double>(), r[0][2].as<double>() / 24.0};
+                }
+            }
+            
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(events->size() * 80 + 160);
+            ResponseWriter w(body, format);
+            w.beginObject().field("product_id", productId);
+            w.key("events").beginArray();
+            for (const auto& m : *events) {
+                w.beginObject()
+                    .field("delta", m.delta)
+                    .field("stock_after", m.stock_after)
+                    .field("occurred_at", isotime::format(m.at_us).view())
+                    .endObject();
+            }
+            w.endArray();
+            w.key("units_sold_per_hour").beginObject()
+                .field("15m", (*velocity)[StockHistory::k15Minutes])
+                .field("1h", (*velocity)[StockHistory::k1Hour])
+                .field("24h", (*velocity)[StockHistory::k24Hours])
+                .endObject();
+            w.endObject();
+            res.set_content(std::move(body), responseformat::contentType(format));
+            res.status = 200;
+        } catch (const std::exception& e) {
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            res.status = 500;
+        }
+    });
+
+    // UPDATE inventory/stock - PUT /api/inventory/:product_id (honours Idempotency-Key)
+    server.Put(R"(/api/inventory/(\d+))", idempotent([](const httplib::Request& req, httplib::Response& res) {
         try {
             int productId = std::stoi(req.matches[1]);
             json body = json::parse(req.body);
@@ -251,11 +1038,17 @@ void registerProductRoutes(httplib::Server& server) {
             }
             
             int newStock = body["stock"];
+            // Optional; the stored reorder point is kept when absent
+            std::optional<int> reorderPoint;
+            if (body.contains("reorder_point")) {
+                reorderPoint = body["reorder_point"].get<int>();
+            }
             
-            // Get old stock first
+            // Get old stock first; the row lock keeps concurrent updates from
+            // recording movements against the same old stock
             pqxx::work txn(PostgresConnection::getConnection());
             pqxx::result old_stock_result = txn.exec_params(
-                "SELECT stock FROM inventory WHERE product_id = $1",
+                "SELECT stock FROM inventory WHERE product_id = $1 FOR UPDATE",
                 productId
             );
             
@@ -264,12 +1057,29 @@ void registerProductRoutes(httplib::Server& server) {
                 oldStock = old_stock_result[0]["stock"].as<int>();
             }
             
-            // Update inventory in database
-            txn.exec_params(
-                "UPDATE inventory SET stock=$1, updated_at=CURRENT_TIMESTAMP WHERE product_id=$2",
-                newStock, productId
+            // Update inventory in database. version is bumped under the row
+            // lock, so it orders the writes to one row the way they
+            // committed; the caches below use it to drop a write that reaches
+            // them after a newer one.
+            pqxx::result updated = txn.exec_params(
+                "UPDATE inventory SET stock=$1, reorder_point=COALESCE($3, reorder_point), updated_at=CURRENT_TIMESTAMP, "
+                "version=version+1 WHERE product_id=$2" + std::string(kStockWriteReturning),
+                newStock, productId, reorderPoint
             );
             txn.commit();
+            inventoryLookups().forget(productId);
+            if (!updated.empty()) {
+                int storedReorderPoint = updated[0][1].as<int>();
+                long long version = updated[0][2].as<long long>();
+                CatalogCache::instance().putStock(productId, newStock, storedReorderPoint, updated[0][0].as<std::string>(),
+                                                  version);
+                StockIndex::products().set(static_cast<uint32_t>(productId), newStock, version);
+                LowStockIndex::products().set(static_cast<uint32_t>(productId), newStock, storedReorderPoint, version);
+                if (newStock != oldStock) {
+                    recordStockMovement(productId, newStock - oldStock, newStock, updated[0][3].as<long long>(), false);
+                }
+                DashboardCounters::instance().stockChanged(productId, oldStock, newStock, version);
+            }
             
             // If stock went from 0 to > 0, trigger notifications (restocked)
             bool was_out_of_stock = oldStock == 0;
@@ -283,6 +1093,9 @@ void registerProductRoutes(httplib::Server& server) {
                 {"notifications_sent", false},
                 {"updated_at", "2026-01-16T12:00:00Z"}
             };
+            if (!updated.empty()) {
+                response["reorder_point"] = updated[0][1].as<int>();
+            }
             
             if (was_out_of_stock && is_now_in_stock) {
                 // Trigger notifications via notification service
@@ -300,5 +1113,5 @@ void registerProductRoutes(httplib::Server& server) {
             res.set_content(json{{"error", e.what()}}.dump(), "application/json");
             res.status = 500;
         }
-    });
+    }));
 }
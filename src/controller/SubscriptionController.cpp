@@ -2,31 +2,43 @@
 #include <nlohmann/json.hpp>
 #include <string>
 #include "../repository/postgres/PostgresConnection.h"
+#include "../repository/postgres/PgJson.h"
+#include "../repository/cache/DashboardCounters.h"
 #include <pqxx/pqxx>
 
 using json = nlohmann::json;
 
+// Columns are read positionally: id, user_id, product_id, active, created_at
+static void writeSubscriptionRow(ResponseWriter& w, const pqxx::row& row) {
+    w.beginObject();
+    pgjson::integer(w, "id", row[0]);
+    pgjson::integer(w, "user_id", row[1]);
+    pgjson::integer(w, "product_id", row[2]);
+    pgjson::boolean(w, "active", row[3]);
+    pgjson::text(w, "created_at", row[4]);
+    w.endObject();
+}
+
 void registerSubscriptionRoutes(httplib::Server& server) {
 
     // GET all subscriptions - GET /api/subscriptions
-    server.Get("/api/subscriptions", [](const httplib::Request&, httplib::Response& res) {
+    server.Get("/api/subscriptions", [](const httplib::Request& req, httplib::Response& res) {
         try {
-            pqxx::work txn(PostgresConnection::getConnection());
-            pqxx::result r = txn.exec("SELECT id, user_id, product_id, active, created_at FROM subscriptions");
-            
-            json response = json::array();
+            pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                return txn.exec("SELECT id, user_id, product_id, active, created_at FROM subscriptions");
+            });
+            
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(r.size() * 96 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
             for (const auto& row : r) {
-                response.push_back(json{
-                    {"id", row["id"].as<int>()},
-                    {"user_id", row["user_id"].as<int>()},
-                    {"product_id", row["product_id"].as<int>()},
-                    {"active", row["active"].as<bool>()},
-                    {"created_at", row["created_at"].as<std::string>()}
-                });
+                writeSubscriptionRow(w, row);
             }
-            txn.commit();
+            w.endArray();
             
-            res.set_content(response.dump(), "application/json");
+            res.set_content(std::move(body), responseformat::contentType(format));
             res.status = 200;
         } catch (const std::exception& e) {
             res.set_content(json{{"error", e.what()}}.dump(), "application/json");
@@ -39,25 +51,24 @@ void registerSubscriptionRoutes(httplib::Server& server) {
         try {
             int userId = std::stoi(req.matches[1]);
             
-            pqxx::work txn(PostgresConnection::getConnection());
-            pqxx::result r = txn.exec_params(
-                "SELECT id, user_id, product_id, active, created_at FROM subscriptions WHERE user_id = $1",
-                userId
-            );
-            
-            json response = json::array();
+            pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                return txn.exec_params(
+                    "SELECT id, user_id, product_id, active, created_at FROM subscriptions WHERE user_id = $1",
+                    userId
+                );
+            });
+            
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            std::string body;
+            body.reserve(r.size() * 96 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
             for (const auto& row : r) {
-                response.push_back(json{
-                    {"id", row["id"].as<int>()},
-                    {"user_id", row["user_id"].as<int>()},
-                    {"product_id", row["product_id"].as<int>()},
-                    {"active", row["active"].as<bool>()},
-                    {"created_at", row["created_at"].as<std::string>()}
-                });
+                writeSubscriptionRow(w, row);
             }
-            txn.commit();
+            w.endArray();
             
-            res.set_content(response.dump(), "application/json");
+            res.set_content(std::move(body), responseformat::contentType(format));
             res.status = 200;
         } catch (const std::exception& e) {
             res.set_content(json{{"error", e.what()}}.dump(), "application/json");
@@ -88,6 +99,7 @@ void registerSubscriptionRoutes(httplib::Server& server) {
             int subscriptionId = r[0]["id"].as<int>();
             std::string createdAt = r[0]["created_at"].as<std::string>();
             txn.commit();
+            DashboardCounters::instance().subscriptionAdded(productId, true);
             
             json response = json{
                 {"id", subscriptionId},
@@ -113,11 +125,12 @@ void registerSubscriptionRoutes(httplib::Server& server) {
         try {
             int subscriptionId = std::stoi(req.matches[1]);
             
-            pqxx::work txn(PostgresConnection::getConnection());
-            pqxx::result r = txn.exec_params(
-                "SELECT id, user_id, product_id, active, created_at FROM subscriptions WHERE id = $1",
-                subscriptionId
-            );
+            pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                return txn.exec_params(
+                    "SELECT id, user_id, product_id, active, created_at FROM subscriptions WHERE id = $1",
+                    subscriptionId
+                );
+            });
             
             if (r.empty()) {
                 res.set_content(json{{"error", "Subscription not found"}}.dump(), "application/json");
@@ -132,7 +145,6 @@ void registerSubscriptionRoutes(httplib::Server& server) {
                 {"active", r[0]["active"].as<bool>()},
                 {"created_at", r[0]["created_at"].as<std::string>()}
             };
-            txn.commit();
             
             res.set_content(response.dump(), "application/json");
             res.status = 200;
@@ -148,10 +160,10 @@ void registerSubscriptionRoutes(httplib::Server& server) {
             int subscriptionId = std::stoi(req.matches[1]);
             json body = json::parse(req.body);
             
-            // Check if subscription exists
+            // Check if subscription exists (locked, so its old state stays current)
             pqxx::work txn(PostgresConnection::getConnection());
             pqxx::result check = txn.exec_params(
-                "SELECT id FROM subscriptions WHERE id = $1",
+                "SELECT active FROM subscriptions WHERE id = $1 FOR UPDATE",
                 subscriptionId
             );
             
@@ -160,6 +172,7 @@ void registerSubscriptionRoutes(httplib::Server& server) {
                 res.status = 404;
                 return;
             }
+            bool wasActive = check[0][0].as<bool>(false);
             
             bool active = body.value("active", true);
             
@@ -169,6 +182,7 @@ void registerSubscriptionRoutes(httplib::Server& server) {
                 active, subscriptionId
             );
             txn.commit();
+            DashboardCounters::instance().subscriptionActiveChanged(r[0]["product_id"].as<int>(), wasActive, active);
             
             json response = json{
                 {"id", r[0]["id"].as<int>()},
@@ -209,10 +223,13 @@ void registerSubscriptionRoutes(httplib::Server& server) {
             
             // Delete subscription
             pqxx::result r = txn.exec_params(
-                "DELETE FROM subscriptions WHERE id = $1 RETURNING id",
+                "DELETE FROM subscriptions WHERE id = $1 RETURNING product_id, active",
                 subscriptionId
             );
             txn.commit();
+            if (!r.empty()) {
+                DashboardCounters::instance().subscriptionRemoved(r[0][0].as<int>(), r[0][1].as<bool>(false));
+            }
             
             json response = json{
                 {"id", subscriptionId},
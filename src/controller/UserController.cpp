@@ -2,6 +2,10 @@
 #include <nlohmann/json.hpp>
 #include <string>
 #include "../repository/postgres/PostgresConnection.h"
+#include "../repository/postgres/PgJson.h"
+#include "../repository/cache/PreferenceCache.h"
+#include "../repository/cache/DashboardCounters.h"
+#include "../repository/cache/SubscriberCounts.h"
 #include <pqxx/pqxx>
 
 using json = nlohmann::json;
@@ -9,23 +13,29 @@ using json = nlohmann::json;
 void registerUserRoutes(httplib::Server& server) {
 
     // GET all users - GET /api/users
-    server.Get("/api/users", [](const httplib::Request&, httplib::Response& res) {
+    server.Get("/api/users", [](const httplib::Request& req, httplib::Response& res) {
         try {
-            pqxx::work txn(PostgresConnection::getConnection());
-            pqxx::result r = txn.exec("SELECT id, name, email, role FROM users");
+            pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                return txn.exec("SELECT id, name, email, role FROM users");
+            });
             
-            json response = json::array();
+            ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+            // Columns are read positionally: 0=id, 1=name, 2=email, 3=role
+            std::string body;
+            body.reserve(r.size() * 96 + 2);
+            ResponseWriter w(body, format);
+            w.beginArray();
             for (const auto& row : r) {
-                response.push_back(json{
-                    {"id", row["id"].as<int>()},
-                    {"name", row["name"].as<std::string>()},
-                    {"email", row["email"].as<std::string>()},
-                    {"role", row["role"].as<std::string>()}
-                });
+                w.beginObject();
+                pgjson::integer(w, "id", row[0]);
+                pgjson::text(w, "name", row[1]);
+                pgjson::text(w, "email", row[2]);
+                pgjson::text(w, "role", row[3]);
+                w.endObject();
             }
-            txn.commit();
+            w.endArray();
             
-            res.set_content(response.dump(), "application/json");
+            res.set_content(std::move(body), responseformat::contentType(format));
             res.status = 200;
         } catch (const std::exception& e) {
             res.set_content(json{{"error", e.what()}}.dump(), "application/json");
@@ -38,11 +48,12 @@ void registerUserRoutes(httplib::Server& server) {
         try {
             int userId = std::stoi(req.matches[1]);
             
-            pqxx::work txn(PostgresConnection::getConnection());
-            pqxx::result r = txn.exec_params(
-                "SELECT id, name, email, role FROM users WHERE id = $1",
-                userId
-            );
+            pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                return txn.exec_params(
+                    "SELECT id, name, email, role FROM users WHERE id = $1",
+                    userId
+                );
+            });
             
             if (r.empty()) {
                 res.set_content(json{{"error", "User not found"}}.dump(), "application/json");
@@ -56,7 +67,6 @@ void registerUserRoutes(httplib::Server& server) {
                 {"email", r[0]["email"].as<std::string>()},
                 {"role", r[0]["role"].as<std::string>()}
             };
-            txn.commit();
             
             res.set_content(response.dump(), "application/json");
             res.status = 200;
@@ -97,6 +107,7 @@ void registerUserRoutes(httplib::Server& server) {
             );
             int userId = r[0][0].as<int>();
             txn.commit();
+            DashboardCounters::instance().userCreated();
             
             json response = json{
                 {"id", userId},
@@ -221,12 +232,39 @@ void registerUserRoutes(httplib::Server& server) {
                 return;
             }
             
+            // Delete their restock subscriptions here rather than by cascade
+            // and take the unsent ones off the per-product pending counts.
+            // Counting the rows the DELETE returns, not a separate SELECT,
+            // means a subscription re-armed or sent concurrently is counted
+            // as it was when it went.
+            pqxx::result counts = txn.exec_params(
+                "WITH gone AS ("
+                "  DELETE FROM product_notifications WHERE user_id = $1 "
+                "  RETURNING product_id, is_sent), "
+                "x AS (SELECT product_id, count(*) AS n FROM gone WHERE is_sent = FALSE GROUP BY product_id) "
+                "UPDATE product_subscriber_counts c "
+                "SET pending = GREATEST(c.pending - x.n, 0), version = c.version + 1 "
+                "FROM x "
+                "WHERE c.product_id = x.product_id "
+                "RETURNING c.product_id, c.pending, c.version",
+                userId
+            );
+            
             // Delete user
             pqxx::result r = txn.exec_params(
                 "DELETE FROM users WHERE id = $1 RETURNING id",
                 userId
             );
             txn.commit();
+            for (const auto& row : counts) {
+                SubscriberCounts::instance().apply(
+                    SubscriberCounts::Row{row[0].as<int>(), row[1].as<int>(), row[2].as<long long>()});
+            }
+            // notification_preferences rows cascade with the user
+            PreferenceCache::instance().remove(userId);
+            if (!r.empty()) {
+                DashboardCounters::instance().userRemoved();
+            }
             
             json response = json{
                 {"id", userId},
@@ -1,70 +1,117 @@
 #pragma once
-#include <string>
+#include <cstddef>
+#include <cstdint>
 #include <ctime>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace domain {
 
-enum class NotificationType {
+// Stored as their text names in the database and API; held as one byte
+// in memory. The name tables below are indexed by enum value.
+enum class NotificationType : uint8_t {
     OUT_OF_STOCK,
     RESTOCKED
 };
 
-enum class NotificationStatus {
+enum class NotificationStatus : uint8_t {
     PENDING,
     SENT,
     FAILED,
     RETRIED
 };
 
-struct Notification {
-    int id;
-    int product_id;
-    int user_id;
-    NotificationType type;
-    std::string type_str;
-    bool is_sent;
-    std::string created_at;
-    std::string updated_at;
-    std::string sent_at;
-    
-    Notification() : id(0), product_id(0), user_id(0), 
-                     type(NotificationType::RESTOCKED), 
-                     is_sent(false) {}
-    
-    Notification(int id, int product_id, int user_id, 
-                 const std::string& type_str, bool is_sent,
-                 const std::string& created_at, const std::string& updated_at)
-        : id(id), product_id(product_id), user_id(user_id), 
-          type_str(type_str), is_sent(is_sent),
-          created_at(created_at), updated_at(updated_at) {
-        
-        if (type_str == "out_of_stock") {
-            type = NotificationType::OUT_OF_STOCK;
-        } else {
-            type = NotificationType::RESTOCKED;
+inline constexpr std::string_view kNotificationTypeNames[] = {"out_of_stock", "restocked"};
+inline constexpr std::string_view kNotificationStatusNames[] = {"pending", "sent", "failed", "retried"};
+
+constexpr std::string_view toString(NotificationType type) {
+    return kNotificationTypeNames[static_cast<size_t>(type)];
+}
+
+constexpr std::string_view toString(NotificationStatus status) {
+    return kNotificationStatusNames[static_cast<size_t>(status)];
+}
+
+// False (and `out` untouched) for an unknown name
+constexpr bool parse(std::string_view name, NotificationType& out) {
+    for (size_t i = 0; i < std::size(kNotificationTypeNames); ++i) {
+        if (kNotificationTypeNames[i] == name) {
+            out = static_cast<NotificationType>(i);
+            return true;
         }
     }
+    return false;
+}
+
+constexpr bool parse(std::string_view name, NotificationStatus& out) {
+    for (size_t i = 0; i < std::size(kNotificationStatusNames); ++i) {
+        if (kNotificationStatusNames[i] == name) {
+            out = static_cast<NotificationStatus>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Timestamps are microseconds since the Unix epoch (UTC); 0 when unset
+// (sent_at_us of a notification not yet sent). Widest members first, so
+// the structs carry no padding beyond their tails.
+struct Notification {
+    int64_t created_at_us = 0;
+    int64_t updated_at_us = 0;
+    int64_t sent_at_us = 0;
+    int id = 0;
+    int product_id = 0;
+    int user_id = 0;
+    NotificationType type = NotificationType::RESTOCKED;
+    bool is_sent = false;
 };
 
+// Allocator-aware, so the text of logs in a NotificationLogList lives in
+// the list's memory resource along with the records themselves
 struct NotificationLog {
-    int id;
-    int notification_id;
-    int user_id;
-    int product_id;
-    std::string notification_type;
-    std::string message;
-    std::string status;
-    int retry_count;
-    int max_retries;
-    std::string error_message;
-    std::string sent_at;
-    std::string created_at;
-    std::string updated_at;
-    
-    NotificationLog() : id(0), notification_id(0), user_id(0), product_id(0),
-                        retry_count(0), max_retries(3) {}
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    int64_t sent_at_us = 0;
+    int64_t created_at_us = 0;
+    int64_t updated_at_us = 0;
+    std::pmr::string message;
+    std::pmr::string error_message;
+    int id = 0;
+    int notification_id = 0;
+    int user_id = 0;
+    int product_id = 0;
+    int retry_count = 0;
+    int max_retries = 3;
+    NotificationType notification_type = NotificationType::RESTOCKED;
+    NotificationStatus status = NotificationStatus::PENDING;
+
+    NotificationLog() = default;
+    explicit NotificationLog(const allocator_type& alloc) : message(alloc), error_message(alloc) {}
+    NotificationLog(const NotificationLog&) = default;
+    NotificationLog(NotificationLog&&) = default;
+    // Copy/move into `alloc` (assignment keeps the target's resource)
+    NotificationLog(const NotificationLog& other, const allocator_type& alloc) : NotificationLog(alloc) {
+        *this = other;
+    }
+    NotificationLog(NotificationLog&& other, const allocator_type& alloc) : NotificationLog(alloc) {
+        *this = std::move(other);
+    }
+    NotificationLog& operator=(const NotificationLog&) = default;
+    NotificationLog& operator=(NotificationLog&&) = default;
 };
 
+// Result lists of the notification repository and service. They allocate
+// from the memory resource they were built with, which on a request path
+// is the request's arena (server/RequestArena.h): do not keep one beyond
+// the request that produced it.
+using NotificationList = std::pmr::vector<Notification>;
+using NotificationLogList = std::pmr::vector<NotificationLog>;
+
 struct NotificationPreference {
     int id;
     int user_id;
@@ -21,5 +21,5 @@ public:
     string get_name()const{return this->name;}
     string get_email()const{return this->email;}
     string get_role()const {return this->role;}
-    ~user();
+    ~user() = default;
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// On-disk layout of the inventory snapshot (GET /api/export/inventory.snapshot).
+//
+//   [Header, 160 bytes]
+//   ids          int32[row_count]      product id, ascending
+//   stock        int32[row_count]      -1 when the product has no inventory row
+//   updated_at   int64[row_count]      inventory.updated_at, microseconds since
+//                                      the Unix epoch (0 when no inventory row)
+//   name_offsets uint32[row_count + 1] byte offsets into the name heap
+//   name_heap    bytes                 UTF-8 names, not NUL-terminated
+//
+// Every section starts on an 8-byte boundary; offsets in the header are
+// from the start of the file. All integers are little-endian. Each section
+// carries a CRC-32 (IEEE), and the header its own CRC over the bytes
+// before `header_crc`, so a reader can validate without trusting anything.
+namespace InventorySnapshot {
+
+constexpr char kMagic[8] = {'I', 'N', 'V', 'S', 'N', 'A', 'P', '1'};
+constexpr uint32_t kVersion = 1;
+
+enum Section { kIds = 0, kStock, kUpdatedAt, kNameOffsets, kNameHeap, kSectionCount };
+
+struct SectionRef {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t crc;
+    uint32_t reserved;
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t row_count;
+    uint64_t created_at_us;
+    SectionRef sections[kSectionCount];
+    uint32_t reserved;
+    uint32_t header_crc;
+};
+
+static_assert(sizeof(Header) == 160, "snapshot header layout changed");
+
+inline constexpr uint64_t align8(uint64_t n) {
+    return (n + 7) & ~uint64_t{7};
+}
+
+namespace detail {
+
+inline constexpr std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint32_t, 256> kCrcTable = makeCrcTable();
+
+} // namespace detail
+
+// CRC-32 (IEEE 802.3); pass the previous result as `crc` to continue a run.
+inline uint32_t crc32(const void* data, size_t size, uint32_t crc = 0) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = detail::kCrcTable[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+inline uint32_t headerCrc(const Header& header) {
+    return crc32(&header, offsetof(Header, header_crc));
+}
+
+} // namespace InventorySnapshot
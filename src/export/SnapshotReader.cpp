@@ -0,0 +1,115 @@
+#include "SnapshotReader.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SnapshotReader::SnapshotReader(const std::string& path, bool verify_checksums) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat " + path);
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length < sizeof(InventorySnapshot::Header)) {
+        ::close(fd);
+        throw std::runtime_error(path + " is too small to be a snapshot");
+    }
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("cannot mmap " + path);
+    }
+    base = static_cast<const unsigned char*>(mapped);
+    // Columns are scanned front to back
+    ::madvise(mapped, length, MADV_SEQUENTIAL);
+
+    try {
+        validate(verify_checksums);
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+SnapshotReader::~SnapshotReader() {
+    unmap();
+}
+
+void SnapshotReader::unmap() {
+    if (base) {
+        ::munmap(const_cast<unsigned char*>(base), length);
+        base = nullptr;
+    }
+}
+
+void SnapshotReader::validate(bool verify_checksums) {
+    using namespace InventorySnapshot;
+
+    header = reinterpret_cast<const Header*>(base);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("not an inventory snapshot (bad magic)");
+    }
+    if (header->version != kVersion || header->header_size != sizeof(Header)) {
+        throw std::runtime_error("unsupported snapshot version");
+    }
+    if (headerCrc(*header) != header->header_crc) {
+        throw std::runtime_error("snapshot header checksum mismatch");
+    }
+
+    // Every row takes more than 16 bytes of columns; checking that first
+    // also keeps the size arithmetic below from overflowing
+    const uint64_t rows = header->row_count;
+    if (rows > length / 16) {
+        throw std::runtime_error("snapshot row count exceeds the file size");
+    }
+    const uint64_t expected[kSectionCount] = {
+        rows * sizeof(int32_t), rows * sizeof(int32_t), rows * sizeof(int64_t), (rows + 1) * sizeof(uint32_t), 0,
+    };
+    for (int s = 0; s < kSectionCount; ++s) {
+        const SectionRef& ref = header->sections[s];
+        if (ref.offset % 8 != 0 || ref.offset > length || ref.size > length - ref.offset) {
+            throw std::runtime_error("snapshot section out of bounds");
+        }
+        if (s != kNameHeap && ref.size != expected[s]) {
+            throw std::runtime_error("snapshot section has the wrong size");
+        }
+        if (verify_checksums && crc32(base + ref.offset, ref.size) != ref.crc) {
+            throw std::runtime_error("snapshot section checksum mismatch");
+        }
+    }
+
+    ids_column = reinterpret_cast<const int32_t*>(base + header->sections[kIds].offset);
+    stock_column = reinterpret_cast<const int32_t*>(base + header->sections[kStock].offset);
+    updated_at_column = reinterpret_cast<const int64_t*>(base + header->sections[kUpdatedAt].offset);
+    name_offsets = reinterpret_cast<const uint32_t*>(base + header->sections[kNameOffsets].offset);
+    name_heap = reinterpret_cast<const char*>(base + header->sections[kNameHeap].offset);
+
+    // Offsets must be monotonic and inside the heap, or name() could read
+    // out of bounds
+    const uint64_t heap_size = header->sections[kNameHeap].size;
+    if (name_offsets[0] != 0) {
+        throw std::runtime_error("snapshot name offsets are corrupt");
+    }
+    for (uint64_t i = 0; i < rows; ++i) {
+        if (name_offsets[i + 1] < name_offsets[i] || name_offsets[i + 1] > heap_size) {
+            throw std::runtime_error("snapshot name offsets are corrupt");
+        }
+    }
+}
+
+long long SnapshotReader::find(int32_t id) const {
+    const int32_t* end = ids_column + size();
+    const int32_t* it = std::lower_bound(ids_column, end, id);
+    if (it == end || *it != id) {
+        return -1;
+    }
+    return static_cast<long long>(it - ids_column);
+}
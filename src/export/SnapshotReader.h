@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "InventorySnapshot.h"
+
+// Read-only view of an inventory snapshot file, memory-mapped so columns
+// can be scanned in place without parsing:
+//
+//   SnapshotReader snap("inventory.snapshot");
+//   for (size_t i = 0; i < snap.size(); ++i)
+//       if (snap.stock()[i] == 0) std::cout << snap.name(i) << "\n";
+//
+// The constructor validates the header, section bounds and (unless told
+// not to) every section checksum, throwing std::runtime_error on failure.
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const std::string& path, bool verify_checksums = true);
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    size_t size() const { return static_cast<size_t>(header->row_count); }
+    uint64_t createdAtMicros() const { return header->created_at_us; }
+
+    const int32_t* ids() const { return ids_column; }
+    const int32_t* stock() const { return stock_column; }
+    const int64_t* updatedAtMicros() const { return updated_at_column; }
+
+    std::string_view name(size_t row) const {
+        return std::string_view(name_heap + name_offsets[row], name_offsets[row + 1] - name_offsets[row]);
+    }
+
+    // Row index of product `id`, or -1 (binary search; ids are ascending)
+    long long find(int32_t id) const;
+
+private:
+    const unsigned char* base = nullptr;
+    size_t length = 0;
+    const InventorySnapshot::Header* header = nullptr;
+    const int32_t* ids_column = nullptr;
+    const int32_t* stock_column = nullptr;
+    const int64_t* updated_at_column = nullptr;
+    const uint32_t* name_offsets = nullptr;
+    const char* name_heap = nullptr;
+
+    void validate(bool verify_checksums);
+    void unmap();
+};
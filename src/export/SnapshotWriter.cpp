@@ -0,0 +1,98 @@
+#include "SnapshotWriter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <stdlib.h>
+#include <unistd.h>
+
+void SnapshotWriter::reserve(size_t rows) {
+    ids.reserve(rows);
+    stock.reserve(rows);
+    updated_at.reserve(rows);
+    name_offsets.reserve(rows + 1);
+}
+
+void SnapshotWriter::add(int32_t id, std::string_view name, int32_t stock_level, int64_t updated_at_us) {
+    if (!ids.empty() && id <= ids.back()) {
+        throw std::runtime_error("snapshot rows must be added in ascending id order");
+    }
+    ids.push_back(id);
+    stock.push_back(stock_level);
+    updated_at.push_back(updated_at_us);
+    name_heap.append(name);
+    if (name_heap.size() > UINT32_MAX) {
+        throw std::runtime_error("snapshot name heap exceeds 4 GiB");
+    }
+    name_offsets.push_back(static_cast<uint32_t>(name_heap.size()));
+}
+
+void SnapshotWriter::writeTo(const std::string& path) const {
+    using namespace InventorySnapshot;
+
+    struct Column {
+        const void* data;
+        uint64_t size;
+    };
+    const Column columns[kSectionCount] = {
+        {ids.data(), ids.size() * sizeof(int32_t)},
+        {stock.data(), stock.size() * sizeof(int32_t)},
+        {updated_at.data(), updated_at.size() * sizeof(int64_t)},
+        {name_offsets.data(), name_offsets.size() * sizeof(uint32_t)},
+        {name_heap.data(), name_heap.size()},
+    };
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.header_size = sizeof(Header);
+    header.row_count = ids.size();
+    header.created_at_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    uint64_t offset = sizeof(Header);
+    for (int s = 0; s < kSectionCount; ++s) {
+        header.sections[s].offset = offset;
+        header.sections[s].size = columns[s].size;
+        header.sections[s].crc = crc32(columns[s].data, columns[s].size);
+        offset = align8(offset + columns[s].size);
+    }
+    header.header_crc = headerCrc(header);
+
+    // mkstemp creates a new file (O_EXCL, mode 0600) under a random name,
+    // so nothing planted in the directory can be written through
+    std::string tmp = path + ".XXXXXX";
+    int fd = ::mkstemp(&tmp[0]);
+    if (fd < 0) {
+        throw std::runtime_error("cannot create a temporary file for " + path);
+    }
+    FILE* f = ::fdopen(fd, "wb");
+    if (!f) {
+        ::close(fd);
+        std::remove(tmp.c_str());
+        throw std::runtime_error("cannot create " + tmp);
+    }
+    static const char kPadding[8] = {};
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    uint64_t written = sizeof(Header);
+    for (int s = 0; s < kSectionCount && ok; ++s) {
+        if (columns[s].size > 0) {
+            ok = std::fwrite(columns[s].data, 1, columns[s].size, f) == columns[s].size;
+        }
+        written += columns[s].size;
+        uint64_t pad = align8(written) - written;
+        if (ok && pad > 0) {
+            ok = std::fwrite(kPadding, 1, pad, f) == pad;
+            written += pad;
+        }
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("failed writing " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("cannot rename " + tmp + " to " + path);
+    }
+}
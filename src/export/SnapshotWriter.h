@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "InventorySnapshot.h"
+
+// Accumulates snapshot rows column by column and writes the file in one
+// pass. Rows must be added in ascending id order. The file is written to a
+// new, uniquely named file next to `path` and renamed into place, so a
+// reader (or a response that is still sending the previous snapshot) never
+// sees a partial file.
+class SnapshotWriter {
+public:
+    void reserve(size_t rows);
+    void add(int32_t id, std::string_view name, int32_t stock, int64_t updated_at_us);
+    size_t rows() const { return ids.size(); }
+
+    // Throws std::runtime_error on I/O failure.
+    void writeTo(const std::string& path) const;
+
+private:
+    std::vector<int32_t> ids;
+    std::vector<int32_t> stock;
+    std::vector<int64_t> updated_at;
+    std::vector<uint32_t> name_offsets{0};
+    std::string name_heap;
+};
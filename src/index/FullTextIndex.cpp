@@ -0,0 +1,531 @@
+#include "FullTextIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <queue>
+
+namespace {
+
+void putVarint(std::string& out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+uint32_t getVarint(const char*& p) {
+    uint32_t v = 0;
+    int shift = 0;
+    for (;;) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        v |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return v;
+        }
+        shift += 7;
+    }
+}
+
+bool isTokenByte(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+// Sequential reader over one posting list
+struct Cursor {
+    const char* p;
+    const char* end;
+    uint32_t doc = 0;
+    uint32_t tf = 0;
+    float idf;
+    bool done = false;
+
+    Cursor(const std::string& bytes, float idf) : p(bytes.data()), end(bytes.data() + bytes.size()), idf(idf) {
+        next(true);
+    }
+
+    void next(bool first = false) {
+        if (p == end) {
+            done = true;
+            return;
+        }
+        uint32_t gap = getVarint(p);
+        doc = first ? gap : doc + gap;
+        tf = getVarint(p);
+    }
+};
+
+struct Ranked {
+    float score;
+    uint32_t id;
+};
+
+// Heap order: the worst hit (lowest score, then highest id) on top
+struct WorseOnTop {
+    bool operator()(const Ranked& a, const Ranked& b) const {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        return a.id < b.id;
+    }
+};
+
+} // namespace
+
+FullTextIndex& FullTextIndex::products() {
+    static FullTextIndex index;
+    return index;
+}
+
+FullTextIndex::~FullTextIndex() {
+    {
+        std::lock_guard<std::mutex> lock(compactor_mutex);
+        stopping = true;
+    }
+    compactor_wake.notify_one();
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+}
+
+std::vector<std::string> FullTextIndex::tokenize(std::string_view text) {
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && !isTokenByte(static_cast<unsigned char>(text[i]))) {
+            ++i;
+        }
+        size_t start = i;
+        while (i < text.size() && isTokenByte(static_cast<unsigned char>(text[i]))) {
+            ++i;
+        }
+        if (i > start) {
+            std::string token(text.substr(start, i - start));
+            for (char& c : token) {
+                if (c >= 'A' && c <= 'Z') {
+                    c = static_cast<char>(c - 'A' + 'a');
+                }
+            }
+            tokens.push_back(std::move(token));
+        }
+    }
+    return tokens;
+}
+
+void FullTextIndex::clearLocked() {
+    term_ids.clear();
+    postings.clear();
+    docs.clear();
+    current_doc.clear();
+    live_docs = 0;
+    live_length = 0;
+}
+
+void FullTextIndex::addLocked(uint32_t id, std::string_view name, std::string_view description) {
+    removeLocked(id);
+
+    std::unordered_map<std::string, uint32_t> tf;
+    uint32_t length = 0;
+    for (auto& token : tokenize(name)) {
+        tf[std::move(token)] += kNameWeight;
+        length += kNameWeight;
+    }
+    for (auto& token : tokenize(description)) {
+        tf[std::move(token)] += 1;
+        length += 1;
+    }
+
+    const uint32_t docno = static_cast<uint32_t>(docs.size());
+    docs.push_back(DocInfo{id, length, true});
+    current_doc[id] = docno;
+    ++live_docs;
+    live_length += length;
+
+    for (auto& entry : tf) {
+        auto found = term_ids.find(entry.first);
+        uint32_t term;
+        if (found == term_ids.end()) {
+            term = static_cast<uint32_t>(postings.size());
+            term_ids.emplace(entry.first, term);
+            postings.emplace_back();
+            if (compacting) {
+                journal.new_terms.emplace_back(entry.first, term);
+            }
+        } else {
+            term = found->second;
+        }
+        if (compacting) {
+            journal.terms.push_back(term);
+        }
+        Postings& list = postings[term];
+        // The first entry stores the docno itself, later ones the gap
+        putVarint(list.bytes, list.df == 0 ? docno : docno - list.last_doc);
+        putVarint(list.bytes, entry.second);
+        list.last_doc = docno;
+        ++list.df;
+    }
+}
+
+void FullTextIndex::removeLocked(uint32_t id) {
+    if (compacting) {
+        journal.products.push_back(id);
+    }
+    auto it = current_doc.find(id);
+    if (it == current_doc.end()) {
+        return;
+    }
+    if (compacting) {
+        journal.removed_docs.push_back(it->second);
+    }
+    DocInfo& doc = docs[it->second];
+    doc.live = false;
+    --live_docs;
+    live_length -= doc.length;
+    current_doc.erase(it);
+}
+
+// Called with the exclusive lock held
+void FullTextIndex::maybeCompact() {
+    size_t dead = docs.size() - live_docs;
+    if (compacting || dead < std::max<size_t>(1024, live_docs / 4)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(compactor_mutex);
+    if (compaction_requested || stopping) {
+        return;
+    }
+    compaction_requested = true;
+    if (!compactor.joinable()) {
+        compactor = std::thread([this] {
+            std::unique_lock<std::mutex> wait_lock(compactor_mutex);
+            while (!stopping) {
+                compactor_wake.wait(wait_lock, [&] { return stopping || compaction_requested; });
+                if (stopping) {
+                    return;
+                }
+                compaction_requested = false;
+                wait_lock.unlock();
+                compact();
+                wait_lock.lock();
+            }
+        });
+    }
+    compactor_wake.notify_one();
+}
+
+void FullTextIndex::compact() {
+    uint64_t started_generation;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        compacting = true;
+        journal = Journal();
+        started_generation = generation;
+    }
+    std::unordered_map<std::string, uint32_t> old_term_ids;
+    std::vector<Postings> old_postings;
+    std::vector<DocInfo> old_docs;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        old_term_ids = term_ids;
+        old_postings = postings;
+        old_docs = docs;
+    }
+
+    // Renumber the live documents densely, keeping their relative order,
+    // then re-encode every posting list through the mapping.
+    std::vector<uint32_t> remap(old_docs.size(), UINT32_MAX);
+    std::vector<DocInfo> kept;
+    for (uint32_t d = 0; d < old_docs.size(); ++d) {
+        if (old_docs[d].live) {
+            remap[d] = static_cast<uint32_t>(kept.size());
+            kept.push_back(old_docs[d]);
+        }
+    }
+
+    std::unordered_map<std::string, uint32_t> new_term_ids;
+    std::vector<Postings> new_postings;
+    std::vector<const std::string*> old_terms(old_postings.size());
+    std::vector<uint32_t> term_remap(old_postings.size(), UINT32_MAX);
+    for (auto& entry : old_term_ids) {
+        old_terms[entry.second] = &entry.first;
+        Postings& old = old_postings[entry.second];
+        Postings fresh;
+        for (Cursor c(old.bytes, 0.0f); !c.done; c.next()) {
+            uint32_t docno = remap[c.doc];
+            if (docno == UINT32_MAX) {
+                continue;
+            }
+            putVarint(fresh.bytes, fresh.df == 0 ? docno : docno - fresh.last_doc);
+            putVarint(fresh.bytes, c.tf);
+            fresh.last_doc = docno;
+            ++fresh.df;
+        }
+        if (fresh.df == 0) {
+            continue;
+        }
+        fresh.bytes.shrink_to_fit();
+        term_remap[entry.second] = static_cast<uint32_t>(new_postings.size());
+        new_term_ids.emplace(entry.first, static_cast<uint32_t>(new_postings.size()));
+        new_postings.push_back(std::move(fresh));
+    }
+    std::unordered_map<uint32_t, uint32_t> new_current_doc;
+    new_current_doc.reserve(kept.size());
+    for (uint32_t d = 0; d < kept.size(); ++d) {
+        new_current_doc[kept[d].product_id] = d;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    compacting = false;
+    Journal written = std::move(journal);
+    journal = Journal();
+    if (generation != started_generation) {
+        return;
+    }
+
+    // Documents added since the copy follow the kept ones, in order
+    const uint32_t copied_docs = static_cast<uint32_t>(old_docs.size());
+    const uint32_t kept_docs = static_cast<uint32_t>(kept.size());
+    auto translate = [&](uint32_t d) { return d < copied_docs ? remap[d] : kept_docs + (d - copied_docs); };
+    for (uint32_t d = copied_docs; d < docs.size(); ++d) {
+        kept.push_back(docs[d]);
+    }
+    for (uint32_t d : written.removed_docs) {
+        if (d < copied_docs && remap[d] != UINT32_MAX) {
+            kept[remap[d]].live = false;
+        }
+    }
+
+    // Their postings sit past the copied end of each list they were added to
+    std::unordered_map<uint32_t, const std::string*> added_terms;
+    for (const auto& entry : written.new_terms) {
+        added_terms.emplace(entry.second, &entry.first);
+    }
+    std::sort(written.terms.begin(), written.terms.end());
+    written.terms.erase(std::unique(written.terms.begin(), written.terms.end()), written.terms.end());
+    for (uint32_t t : written.terms) {
+        const bool copied = t < old_postings.size();
+        const Postings& current = postings[t];
+        const size_t from = copied ? old_postings[t].bytes.size() : 0;
+        if (current.bytes.size() == from) {
+            continue;
+        }
+        uint32_t target = copied ? term_remap[t] : UINT32_MAX;
+        if (target == UINT32_MAX) {
+            const std::string& term = copied ? *old_terms[t] : *added_terms.at(t);
+            target = static_cast<uint32_t>(new_postings.size());
+            new_term_ids.emplace(term, target);
+            new_postings.emplace_back();
+        }
+        Postings& list = new_postings[target];
+        const char* p = current.bytes.data() + from;
+        const char* end = current.bytes.data() + current.bytes.size();
+        uint32_t doc = copied ? old_postings[t].last_doc : 0;
+        bool first = !copied || old_postings[t].df == 0;
+        while (p < end) {
+            uint32_t gap = getVarint(p);
+            doc = first ? gap : doc + gap;
+            first = false;
+            uint32_t tf = getVarint(p);
+            uint32_t docno = translate(doc);
+            putVarint(list.bytes, list.df == 0 ? docno : docno - list.last_doc);
+            putVarint(list.bytes, tf);
+            list.last_doc = docno;
+            ++list.df;
+        }
+    }
+
+    for (uint32_t id : written.products) {
+        auto it = current_doc.find(id);
+        if (it == current_doc.end()) {
+            new_current_doc.erase(id);
+        } else {
+            new_current_doc[id] = translate(it->second);
+        }
+    }
+
+    docs = std::move(kept);
+    term_ids = std::move(new_term_ids);
+    postings = std::move(new_postings);
+    current_doc = std::move(new_current_doc);
+    // Writes during a long compaction may already call for the next one
+    maybeCompact();
+}
+
+void FullTextIndex::rebuild(const std::function<std::vector<Document>()>& source) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::vector<Document> input = source();
+    clearLocked();
+    // A compaction still running is discarded at its swap; stop journaling
+    // for it
+    ++generation;
+    compacting = false;
+    journal = Journal();
+    docs.reserve(input.size());
+    current_doc.reserve(input.size());
+    for (const auto& doc : input) {
+        addLocked(doc.id, doc.name, doc.description);
+    }
+    for (auto& list : postings) {
+        list.bytes.shrink_to_fit();
+    }
+    loaded.store(true, std::memory_order_release);
+}
+
+void FullTextIndex::add(uint32_t id, std::string_view name, std::string_view description) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    addLocked(id, name, description);
+    maybeCompact();
+}
+
+void FullTextIndex::update(uint32_t id, std::string_view name, std::string_view description) {
+    add(id, name, description);
+}
+
+void FullTextIndex::remove(uint32_t id) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    removeLocked(id);
+    maybeCompact();
+}
+
+std::vector<FullTextIndex::Hit> FullTextIndex::search(std::string_view query, size_t limit) const {
+    std::vector<std::string> terms = tokenize(query);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    if (terms.empty() || limit == 0) {
+        return {};
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (live_docs == 0) {
+        return {};
+    }
+
+    const float n = static_cast<float>(docs.size());
+    const float avgdl = static_cast<float>(live_length) / static_cast<float>(live_docs);
+    std::vector<Cursor> cursors;
+    cursors.reserve(terms.size());
+    for (const auto& term : terms) {
+        auto it = term_ids.find(term);
+        if (it == term_ids.end()) {
+            continue;
+        }
+        const Postings& list = postings[it->second];
+        float df = static_cast<float>(list.df);
+        float idf = std::log(1.0f + (n - df + 0.5f) / (df + 0.5f));
+        cursors.emplace_back(list.bytes, idf);
+    }
+
+    // MaxScore: a list can add at most idf * (k1 + 1) to any document. With
+    // the lists sorted by that bound, once the heap is full the lists whose
+    // bounds sum to less than the current k-th score are "non-essential":
+    // a document found only in them cannot enter the top k, so candidates
+    // are drawn from the essential lists alone and the others are merely
+    // advanced to each candidate.
+    std::sort(cursors.begin(), cursors.end(), [](const Cursor& a, const Cursor& b) { return a.idf < b.idf; });
+    std::vector<float> bound_prefix(cursors.size());
+    float running = 0.0f;
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        running += cursors[i].idf * (kK1 + 1.0f);
+        bound_prefix[i] = running;
+    }
+
+    std::priority_queue<Ranked, std::vector<Ranked>, WorseOnTop> heap;
+    size_t first_essential = 0;
+    for (;;) {
+        uint32_t doc = UINT32_MAX;
+        for (size_t i = first_essential; i < cursors.size(); ++i) {
+            if (!cursors[i].done && cursors[i].doc < doc) {
+                doc = cursors[i].doc;
+            }
+        }
+        if (doc == UINT32_MAX) {
+            break;
+        }
+
+        const DocInfo& info = docs[doc];
+        const float norm = kK1 * (1.0f - kB + kB * static_cast<float>(info.length) / avgdl);
+        float score = 0.0f;
+        for (size_t i = first_essential; i < cursors.size(); ++i) {
+            Cursor& c = cursors[i];
+            if (!c.done && c.doc == doc) {
+                float tf = static_cast<float>(c.tf);
+                score += c.idf * tf * (kK1 + 1.0f) / (tf + norm);
+                c.next();
+            }
+        }
+        if (!info.live) {
+            continue;
+        }
+        const bool full = heap.size() >= limit;
+        for (size_t i = first_essential; i-- > 0;) {
+            if (full && score + bound_prefix[i] < heap.top().score) {
+                break;
+            }
+            Cursor& c = cursors[i];
+            while (!c.done && c.doc < doc) {
+                c.next();
+            }
+            if (!c.done && c.doc == doc) {
+                float tf = static_cast<float>(c.tf);
+                score += c.idf * tf * (kK1 + 1.0f) / (tf + norm);
+            }
+        }
+
+        Ranked candidate{score, info.product_id};
+        if (!full) {
+            heap.push(candidate);
+        } else if (WorseOnTop()(candidate, heap.top())) {
+            heap.pop();
+            heap.push(candidate);
+        } else {
+            continue;
+        }
+        if (heap.size() >= limit) {
+            const float threshold = heap.top().score;
+            while (first_essential < cursors.size() && bound_prefix[first_essential] < threshold) {
+                ++first_essential;
+            }
+        }
+    }
+    lock.unlock();
+
+    std::vector<Hit> hits(heap.size());
+    for (size_t i = hits.size(); i-- > 0;) {
+        hits[i] = Hit{heap.top().id, heap.top().score};
+        heap.pop();
+    }
+    return hits;
+}
+
+size_t FullTextIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return live_docs;
+}
+
+size_t FullTextIndex::termCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return postings.size();
+}
+
+size_t FullTextIndex::postingBytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    size_t bytes = 0;
+    for (const auto& list : postings) {
+        bytes += list.bytes.capacity();
+    }
+    return bytes;
+}
+
+size_t FullTextIndex::memoryBytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    size_t bytes = postings.capacity() * sizeof(Postings) + docs.capacity() * sizeof(DocInfo);
+    for (const auto& list : postings) {
+        bytes += list.bytes.capacity();
+    }
+    for (const auto& entry : term_ids) {
+        // key + value + node/bucket overhead
+        bytes += sizeof(entry) + entry.first.capacity() + 2 * sizeof(void*);
+    }
+    bytes += current_doc.size() * (sizeof(std::pair<uint32_t, uint32_t>) + 2 * sizeof(void*));
+    return bytes;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// In-process full-text index with BM25 ranking over name + description.
+//
+// Text is split into lowercased runs of ASCII letters/digits (bytes >= 0x80
+// are kept inside tokens so UTF-8 words survive). Every indexed version of a
+// product gets an internal, ever-increasing document number, so posting
+// lists only ever grow at the end: each one is a byte string of
+// varint(docno gap), varint(term frequency) pairs. Updating a product
+// appends a new document and marks the old one dead; once dead documents
+// pass a quarter of the index the postings are re-encoded without them.
+// That compaction runs on a background thread: it copies the postings
+// under a shared lock, re-encodes the copy with no lock held, and swaps
+// the result in under the exclusive lock, appending the documents added
+// meanwhile (they sit at the end of every list) and re-applying removals.
+//
+// Name terms count kNameWeight times, a cheap stand-in for BM25F field
+// weights. Document frequencies include dead documents until the next
+// compaction, which only nudges idf.
+//
+// Queries are OR-of-terms, scored document-at-a-time across the decoded
+// posting cursors with a bounded min-heap keeping the best `limit`; once
+// the heap is full, lists whose maximum possible contribution cannot lift
+// a document into it stop producing candidates (MaxScore). All public
+// methods are thread-safe; reads take a shared lock.
+class FullTextIndex {
+public:
+    struct Document {
+        uint32_t id;
+        std::string name;
+        std::string description;
+    };
+
+    struct Hit {
+        uint32_t id;
+        float score;
+    };
+
+    FullTextIndex() = default;
+    ~FullTextIndex();
+
+    // Index over product name/description, maintained by ProductRepo.
+    static FullTextIndex& products();
+
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+    // Replaces the index with the documents from `source`, which runs under
+    // the exclusive lock (see TrigramIndex::rebuild).
+    void rebuild(const std::function<std::vector<Document>()>& source);
+
+    void add(uint32_t id, std::string_view name, std::string_view description);
+    void update(uint32_t id, std::string_view name, std::string_view description);
+    void remove(uint32_t id);
+
+    // Best `limit` products by BM25 score, highest first; ties go to the
+    // lower id.
+    std::vector<Hit> search(std::string_view query, size_t limit) const;
+
+    size_t size() const;
+    size_t termCount() const;
+    size_t postingBytes() const;
+    // Postings + lexicon + document table, approximate
+    size_t memoryBytes() const;
+
+    static std::vector<std::string> tokenize(std::string_view text);
+
+    static constexpr float kK1 = 1.2f;
+    static constexpr float kB = 0.75f;
+    static constexpr uint32_t kNameWeight = 2;
+
+private:
+    struct Postings {
+        std::string bytes;
+        uint32_t last_doc = 0;
+        uint32_t df = 0;
+    };
+
+    struct DocInfo {
+        uint32_t product_id;
+        uint32_t length;
+        bool live;
+    };
+
+    // What a compaction must re-apply at the swap: written while it ran
+    struct Journal {
+        std::vector<uint32_t> products;     // added or removed
+        std::vector<uint32_t> removed_docs;
+        std::vector<uint32_t> terms;        // lists appended to
+        std::vector<std::pair<std::string, uint32_t>> new_terms;
+    };
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, uint32_t> term_ids;
+    std::vector<Postings> postings;
+    std::vector<DocInfo> docs;
+    std::unordered_map<uint32_t, uint32_t> current_doc;
+    size_t live_docs = 0;
+    uint64_t live_length = 0;
+    std::atomic<bool> loaded{false};
+
+    // `generation` changes on rebuild so a compaction of the old index is
+    // discarded
+    bool compacting = false;
+    Journal journal;
+    uint64_t generation = 0;
+
+    std::mutex compactor_mutex;
+    std::condition_variable compactor_wake;
+    bool compaction_requested = false;
+    bool stopping = false;
+    std::thread compactor;
+
+    void clearLocked();
+    void addLocked(uint32_t id, std::string_view name, std::string_view description);
+    void removeLocked(uint32_t id);
+    void maybeCompact();
+    void compact();
+};
@@ -0,0 +1,104 @@
+#include "LowStockIndex.h"
+#include <iterator>
+#include <mutex>
+
+namespace {
+
+long long shortfallKey(int stock, int reorder_point) {
+    return static_cast<long long>(stock) - reorder_point;
+}
+
+} // namespace
+
+LowStockIndex& LowStockIndex::products() {
+    static LowStockIndex index;
+    return index;
+}
+
+void LowStockIndex::removeLocked(uint32_t id) {
+    auto it = items.find(id);
+    if (it == items.end()) {
+        return;
+    }
+    const Item& old = it->second;
+    by_stock.erase(Key(old.stock, id));
+    if (old.stock <= old.reorder_point) {
+        by_shortfall.erase(Key(shortfallKey(old.stock, old.reorder_point), id));
+    }
+    items.erase(it);
+}
+
+void LowStockIndex::setLocked(const Item& item) {
+    if (removed.count(item.id)) {
+        return;
+    }
+    auto it = items.find(item.id);
+    if (it != items.end() && it->second.version >= item.version) {
+        return;
+    }
+    removeLocked(item.id);
+    items.emplace(item.id, item);
+    by_stock.emplace(item.stock, item.id);
+    if (item.stock <= item.reorder_point) {
+        by_shortfall.emplace(shortfallKey(item.stock, item.reorder_point), item.id);
+    }
+}
+
+void LowStockIndex::rebuild(const std::function<std::vector<Item>()>& source) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::vector<Item> rows = source();
+    items.clear();
+    by_stock.clear();
+    by_shortfall.clear();
+    // `removed` is kept, so deleted products stay out of the rebuilt index
+    items.reserve(rows.size());
+    for (const auto& row : rows) {
+        setLocked(row);
+    }
+    loaded.store(true, std::memory_order_release);
+}
+
+void LowStockIndex::set(uint32_t id, int stock, int reorder_point, long long version) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    setLocked(Item{id, stock, reorder_point, version});
+}
+
+void LowStockIndex::remove(uint32_t id) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    removeLocked(id);
+    removed.insert(id);
+}
+
+LowStockIndex::Page LowStockIndex::pageOf(const std::set<Key>& ordered, size_t limit,
+                                          const std::optional<Cursor>& after) const {
+    Page page;
+    auto it = after ? ordered.upper_bound(Key(after->key, after->id)) : ordered.begin();
+    for (; it != ordered.end() && page.items.size() < limit; ++it) {
+        page.items.push_back(items.at(it->second));
+    }
+    if (it != ordered.end() && !page.items.empty()) {
+        auto last = std::prev(it);
+        page.next = Cursor{last->first, last->second};
+    }
+    return page;
+}
+
+LowStockIndex::Page LowStockIndex::lowest(size_t limit, const std::optional<Cursor>& after) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return pageOf(by_stock, limit, after);
+}
+
+LowStockIndex::Page LowStockIndex::belowReorderPoint(size_t limit, const std::optional<Cursor>& after) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return pageOf(by_shortfall, limit, after);
+}
+
+size_t LowStockIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return items.size();
+}
+
+size_t LowStockIndex::belowReorderPointCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return by_shortfall.size();
+}
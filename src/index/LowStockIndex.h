@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Ordered in-memory views over inventory for the low-stock report.
+//
+// `by_stock` orders every tracked product by (stock, product_id) for the
+// "lowest N" list; `by_shortfall` holds only the products at or below their
+// reorder point, ordered by (stock - reorder_point, product_id) so the most
+// urgent come first. Both are balanced trees, so a stock or reorder-point
+// change costs O(log n) and a page costs O(log n + page size) via keyset
+// cursors.
+//
+// Kept current by the inventory write paths alongside CatalogCache::putStock.
+// All public methods are thread-safe; reads take a shared lock.
+class LowStockIndex {
+public:
+    struct Item {
+        uint32_t id;
+        int stock;
+        int reorder_point;
+        long long version = 0;  // inventory.version
+    };
+
+    // Position after which the next page starts: the sort key of the last
+    // item returned (stock, or stock - reorder_point) and its id.
+    struct Cursor {
+        long long key;
+        uint32_t id;
+    };
+
+    struct Page {
+        std::vector<Item> items;
+        std::optional<Cursor> next;
+    };
+
+    static LowStockIndex& products();
+
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+    // Replaces the index with the rows from `source`, which runs under the
+    // exclusive lock (see TrigramIndex::rebuild).
+    void rebuild(const std::function<std::vector<Item>()>& source);
+
+    // Dropped when the product already holds a newer `version`, so updates
+    // whose hooks run out of order leave the latest values.
+    void set(uint32_t id, int stock, int reorder_point, long long version);
+    // Leaves a tombstone (product ids are never reused), so a set() whose
+    // hook runs after the delete's is dropped whatever its version
+    void remove(uint32_t id);
+
+    // Lowest stock first
+    Page lowest(size_t limit, const std::optional<Cursor>& after) const;
+    // stock <= reorder_point, largest shortfall first
+    Page belowReorderPoint(size_t limit, const std::optional<Cursor>& after) const;
+
+    size_t size() const;
+    size_t belowReorderPointCount() const;
+
+private:
+    using Key = std::pair<long long, uint32_t>;
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<uint32_t, Item> items;
+    std::unordered_set<uint32_t> removed;
+    std::set<Key> by_stock;
+    std::set<Key> by_shortfall;
+    std::atomic<bool> loaded{false};
+
+    void setLocked(const Item& item);
+    void removeLocked(uint32_t id);
+    Page pageOf(const std::set<Key>& ordered, size_t limit, const std::optional<Cursor>& after) const;
+};
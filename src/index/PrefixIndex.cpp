@@ -0,0 +1,351 @@
+#include "PrefixIndex.h"
+#include "TrigramIndex.h"
+#include <algorithm>
+#include <mutex>
+#include <tuple>
+
+namespace {
+
+void putVarint(std::string& out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+uint32_t getVarint(const char*& p) {
+    uint32_t v = 0;
+    int shift = 0;
+    for (;;) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        v |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return v;
+        }
+        shift += 7;
+    }
+}
+
+bool startsWith(std::string_view s, std::string_view prefix) {
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+PrefixIndex& PrefixIndex::products() {
+    static PrefixIndex index;
+    return index;
+}
+
+PrefixIndex::~PrefixIndex() {
+    {
+        std::lock_guard<std::mutex> lock(compactor_mutex);
+        stopping = true;
+    }
+    compactor_wake.notify_one();
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+}
+
+std::shared_ptr<const PrefixIndex::Base> PrefixIndex::encode(const std::vector<Key>& keys) {
+    auto out = std::make_shared<Base>();
+    std::string& blob = out->blob;
+    out->ids.reserve(keys.size());
+    out->block_offsets.reserve(keys.size() / kBlockSize + 1);
+    out->position.reserve(keys.size());
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const std::string& key = keys[i].first;
+        if (i % kBlockSize == 0) {
+            out->block_offsets.push_back(static_cast<uint32_t>(blob.size()));
+            putVarint(blob, static_cast<uint32_t>(key.size()));
+            blob.append(key);
+        } else {
+            const std::string& prev = keys[i - 1].first;
+            size_t lcp = 0;
+            size_t max_lcp = std::min(prev.size(), key.size());
+            while (lcp < max_lcp && prev[lcp] == key[lcp]) {
+                ++lcp;
+            }
+            putVarint(blob, static_cast<uint32_t>(lcp));
+            putVarint(blob, static_cast<uint32_t>(key.size() - lcp));
+            blob.append(key, lcp, std::string::npos);
+        }
+        out->ids.push_back(keys[i].second);
+        out->position[keys[i].second] = i;
+    }
+    blob.shrink_to_fit();
+    return out;
+}
+
+namespace {
+
+// Sequential decoder over the front-coded base.
+struct BaseCursor {
+    const std::string& blob;
+    const std::vector<uint32_t>& block_offsets;
+    const std::vector<uint32_t>& ids;
+    size_t index = 0;
+    const char* p = nullptr;
+    std::string key;
+
+    BaseCursor(const std::string& blob, const std::vector<uint32_t>& block_offsets,
+               const std::vector<uint32_t>& ids, size_t block_size, size_t block)
+        : blob(blob), block_offsets(block_offsets), ids(ids) {
+        if (block < block_offsets.size()) {
+            index = block * block_size;
+            p = blob.data() + block_offsets[block];
+            load(true);
+        } else {
+            index = ids.size();
+        }
+    }
+
+    bool valid() const { return index < ids.size(); }
+    uint32_t id() const { return ids[index]; }
+
+    void load(bool head) {
+        if (head) {
+            uint32_t len = getVarint(p);
+            key.assign(p, len);
+            p += len;
+        } else {
+            uint32_t lcp = getVarint(p);
+            uint32_t suffix = getVarint(p);
+            key.resize(lcp);
+            key.append(p, suffix);
+            p += suffix;
+        }
+    }
+
+    void next(size_t block_size) {
+        ++index;
+        if (valid()) {
+            load(index % block_size == 0);
+        }
+    }
+};
+
+} // namespace
+
+std::vector<PrefixIndex::Key> PrefixIndex::decodeLive(const Base& base, const std::set<Key>& delta,
+                                                       const std::unordered_set<uint32_t>& tombstones) {
+    std::vector<Key> keys;
+    keys.reserve(base.ids.size() - tombstones.size() + delta.size());
+    BaseCursor cursor(base.blob, base.block_offsets, base.ids, kBlockSize, 0);
+    auto dit = delta.begin();
+    while (cursor.valid() || dit != delta.end()) {
+        if (cursor.valid() && tombstones.count(cursor.id())) {
+            cursor.next(kBlockSize);
+            continue;
+        }
+        if (cursor.valid() && (dit == delta.end() ||
+                               std::tie(cursor.key, base.ids[cursor.index]) < std::tie(dit->first, dit->second))) {
+            keys.emplace_back(cursor.key, cursor.id());
+            cursor.next(kBlockSize);
+        } else {
+            keys.push_back(*dit);
+            ++dit;
+        }
+    }
+    return keys;
+}
+
+size_t PrefixIndex::liveCount() const {
+    return base->ids.size() - tombstones.size() + delta.size();
+}
+
+// Called with the exclusive lock held
+void PrefixIndex::maybeCompact() {
+    size_t pending = delta.size() + tombstones.size();
+    if (compacting || pending < std::max(kMinCompactionDelta, base->ids.size() / 16)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(compactor_mutex);
+    if (compaction_requested || stopping) {
+        return;
+    }
+    compaction_requested = true;
+    if (!compactor.joinable()) {
+        compactor = std::thread([this] {
+            std::unique_lock<std::mutex> wait_lock(compactor_mutex);
+            while (!stopping) {
+                compactor_wake.wait(wait_lock, [&] { return stopping || compaction_requested; });
+                if (stopping) {
+                    return;
+                }
+                compaction_requested = false;
+                wait_lock.unlock();
+                compact();
+                wait_lock.lock();
+            }
+        });
+    }
+    compactor_wake.notify_one();
+}
+
+void PrefixIndex::compact() {
+    std::shared_ptr<const Base> old_base;
+    uint64_t started_generation;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        compacting = true;
+        written_while_compacting.clear();
+        old_base = base;
+        started_generation = generation;
+    }
+    std::set<Key> delta_copy;
+    std::unordered_set<uint32_t> tombstones_copy;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        delta_copy = delta;
+        tombstones_copy = tombstones;
+    }
+
+    std::shared_ptr<const Base> fresh = encode(decodeLive(*old_base, delta_copy, tombstones_copy));
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    compacting = false;
+    if (generation != started_generation) {
+        written_while_compacting.clear();
+        return;
+    }
+    // Ids written since the copy may be in the new base with a stale key;
+    // their current state is whatever the live delta says
+    std::set<Key> next_delta;
+    std::unordered_map<uint32_t, std::string> next_delta_keys;
+    std::unordered_set<uint32_t> next_tombstones;
+    for (uint32_t id : written_while_compacting) {
+        if (fresh->position.count(id)) {
+            next_tombstones.insert(id);
+        }
+        auto it = delta_keys.find(id);
+        if (it != delta_keys.end()) {
+            next_delta.emplace(it->second, id);
+            next_delta_keys[id] = it->second;
+        }
+    }
+    written_while_compacting.clear();
+    base = std::move(fresh);
+    delta = std::move(next_delta);
+    delta_keys = std::move(next_delta_keys);
+    tombstones = std::move(next_tombstones);
+    // Writes during a long compaction may already call for the next one
+    maybeCompact();
+}
+
+void PrefixIndex::rebuild(const std::function<std::vector<Document>()>& source) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::vector<Document> docs = source();
+    std::vector<Key> keys;
+    keys.reserve(docs.size());
+    for (auto& doc : docs) {
+        keys.emplace_back(TrigramIndex::normalize(doc.second), doc.first);
+    }
+    std::sort(keys.begin(), keys.end());
+    base = encode(keys);
+    delta.clear();
+    delta_keys.clear();
+    tombstones.clear();
+    ++generation;
+    loaded.store(true, std::memory_order_release);
+}
+
+void PrefixIndex::removeLocked(uint32_t id) {
+    if (compacting) {
+        written_while_compacting.push_back(id);
+    }
+    if (base->position.count(id)) {
+        tombstones.insert(id);
+    }
+    auto it = delta_keys.find(id);
+    if (it != delta_keys.end()) {
+        delta.erase(Key(it->second, id));
+        delta_keys.erase(it);
+    }
+}
+
+void PrefixIndex::add(uint32_t id, std::string_view name) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    removeLocked(id);
+    std::string key = TrigramIndex::normalize(name);
+    delta.emplace(key, id);
+    delta_keys[id] = std::move(key);
+    maybeCompact();
+}
+
+void PrefixIndex::update(uint32_t id, std::string_view name) {
+    add(id, name);
+}
+
+void PrefixIndex::remove(uint32_t id) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    removeLocked(id);
+    maybeCompact();
+}
+
+std::vector<PrefixIndex::Match> PrefixIndex::complete(std::string_view prefix_in, size_t limit) const {
+    std::string prefix = TrigramIndex::normalize(prefix_in);
+    std::vector<Match> out;
+    if (limit == 0) {
+        return out;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const Base& b = *base;
+
+    // First block whose head is >= prefix; matches can start in the block
+    // before it, so decoding begins one block earlier.
+    size_t lo = 0;
+    size_t hi = b.block_offsets.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const char* p = b.blob.data() + b.block_offsets[mid];
+        uint32_t len = getVarint(p);
+        if (std::string_view(p, len) < prefix) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    size_t start_block = lo == 0 ? 0 : lo - 1;
+
+    BaseCursor cursor(b.blob, b.block_offsets, b.ids, kBlockSize, start_block);
+    while (cursor.valid() && cursor.key < prefix) {
+        cursor.next(kBlockSize);
+    }
+    auto dit = delta.lower_bound(Key(prefix, 0));
+
+    while (out.size() < limit) {
+        bool base_ok = cursor.valid() && startsWith(cursor.key, prefix);
+        if (base_ok && tombstones.count(cursor.id())) {
+            cursor.next(kBlockSize);
+            continue;
+        }
+        bool delta_ok = dit != delta.end() && startsWith(dit->first, prefix);
+        if (!base_ok && !delta_ok) {
+            break;
+        }
+        if (base_ok && (!delta_ok ||
+                        std::tie(cursor.key, b.ids[cursor.index]) < std::tie(dit->first, dit->second))) {
+            out.push_back(Match{cursor.id(), cursor.key});
+            cursor.next(kBlockSize);
+        } else {
+            out.push_back(Match{dit->second, dit->first});
+            ++dit;
+        }
+    }
+    return out;
+}
+
+size_t PrefixIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return liveCount();
+}
+
+size_t PrefixIndex::encodedBytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return base->blob.size() + base->block_offsets.size() * sizeof(uint32_t) + base->ids.size() * sizeof(uint32_t);
+}
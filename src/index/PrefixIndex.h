@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Prefix (autocomplete) index over lowercased names.
+//
+// The bulk of the keys live in a sorted, front-coded string array: keys are
+// grouped in blocks of kBlockSize, the first key of each block is stored in
+// full and every following key as (shared-prefix length, suffix). A lookup
+// binary-searches the block heads and then decodes forward, so a query
+// touches one or two blocks regardless of catalog size.
+//
+// Writes do not re-encode the array. New/renamed keys go to a small sorted
+// delta set and replaced/deleted ids are tombstoned; queries merge the two
+// sources. Once the delta grows past a fraction of the base the whole index
+// is re-encoded (compaction) on a background thread: it copies the delta
+// under a shared lock, encodes the new base with no lock held, and swaps
+// it in under the exclusive lock, carrying over the writes that arrived
+// meanwhile. Reads and writes keep going while it runs.
+//
+// Results come back in (key, id) order: alphabetical by lowercased name,
+// ties by id. All public methods are thread-safe.
+class PrefixIndex {
+public:
+    using Document = std::pair<uint32_t, std::string>;
+
+    struct Match {
+        uint32_t id;
+        std::string key;
+    };
+
+    PrefixIndex() = default;
+    ~PrefixIndex();
+
+    // Index over product names, maintained by ProductRepo.
+    static PrefixIndex& products();
+
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+    // Replaces the index with the documents from `source`, which runs under
+    // the exclusive lock (see TrigramIndex::rebuild).
+    void rebuild(const std::function<std::vector<Document>()>& source);
+
+    void add(uint32_t id, std::string_view name);
+    void update(uint32_t id, std::string_view name);
+    void remove(uint32_t id);
+
+    std::vector<Match> complete(std::string_view prefix, size_t limit) const;
+
+    size_t size() const;
+    size_t encodedBytes() const;
+
+private:
+    static constexpr size_t kBlockSize = 16;
+    static constexpr size_t kMinCompactionDelta = 4096;
+
+    using Key = std::pair<std::string, uint32_t>;
+
+    // Front-coded base; never modified once built, so compaction can read
+    // it without the lock while writers carry on
+    struct Base {
+        std::string blob;
+        std::vector<uint32_t> block_offsets;
+        std::vector<uint32_t> ids;
+        std::unordered_map<uint32_t, size_t> position;
+    };
+
+    std::shared_ptr<const Base> base = std::make_shared<Base>();
+
+    // Pending writes
+    std::set<Key> delta;
+    std::unordered_map<uint32_t, std::string> delta_keys;
+    std::unordered_set<uint32_t> tombstones;
+
+    // While a compaction runs, the ids written since it copied the delta;
+    // `generation` changes on rebuild so a compaction of the old index is
+    // discarded
+    bool compacting = false;
+    std::vector<uint32_t> written_while_compacting;
+    uint64_t generation = 0;
+
+    mutable std::shared_mutex mutex;
+    std::atomic<bool> loaded{false};
+
+    std::mutex compactor_mutex;
+    std::condition_variable compactor_wake;
+    bool compaction_requested = false;
+    bool stopping = false;
+    std::thread compactor;
+
+    static std::shared_ptr<const Base> encode(const std::vector<Key>& keys);
+    static std::vector<Key> decodeLive(const Base& base, const std::set<Key>& delta,
+                                       const std::unordered_set<uint32_t>& tombstones);
+    void removeLocked(uint32_t id);
+    void maybeCompact();
+    void compact();
+    size_t liveCount() const;
+};
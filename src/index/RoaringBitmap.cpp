@@ -0,0 +1,336 @@
+#include "RoaringBitmap.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+enum Op { kOr, kAnd, kAndNot };
+
+// SWAR popcount: without -mpopcnt, __builtin_popcountll is a libgcc call
+// on x86-64, which dominated the word loops below
+uint32_t popcount(uint64_t w) {
+    w = w - ((w >> 1) & 0x5555555555555555ULL);
+    w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+    w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<uint32_t>((w * 0x0101010101010101ULL) >> 56);
+}
+
+} // namespace
+
+void RoaringBitmap::Chunk::toBitset() {
+    bits.assign(kWords, 0);
+    for (uint16_t v : array) {
+        bits[v >> 6] |= uint64_t{1} << (v & 63);
+    }
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void RoaringBitmap::Chunk::toArray() {
+    array.clear();
+    array.reserve(count);
+    for (size_t w = 0; w < kWords; ++w) {
+        uint64_t word = bits[w];
+        while (word) {
+            int bit = __builtin_ctzll(word);
+            array.push_back(static_cast<uint16_t>(w * 64 + static_cast<size_t>(bit)));
+            word &= word - 1;
+        }
+    }
+    bits.clear();
+    bits.shrink_to_fit();
+}
+
+void RoaringBitmap::Chunk::normalize() {
+    if (isBitset() && count <= kArrayMax) {
+        toArray();
+    } else if (!isBitset() && count > kArrayMax) {
+        toBitset();
+    }
+}
+
+RoaringBitmap::Chunk* RoaringBitmap::find(uint16_t key) {
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), key,
+                               [](const Chunk& c, uint16_t k) { return c.key < k; });
+    return it != chunks.end() && it->key == key ? &*it : nullptr;
+}
+
+const RoaringBitmap::Chunk* RoaringBitmap::find(uint16_t key) const {
+    return const_cast<RoaringBitmap*>(this)->find(key);
+}
+
+void RoaringBitmap::add(uint32_t id) {
+    uint16_t key = static_cast<uint16_t>(id >> 16);
+    uint16_t low = static_cast<uint16_t>(id & 0xffff);
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), key,
+                               [](const Chunk& c, uint16_t k) { return c.key < k; });
+    if (it == chunks.end() || it->key != key) {
+        Chunk chunk;
+        chunk.key = key;
+        it = chunks.insert(it, std::move(chunk));
+    }
+    Chunk& c = *it;
+    if (c.isBitset()) {
+        uint64_t mask = uint64_t{1} << (low & 63);
+        if (!(c.bits[low >> 6] & mask)) {
+            c.bits[low >> 6] |= mask;
+            ++c.count;
+        }
+        return;
+    }
+    auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+    if (pos != c.array.end() && *pos == low) {
+        return;
+    }
+    c.array.insert(pos, low);
+    ++c.count;
+    c.normalize();
+}
+
+void RoaringBitmap::remove(uint32_t id) {
+    uint16_t key = static_cast<uint16_t>(id >> 16);
+    uint16_t low = static_cast<uint16_t>(id & 0xffff);
+    auto it = std::lower_bound(chunks.begin(), chunks.end(), key,
+                               [](const Chunk& c, uint16_t k) { return c.key < k; });
+    if (it == chunks.end() || it->key != key) {
+        return;
+    }
+    Chunk& c = *it;
+    if (c.isBitset()) {
+        uint64_t mask = uint64_t{1} << (low & 63);
+        if (!(c.bits[low >> 6] & mask)) {
+            return;
+        }
+        c.bits[low >> 6] &= ~mask;
+        --c.count;
+        c.normalize();
+    } else {
+        auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+        if (pos == c.array.end() || *pos != low) {
+            return;
+        }
+        c.array.erase(pos);
+        --c.count;
+    }
+    if (c.count == 0) {
+        chunks.erase(it);
+    }
+}
+
+bool RoaringBitmap::contains(uint32_t id) const {
+    const Chunk* c = find(static_cast<uint16_t>(id >> 16));
+    if (!c) {
+        return false;
+    }
+    uint16_t low = static_cast<uint16_t>(id & 0xffff);
+    if (c->isBitset()) {
+        return (c->bits[low >> 6] >> (low & 63)) & 1;
+    }
+    return std::binary_search(c->array.begin(), c->array.end(), low);
+}
+
+uint64_t RoaringBitmap::cardinality() const {
+    uint64_t total = 0;
+    for (const auto& c : chunks) {
+        total += c.count;
+    }
+    return total;
+}
+
+RoaringBitmap::Chunk RoaringBitmap::combine(const Chunk& a, const Chunk& b, int op) {
+    Chunk out;
+    out.key = a.key;
+    if (!a.isBitset() && !b.isBitset()) {
+        auto sink = std::back_inserter(out.array);
+        if (op == kOr) {
+            out.array.reserve(a.array.size() + b.array.size());
+            std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), sink);
+        } else if (op == kAnd) {
+            std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), sink);
+        } else {
+            std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), sink);
+        }
+        out.count = static_cast<uint32_t>(out.array.size());
+        out.normalize();
+        return out;
+    }
+
+    // A sparse left side against a dense right side: probe the bitset
+    if (!a.isBitset() && op != kOr) {
+        for (uint16_t v : a.array) {
+            bool in_b = (b.bits[v >> 6] >> (v & 63)) & 1;
+            if (in_b == (op == kAnd)) {
+                out.array.push_back(v);
+            }
+        }
+        out.count = static_cast<uint32_t>(out.array.size());
+        return out;
+    }
+
+    // Otherwise work on words, expanding a sparse side into a scratch bitset
+    std::vector<uint64_t> scratch;
+    auto wordsOf = [&scratch](const Chunk& c) -> const uint64_t* {
+        if (c.isBitset()) {
+            return c.bits.data();
+        }
+        scratch.assign(kWords, 0);
+        for (uint16_t v : c.array) {
+            scratch[v >> 6] |= uint64_t{1} << (v & 63);
+        }
+        return scratch.data();
+    };
+    const uint64_t* x = wordsOf(a);
+    const uint64_t* y = wordsOf(b);
+    out.bits.resize(kWords);
+    for (size_t w = 0; w < kWords; ++w) {
+        uint64_t r = op == kOr ? (x[w] | y[w]) : op == kAnd ? (x[w] & y[w]) : (x[w] & ~y[w]);
+        out.bits[w] = r;
+        out.count += popcount(r);
+    }
+    out.normalize();
+    return out;
+}
+
+void RoaringBitmap::combineInto(Chunk& a, const Chunk& b, int op) {
+    if (!a.isBitset()) {
+        a = combine(a, b, op);
+        return;
+    }
+    if (b.isBitset()) {
+        uint32_t count = 0;
+        for (size_t w = 0; w < kWords; ++w) {
+            uint64_t x = a.bits[w];
+            uint64_t y = b.bits[w];
+            uint64_t r = op == kOr ? (x | y) : op == kAnd ? (x & y) : (x & ~y);
+            a.bits[w] = r;
+            count += popcount(r);
+        }
+        a.count = count;
+    } else if (op == kAnd) {
+        a = combine(b, a, kAnd);
+        return;
+    } else {
+        for (uint16_t v : b.array) {
+            uint64_t mask = uint64_t{1} << (v & 63);
+            uint64_t& word = a.bits[v >> 6];
+            bool present = word & mask;
+            if (op == kOr && !present) {
+                word |= mask;
+                ++a.count;
+            } else if (op == kAndNot && present) {
+                word &= ~mask;
+                --a.count;
+            }
+        }
+    }
+    a.normalize();
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other) {
+    std::vector<Chunk> merged;
+    merged.reserve(chunks.size() + other.chunks.size());
+    size_t i = 0;
+    size_t j = 0;
+    while (i < chunks.size() || j < other.chunks.size()) {
+        if (j == other.chunks.size() || (i < chunks.size() && chunks[i].key < other.chunks[j].key)) {
+            merged.push_back(std::move(chunks[i++]));
+        } else if (i == chunks.size() || other.chunks[j].key < chunks[i].key) {
+            merged.push_back(other.chunks[j++]);
+        } else {
+            combineInto(chunks[i], other.chunks[j++], kOr);
+            merged.push_back(std::move(chunks[i++]));
+        }
+    }
+    chunks = std::move(merged);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+    size_t kept = 0;
+    size_t j = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        while (j < other.chunks.size() && other.chunks[j].key < chunks[i].key) {
+            ++j;
+        }
+        if (j == other.chunks.size() || other.chunks[j].key != chunks[i].key) {
+            continue;
+        }
+        combineInto(chunks[i], other.chunks[j], kAnd);
+        if (chunks[i].count) {
+            if (kept != i) {
+                chunks[kept] = std::move(chunks[i]);
+            }
+            ++kept;
+        }
+    }
+    chunks.resize(kept);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator-=(const RoaringBitmap& other) {
+    size_t kept = 0;
+    size_t j = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        while (j < other.chunks.size() && other.chunks[j].key < chunks[i].key) {
+            ++j;
+        }
+        if (j < other.chunks.size() && other.chunks[j].key == chunks[i].key) {
+            combineInto(chunks[i], other.chunks[j], kAndNot);
+        }
+        if (chunks[i].count) {
+            if (kept != i) {
+                chunks[kept] = std::move(chunks[i]);
+            }
+            ++kept;
+        }
+    }
+    chunks.resize(kept);
+    return *this;
+}
+
+std::vector<uint32_t> RoaringBitmap::toVector(size_t offset, size_t limit) const {
+    std::vector<uint32_t> out;
+    for (const auto& c : chunks) {
+        if (out.size() >= limit) {
+            break;
+        }
+        if (offset >= c.count) {
+            offset -= c.count;
+            continue;
+        }
+        const uint32_t high = static_cast<uint32_t>(c.key) << 16;
+        if (!c.isBitset()) {
+            for (size_t k = offset; k < c.array.size() && out.size() < limit; ++k) {
+                out.push_back(high | c.array[k]);
+            }
+        } else {
+            for (size_t w = 0; w < kWords && out.size() < limit; ++w) {
+                uint64_t word = c.bits[w];
+                uint32_t n = popcount(word);
+                if (offset >= n) {
+                    offset -= n;
+                    continue;
+                }
+                while (word && out.size() < limit) {
+                    int bit = __builtin_ctzll(word);
+                    word &= word - 1;
+                    if (offset > 0) {
+                        --offset;
+                        continue;
+                    }
+                    out.push_back(high | static_cast<uint32_t>(w * 64 + static_cast<size_t>(bit)));
+                }
+            }
+        }
+        offset = 0;
+    }
+    return out;
+}
+
+size_t RoaringBitmap::memoryBytes() const {
+    size_t bytes = chunks.capacity() * sizeof(Chunk);
+    for (const auto& c : chunks) {
+        bytes += c.array.capacity() * sizeof(uint16_t) + c.bits.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
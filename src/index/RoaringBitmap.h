@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compressed set of uint32 ids in the style of Roaring bitmaps.
+//
+// The id space is cut into 2^16-wide chunks keyed by the high 16 bits. A
+// chunk with at most kArrayMax members is a sorted uint16 array; a denser
+// chunk is a 65536-bit bitset. Sparse sets therefore cost ~2 bytes per id
+// and dense ones 1 bit per id, and AND/OR/ANDNOT work chunk by chunk.
+//
+// Not thread-safe; owners guard it (see StockIndex).
+class RoaringBitmap {
+public:
+    void add(uint32_t id);
+    void remove(uint32_t id);
+    bool contains(uint32_t id) const;
+    uint64_t cardinality() const;
+    bool empty() const { return chunks.empty(); }
+    void clear() { chunks.clear(); }
+
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+    // Removes every id that is in `other`
+    RoaringBitmap& operator-=(const RoaringBitmap& other);
+
+    friend RoaringBitmap operator|(RoaringBitmap a, const RoaringBitmap& b) { return a |= b; }
+    friend RoaringBitmap operator&(RoaringBitmap a, const RoaringBitmap& b) { return a &= b; }
+    friend RoaringBitmap operator-(RoaringBitmap a, const RoaringBitmap& b) { return a -= b; }
+
+    // Ids in ascending order, skipping the first `offset`, at most `limit`
+    std::vector<uint32_t> toVector(size_t offset = 0, size_t limit = SIZE_MAX) const;
+
+    size_t memoryBytes() const;
+
+private:
+    static constexpr uint32_t kArrayMax = 4096;
+    static constexpr size_t kWords = 1024;
+
+    struct Chunk {
+        uint16_t key = 0;
+        uint32_t count = 0;
+        std::vector<uint16_t> array;  // used while count <= kArrayMax
+        std::vector<uint64_t> bits;   // kWords words once denser
+
+        bool isBitset() const { return !bits.empty(); }
+        void toBitset();
+        void toArray();
+        // Switches representation if the count crossed kArrayMax
+        void normalize();
+    };
+
+    // Sorted by key
+    std::vector<Chunk> chunks;
+
+    Chunk* find(uint16_t key);
+    const Chunk* find(uint16_t key) const;
+
+    static Chunk combine(const Chunk& a, const Chunk& b, int op);
+    // Same as a = combine(a, b, op), in place when `a` is a bitset
+    static void combineInto(Chunk& a, const Chunk& b, int op);
+};
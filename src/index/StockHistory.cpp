@@ -0,0 +1,240 @@
+#include "StockHistory.h"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+constexpr int64_t kMicrosPerMinute = 60LL * 1000000;
+
+int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+bool sameMovement(const StockHistory::Movement& a, const StockHistory::Movement& b) {
+    return a.at_us == b.at_us && a.delta == b.delta && a.stock_after == b.stock_after;
+}
+
+} // namespace
+
+constexpr int64_t StockHistory::kWindowMicros[];
+
+StockHistory& StockHistory::products() {
+    static StockHistory history;
+    return history;
+}
+
+void StockHistory::configure(size_t ring_depth, size_t product_cap) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    depth = std::max<size_t>(ring_depth, 1);
+    max_products = std::max<size_t>(product_cap, 1);
+}
+
+const StockHistory::Movement& StockHistory::Ring::newest(size_t i) const {
+    return slots[(head + slots.size() - 1 - i) % slots.size()];
+}
+
+StockHistory::Ring& StockHistory::ringLocked(uint32_t id) {
+    auto it = rings.find(id);
+    if (it != rings.end()) {
+        lru.splice(lru.begin(), lru, it->second.lru);
+        return it->second;
+    }
+    if (rings.size() >= max_products && !lru.empty()) {
+        auto victim = rings.find(lru.back());
+        if (victim->second.count > 0) {
+            evicted_newest_us = std::max(evicted_newest_us, victim->second.newest(0).at_us);
+        }
+        rings.erase(victim);
+        lru.pop_back();
+    }
+    Ring& ring = rings[id];
+    ring.slots.resize(depth);
+    ring.counted_from_us = evicted_newest_us;
+    lru.push_front(id);
+    ring.lru = lru.begin();
+    return ring;
+}
+
+void StockHistory::addSold(Ring& ring, int64_t minute, int64_t units) {
+    Bucket& m = ring.minutes[static_cast<size_t>(((minute % 60) + 60) % 60)];
+    if (m.tag < minute) {
+        m.tag = minute;
+        m.units = 0;
+    }
+    if (m.tag == minute) {
+        m.units += units;
+    }
+    int64_t hour = floorDiv(minute, 60);
+    Bucket& h = ring.hours[static_cast<size_t>(((hour % 24) + 24) % 24)];
+    if (h.tag < hour) {
+        h.tag = hour;
+        h.units = 0;
+    }
+    if (h.tag == hour) {
+        h.units += units;
+    }
+}
+
+void StockHistory::pushLocked(Ring& ring, const Movement& movement) {
+    const size_t capacity = ring.slots.size();
+    // Movements normally arrive in time order; a late one is slotted into
+    // place (or dropped if it is older than everything the ring holds)
+    size_t pos = 0;  // how many held movements are newer than this one
+    while (pos < ring.count && ring.newest(pos).at_us > movement.at_us) {
+        ++pos;
+    }
+    for (size_t i = pos; i < ring.count && ring.newest(i).at_us == movement.at_us; ++i) {
+        if (sameMovement(ring.newest(i), movement)) {
+            return;
+        }
+    }
+    if (movement.delta < 0) {
+        addSold(ring, floorDiv(movement.at_us, kMicrosPerMinute), -static_cast<int64_t>(movement.delta));
+    }
+    if (pos == ring.count && ring.count == capacity) {
+        return;
+    }
+    ring.slots[ring.head] = movement;
+    ring.head = (ring.head + 1) % capacity;
+    if (ring.count < capacity) {
+        ++ring.count;
+    } else {
+        ring.complete = false;
+    }
+    // Bubble the new movement back past the `pos` newer ones
+    for (size_t i = 0; i < pos; ++i) {
+        size_t a = (ring.head + capacity - 1 - i) % capacity;
+        size_t b = (ring.head + capacity - 2 - i) % capacity;
+        std::swap(ring.slots[a], ring.slots[b]);
+    }
+}
+
+void StockHistory::rebuild(const std::function<Snapshot()>& source) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    Snapshot snapshot = source();
+    rings.clear();
+    lru.clear();
+    evicted_newest_us = INT64_MIN;
+
+    // Seed the least recently moved first so the LRU order (and any
+    // eviction past max_products) follows recency
+    auto newestOf = [](const Seed& seed) {
+        return seed.movements.empty() ? INT64_MIN : seed.movements.back().at_us;
+    };
+    std::sort(snapshot.rings.begin(), snapshot.rings.end(),
+              [&](const Seed& a, const Seed& b) { return newestOf(a) < newestOf(b); });
+    for (const auto& seed : snapshot.rings) {
+        Ring& ring = ringLocked(seed.id);
+        size_t skip = seed.movements.size() > depth ? seed.movements.size() - depth : 0;
+        for (size_t i = skip; i < seed.movements.size(); ++i) {
+            const Movement& m = seed.movements[i];
+            ring.slots[ring.head] = m;
+            ring.head = (ring.head + 1) % ring.slots.size();
+            ++ring.count;
+        }
+        ring.complete = seed.complete && skip == 0;
+    }
+    // Sold counters come pre-aggregated per minute: the seeded rings only
+    // hold the last `depth` movements, not a day of them
+    for (const auto& sold : snapshot.sold) {
+        auto it = rings.find(sold.id);
+        if (it != rings.end()) {
+            addSold(it->second, sold.minute, sold.units);
+        }
+    }
+    loaded.store(true, std::memory_order_release);
+}
+
+void StockHistory::record(uint32_t id, const Movement& movement, bool first) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    bool is_new = rings.find(id) == rings.end();
+    Ring& ring = ringLocked(id);
+    if (is_new) {
+        // Nothing is known about movements before this one unless it is the
+        // product's first
+        ring.complete = first;
+    }
+    pushLocked(ring, movement);
+}
+
+void StockHistory::remove(uint32_t id) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = rings.find(id);
+    if (it != rings.end()) {
+        lru.erase(it->second.lru);
+        rings.erase(it);
+    }
+}
+
+std::optional<std::vector<StockHistory::Movement>> StockHistory::recent(uint32_t id, size_t limit) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (!loaded.load(std::memory_order_acquire)) {
+        return std::nullopt;
+    }
+    auto it = rings.find(id);
+    if (it == rings.end()) {
+        return std::nullopt;
+    }
+    const Ring& ring = it->second;
+    if (ring.count < limit && !ring.complete) {
+        return std::nullopt;
+    }
+    std::vector<Movement> out;
+    size_t n = std::min(limit, ring.count);
+    out.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        out.push_back(ring.newest(i));
+    }
+    return out;
+}
+
+std::optional<std::array<double, StockHistory::kWindowCount>> StockHistory::velocity(uint32_t id,
+                                                                                     int64_t now_us) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (!loaded.load(std::memory_order_acquire)) {
+        return std::nullopt;
+    }
+    std::array<double, kWindowCount> rates{};
+    auto it = rings.find(id);
+    if (it == rings.end()) {
+        // No ring: zero, unless an evicted ring may have held sales in the window
+        if (evicted_newest_us >= now_us - kWindowMicros[k24Hours]) {
+            return std::nullopt;
+        }
+        return rates;
+    }
+    const Ring& ring = it->second;
+    // A ring created after an eviction may have lost the product's earlier
+    // sales with its previous ring
+    if (ring.counted_from_us >= now_us - kWindowMicros[k24Hours]) {
+        return std::nullopt;
+    }
+    const int64_t now_minute = floorDiv(now_us, kMicrosPerMinute);
+    const int64_t now_hour = floorDiv(now_minute, 60);
+    int64_t sold_15m = 0;
+    int64_t sold_1h = 0;
+    for (const Bucket& b : ring.minutes) {
+        if (b.tag > now_minute - 60 && b.tag <= now_minute) {
+            sold_1h += b.units;
+            if (b.tag > now_minute - 15) {
+                sold_15m += b.units;
+            }
+        }
+    }
+    int64_t sold_24h = 0;
+    for (const Bucket& b : ring.hours) {
+        if (b.tag > now_hour - 24 && b.tag <= now_hour) {
+            sold_24h += b.units;
+        }
+    }
+    rates[k15Minutes] = static_cast<double>(sold_15m) * 4.0;
+    rates[k1Hour] = static_cast<double>(sold_1h);
+    rates[k24Hours] = static_cast<double>(sold_24h) / 24.0;
+    return rates;
+}
+
+size_t StockHistory::trackedProducts() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return rings.size();
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// Recent stock movements per product, kept in memory so the history and
+// sell-through endpoints do not have to read inventory_events.
+//
+// Each product that moves gets a fixed-size ring of its latest movements
+// plus sold-unit counters in 60 one-minute and 24 one-hour buckets. The
+// buckets are tagged with the minute/hour they count and reset lazily when
+// reused, so a sliding window is a sum over at most 60 (or 24) slots.
+// Only the most recently moved `max_products` are tracked; the least
+// recently moved ring is evicted first.
+//
+// "Sold" is every decrease in stock; restocks do not count. The 24h window
+// is summed from hour buckets and so may include up to one extra hour at
+// its old edge; the 15m and 1h windows are exact to the minute.
+//
+// Kept current by the inventory write paths next to CatalogCache::putStock.
+// All public methods are thread-safe; reads take a shared lock.
+class StockHistory {
+public:
+    struct Movement {
+        int64_t at_us;     // microseconds since the Unix epoch (UTC)
+        int32_t delta;     // stock_after minus the previous stock
+        int32_t stock_after;
+    };
+
+    // Seed for one product: its latest movements, oldest first. `complete`
+    // when these are all of its movements, so short histories can be served
+    // without the database.
+    struct Seed {
+        uint32_t id;
+        std::vector<Movement> movements;
+        bool complete;
+    };
+
+    // Units sold by one product within one minute (minute = at_us / 60s)
+    struct SoldMinute {
+        uint32_t id;
+        int64_t minute;
+        int64_t units;
+    };
+
+    struct Snapshot {
+        std::vector<Seed> rings;
+        std::vector<SoldMinute> sold;
+    };
+
+    enum Window { k15Minutes = 0, k1Hour, k24Hours, kWindowCount };
+    static constexpr int64_t kWindowMicros[kWindowCount] = {
+        15LL * 60 * 1000000, 60LL * 60 * 1000000, 24LL * 60 * 60 * 1000000,
+    };
+
+    static StockHistory& products();
+
+    // Ring depth and tracked-product cap; call before rebuild()
+    void configure(size_t depth, size_t max_products);
+
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+    // Replaces every ring with `source`'s seed, which runs under the
+    // exclusive lock (see TrigramIndex::rebuild).
+    void rebuild(const std::function<Snapshot()>& source);
+
+    // Appends a movement. A movement identical to one already in the ring
+    // is ignored, so one seeded from the database and then recorded by
+    // the request that made it is not counted twice. `first` marks the
+    // product's initial stock, so its ring is known to be complete.
+    void record(uint32_t id, const Movement& movement, bool first = false);
+    void remove(uint32_t id);
+
+    // The newest `limit` movements, newest first; nullopt when the ring
+    // cannot answer (product not tracked, or fewer than `limit` movements
+    // held and older ones exist).
+    std::optional<std::vector<Movement>> recent(uint32_t id, size_t limit) const;
+
+    // Units sold per hour over each window ending at `now_us`; nullopt when
+    // memory cannot answer (not loaded, or the product may have had sales
+    // within the last day in a ring that was since evicted).
+    std::optional<std::array<double, kWindowCount>> velocity(uint32_t id, int64_t now_us) const;
+
+    size_t trackedProducts() const;
+
+private:
+    struct Bucket {
+        int64_t tag = -1;  // minute or hour number this slot counts
+        int64_t units = 0;
+    };
+
+    struct Ring {
+        std::vector<Movement> slots;  // capacity `depth`
+        size_t head = 0;              // next write position
+        size_t count = 0;
+        bool complete = false;
+        // Sold counters are complete for windows starting after this
+        int64_t counted_from_us = INT64_MIN;
+        std::array<Bucket, 60> minutes;
+        std::array<Bucket, 24> hours;
+        std::list<uint32_t>::iterator lru;
+
+        const Movement& newest(size_t i) const;  // i = 0 is the newest
+    };
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<uint32_t, Ring> rings;
+    std::list<uint32_t> lru;  // front = most recently moved
+    size_t depth = 32;
+    size_t max_products = 100000;
+    // Newest movement among evicted rings: products without a ring have
+    // sold nothing since, so windows starting after it are known to be zero.
+    int64_t evicted_newest_us = INT64_MIN;
+    std::atomic<bool> loaded{false};
+
+    Ring& ringLocked(uint32_t id);
+    void pushLocked(Ring& ring, const Movement& movement);
+    static void addSold(Ring& ring, int64_t minute, int64_t units);
+};
@@ -0,0 +1,119 @@
+#include "StockIndex.h"
+#include <iterator>
+#include <mutex>
+
+StockIndex& StockIndex::products() {
+    static StockIndex index;
+    return index;
+}
+
+void StockIndex::setLocked(uint32_t id, int stock, long long version) {
+    auto seen = versions.try_emplace(id, version);
+    if (!seen.second) {
+        if (seen.first->second >= version) {
+            return;
+        }
+        seen.first->second = version;
+    }
+    // The table has CHECK (stock >= 0); clamp rather than corrupt the slices
+    uint32_t value = stock > 0 ? static_cast<uint32_t>(stock) : 0;
+    tracked.add(id);
+    if (value == 0) {
+        zero.add(id);
+    } else {
+        zero.remove(id);
+    }
+    for (int i = 0; i < kSlices; ++i) {
+        if ((value >> i) & 1) {
+            slices[i].add(id);
+        } else {
+            slices[i].remove(id);
+        }
+    }
+}
+
+void StockIndex::rebuild(const std::function<std::vector<Row>()>& source) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::vector<Row> rows = source();
+    tracked.clear();
+    zero.clear();
+    for (auto& slice : slices) {
+        slice.clear();
+    }
+    // Tombstones survive, so deleted products stay out of the rebuilt index
+    for (auto it = versions.begin(); it != versions.end();) {
+        it = it->second == kRemoved ? std::next(it) : versions.erase(it);
+    }
+    versions.reserve(versions.size() + rows.size());
+    for (const auto& row : rows) {
+        setLocked(row.id, row.stock, row.version);
+    }
+    loaded.store(true, std::memory_order_release);
+}
+
+void StockIndex::set(uint32_t id, int stock, long long version) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    setLocked(id, stock, version);
+}
+
+void StockIndex::remove(uint32_t id) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    tracked.remove(id);
+    zero.remove(id);
+    for (auto& slice : slices) {
+        slice.remove(id);
+    }
+    versions[id] = kRemoved;
+}
+
+RoaringBitmap StockIndex::atMostLocked(int threshold) const {
+    // A negative threshold behaves like 0: nothing is "low"
+    const uint32_t t = threshold > 0 ? static_cast<uint32_t>(threshold) : 0;
+    // Walk the bits of the threshold from the top: `eq` keeps the products
+    // whose stock matches the threshold on the bits seen so far, `lt` those
+    // already known to be smaller.
+    RoaringBitmap lt;
+    RoaringBitmap eq = tracked;
+    for (int i = kSlices - 1; i >= 0 && !eq.empty(); --i) {
+        if ((t >> i) & 1) {
+            lt |= eq - slices[i];
+            eq &= slices[i];
+        } else {
+            eq -= slices[i];
+        }
+    }
+    return lt |= eq;
+}
+
+RoaringBitmap StockIndex::select(State state, int threshold) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    switch (state) {
+    case State::Out:
+        return zero;
+    case State::Low:
+        return atMostLocked(threshold) -= zero;
+    case State::In:
+    default:
+        return tracked - atMostLocked(threshold);
+    }
+}
+
+StockIndex::Counts StockIndex::counts(int threshold) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    RoaringBitmap at_most = atMostLocked(threshold);
+    // zero is always a subset of at_most, and at_most of tracked
+    Counts c;
+    c.out = zero.cardinality();
+    c.low = at_most.cardinality() - c.out;
+    c.in = tracked.cardinality() - at_most.cardinality();
+    return c;
+}
+
+size_t StockIndex::memoryBytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    size_t bytes = tracked.memoryBytes() + zero.memoryBytes();
+    for (const auto& slice : slices) {
+        bytes += slice.memoryBytes();
+    }
+    return bytes;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "RoaringBitmap.h"
+
+// Bit-sliced bitmap index over inventory stock levels, keyed by product id.
+//
+// `tracked` holds every product with an inventory row, `zero` those with
+// stock 0, and slice i those whose stock has bit i set. "stock <= t" for an
+// arbitrary threshold is then computed with one pass over the slices
+// (O'Neil & Quass range evaluation), so out/low/in listings and their counts
+// are a few dozen bitmap operations instead of a table scan.
+//
+// Kept current by the inventory write paths alongside CatalogCache::putStock.
+// All public methods are thread-safe; reads take a shared lock.
+class StockIndex {
+public:
+    enum class State { Out, Low, In };
+
+    struct Counts {
+        uint64_t out = 0;
+        uint64_t low = 0;
+        uint64_t in = 0;
+    };
+
+    struct Row {
+        uint32_t id;
+        int stock;
+        long long version;  // inventory.version
+    };
+
+    static StockIndex& products();
+
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+    // Replaces the index with the rows from `source`, which runs under the
+    // exclusive lock (see TrigramIndex::rebuild).
+    void rebuild(const std::function<std::vector<Row>()>& source);
+
+    // Dropped when the product already holds a newer `version`, so updates
+    // whose hooks run out of order leave the latest stock (see
+    // CatalogCache::putStock).
+    void set(uint32_t id, int stock, long long version);
+    // Leaves a tombstone that outranks every version (product ids are never
+    // reused), so a set() whose hook runs after the delete's is dropped
+    void remove(uint32_t id);
+
+    // out: stock == 0, low: 0 < stock <= threshold, in: stock > threshold
+    RoaringBitmap select(State state, int threshold) const;
+    Counts counts(int threshold) const;
+
+    size_t memoryBytes() const;
+
+private:
+    static constexpr int kSlices = 31;  // stock is a non-negative INT
+    static constexpr long long kRemoved = std::numeric_limits<long long>::max();
+
+    mutable std::shared_mutex mutex;
+    RoaringBitmap tracked;
+    RoaringBitmap zero;
+    RoaringBitmap slices[kSlices];
+    std::unordered_map<uint32_t, long long> versions;  // kRemoved for deleted products
+    std::atomic<bool> loaded{false};
+
+    void setLocked(uint32_t id, int stock, long long version);
+    RoaringBitmap atMostLocked(int threshold) const;
+};
@@ -0,0 +1,225 @@
+#include "TrigramIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <tuple>
+
+namespace {
+
+uint32_t packTrigram(const char* p) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(p[0])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(p[1])) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(p[2]));
+}
+
+// Intersects the sorted array `acc` in place with the sorted array `list`.
+// For each value in the (smaller) accumulator the cursor into `list`
+// gallops forward in doubling steps, then binary-searches the last step,
+// so the cost is O(|acc| log(|list| / |acc|)) rather than O(|list|).
+void intersectGalloping(std::vector<uint32_t>& acc, const std::vector<uint32_t>& list) {
+    size_t out = 0;
+    size_t lo = 0;
+    const size_t n = list.size();
+    for (uint32_t v : acc) {
+        if (lo >= n) {
+            break;
+        }
+        size_t bound = 1;
+        while (lo + bound < n && list[lo + bound] < v) {
+            bound <<= 1;
+        }
+        auto first = list.begin() + static_cast<std::ptrdiff_t>(lo + bound / 2);
+        auto last = list.begin() + static_cast<std::ptrdiff_t>(std::min(lo + bound + 1, n));
+        lo = static_cast<size_t>(std::lower_bound(first, last, v) - list.begin());
+        if (lo < n && list[lo] == v) {
+            acc[out++] = v;
+            ++lo;
+        }
+    }
+    acc.resize(out);
+}
+
+bool isWordBoundary(const std::string& name, size_t pos) {
+    return pos == 0 || !std::isalnum(static_cast<unsigned char>(name[pos - 1]));
+}
+
+} // namespace
+
+TrigramIndex& TrigramIndex::products() {
+    static TrigramIndex index;
+    return index;
+}
+
+std::string TrigramIndex::normalize(std::string_view s) {
+    std::string out(s);
+    for (char& c : out) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return out;
+}
+
+std::vector<uint32_t> TrigramIndex::trigramsOf(std::string_view normalized) {
+    std::vector<uint32_t> grams;
+    if (normalized.size() < 3) {
+        return grams;
+    }
+    grams.reserve(normalized.size() - 2);
+    for (size_t i = 0; i + 3 <= normalized.size(); ++i) {
+        grams.push_back(packTrigram(normalized.data() + i));
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+void TrigramIndex::addLocked(uint32_t id, std::string normalized) {
+    for (uint32_t gram : trigramsOf(normalized)) {
+        auto& list = postings[gram];
+        // New products get increasing ids, so this is almost always an append
+        if (list.empty() || list.back() < id) {
+            list.push_back(id);
+        } else {
+            auto it = std::lower_bound(list.begin(), list.end(), id);
+            if (it == list.end() || *it != id) {
+                list.insert(it, id);
+            }
+        }
+    }
+    names[id] = std::move(normalized);
+}
+
+void TrigramIndex::removeLocked(uint32_t id) {
+    auto found = names.find(id);
+    if (found == names.end()) {
+        return;
+    }
+    for (uint32_t gram : trigramsOf(found->second)) {
+        auto pit = postings.find(gram);
+        if (pit == postings.end()) {
+            continue;
+        }
+        auto& list = pit->second;
+        auto it = std::lower_bound(list.begin(), list.end(), id);
+        if (it != list.end() && *it == id) {
+            list.erase(it);
+        }
+        if (list.empty()) {
+            postings.erase(pit);
+        }
+    }
+    names.erase(found);
+}
+
+void TrigramIndex::rebuild(const std::function<std::vector<Document>()>& source) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::vector<Document> docs = source();
+    std::sort(docs.begin(), docs.end(), [](const Document& a, const Document& b) { return a.first < b.first; });
+
+    postings.clear();
+    names.clear();
+    names.reserve(docs.size());
+    // Ids are visited in ascending order, so every posting list is built
+    // by appends and comes out sorted.
+    for (auto& doc : docs) {
+        addLocked(doc.first, normalize(doc.second));
+    }
+    for (auto& entry : postings) {
+        entry.second.shrink_to_fit();
+    }
+    loaded.store(true, std::memory_order_release);
+}
+
+void TrigramIndex::add(uint32_t id, std::string_view name) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    removeLocked(id);
+    addLocked(id, normalize(name));
+}
+
+void TrigramIndex::update(uint32_t id, std::string_view name) {
+    add(id, name);
+}
+
+void TrigramIndex::remove(uint32_t id) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    removeLocked(id);
+}
+
+std::vector<uint32_t> TrigramIndex::search(std::string_view query, size_t limit) const {
+    std::string q = normalize(query);
+    std::vector<uint32_t> candidates;
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+
+    if (q.size() < 3) {
+        candidates.reserve(names.size());
+        for (const auto& entry : names) {
+            candidates.push_back(entry.first);
+        }
+    } else {
+        std::vector<const std::vector<uint32_t>*> lists;
+        for (uint32_t gram : trigramsOf(q)) {
+            auto it = postings.find(gram);
+            if (it == postings.end()) {
+                return {};
+            }
+            lists.push_back(&it->second);
+        }
+        std::sort(lists.begin(), lists.end(),
+                  [](const auto* a, const auto* b) { return a->size() < b->size(); });
+        candidates = *lists.front();
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+            intersectGalloping(candidates, *lists[i]);
+        }
+    }
+
+    // (class, position, length, id): lower sorts first
+    using Rank = std::tuple<int, size_t, size_t, uint32_t>;
+    std::vector<Rank> ranked;
+    for (uint32_t id : candidates) {
+        const std::string& name = names.at(id);
+        size_t pos = name.find(q);
+        if (pos == std::string::npos) {
+            continue;
+        }
+        int cls;
+        if (pos == 0 && name.size() == q.size()) {
+            cls = 0;
+        } else if (pos == 0) {
+            cls = 1;
+        } else if (isWordBoundary(name, pos)) {
+            cls = 2;
+        } else {
+            // A later occurrence may still start a word
+            cls = 3;
+            for (size_t p = name.find(q, pos + 1); p != std::string::npos; p = name.find(q, p + 1)) {
+                if (isWordBoundary(name, p)) {
+                    cls = 2;
+                    pos = p;
+                    break;
+                }
+            }
+        }
+        ranked.emplace_back(cls, pos, name.size(), id);
+    }
+    lock.unlock();
+
+    size_t keep = std::min(limit, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(keep), ranked.end());
+
+    std::vector<uint32_t> ids;
+    ids.reserve(keep);
+    for (size_t i = 0; i < keep; ++i) {
+        ids.push_back(std::get<3>(ranked[i]));
+    }
+    return ids;
+}
+
+size_t TrigramIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return names.size();
+}
+
+size_t TrigramIndex::trigramCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return postings.size();
+}
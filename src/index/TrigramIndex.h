@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// In-process trigram inverted index for case-insensitive substring search.
+//
+// Every name is lowercased (ASCII) and split into overlapping 3-byte
+// trigrams; each trigram maps to a posting list of document ids kept as a
+// sorted uint32 array. A query's candidates are the intersection of the
+// posting lists of its trigrams (smallest list first, galloping search into
+// the larger ones), and each candidate is then verified against the stored
+// name, so results match `ILIKE '%q%'` exactly. Queries shorter than three
+// characters fall back to a scan of the stored names.
+//
+// All public methods are thread-safe; reads take a shared lock.
+class TrigramIndex {
+public:
+    using Document = std::pair<uint32_t, std::string>;
+
+    // Index over product names, maintained by ProductRepo.
+    static TrigramIndex& products();
+
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+    // Replaces the whole index with the documents returned by `source`.
+    // `source` runs under the exclusive lock so that writes racing with
+    // the rebuild are applied after it rather than lost.
+    void rebuild(const std::function<std::vector<Document>()>& source);
+
+    void add(uint32_t id, std::string_view name);
+    void update(uint32_t id, std::string_view name);
+    void remove(uint32_t id);
+
+    // Matching ids ordered by relevance: exact match, then prefix match,
+    // then match at a word boundary, then anywhere; ties go to the earlier
+    // match position, the shorter name and finally the lower id.
+    std::vector<uint32_t> search(std::string_view query, size_t limit) const;
+
+    size_t size() const;
+    size_t trigramCount() const;
+
+    static std::string normalize(std::string_view s);
+
+private:
+    mutable std::shared_mutex mutex;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+    std::unordered_map<uint32_t, std::string> names;
+    std::atomic<bool> loaded{false};
+
+    static std::vector<uint32_t> trigramsOf(std::string_view normalized);
+    void addLocked(uint32_t id, std::string normalized);
+    void removeLocked(uint32_t id);
+};
@@ -1,30 +1,80 @@
+#include <chrono>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include "external/httplib.h"
+#include "server/EventLoopServer.h"
+#include "server/Warmup.h"
+#include "server/Config.h"
+#include "server/RequestArena.h"
+#include "server/ContentNegotiation.h"
+#include "server/Admission.h"
+#include "server/ConcurrencyLimit.h"
+#include "repository/postgres/PostgresConnection.h"
+#include "repository/postgres/CacheLoader.h"
+#include "repository/cache/CatalogCache.h"
+#include "repository/cache/DashboardCounters.h"
+#include "repository/cache/SubscriberCounts.h"
+#include "index/TrigramIndex.h"
+#include "index/PrefixIndex.h"
+#include "index/FullTextIndex.h"
+#include "index/StockIndex.h"
+#include "index/LowStockIndex.h"
+#include "index/StockHistory.h"
+#include "repository/postgres/InventoryEventLog.h"
+#include "repository/postgres/IdempotencyStore.h"
+#include "repository/postgres/ReplicaRouter.h"
 
 #include "../src/controller/ProductRoutes.h"
 #include "../src/controller/UserRoutes.h"
 #include "../src/controller/SubscriptionRoutes.h"
 #include "../src/controller/NotificationController.h"
+#include "../src/controller/HealthRoutes.h"
+#include "../src/controller/ExportRoutes.h"
+#include "../src/controller/DashboardRoutes.h"
 
 int main() {
-    httplib::Server server;
+    // SERVER_MODE=epoll selects the event-loop front end; IO_THREADS sets its
+    // I/O thread count. Anything else keeps httplib's thread-per-connection mode.
+    bool use_event_loop = Config::envString("SERVER_MODE", "threads") == "epoll";
+
+    EventLoopServer server(Config::envSize("IO_THREADS", 2));
 
     // Handle CORS preflight requests
     server.Options(R"(/api/.*)", [](const httplib::Request&, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization, Idempotency-Key");
         res.set_header("Access-Control-Max-Age", "3600");
         res.status = 204;
     });
 
+    // Handler temporaries come from a per-thread arena for the length of
+    // the request; the post-routing handler rewinds it and records the
+    // request's allocation counts under its route (GET /metrics/allocations).
+    // Rate limits answer 429 here, before any handler runs (server/Admission.h)
+    server.set_pre_routing_handler([](const httplib::Request& req, httplib::Response& res) {
+        RequestArena::begin();
+        ConcurrencyLimit::begin();
+        ReplicaRouter::beginRequest(req.method, clientKey(req));
+        if (!admitRequest(req, res)) {
+            return httplib::Server::HandlerResponse::Handled;
+        }
+        return httplib::Server::HandlerResponse::Unhandled;
+    });
+
     // Add CORS headers to all responses using post_routing_handler
-    server.set_post_routing_handler([](const httplib::Request&, httplib::Response& res) {
+    server.set_post_routing_handler([](const httplib::Request& req, httplib::Response& res) {
+        RouteAllocations::instance().record(req.method, req.matched_route, RequestArena::end());
+        finishRequest(res);
+        ReplicaRouter::endRequest();
+        applyResponseFormat(req, res);
+
         // Only add CORS header if not already set
         if (!res.has_header("Access-Control-Allow-Origin")) {
             res.set_header("Access-Control-Allow-Origin", "*");
             res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-            res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+            res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization, Idempotency-Key");
         }
         return httplib::Server::HandlerResponse::Handled;
     });
@@ -33,9 +83,120 @@ int main() {
     registerUserRoutes(server);
     registerSubscriptionRoutes(server);
     NotificationController::registerRoutes(server);
+    registerHealthRoutes(server);
+    registerExportRoutes(server);
+    registerDashboardRoutes(server);
+
+    // Warm-up runs in the background while the server already listens;
+    // GET /ready stays 503 until it completes.
+    Warmup& warmup = Warmup::instance();
+    warmup.addPhase("connections", [] {
+        PostgresConnection::prewarm(CPPHTTPLIB_THREAD_POOL_COUNT);
+    });
+    warmup.addPhase("hot-data", [] {
+        CacheLoader::loadHotData();
+    });
+    if (!Config::useDatabaseSearch()) {
+        warmup.addPhase("search-index", [] {
+            if (!CatalogCache::instance().isLoaded()) {
+                throw std::runtime_error("catalog cache not loaded; search stays on the database");
+            }
+            TrigramIndex::products().rebuild([] {
+                std::vector<TrigramIndex::Document> docs;
+                for (auto& entry : CatalogCache::instance().snapshot()) {
+                    docs.emplace_back(static_cast<uint32_t>(entry.id), std::move(entry.name));
+                }
+                return docs;
+            });
+        });
+        warmup.addPhase("fulltext-index", [] {
+            if (!CatalogCache::instance().isLoaded()) {
+                throw std::runtime_error("catalog cache not loaded; full-text search stays on the database");
+            }
+            FullTextIndex::products().rebuild([] {
+                std::vector<FullTextIndex::Document> docs;
+                for (auto& entry : CatalogCache::instance().snapshot()) {
+                    docs.push_back(FullTextIndex::Document{static_cast<uint32_t>(entry.id),
+                                                           std::move(entry.name),
+                                                           std::move(entry.description)});
+                }
+                return docs;
+            });
+        });
+    }
+    warmup.addPhase("autocomplete-index", [] {
+        if (!CatalogCache::instance().isLoaded()) {
+            throw std::runtime_error("catalog cache not loaded; autocomplete stays on the database");
+        }
+        PrefixIndex::products().rebuild([] {
+            std::vector<PrefixIndex::Document> docs;
+            for (auto& entry : CatalogCache::instance().snapshot()) {
+                docs.emplace_back(static_cast<uint32_t>(entry.id), std::move(entry.name));
+            }
+            return docs;
+        });
+    });
+    warmup.addPhase("stock-bitmaps", [] {
+        if (!CatalogCache::instance().isLoaded()) {
+            throw std::runtime_error("catalog cache not loaded; stock-state filters stay on the database");
+        }
+        StockIndex::products().rebuild([] {
+            std::vector<StockIndex::Row> rows;
+            for (const auto& entry : CatalogCache::instance().snapshot()) {
+                if (entry.has_stock) {
+                    rows.push_back(StockIndex::Row{static_cast<uint32_t>(entry.id), entry.stock, entry.stock_version});
+                }
+            }
+            return rows;
+        });
+    });
+    warmup.addPhase("low-stock-index", [] {
+        if (!CatalogCache::instance().isLoaded()) {
+            throw std::runtime_error("catalog cache not loaded; the low-stock report stays on the database");
+        }
+        LowStockIndex::products().rebuild([] {
+            std::vector<LowStockIndex::Item> rows;
+            for (const auto& entry : CatalogCache::instance().snapshot()) {
+                if (entry.has_stock) {
+                    rows.push_back(LowStockIndex::Item{static_cast<uint32_t>(entry.id), entry.stock, entry.reorder_point,
+                                                      entry.stock_version});
+                }
+            }
+            return rows;
+        });
+    });
+    // Stock movements recorded before this phase are flushed first so the
+    // seed read from inventory_events includes them
+    warmup.addPhase("stock-history", [] {
+        size_t depth = Config::envSize("INVENTORY_HISTORY_DEPTH", 32);
+        StockHistory& history = StockHistory::products();
+        history.configure(depth, Config::envSize("INVENTORY_HISTORY_PRODUCTS", 100000));
+        history.rebuild([depth] {
+            InventoryEventLog::instance().flush(std::chrono::seconds(5));
+            return CacheLoader::loadStockHistory(depth);
+        });
+        std::cout << "✅ Stock history loaded: " << history.trackedProducts() << " active products" << std::endl;
+    });
+    warmup.addPhase("subscriber-counts", [] {
+        SubscriberCounts::instance().rebuild(CacheLoader::loadSubscriberCounts);
+    });
+    warmup.addPhase("dashboard-counters", [] {
+        DashboardCounters::instance().reconcile(CacheLoader::loadDashboardCounts);
+    });
+    warmup.start();
+    InventoryEventLog::instance().start();
+    IdempotencyStore::instance().startPurger();
+    ReplicaRouter::instance().startMonitor();
+    DashboardCounters::instance().startReconciler(
+        std::chrono::seconds(Config::envSize("DASHBOARD_RECONCILE_SECONDS", 60)), CacheLoader::loadDashboardCounts);
 
     std::cout << "Server running on http://localhost:8080\n";
     std::cout << "CORS enabled for all origins\n";
     std::cout << "Notification system initialized\n";
-    server.listen("0.0.0.0", 8080);
+    if (use_event_loop) {
+        std::cout << "Event-loop mode (epoll) enabled\n";
+        server.listenEventLoop("0.0.0.0", 8080);
+    } else {
+        server.listen("0.0.0.0", 8080);
+    }
 }
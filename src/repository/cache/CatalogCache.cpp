@@ -0,0 +1,200 @@
+#include "CatalogCache.h"
+#include <mutex>
+
+CatalogCache& CatalogCache::instance() {
+    static CatalogCache cache;
+    return cache;
+}
+
+std::optional<product> CatalogCache::findProduct(int id) const {
+    if (!isLoaded()) {
+        return std::nullopt;
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+        return std::nullopt;
+    }
+    return product(it->second.id, it->second.name, it->second.description);
+}
+
+std::optional<CatalogCache::Entry> CatalogCache::findEntry(int id) const {
+    if (!isLoaded()) {
+        return std::nullopt;
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+size_t CatalogCache::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return entries.size();
+}
+
+std::vector<CatalogCache::Entry> CatalogCache::snapshot() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::vector<Entry> out;
+    out.reserve(entries.size());
+    for (const auto& kv : entries) {
+        out.push_back(kv.second);
+    }
+    return out;
+}
+
+void CatalogCache::applyProduct(Entry& e, const std::string& name, const std::string& description,
+                                long long version) {
+    e.name = name;
+    e.description = description;
+    e.product_version = version;
+}
+
+void CatalogCache::applyStock(Entry& e, const StockRow& row) {
+    e.has_stock = true;
+    e.stock = row.stock;
+    e.reorder_point = row.reorder_point;
+    e.stock_updated_at = row.updated_at;
+    e.stock_version = row.version;
+}
+
+bool CatalogCache::addProduct(int id, const std::string& name, const std::string& description, long long version) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (removed.count(id)) {
+        return false;
+    }
+    auto inserted = entries.try_emplace(id);
+    Entry& e = inserted.first->second;
+    if (!inserted.second && e.product_version >= version) {
+        return false;
+    }
+    e.id = id;
+    applyProduct(e, name, description, version);
+    if (loading && inserted.second) {
+        auto written = stock_written_during_load.find(id);
+        if (written != stock_written_during_load.end()) {
+            applyStock(e, written->second);
+        }
+    }
+    return true;
+}
+
+bool CatalogCache::updateProduct(int id, const std::string& name, const std::string& description,
+                                 long long version) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (removed.count(id)) {
+        return false;
+    }
+    auto it = entries.find(id);
+    if (it != entries.end()) {
+        if (it->second.product_version >= version) {
+            return false;
+        }
+        applyProduct(it->second, name, description, version);
+        return true;
+    }
+    if (!loading) {
+        return false;
+    }
+    // loadProducts applies it if the bulk row is older
+    auto written = products_written_during_load.try_emplace(id);
+    Entry& pending = written.first->second;
+    if (!written.second && pending.product_version >= version) {
+        return false;
+    }
+    pending.id = id;
+    applyProduct(pending, name, description, version);
+    return true;
+}
+
+void CatalogCache::putStock(int id, int stock, int reorder_point, const std::string& updated_at, long long version) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (removed.count(id)) {
+        return;
+    }
+    StockRow row{id, stock, reorder_point, updated_at, version};
+    if (loading) {
+        // Kept even when the product is not loaded yet; loadProducts applies it
+        auto written = stock_written_during_load.try_emplace(id, row);
+        if (!written.second && written.first->second.version < version) {
+            written.first->second = row;
+        }
+    }
+    auto it = entries.find(id);
+    if (it == entries.end() || (it->second.has_stock && it->second.stock_version >= version)) {
+        return;
+    }
+    applyStock(it->second, row);
+}
+
+void CatalogCache::removeProduct(int id) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries.erase(id);
+    removed.insert(id);
+    products_written_during_load.erase(id);
+    stock_written_during_load.erase(id);
+}
+
+void CatalogCache::beginLoad() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    loading = true;
+    products_written_during_load.clear();
+    stock_written_during_load.clear();
+}
+
+void CatalogCache::loadProducts(std::vector<Entry> rows) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries.reserve(entries.size() + rows.size());
+    for (auto& row : rows) {
+        if (removed.count(row.id)) {
+            continue;
+        }
+        auto pending = products_written_during_load.find(row.id);
+        if (pending != products_written_during_load.end() && pending->second.product_version > row.product_version) {
+            applyProduct(row, pending->second.name, pending->second.description, pending->second.product_version);
+        }
+        auto existing = entries.find(row.id);
+        if (existing != entries.end()) {
+            // Added by a request during the load; keep whichever write is newer
+            if (existing->second.product_version < row.product_version) {
+                applyProduct(existing->second, row.name, row.description, row.product_version);
+            }
+            continue;
+        }
+        auto written = stock_written_during_load.find(row.id);
+        if (written != stock_written_during_load.end()) {
+            applyStock(row, written->second);
+        }
+        entries.emplace(row.id, std::move(row));
+    }
+}
+
+void CatalogCache::loadStock(const std::vector<StockRow>& rows) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    for (const auto& row : rows) {
+        // Stock written by a request during the load stays unless this row
+        // is newer still
+        auto it = entries.find(row.product_id);
+        if (it == entries.end() || (it->second.has_stock && it->second.stock_version >= row.version)) {
+            continue;
+        }
+        applyStock(it->second, row);
+    }
+}
+
+void CatalogCache::finishLoad() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    loading = false;
+    products_written_during_load.clear();
+    stock_written_during_load.clear();
+    loaded.store(true, std::memory_order_release);
+}
+
+void CatalogCache::abortLoad() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    loading = false;
+    products_written_during_load.clear();
+    stock_written_during_load.clear();
+}
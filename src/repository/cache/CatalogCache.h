@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../../domain/product.h"
+
+// In-memory copy of the products table joined with inventory, bulk-loaded
+// during warm-up and kept current by the product/inventory write paths of
+// this process. Reads only consult it once a load has completed; before
+// that (or after a failed load) callers fall back to the database.
+class CatalogCache {
+public:
+    struct Entry {
+        int id = 0;
+        std::string name;
+        std::string description;
+        long long product_version = 0;  // products.version
+        bool has_stock = false;
+        int stock = 0;
+        int reorder_point = 0;
+        std::string stock_updated_at;
+        long long stock_version = 0;  // inventory.version
+    };
+
+    struct StockRow {
+        int product_id;
+        int stock;
+        int reorder_point;
+        std::string updated_at;
+        long long version;  // inventory.version
+    };
+
+    static CatalogCache& instance();
+
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+    std::optional<product> findProduct(int id) const;
+    std::optional<Entry> findEntry(int id) const;
+    size_t size() const;
+
+    // Copies every entry out under a shared lock; used to seed derived
+    // indexes after the bulk load.
+    std::vector<Entry> snapshot() const;
+
+    // Write-through hooks for the repositories/handlers. Writes to the same
+    // product can finish out of order after their commits, so each carries
+    // its row's version (products.version or inventory.version, bumped by
+    // every write) and is dropped when the entry already holds a newer one.
+    // A removed product leaves a tombstone (ids are never reused): writes
+    // whose hooks run after its delete's are dropped instead of bringing it
+    // back. The product hooks return whether the write was applied, which
+    // is when the caller should update the derived indexes as well.
+    bool addProduct(int id, const std::string& name, const std::string& description, long long version);
+    // Never inserts: an update of a product the cache does not hold is
+    // dropped (or, during a load, applied to the bulk row when it arrives)
+    bool updateProduct(int id, const std::string& name, const std::string& description, long long version);
+    void putStock(int id, int stock, int reorder_point, const std::string& updated_at, long long version);
+    void removeProduct(int id);
+
+    // Bulk load. Writes made by requests while the load was running are
+    // compared with the bulk rows by version like any other write, and
+    // products deleted meanwhile are not loaded. A write for a product the
+    // load has not reached yet is held back and applied to that product's
+    // row when it arrives.
+    void beginLoad();
+    void loadProducts(std::vector<Entry> rows);
+    void loadStock(const std::vector<StockRow>& rows);
+    void finishLoad();
+    void abortLoad();
+
+private:
+    CatalogCache() = default;
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<int, Entry> entries;
+    std::unordered_set<int> removed;
+    std::unordered_map<int, Entry> products_written_during_load;
+    std::unordered_map<int, StockRow> stock_written_during_load;
+    bool loading = false;
+    std::atomic<bool> loaded{false};
+
+    static void applyProduct(Entry& e, const std::string& name, const std::string& description, long long version);
+    static void applyStock(Entry& e, const StockRow& row);
+};
@@ -0,0 +1,275 @@
+#include "DashboardCounters.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void addTotals(DashboardCounters::Totals& into, const DashboardCounters::Totals& d) {
+    into.products += d.products;
+    into.users += d.users;
+    into.subscriptions += d.subscriptions;
+    into.active_subscriptions += d.active_subscriptions;
+    into.out_of_stock += d.out_of_stock;
+    into.pending_notifications += d.pending_notifications;
+    into.failed_notifications += d.failed_notifications;
+}
+
+// Adjusts the pending/failed counters for one notification log status
+void countStatus(DashboardCounters::Totals& t, const std::string& status, long long by) {
+    if (status == "pending") {
+        t.pending_notifications += by;
+    } else if (status == "failed") {
+        t.failed_notifications += by;
+    }
+}
+
+} // namespace
+
+DashboardCounters& DashboardCounters::instance() {
+    static DashboardCounters counters;
+    return counters;
+}
+
+DashboardCounters::~DashboardCounters() {
+    {
+        std::lock_guard<std::mutex> lock(reconciler_mutex);
+        stopping = true;
+    }
+    reconciler_wake.notify_one();
+    if (reconciler.joinable()) {
+        reconciler.join();
+    }
+}
+
+void DashboardCounters::setWatchersLocked(int product_id, long long count) {
+    auto it = watchers.find(product_id);
+    if (it != watchers.end()) {
+        by_watchers.erase({-it->second, product_id});
+        watchers.erase(it);
+    }
+    if (count > 0) {
+        watchers.emplace(product_id, count);
+        by_watchers.emplace(-count, product_id);
+    }
+}
+
+void DashboardCounters::applyLocked(const Delta& delta) {
+    addTotals(totals, delta.totals);
+    if (delta.watchers != 0) {
+        auto it = watchers.find(delta.product_id);
+        long long current = it == watchers.end() ? 0 : it->second;
+        setWatchersLocked(delta.product_id, current + delta.watchers);
+    }
+}
+
+void DashboardCounters::recordLocked(const Delta& delta) {
+    applyLocked(delta);
+    if (capturing) {
+        captured.push_back(delta);
+    }
+}
+
+void DashboardCounters::apply(const Delta& delta) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    recordLocked(delta);
+}
+
+void DashboardCounters::productCreated() {
+    Delta d;
+    d.totals.products = 1;
+    apply(d);
+}
+
+void DashboardCounters::productRemoved() {
+    Delta d;
+    d.totals.products = -1;
+    apply(d);
+    // Its inventory, subscriptions and notification logs cascade
+    markStale();
+}
+
+void DashboardCounters::userCreated() {
+    Delta d;
+    d.totals.users = 1;
+    apply(d);
+}
+
+void DashboardCounters::userRemoved() {
+    Delta d;
+    d.totals.users = -1;
+    apply(d);
+    // Their subscriptions and notification logs cascade
+    markStale();
+}
+
+void DashboardCounters::stockChanged(int product_id, std::optional<int> old_stock, int new_stock, long long version) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    bool was_out = old_stock && *old_stock == 0;
+    bool out = new_stock == 0;
+    auto it = stock_states.find(product_id);
+    if (it == stock_states.end()) {
+        stock_states.emplace(product_id, StockState{version, version, out});
+    } else if (version > it->second.version) {
+        // Counts any changes in between that have not been reported yet
+        was_out = it->second.out;
+        it->second.version = version;
+        it->second.out = out;
+    } else if (version >= it->second.first_version) {
+        return;
+    }
+    Delta d;
+    d.totals.out_of_stock = (out ? 1 : 0) - (was_out ? 1 : 0);
+    if (d.totals.out_of_stock != 0) {
+        recordLocked(d);
+    }
+}
+
+void DashboardCounters::subscriptionAdded(int product_id, bool active) {
+    Delta d;
+    d.totals.subscriptions = 1;
+    if (active) {
+        d.totals.active_subscriptions = 1;
+        d.product_id = product_id;
+        d.watchers = 1;
+    }
+    apply(d);
+}
+
+void DashboardCounters::subscriptionRemoved(int product_id, bool active) {
+    Delta d;
+    d.totals.subscriptions = -1;
+    if (active) {
+        d.totals.active_subscriptions = -1;
+        d.product_id = product_id;
+        d.watchers = -1;
+    }
+    apply(d);
+}
+
+void DashboardCounters::subscriptionActiveChanged(int product_id, bool was_active, bool active) {
+    if (was_active == active) {
+        return;
+    }
+    Delta d;
+    d.totals.active_subscriptions = active ? 1 : -1;
+    d.product_id = product_id;
+    d.watchers = d.totals.active_subscriptions;
+    apply(d);
+}
+
+void DashboardCounters::notificationLogCreated(const std::string& status) {
+    Delta d;
+    countStatus(d.totals, status, 1);
+    apply(d);
+}
+
+void DashboardCounters::notificationLogStatusChanged(const std::string& from, const std::string& to) {
+    if (from == to) {
+        return;
+    }
+    Delta d;
+    countStatus(d.totals, from, -1);
+    countStatus(d.totals, to, 1);
+    apply(d);
+}
+
+void DashboardCounters::markStale() {
+    {
+        std::lock_guard<std::mutex> lock(reconciler_mutex);
+        stale = true;
+    }
+    reconciler_wake.notify_one();
+}
+
+DashboardCounters::Summary DashboardCounters::summary(size_t top) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    Summary out;
+    out.totals = totals;
+    out.reconciled_at_us = reconciled_at_us;
+    for (auto it = by_watchers.begin(); it != by_watchers.end() && out.top_watched.size() < top; ++it) {
+        out.top_watched.push_back(Watched{it->second, -it->first});
+    }
+    return out;
+}
+
+DashboardCounters::Summary DashboardCounters::summarize(Snapshot snapshot, size_t top) {
+    Summary out;
+    out.totals = snapshot.totals;
+    out.reconciled_at_us = nowMicros();
+    auto byWatchers = [](const Watched& a, const Watched& b) {
+        return a.watchers != b.watchers ? a.watchers > b.watchers : a.product_id < b.product_id;
+    };
+    size_t n = std::min(top, snapshot.watchers.size());
+    std::partial_sort(snapshot.watchers.begin(), snapshot.watchers.begin() + static_cast<std::ptrdiff_t>(n),
+                      snapshot.watchers.end(), byWatchers);
+    snapshot.watchers.resize(n);
+    out.top_watched = std::move(snapshot.watchers);
+    return out;
+}
+
+void DashboardCounters::reconcile(const std::function<Snapshot()>& source) {
+    std::lock_guard<std::mutex> serial(reconcile_serial);
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        capturing = true;
+        captured.clear();
+    }
+    Snapshot snapshot;
+    try {
+        snapshot = source();
+    } catch (...) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        capturing = false;
+        captured.clear();
+        throw;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    totals = snapshot.totals;
+    watchers.clear();
+    by_watchers.clear();
+    watchers.reserve(snapshot.watchers.size());
+    for (const auto& w : snapshot.watchers) {
+        setWatchersLocked(w.product_id, w.watchers);
+    }
+    // A change that committed just before the snapshot may be counted
+    // twice here; the next reconcile settles it
+    for (const auto& d : captured) {
+        applyLocked(d);
+    }
+    capturing = false;
+    captured.clear();
+    reconciled_at_us = nowMicros();
+    loaded.store(true, std::memory_order_release);
+}
+
+void DashboardCounters::startReconciler(std::chrono::seconds interval, std::function<Snapshot()> source) {
+    std::lock_guard<std::mutex> lock(reconciler_mutex);
+    if (reconciler.joinable()) {
+        return;
+    }
+    reconciler = std::thread([this, interval, source = std::move(source)] {
+        std::unique_lock<std::mutex> lock(reconciler_mutex);
+        while (!stopping) {
+            reconciler_wake.wait_for(lock, interval, [&] { return stopping || stale; });
+            if (stopping) {
+                return;
+            }
+            stale = false;
+            lock.unlock();
+            try {
+                reconcile(source);
+            } catch (const std::exception& e) {
+                std::cerr << "❌ Dashboard counter reconcile failed: " << e.what() << std::endl;
+            }
+            // Bursts of cascading deletes trigger at most one reconcile a second
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            lock.lock();
+        }
+    });
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Running totals behind GET /api/dashboard/summary, so the dashboard does
+// not count (or download) whole tables on every view.
+//
+// The write paths report each committed change through the hooks below and
+// the counters move by that delta. A reconciler thread periodically
+// replaces them with counts read from the database (DASHBOARD_RECONCILE_SECONDS,
+// default 60), which also corrects whatever the hooks cannot see: rows
+// removed by ON DELETE CASCADE, and writes made by other processes.
+// Deletes that cascade call markStale() so that reconcile happens soon.
+//
+// Changes reported while a reconcile query runs are replayed on top of its
+// result, so a reconcile does not undo them. Reads take a shared lock.
+class DashboardCounters {
+public:
+    struct Totals {
+        long long products = 0;
+        long long users = 0;
+        long long subscriptions = 0;
+        long long active_subscriptions = 0;
+        long long out_of_stock = 0;
+        long long pending_notifications = 0;
+        long long failed_notifications = 0;
+    };
+
+    // Active subscriptions per product
+    struct Watched {
+        int product_id;
+        long long watchers;
+    };
+
+    struct Snapshot {
+        Totals totals;
+        std::vector<Watched> watchers;
+    };
+
+    struct Summary {
+        Totals totals;
+        std::vector<Watched> top_watched;  // most watchers first
+        int64_t reconciled_at_us = 0;      // microseconds since the Unix epoch
+    };
+
+    static DashboardCounters& instance();
+
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+    Summary summary(size_t top) const;
+    // The same shape computed straight from a database snapshot
+    static Summary summarize(Snapshot snapshot, size_t top);
+
+    // Write-path hooks; call after the transaction has committed.
+    void productCreated();
+    void productRemoved();
+    void userCreated();
+    void userRemoved();
+    // old_stock is nullopt when the inventory row was just created;
+    // `version` is the row's inventory.version. The out-of-stock
+    // count moves from the state last applied for the product, so a change
+    // whose hook runs after a newer one's is already counted and dropped.
+    // Changes older than the first one seen for the product still count by
+    // their own old/new stock.
+    void stockChanged(int product_id, std::optional<int> old_stock, int new_stock, long long version);
+    void subscriptionAdded(int product_id, bool active);
+    void subscriptionRemoved(int product_id, bool active);
+    void subscriptionActiveChanged(int product_id, bool was_active, bool active);
+    void notificationLogCreated(const std::string& status);
+    void notificationLogStatusChanged(const std::string& from, const std::string& to);
+    void markStale();
+
+    // Replaces the counters with `source`'s counts. `source` runs without
+    // the lock held; changes reported meanwhile are replayed afterwards.
+    void reconcile(const std::function<Snapshot()>& source);
+
+    // Runs reconcile(source) every `interval`, or sooner after markStale().
+    void startReconciler(std::chrono::seconds interval, std::function<Snapshot()> source);
+
+private:
+    struct Delta {
+        Totals totals;
+        int product_id = 0;  // watcher change for this product, if any
+        long long watchers = 0;
+    };
+
+    // Stock changes applied for a product: the oldest and newest version
+    // seen, and whether the newest left it out of stock
+    struct StockState {
+        long long first_version;
+        long long version;
+        bool out;
+    };
+
+    DashboardCounters() = default;
+    ~DashboardCounters();
+
+    void apply(const Delta& delta);
+    void recordLocked(const Delta& delta);
+    void applyLocked(const Delta& delta);
+    void setWatchersLocked(int product_id, long long watchers);
+
+    mutable std::shared_mutex mutex;
+    Totals totals;
+    std::unordered_map<int, long long> watchers;
+    std::set<std::pair<long long, int>> by_watchers;  // (-watchers, product_id)
+    std::unordered_map<int, StockState> stock_states;
+    bool capturing = false;
+    std::vector<Delta> captured;
+    int64_t reconciled_at_us = 0;
+    std::atomic<bool> loaded{false};
+
+    std::mutex reconcile_serial;  // one reconcile at a time
+    std::mutex reconciler_mutex;
+    std::condition_variable reconciler_wake;
+    bool stale = false;
+    bool stopping = false;
+    std::thread reconciler;
+};
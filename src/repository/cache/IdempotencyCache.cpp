@@ -0,0 +1,109 @@
+#include "IdempotencyCache.h"
+#include <algorithm>
+#include <functional>
+#include "../../server/Config.h"
+
+IdempotencyCache& IdempotencyCache::instance() {
+    static IdempotencyCache cache;
+    return cache;
+}
+
+IdempotencyCache::IdempotencyCache()
+    : shard_capacity(std::max<size_t>(Config::envSize("IDEMPOTENCY_CACHE_ENTRIES", 10000) / kShards, 1)) {}
+
+IdempotencyCache::Shard& IdempotencyCache::shardFor(const std::string& key) {
+    return shards[std::hash<std::string>()(key) % kShards];
+}
+
+IdempotencyCache::Entry& IdempotencyCache::touchLocked(Shard& shard, const std::string& key) {
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+        return it->second;
+    }
+    if (shard.entries.size() >= shard_capacity) {
+        eraseLocked(shard, shard.entries.find(shard.lru.back()));
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.lru.push_front(key);
+    Entry& entry = shard.entries[key];
+    entry.lru = shard.lru.begin();
+    return entry;
+}
+
+void IdempotencyCache::eraseLocked(Shard& shard, std::unordered_map<std::string, Entry>::iterator it) {
+    shard.lru.erase(it->second.lru);
+    shard.entries.erase(it);
+}
+
+IdempotencyCache::Lookup IdempotencyCache::claim(const std::string& key, const std::string& fingerprint,
+                                                 std::chrono::milliseconds lock_timeout) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto now = Clock::now();
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end() && it->second.expires > now) {
+        Entry& entry = it->second;
+        shard.lru.splice(shard.lru.begin(), shard.lru, entry.lru);
+        if (entry.fingerprint != fingerprint) {
+            mismatches.fetch_add(1, std::memory_order_relaxed);
+            return Lookup{Outcome::Mismatch, {}};
+        }
+        if (entry.pending) {
+            in_flight.fetch_add(1, std::memory_order_relaxed);
+            return Lookup{Outcome::InFlight, {}};
+        }
+        replays.fetch_add(1, std::memory_order_relaxed);
+        return Lookup{Outcome::Replay, entry.response};
+    }
+
+    Entry& entry = touchLocked(shard, key);
+    entry.fingerprint = fingerprint;
+    entry.token = next_token.fetch_add(1, std::memory_order_relaxed);
+    entry.pending = true;
+    entry.response = Response();
+    entry.expires = now + lock_timeout;
+    claims.fetch_add(1, std::memory_order_relaxed);
+    return Lookup{Outcome::Claimed, {}, entry.token};
+}
+
+// An entry evicted or taken over since the claim is left alone; the table
+// still answers for an evicted key.
+void IdempotencyCache::complete(const std::string& key, uint64_t token, Response response,
+                                std::chrono::milliseconds ttl) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end() || it->second.token != token) {
+        return;
+    }
+    Entry& entry = it->second;
+    shard.lru.splice(shard.lru.begin(), shard.lru, entry.lru);
+    entry.pending = false;
+    entry.response = std::move(response);
+    entry.expires = Clock::now() + ttl;
+}
+
+void IdempotencyCache::release(const std::string& key, uint64_t token) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end() && it->second.token == token) {
+        eraseLocked(shard, it);
+    }
+}
+
+IdempotencyCache::Stats IdempotencyCache::stats() const {
+    Stats s;
+    s.claims = claims.load(std::memory_order_relaxed);
+    s.replays = replays.load(std::memory_order_relaxed);
+    s.in_flight = in_flight.load(std::memory_order_relaxed);
+    s.mismatches = mismatches.load(std::memory_order_relaxed);
+    s.evictions = evictions.load(std::memory_order_relaxed);
+    s.capacity = shard_capacity * kShards;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        s.entries += shard.entries.size();
+    }
+    return s;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Recently used Idempotency-Key values and the response each one produced,
+// in front of the idempotency_keys table (repository/postgres/IdempotencyStore.h).
+//
+// Keys are spread over 16 shards, each an LRU list under its own mutex, so
+// concurrent writes with different keys rarely contend. The total size is
+// capped at IDEMPOTENCY_CACHE_ENTRIES (default 10000); the least recently
+// used key of a full shard is dropped, after which the table answers for it.
+// An entry is either in flight (its request is still executing; it expires
+// after the lock timeout so a hung request does not block retries forever)
+// or completed with its response (it expires with the key's TTL).
+//
+// Each claim gets a token, and complete() and release() only act while
+// the entry still belongs to that claim: a request that outlived its lock
+// timeout cannot overwrite or drop the claim of the retry that took over.
+class IdempotencyCache {
+public:
+    struct Response {
+        int status = 0;
+        std::string content_type;
+        std::string body;
+    };
+
+    enum class Outcome {
+        Claimed,   // unknown key: the caller now holds it and executes the request
+        InFlight,  // the same request is still executing
+        Replay,    // completed earlier; `response` holds what it returned
+        Mismatch   // the key was used for a different request
+    };
+
+    struct Lookup {
+        Outcome outcome;
+        Response response;
+        uint64_t token = 0;  // Claimed: identifies the claim to complete() and release()
+    };
+
+    struct Stats {
+        uint64_t claims = 0;
+        uint64_t replays = 0;
+        uint64_t in_flight = 0;
+        uint64_t mismatches = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t capacity = 0;
+    };
+
+    static IdempotencyCache& instance();
+
+    // `fingerprint` identifies the request (method, path, body); a claimed
+    // key stays in flight for at most `lock_timeout`.
+    Lookup claim(const std::string& key, const std::string& fingerprint, std::chrono::milliseconds lock_timeout);
+
+    // Stores the response for `key`, kept for `ttl`, if the claim `token`
+    // still holds it
+    void complete(const std::string& key, uint64_t token, Response response, std::chrono::milliseconds ttl);
+
+    // Forgets `key` if the claim `token` still holds it, e.g. after its
+    // request failed, so a retry executes again
+    void release(const std::string& key, uint64_t token);
+
+    Stats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string fingerprint;
+        uint64_t token = 0;
+        bool pending = true;
+        Response response;
+        Clock::time_point expires;
+        std::list<std::string>::iterator lru;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+        std::list<std::string> lru;  // front = most recently used
+    };
+
+    static constexpr size_t kShards = 16;
+
+    IdempotencyCache();
+
+    Shard& shardFor(const std::string& key);
+    // Inserts or refreshes `key` as the shard's most recent entry, evicting
+    // the least recent one when the shard is full
+    Entry& touchLocked(Shard& shard, const std::string& key);
+    void eraseLocked(Shard& shard, std::unordered_map<std::string, Entry>::iterator it);
+
+    std::array<Shard, kShards> shards;
+    size_t shard_capacity;
+    std::atomic<uint64_t> next_token{1};
+    std::atomic<uint64_t> claims{0};
+    std::atomic<uint64_t> replays{0};
+    std::atomic<uint64_t> in_flight{0};
+    std::atomic<uint64_t> mismatches{0};
+    std::atomic<uint64_t> evictions{0};
+};
@@ -0,0 +1,70 @@
+#include "PreferenceCache.h"
+#include <mutex>
+
+PreferenceCache& PreferenceCache::instance() {
+    static PreferenceCache cache;
+    return cache;
+}
+
+std::optional<domain::NotificationPreference> PreferenceCache::find(int user_id) const {
+    if (!isLoaded()) {
+        return std::nullopt;
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = prefs.find(user_id);
+    if (it == prefs.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void PreferenceCache::put(const domain::NotificationPreference& pref) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    prefs[pref.user_id] = pref;
+    if (loading) {
+        touched_during_load.insert(pref.user_id);
+    }
+}
+
+void PreferenceCache::remove(int user_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    prefs.erase(user_id);
+    if (loading) {
+        touched_during_load.insert(user_id);
+    }
+}
+
+size_t PreferenceCache::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return prefs.size();
+}
+
+void PreferenceCache::beginLoad() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    loading = true;
+    touched_during_load.clear();
+}
+
+void PreferenceCache::load(std::vector<domain::NotificationPreference> rows) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    prefs.reserve(prefs.size() + rows.size());
+    for (auto& row : rows) {
+        if (touched_during_load.count(row.user_id)) {
+            continue;
+        }
+        prefs.emplace(row.user_id, std::move(row));
+    }
+}
+
+void PreferenceCache::finishLoad() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    loading = false;
+    touched_during_load.clear();
+    loaded.store(true, std::memory_order_release);
+}
+
+void PreferenceCache::abortLoad() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    loading = false;
+    touched_during_load.clear();
+}
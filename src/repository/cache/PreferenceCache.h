@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../../domain/notification.h"
+
+// Notification preferences by user id. Read on every notification send,
+// so warm-up bulk-loads the table and NotificationRepo keeps it current.
+// A miss always falls back to the database.
+class PreferenceCache {
+public:
+    static PreferenceCache& instance();
+
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+    std::optional<domain::NotificationPreference> find(int user_id) const;
+    void put(const domain::NotificationPreference& pref);
+    void remove(int user_id);
+    size_t size() const;
+
+    void beginLoad();
+    void load(std::vector<domain::NotificationPreference> rows);
+    void finishLoad();
+    void abortLoad();
+
+private:
+    PreferenceCache() = default;
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<int, domain::NotificationPreference> prefs;
+    std::unordered_set<int> touched_during_load;
+    bool loading = false;
+    std::atomic<bool> loaded{false};
+};
@@ -0,0 +1,57 @@
+#include "SubscriberCounts.h"
+#include <mutex>
+
+SubscriberCounts& SubscriberCounts::instance() {
+    static SubscriberCounts mirror;
+    return mirror;
+}
+
+void SubscriberCounts::applyLocked(const Row& row) {
+    auto it = counts.find(row.product_id);
+    if (it != counts.end() && it->second.version >= row.version) {
+        return;
+    }
+    counts[row.product_id] = Count{row.pending, row.version};
+    if (row.pending > 0) {
+        with_pending.add(static_cast<uint32_t>(row.product_id));
+    } else {
+        with_pending.remove(static_cast<uint32_t>(row.product_id));
+    }
+}
+
+void SubscriberCounts::rebuild(const std::function<std::vector<Row>()>& source) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::vector<Row> rows = source();
+    counts.clear();
+    with_pending.clear();
+    counts.reserve(rows.size());
+    for (const auto& row : rows) {
+        applyLocked(row);
+    }
+    loaded.store(true, std::memory_order_release);
+}
+
+void SubscriberCounts::apply(const Row& row) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    applyLocked(row);
+}
+
+void SubscriberCounts::remove(int product_id) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    counts.erase(product_id);
+    with_pending.remove(static_cast<uint32_t>(product_id));
+}
+
+std::optional<int> SubscriberCounts::pending(int product_id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (!loaded.load(std::memory_order_acquire)) {
+        return std::nullopt;
+    }
+    auto it = counts.find(product_id);
+    return it == counts.end() ? 0 : it->second.pending;
+}
+
+RoaringBitmap SubscriberCounts::withPending() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return with_pending;
+}
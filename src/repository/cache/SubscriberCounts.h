@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "../../index/RoaringBitmap.h"
+
+// In-memory mirror of product_subscriber_counts: pending (not yet sent)
+// restock subscribers per product. Loaded during warm-up and kept current
+// by NotificationRepo, which changes the table in the same transaction as
+// product_notifications and passes on the row it wrote.
+//
+// Every write to a row bumps its `version`, and the mirror only takes a row
+// newer than the one it holds, so two requests finishing out of order (or
+// a write racing the bulk load) cannot leave an older count behind.
+// `with_pending` is a bitmap of the products with pending > 0, for
+// intersecting with StockIndex selections.
+class SubscriberCounts {
+public:
+    struct Row {
+        int product_id;
+        int pending;
+        long long version;
+    };
+
+    static SubscriberCounts& instance();
+
+    bool isLoaded() const { return loaded.load(std::memory_order_acquire); }
+
+    // Replaces the mirror with the rows from `source`, which runs under the
+    // exclusive lock (see TrigramIndex::rebuild).
+    void rebuild(const std::function<std::vector<Row>()>& source);
+
+    void apply(const Row& row);
+    void remove(int product_id);
+
+    // nullopt until loaded
+    std::optional<int> pending(int product_id) const;
+    RoaringBitmap withPending() const;
+
+private:
+    struct Count {
+        int pending;
+        long long version;
+    };
+
+    SubscriberCounts() = default;
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<int, Count> counts;
+    RoaringBitmap with_pending;
+    std::atomic<bool> loaded{false};
+
+    void applyLocked(const Row& row);
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include<string>
+#include<vector>
 #include "domain/inventory.h"
 using namespace std;
 
@@ -9,6 +10,9 @@ class IinventoryRepo
 public:
     virtual void create(int prod_id,int initialStock)=0;
     virtual inventory findProductBy_id(int prod_id)=0;
+    // Inventory rows for `prod_ids` in that order, one query for all of
+    // them; products without a row are skipped
+    virtual vector<inventory> find_by_ids(const vector<int>& prod_ids)=0;
     virtual void update_stock(int prod_id,int new_stock)=0;
     virtual void removeProductBy_id(int prod_id)=0;
     virtual ~IinventoryRepo()=default;
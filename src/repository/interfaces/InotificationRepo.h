@@ -10,9 +10,12 @@ public:
     // Notification subscription operations
     virtual bool subscribeToNotification(int user_id, int product_id, const std::string& type) = 0;
     virtual bool unsubscribeFromNotification(int notification_id) = 0;
-    virtual std::vector<domain::Notification> getUserNotifications(int user_id) = 0;
-    virtual std::vector<domain::Notification> getProductSubscribers(int product_id) = 0;
+    virtual domain::NotificationList getUserNotifications(int user_id) = 0;
+    virtual domain::NotificationList getProductSubscribers(int product_id) = 0;
     virtual domain::Notification getNotificationById(int notification_id) = 0;
+    // Notifications for `notification_ids` in that order, one query for all
+    // of them; ids that do not exist are skipped
+    virtual domain::NotificationList getNotificationsByIds(const std::vector<int>& notification_ids) = 0;
     
     // Check if user is subscribed to product
     virtual bool isUserSubscribed(int user_id, int product_id) = 0;
@@ -24,15 +27,18 @@ public:
     // Notification logging operations (fault tolerance)
     virtual int createNotificationLog(const domain::NotificationLog& log) = 0;
     virtual bool updateNotificationLogStatus(int log_id, const std::string& status, const std::string& message = "") = 0;
-    virtual std::vector<domain::NotificationLog> getNotificationLogs(int user_id, const std::string& status = "") = 0;
-    virtual std::vector<domain::NotificationLog> getFailedNotifications() = 0;
+    virtual domain::NotificationLogList getNotificationLogs(int user_id, const std::string& status = "") = 0;
+    virtual domain::NotificationLogList getFailedNotifications() = 0;
     virtual bool incrementRetryCount(int log_id) = 0;
     
     // Notification preferences
     virtual bool createNotificationPreference(int user_id) = 0;
     virtual domain::NotificationPreference getNotificationPreference(int user_id) = 0;
+    // Preferences for each of `user_ids` (result[i] for user_ids[i]); users
+    // without a row get one created with the defaults, as above
+    virtual std::vector<domain::NotificationPreference> getNotificationPreferences(const std::vector<int>& user_ids) = 0;
     virtual bool updateNotificationPreference(const domain::NotificationPreference& pref) = 0;
     
     // Get all pending notifications (unsent)
-    virtual std::vector<domain::Notification> getPendingNotifications() = 0;
+    virtual domain::NotificationList getPendingNotifications() = 0;
 };
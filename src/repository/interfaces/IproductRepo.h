@@ -9,7 +9,19 @@ class IproductRepo
 public:
    virtual int create(string name,string description)=0;
    virtual product find_by_id(int prod_id)=0;
+   // Products for `prod_ids` in that order, one query for all of them;
+   // ids that do not exist are skipped
+   virtual vector<product> find_by_ids(const vector<int>& prod_ids)=0;
    virtual vector<product> find_by_name(string name)=0;
+   // Substring matches plus fuzzy matches with similarity >= min_similarity,
+   // most similar first, at most `limit` rows (pg_trgm)
+   virtual vector<product> search_ranked(string name,size_t limit,double min_similarity)=0;
+   // Full-text match on name + description (any term), best first, at most
+   // `limit` rows
+   virtual vector<product> search_fulltext(string query,size_t limit)=0;
+   // Names starting with `prefix` (case-insensitive), ordered by lowercased
+   // name, at most `limit` rows
+   virtual vector<product> find_by_prefix(string prefix,size_t limit)=0;
    virtual void update(int prod_id,string name,string description)=0;
    virtual void remove(int prod_id)=0;
    virtual ~IproductRepo()=default;
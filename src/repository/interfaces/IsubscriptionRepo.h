@@ -6,6 +6,9 @@ public:
     virtual void subscribe(int prod_id, int user_id) = 0;
     virtual void unsubscribe(int prod_id, int user_id) = 0;
     virtual std::vector<int> find_subscribers(int prod_id) = 0;
+    // Subscribers of each of `prod_ids` (result[i] for prod_ids[i]), one
+    // query for all of them
+    virtual std::vector<std::vector<int>> find_subscribers_by_ids(const std::vector<int>& prod_ids) = 0;
 
     virtual ~IsubscriptionRepo() = default;
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include "domain/user.h"
 #include<string>
+#include<vector>
 using namespace std;
 
 class IuserRepo
@@ -9,6 +10,9 @@ public:
     virtual int create(string name,string email,string role)=0;
     virtual user find_by_name(string name)=0;
     virtual user find_by_id(int user_id)=0;
+    // Users for `user_ids` in that order, one query for all of them; ids
+    // that do not exist are skipped
+    virtual vector<user> find_by_ids(const vector<int>& user_ids)=0;
     virtual user find_by_email(string email)=0;
     virtual ~IuserRepo()=default;
 };
\ No newline at end of file
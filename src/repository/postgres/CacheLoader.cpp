@@ -0,0 +1,190 @@
+#include "CacheLoader.h"
+#include "PostgresConnection.h"
+#include "../cache/CatalogCache.h"
+#include "../cache/PreferenceCache.h"
+#include <future>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<CatalogCache::Entry> streamProducts() {
+    pqxx::connection conn(PostgresConnection::dsn());
+    pqxx::work txn(conn);
+    std::vector<CatalogCache::Entry> rows;
+    for (auto [id, name, description, version] : txn.stream<int, std::string, std::optional<std::string>, long long>(
+             "SELECT id, name, description, version FROM products")) {
+        CatalogCache::Entry e;
+        e.id = id;
+        e.name = std::move(name);
+        e.description = description ? std::move(*description) : std::string();
+        e.product_version = version;
+        rows.push_back(std::move(e));
+    }
+    txn.commit();
+    return rows;
+}
+
+std::vector<CatalogCache::StockRow> streamInventory() {
+    pqxx::connection conn(PostgresConnection::dsn());
+    pqxx::work txn(conn);
+    std::vector<CatalogCache::StockRow> rows;
+    for (auto [product_id, stock, reorder_point, updated_at, version] :
+         txn.stream<int, int, int, std::optional<std::string>, std::optional<long long>>(
+             "SELECT product_id, stock, reorder_point, updated_at, version FROM inventory")) {
+        rows.push_back(CatalogCache::StockRow{product_id, stock, reorder_point,
+                                              updated_at ? std::move(*updated_at) : std::string(),
+                                              version.value_or(0)});
+    }
+    txn.commit();
+    return rows;
+}
+
+std::vector<domain::NotificationPreference> streamPreferences() {
+    pqxx::connection conn(PostgresConnection::dsn());
+    pqxx::work txn(conn);
+    std::vector<domain::NotificationPreference> rows;
+    for (auto [id, user_id, email, push, sms, in_app, created_at, updated_at] :
+         txn.stream<int, int, bool, bool, bool, bool, std::string, std::string>(
+             "SELECT id, user_id, email_enabled, push_enabled, sms_enabled, in_app_enabled, created_at, updated_at "
+             "FROM notification_preferences")) {
+        domain::NotificationPreference pref;
+        pref.id = id;
+        pref.user_id = user_id;
+        pref.email_enabled = email;
+        pref.push_enabled = push;
+        pref.sms_enabled = sms;
+        pref.in_app_enabled = in_app;
+        pref.created_at = std::move(created_at);
+        pref.updated_at = std::move(updated_at);
+        rows.push_back(std::move(pref));
+    }
+    txn.commit();
+    return rows;
+}
+
+} // namespace
+
+void CacheLoader::loadHotData() {
+    CatalogCache& catalog = CatalogCache::instance();
+    PreferenceCache& preferences = PreferenceCache::instance();
+    catalog.beginLoad();
+    preferences.beginLoad();
+
+    auto products = std::async(std::launch::async, streamProducts);
+    auto inventory = std::async(std::launch::async, streamInventory);
+    auto prefs = std::async(std::launch::async, streamPreferences);
+
+    std::string errors;
+    try {
+        catalog.loadProducts(products.get());
+        catalog.loadStock(inventory.get());
+        catalog.finishLoad();
+        std::cout << "✅ Catalog cache loaded: " << catalog.size() << " products" << std::endl;
+    } catch (const std::exception& e) {
+        errors += std::string("catalog: ") + e.what() + "; ";
+        catalog.abortLoad();
+        try {
+            inventory.get();
+        } catch (...) {
+        }
+    }
+
+    try {
+        preferences.load(prefs.get());
+        preferences.finishLoad();
+        std::cout << "✅ Preference cache loaded: " << preferences.size() << " users" << std::endl;
+    } catch (const std::exception& e) {
+        errors += std::string("preferences: ") + e.what() + "; ";
+        preferences.abortLoad();
+    }
+
+    if (!errors.empty()) {
+        throw std::runtime_error(errors);
+    }
+}
+
+StockHistory::Snapshot CacheLoader::loadStockHistory(size_t depth) {
+    pqxx::connection conn(PostgresConnection::dsn());
+    pqxx::work txn(conn);
+    StockHistory::Snapshot snapshot;
+
+    // One row past `depth` tells whether a product has older movements
+    for (auto [product_id, at_us, delta, stock_after] :
+         txn.stream<int, long long, int, int>(
+             "SELECT hot.product_id, (extract(epoch FROM e.occurred_at) * 1000000)::bigint, e.delta, e.stock_after "
+             "FROM (SELECT DISTINCT product_id FROM inventory_events "
+             "      WHERE occurred_at > now() - interval '24 hours') hot "
+             "CROSS JOIN LATERAL (SELECT id, occurred_at, delta, stock_after FROM inventory_events "
+             "      WHERE product_id = hot.product_id "
+             "      ORDER BY occurred_at DESC, id DESC LIMIT " + std::to_string(depth + 1) + ") e "
+             "ORDER BY hot.product_id, e.occurred_at, e.id")) {
+        auto id = static_cast<uint32_t>(product_id);
+        if (snapshot.rings.empty() || snapshot.rings.back().id != id) {
+            snapshot.rings.push_back(StockHistory::Seed{id, {}, true});
+        }
+        snapshot.rings.back().movements.push_back(StockHistory::Movement{at_us, delta, stock_after});
+    }
+    for (auto& seed : snapshot.rings) {
+        if (seed.movements.size() > depth) {
+            seed.movements.erase(seed.movements.begin());
+            seed.complete = false;
+        }
+    }
+
+    for (auto [product_id, minute, units] :
+         txn.stream<int, long long, long long>(
+             "SELECT product_id, floor(extract(epoch FROM occurred_at) / 60)::bigint, -SUM(delta) "
+             "FROM inventory_events "
+             "WHERE occurred_at > now() - interval '24 hours' AND delta < 0 "
+             "GROUP BY 1, 2")) {
+        snapshot.sold.push_back(StockHistory::SoldMinute{static_cast<uint32_t>(product_id), minute, units});
+    }
+    txn.commit();
+    return snapshot;
+}
+
+DashboardCounters::Snapshot CacheLoader::loadDashboardCounts() {
+    pqxx::connection conn(PostgresConnection::dsn());
+    pqxx::work txn(conn);
+    txn.exec("SET TRANSACTION ISOLATION LEVEL REPEATABLE READ READ ONLY");
+    DashboardCounters::Snapshot snapshot;
+
+    pqxx::row totals = txn.exec1(
+        "SELECT (SELECT count(*) FROM products), "
+        "       (SELECT count(*) FROM users), "
+        "       (SELECT count(*) FROM subscriptions), "
+        "       (SELECT count(*) FROM subscriptions WHERE active), "
+        "       (SELECT count(*) FROM inventory WHERE stock = 0), "
+        "       (SELECT count(*) FROM notification_logs WHERE status = 'pending'), "
+        "       (SELECT count(*) FROM notification_logs WHERE status = 'failed')");
+    snapshot.totals.products = totals[0].as<long long>();
+    snapshot.totals.users = totals[1].as<long long>();
+    snapshot.totals.subscriptions = totals[2].as<long long>();
+    snapshot.totals.active_subscriptions = totals[3].as<long long>();
+    snapshot.totals.out_of_stock = totals[4].as<long long>();
+    snapshot.totals.pending_notifications = totals[5].as<long long>();
+    snapshot.totals.failed_notifications = totals[6].as<long long>();
+
+    for (auto [product_id, count] : txn.stream<int, long long>(
+             "SELECT product_id, count(*) FROM subscriptions WHERE active GROUP BY product_id")) {
+        snapshot.watchers.push_back(DashboardCounters::Watched{product_id, count});
+    }
+    txn.commit();
+    return snapshot;
+}
+
+std::vector<SubscriberCounts::Row> CacheLoader::loadSubscriberCounts() {
+    pqxx::connection conn(PostgresConnection::dsn());
+    pqxx::work txn(conn);
+    std::vector<SubscriberCounts::Row> rows;
+    for (auto [product_id, pending, version] :
+         txn.stream<int, int, long long>("SELECT product_id, pending, version FROM product_subscriber_counts")) {
+        rows.push_back(SubscriberCounts::Row{product_id, pending, version});
+    }
+    txn.commit();
+    return rows;
+}
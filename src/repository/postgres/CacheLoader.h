@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "../../index/StockHistory.h"
+#include "../cache/DashboardCounters.h"
+#include "../cache/SubscriberCounts.h"
+
+// Bulk loaders used by the warm-up sequence.
+namespace CacheLoader {
+
+// Streams products, inventory and notification preferences over three
+// dedicated connections in parallel and fills CatalogCache and
+// PreferenceCache. Throws if any of the loads failed; the caches whose
+// load succeeded are still marked loaded.
+void loadHotData();
+
+// Seed for StockHistory: the newest `depth` movements of every product that
+// moved in the last 24 hours (one indexed lookup each), and those products'
+// units sold per minute over the same day.
+StockHistory::Snapshot loadStockHistory(size_t depth);
+
+// Dashboard totals and active subscriptions per product, counted in one
+// repeatable-read transaction so they agree with each other.
+DashboardCounters::Snapshot loadDashboardCounts();
+
+// Every row of product_subscriber_counts.
+std::vector<SubscriberCounts::Row> loadSubscriberCounts();
+
+} // namespace CacheLoader
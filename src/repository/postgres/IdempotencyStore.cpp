@@ -0,0 +1,120 @@
+#include "IdempotencyStore.h"
+#include "PostgresConnection.h"
+#include "../../server/Config.h"
+#include <iostream>
+#include <stdexcept>
+
+IdempotencyStore& IdempotencyStore::instance() {
+    static IdempotencyStore store;
+    return store;
+}
+
+IdempotencyStore::IdempotencyStore()
+    : key_ttl(std::chrono::seconds(Config::envSize("IDEMPOTENCY_TTL_SECONDS", 86400))),
+      lock_timeout(std::chrono::seconds(Config::envSize("IDEMPOTENCY_LOCK_SECONDS", 60))),
+      purge_interval(Config::envSize("IDEMPOTENCY_PURGE_SECONDS", 300)) {}
+
+IdempotencyStore::~IdempotencyStore() {
+    {
+        std::lock_guard<std::mutex> lock(purger_mutex);
+        stopping = true;
+    }
+    purger_wake.notify_one();
+    if (purger.joinable()) {
+        purger.join();
+    }
+}
+
+// The insert takes over a row that has expired, or whose request has been
+// in flight for longer than the lock timeout. Otherwise ON CONFLICT leaves
+// the row alone but locks it, so the select that follows in the same
+// transaction is guaranteed to find it. A takeover draws a new claim token.
+std::optional<int64_t> IdempotencyStore::claim(const std::string& client, const std::string& key,
+                                               const std::string& fingerprint, Existing& existing) {
+    pqxx::work txn(PostgresConnection::getConnection());
+    pqxx::result claimed = txn.exec_params(
+        "INSERT INTO idempotency_keys (client, key, fingerprint, created_at, expires_at) "
+        "VALUES ($1, $2, $3, now(), now() + $4 * interval '1 millisecond') "
+        "ON CONFLICT (client, key) DO UPDATE SET fingerprint = EXCLUDED.fingerprint, "
+        "claim_token = EXCLUDED.claim_token, status = NULL, content_type = NULL, body = NULL, "
+        "created_at = EXCLUDED.created_at, expires_at = EXCLUDED.expires_at "
+        "WHERE idempotency_keys.expires_at <= now() "
+        "OR (idempotency_keys.status IS NULL "
+        "AND idempotency_keys.created_at <= now() - $5 * interval '1 millisecond') "
+        "RETURNING claim_token",
+        client, key, fingerprint, static_cast<long long>(key_ttl.count()),
+        static_cast<long long>(lock_timeout.count()));
+    if (!claimed.empty()) {
+        txn.commit();
+        return claimed[0][0].as<int64_t>();
+    }
+
+    pqxx::result row = txn.exec_params(
+        "SELECT fingerprint, status, content_type, body, "
+        "(extract(epoch FROM expires_at - now()) * 1000)::bigint "
+        "FROM idempotency_keys WHERE client = $1 AND key = $2",
+        client, key);
+    txn.commit();
+    if (row.empty()) {
+        throw std::runtime_error("idempotency key vanished while locked");
+    }
+    existing.fingerprint = row[0][0].as<std::string>();
+    existing.remaining = std::chrono::milliseconds(row[0][4].as<long long>());
+    if (row[0][1].is_null()) {
+        existing.response.reset();
+    } else {
+        existing.response = IdempotencyCache::Response{row[0][1].as<int>(), row[0][2].as<std::string>(),
+                                                       row[0][3].as<std::string>()};
+    }
+    return std::nullopt;
+}
+
+void IdempotencyStore::complete(const std::string& client, const std::string& key, int64_t token,
+                                const IdempotencyCache::Response& response) {
+    pqxx::work txn(PostgresConnection::getConnection());
+    txn.exec_params("UPDATE idempotency_keys SET status = $4, content_type = $5, body = $6 "
+                    "WHERE client = $1 AND key = $2 AND claim_token = $3 AND status IS NULL",
+                    client, key, token, response.status, response.content_type, response.body);
+    txn.commit();
+}
+
+void IdempotencyStore::release(const std::string& client, const std::string& key, int64_t token) {
+    pqxx::work txn(PostgresConnection::getConnection());
+    txn.exec_params(
+        "DELETE FROM idempotency_keys WHERE client = $1 AND key = $2 AND claim_token = $3 AND status IS NULL",
+        client, key, token);
+    txn.commit();
+}
+
+size_t IdempotencyStore::purgeExpired() {
+    pqxx::work txn(PostgresConnection::getConnection());
+    pqxx::result deleted = txn.exec("DELETE FROM idempotency_keys WHERE expires_at <= now()");
+    txn.commit();
+    return static_cast<size_t>(deleted.affected_rows());
+}
+
+void IdempotencyStore::startPurger() {
+    std::lock_guard<std::mutex> lock(purger_mutex);
+    if (purger.joinable()) {
+        return;
+    }
+    purger = std::thread([this] {
+        std::unique_lock<std::mutex> lock(purger_mutex);
+        while (!stopping) {
+            purger_wake.wait_for(lock, purge_interval, [&] { return stopping; });
+            if (stopping) {
+                return;
+            }
+            lock.unlock();
+            try {
+                size_t n = purgeExpired();
+                if (n > 0) {
+                    std::cout << "🧹 Purged " << n << " expired idempotency keys" << std::endl;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "❌ Idempotency key purge failed: " << e.what() << std::endl;
+            }
+            lock.lock();
+        }
+    });
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include "../cache/IdempotencyCache.h"
+
+// The idempotency_keys table (db/idempotency_migration.sql): every
+// Idempotency-Key seen in the last IDEMPOTENCY_TTL_SECONDS, per client, with
+// the response it produced, shared by all API processes and surviving
+// restarts. IdempotencyCache answers most lookups; this is consulted when
+// the cache does not know a key.
+//
+// A row is inserted (claimed) before the request executes, with no
+// response, and filled in once it has run. A claim whose request never
+// finished - the process died - can be taken over after the lock timeout.
+// Every claim is stamped with a fresh claim token, and complete() and
+// release() only touch the row while it carries theirs, so a request that
+// outlived the lock timeout leaves the claim that took over alone.
+// Expired rows are deleted by a background thread every
+// IDEMPOTENCY_PURGE_SECONDS (default 300).
+class IdempotencyStore {
+public:
+    struct Existing {
+        std::string fingerprint;
+        std::optional<IdempotencyCache::Response> response;  // nullopt while in flight
+        std::chrono::milliseconds remaining{0};              // until the row expires
+    };
+
+    static IdempotencyStore& instance();
+
+    std::chrono::milliseconds ttl() const { return key_ttl; }
+    std::chrono::milliseconds lockTimeout() const { return lock_timeout; }
+
+    // Inserts `client`'s `key` as in flight and returns the claim token.
+    // nullopt when a live row already holds it; `existing` then describes
+    // that row.
+    std::optional<int64_t> claim(const std::string& client, const std::string& key, const std::string& fingerprint,
+                                 Existing& existing);
+    void complete(const std::string& client, const std::string& key, int64_t token,
+                  const IdempotencyCache::Response& response);
+    void release(const std::string& client, const std::string& key, int64_t token);
+
+    // Deletes expired rows; returns how many
+    size_t purgeExpired();
+    void startPurger();
+
+private:
+    IdempotencyStore();
+    ~IdempotencyStore();
+
+    std::chrono::milliseconds key_ttl;
+    std::chrono::milliseconds lock_timeout;
+    std::chrono::seconds purge_interval;
+
+    std::mutex purger_mutex;
+    std::condition_variable purger_wake;
+    bool stopping = false;
+    std::thread purger;
+};
@@ -0,0 +1,179 @@
+#include "InventoryEventLog.h"
+#include "PostgresConnection.h"
+#include "../../server/Config.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Postgres array literal, e.g. {1,-2,3}
+template <typename Field>
+std::string arrayLiteral(const std::vector<InventoryEventLog::Event>& batch, Field field) {
+    std::string out = "{";
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        out += std::to_string(field(batch[i]));
+    }
+    out += '}';
+    return out;
+}
+
+// One INSERT per batch: the columns travel as four array parameters and
+// are zipped back into rows by unnest. occurred_at is built from the
+// microsecond count exactly (to_timestamp(double) would round). The join
+// skips events of products deleted since, which the foreign key would
+// otherwise reject along with the rest of the batch.
+void writeBatch(pqxx::connection& conn, const std::vector<InventoryEventLog::Event>& batch) {
+    using Event = InventoryEventLog::Event;
+    pqxx::work txn(conn);
+    txn.exec_params(
+        "INSERT INTO inventory_events (product_id, delta, stock_after, occurred_at) "
+        "SELECT e.p, e.d, e.s, to_timestamp(0) + e.t * interval '1 microsecond' "
+        "FROM unnest($1::int[], $2::int[], $3::int[], $4::bigint[]) AS e(p, d, s, t) "
+        "JOIN products ON products.id = e.p",
+        arrayLiteral(batch, [](const Event& e) { return e.product_id; }),
+        arrayLiteral(batch, [](const Event& e) { return e.delta; }),
+        arrayLiteral(batch, [](const Event& e) { return e.stock_after; }),
+        arrayLiteral(batch, [](const Event& e) { return static_cast<long long>(e.occurred_at_us); }));
+    txn.commit();
+}
+
+// Errors worth retrying the same batch for: connection exceptions (08),
+// transaction rollbacks such as serialization failures (40), insufficient
+// resources (53), operator intervention (57) and system errors (58)
+bool transient(const pqxx::sql_error& e) {
+    const std::string& state = e.sqlstate();
+    for (const char* cls : {"08", "40", "53", "57", "58"}) {
+        if (state.compare(0, 2, cls) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// After the database rejected a batch: writes it one event at a time and
+// drops (and logs) the events that fail on their own
+void writeEach(pqxx::connection& conn, const std::vector<InventoryEventLog::Event>& batch) {
+    for (const auto& event : batch) {
+        try {
+            writeBatch(conn, {event});
+        } catch (const pqxx::sql_error& e) {
+            if (transient(e)) {
+                throw;
+            }
+            std::cerr << "❌ Dropped inventory event for product " << event.product_id << " (delta " << event.delta
+                      << "): " << e.what() << "\n";
+        }
+    }
+}
+
+} // namespace
+
+InventoryEventLog& InventoryEventLog::instance() {
+    static InventoryEventLog log;
+    return log;
+}
+
+InventoryEventLog::InventoryEventLog()
+    : batch_size(std::max<size_t>(Config::envSize("INVENTORY_EVENTS_BATCH", 500), 1)),
+      max_queue(std::max<size_t>(Config::envSize("INVENTORY_EVENTS_QUEUE", 100000), 1)),
+      append_wait(static_cast<long>(Config::envSize("INVENTORY_EVENTS_APPEND_WAIT_MS", 50))),
+      interval(static_cast<long>(Config::envSize("INVENTORY_EVENTS_FLUSH_MS", 200))) {}
+
+InventoryEventLog::~InventoryEventLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void InventoryEventLog::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!worker.joinable()) {
+        worker = std::thread([this] { run(); });
+    }
+}
+
+void InventoryEventLog::append(const Event& event) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!drained.wait_for(lock, append_wait, [&] { return queue.size() < max_queue || stopping; })) {
+        // Logged for the first drop and every 1000th after it
+        if (dropped++ % 1000 == 0) {
+            std::cerr << "❌ Inventory event queue full, dropped " << dropped << " events so far\n";
+        }
+        return;
+    }
+    queue.push_back(event);
+    ++appended;
+    if (queue.size() == batch_size) {
+        wake.notify_one();
+    }
+}
+
+bool InventoryEventLog::flush(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = appended;
+    flush_target = std::max(flush_target, target);
+    wake.notify_one();
+    return drained.wait_for(lock, timeout, [&] { return written >= target; });
+}
+
+void InventoryEventLog::run() {
+    std::unique_ptr<pqxx::connection> conn;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait_for(lock, interval, [&] {
+            return stopping || queue.size() >= batch_size || written < flush_target;
+        });
+        if (queue.empty()) {
+            if (stopping) {
+                return;
+            }
+            continue;
+        }
+
+        size_t n = std::min(queue.size(), batch_size);
+        std::vector<Event> batch(queue.begin(), queue.begin() + static_cast<std::ptrdiff_t>(n));
+        lock.unlock();
+        bool ok = false;
+        try {
+            if (!conn) {
+                conn = std::make_unique<pqxx::connection>(PostgresConnection::dsn());
+            }
+            try {
+                writeBatch(*conn, batch);
+            } catch (const pqxx::sql_error& e) {
+                if (transient(e)) {
+                    throw;
+                }
+                std::cerr << "❌ Inventory event batch rejected, writing it event by event: " << e.what() << "\n";
+                writeEach(*conn, batch);
+            }
+            ok = true;
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Failed to write " << n << " inventory events (will retry): " << e.what() << "\n";
+            conn.reset();
+        }
+        lock.lock();
+
+        if (ok) {
+            queue.erase(queue.begin(), queue.begin() + static_cast<std::ptrdiff_t>(n));
+            written += n;
+            drained.notify_all();
+        } else if (stopping) {
+            return;
+        } else {
+            // Back off one interval before retrying the same batch
+            wake.wait_for(lock, interval, [&] { return stopping; });
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Append-only writer for the inventory_events table.
+//
+// Stock writes enqueue their movement after their own transaction commits;
+// a background thread drains the queue every INVENTORY_EVENTS_FLUSH_MS
+// (default 200) or as soon as INVENTORY_EVENTS_BATCH (default 500) events
+// are waiting, inserting each batch with one statement on its own
+// connection. Events of products deleted meanwhile are skipped. A batch
+// that fails for a transient reason (lost connection, serialization
+// failure, server shutting down) stays queued and is retried on the next
+// tick; one the database rejects outright is written event by event, and
+// events that still fail are logged and dropped so they cannot hold up the
+// ones behind them.
+//
+// The log is therefore up to one flush interval behind inventory, and
+// events still queued when the process dies are lost; inventory itself is
+// unaffected. When INVENTORY_EVENTS_QUEUE (default 100000) events are
+// waiting, append() waits up to INVENTORY_EVENTS_APPEND_WAIT_MS (default
+// 50) for the writer to catch up and then drops the event, so a stalled
+// writer slows stock writes down but never blocks them.
+class InventoryEventLog {
+public:
+    struct Event {
+        int product_id;
+        int delta;
+        int stock_after;
+        int64_t occurred_at_us;  // microseconds since the Unix epoch (UTC)
+    };
+
+    static InventoryEventLog& instance();
+
+    void start();
+    void append(const Event& event);
+
+    // Waits (up to `timeout`) until everything appended so far is written;
+    // false on timeout.
+    bool flush(std::chrono::milliseconds timeout);
+
+private:
+    InventoryEventLog();
+    ~InventoryEventLog();
+    void run();
+
+    std::mutex mutex;
+    std::condition_variable wake;     // writer: work or stop
+    std::condition_variable drained;  // appenders/flushers: progress
+    std::deque<Event> queue;
+    uint64_t appended = 0;
+    uint64_t written = 0;
+    uint64_t flush_target = 0;
+    bool stopping = false;
+    size_t batch_size;
+    size_t max_queue;
+    std::chrono::milliseconds append_wait;
+    uint64_t dropped = 0;
+    std::chrono::milliseconds interval;
+    std::thread worker;
+};
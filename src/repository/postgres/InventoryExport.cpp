@@ -0,0 +1,32 @@
+#include "InventoryExport.h"
+#include "PostgresConnection.h"
+#include "ReplicaRouter.h"
+#include "../../export/SnapshotWriter.h"
+#include <optional>
+#include <string>
+
+size_t InventoryExport::writeSnapshot(const std::string& path) {
+    SnapshotWriter writer;
+
+    // Dedicated connection: the stream holds it for the whole scan. The
+    // snapshot is allowed to be stale, so the scan runs on the replica
+    // when there is a healthy one
+    pqxx::connection conn(ReplicaRouter::readsFromReplica() ? ReplicaRouter::instance().dsn().c_str()
+                                                            : PostgresConnection::dsn());
+    pqxx::work txn(conn);
+    pqxx::result count = txn.exec("SELECT count(*) FROM products");
+    writer.reserve(count[0][0].as<size_t>());
+
+    // updated_at is a TIMESTAMP without time zone; its epoch is taken as UTC
+    for (auto [id, name, stock, updated_at_us] :
+         txn.stream<int, std::string, std::optional<int>, std::optional<long long>>(
+             "SELECT p.id, p.name, i.stock, (extract(epoch FROM i.updated_at) * 1000000)::bigint "
+             "FROM products p LEFT JOIN inventory i ON i.product_id = p.id "
+             "ORDER BY p.id")) {
+        writer.add(id, name, stock ? *stock : -1, updated_at_us ? *updated_at_us : 0);
+    }
+    txn.commit();
+
+    writer.writeTo(path);
+    return writer.rows();
+}
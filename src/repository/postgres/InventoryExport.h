@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Bulk exports served by ExportController.
+namespace InventoryExport {
+
+// Streams every product joined with its inventory row, in id order, into a
+// columnar snapshot file at `path` (format: export/InventorySnapshot.h) and
+// returns the number of rows written. The file is replaced atomically.
+size_t writeSnapshot(const std::string& path);
+
+} // namespace InventoryExport
@@ -1,9 +1,11 @@
 #include<pqxx/pqxx>
 #include <vector>
 #include <string>
+#include <unordered_map>
 using namespace std;
 
 #include "PostgresConnection.h"
+#include "PgArray.h"
 #include "../interfaces/IinventoryRepo.h"
 #include "../../domain/inventory.h"
 class InventoryRepo : public IinventoryRepo {
@@ -20,13 +22,13 @@ class InventoryRepo : public IinventoryRepo {
         txn.commit();
     }
     inventory findProductBy_id(int prod_id)override{
-        pqxx::work txn(PostgresConnection::getConnection());
-
-        pqxx::result r = txn.exec_params(
-            "SELECT product_id, stock "
-            "FROM inventory WHERE product_id = $1",
-            prod_id
-        );
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT product_id, stock "
+                "FROM inventory WHERE product_id = $1",
+                prod_id
+            );
+        });
 
         if (r.empty()) {
             throw std::runtime_error("Inventory not found");
@@ -37,11 +39,38 @@ class InventoryRepo : public IinventoryRepo {
             r[0]["stock"].as<int>()
         );
     }
+    vector<inventory> find_by_ids(const vector<int>& prod_ids)override{
+        vector<inventory> rows;
+        if (prod_ids.empty()) {
+            return rows;
+        }
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT product_id, stock "
+                "FROM inventory WHERE product_id = ANY($1::int[])",
+                pgarray::ints(prod_ids)
+            );
+        });
+
+        unordered_map<int, int> stock;
+        stock.reserve(r.size());
+        for (const auto& row : r) {
+            stock.emplace(row["product_id"].as<int>(), row["stock"].as<int>());
+        }
+        rows.reserve(stock.size());
+        for (int id : prod_ids) {
+            auto it = stock.find(id);
+            if (it != stock.end()) {
+                rows.emplace_back(id, it->second);
+            }
+        }
+        return rows;
+    }
     void update_stock(int prod_id,int new_stock)override{
         pqxx::work txn(PostgresConnection::getConnection());
 
         txn.exec_params(
-            "UPDATE inventory SET stock = $1, updated_at = NOW() "
+            "UPDATE inventory SET stock = $1, updated_at = NOW(), version = version + 1 "
             "WHERE product_id = $2",
             new_stock,
             prod_id
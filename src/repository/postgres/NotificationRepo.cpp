@@ -1,6 +1,54 @@
 #include "NotificationRepo.h"
 #include "../postgres/PostgresConnection.h"
+#include "PgArray.h"
+#include "NotificationRows.h"
+#include "../cache/PreferenceCache.h"
+#include "../cache/DashboardCounters.h"
+#include "../cache/SubscriberCounts.h"
+#include "../../server/RequestArena.h"
 #include <iostream>
+#include <optional>
+#include <unordered_map>
+
+namespace {
+
+// Moves a product's pending-subscriber count by `delta` inside `txn` and
+// returns the row written, for SubscriberCounts once `txn` has committed.
+// Clamped at zero so a count that drifted cannot fail the caller's write.
+SubscriberCounts::Row adjustPendingCount(pqxx::work& txn, int product_id, int delta) {
+    pqxx::row r = txn.exec_params1(
+        "INSERT INTO product_subscriber_counts (product_id, pending) VALUES ($1, GREATEST($2, 0)) "
+        "ON CONFLICT (product_id) DO UPDATE "
+        "SET pending = GREATEST(product_subscriber_counts.pending + $2, 0), "
+        "    version = product_subscriber_counts.version + 1 "
+        "RETURNING pending, version",
+        product_id, delta
+    );
+    return SubscriberCounts::Row{product_id, r[0].as<int>(), r[1].as<long long>()};
+}
+
+// Statements whose rows are decoded with rowmap (see NotificationRows.h);
+// their column lists come from the struct declarations
+const std::string kNotificationsByUser = rowmap::select<domain::Notification>(
+    "FROM product_notifications WHERE user_id = $1 ORDER BY created_at DESC");
+const std::string kNotificationsByProduct = rowmap::select<domain::Notification>(
+    "FROM product_notifications WHERE product_id = $1 ORDER BY created_at DESC");
+const std::string kNotificationById = rowmap::select<domain::Notification>(
+    "FROM product_notifications WHERE id = $1");
+const std::string kNotificationsByIds = rowmap::select<domain::Notification>(
+    "FROM product_notifications WHERE id = ANY($1::int[])");
+const std::string kPendingNotifications = rowmap::select<domain::Notification>(
+    "FROM product_notifications WHERE is_sent = FALSE ORDER BY created_at ASC");
+const std::string kLogsByUser = rowmap::select<domain::NotificationLog>(
+    "FROM notification_logs WHERE user_id = $1 ORDER BY created_at DESC");
+const std::string kLogsByUserAndStatus = rowmap::select<domain::NotificationLog>(
+    "FROM notification_logs WHERE user_id = $1 AND status = $2 ORDER BY created_at DESC");
+const std::string kRetryableLogs = rowmap::select<domain::NotificationLog>(
+    "FROM notification_logs WHERE status = 'failed' AND retry_count < max_retries ORDER BY created_at ASC");
+const std::string kPreferencesByUsers = rowmap::select<domain::NotificationPreference>(
+    "FROM notification_preferences WHERE user_id = ANY($1::int[])");
+
+} // namespace
 
 NotificationRepo::NotificationRepo() {}
 
@@ -11,10 +59,12 @@ bool NotificationRepo::subscribeToNotification(int user_id, int product_id, cons
         
         // Check if already subscribed
         pqxx::result r = txn.exec_params(
-            "SELECT id FROM product_notifications WHERE user_id = $1 AND product_id = $2 AND notification_type = $3",
+            "SELECT id, is_sent FROM product_notifications "
+            "WHERE user_id = $1 AND product_id = $2 AND notification_type = $3 FOR UPDATE",
             user_id, product_id, type
         );
         
+        std::optional<SubscriberCounts::Row> count;
         if (!r.empty()) {
             // Already subscribed, just reset is_sent to false
             txn.exec_params(
@@ -22,6 +72,9 @@ bool NotificationRepo::subscribeToNotification(int user_id, int product_id, cons
                 "WHERE user_id = $1 AND product_id = $2 AND notification_type = $3",
                 user_id, product_id, type
             );
+            if (r[0][1].as<bool>(false)) {
+                count = adjustPendingCount(txn, product_id, 1);
+            }
         } else {
             // New subscription
             txn.exec_params(
@@ -29,9 +82,13 @@ bool NotificationRepo::subscribeToNotification(int user_id, int product_id, cons
                 "VALUES ($1, $2, $3, FALSE, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP)",
                 product_id, user_id, type
             );
+            count = adjustPendingCount(txn, product_id, 1);
         }
         
         txn.commit();
+        if (count) {
+            SubscriberCounts::instance().apply(*count);
+        }
         std::cout << "✅ User " << user_id << " subscribed to product " << product_id << std::endl;
         return true;
     } catch (const std::exception& e) {
@@ -46,11 +103,18 @@ bool NotificationRepo::unsubscribeFromNotification(int notification_id) {
         pqxx::work txn(conn);
         
         pqxx::result r = txn.exec_params(
-            "DELETE FROM product_notifications WHERE id = $1",
+            "DELETE FROM product_notifications WHERE id = $1 RETURNING product_id, is_sent",
             notification_id
         );
+        std::optional<SubscriberCounts::Row> count;
+        if (!r.empty() && !r[0][1].as<bool>(false)) {
+            count = adjustPendingCount(txn, r[0][0].as<int>(), -1);
+        }
         
         txn.commit();
+        if (count) {
+            SubscriberCounts::instance().apply(*count);
+        }
         std::cout << "✅ Notification " << notification_id << " removed" << std::endl;
         return r.affected_rows() > 0;
     } catch (const std::exception& e) {
@@ -59,33 +123,16 @@ bool NotificationRepo::unsubscribeFromNotification(int notification_id) {
     }
 }
 
-std::vector<domain::Notification> NotificationRepo::getUserNotifications(int user_id) {
-    std::vector<domain::Notification> notifications;
+domain::NotificationList NotificationRepo::getUserNotifications(int user_id) {
+    domain::NotificationList notifications(RequestArena::resource());
     try {
-        auto& conn = PostgresConnection::getConnection();
-        pqxx::work txn(conn);
-        
-        pqxx::result r = txn.exec_params(
-            "SELECT id, product_id, user_id, notification_type, is_sent, created_at, updated_at, sent_at "
-            "FROM product_notifications WHERE user_id = $1 ORDER BY created_at DESC",
-            user_id
-        );
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(kNotificationsByUser, user_id);
+        });
         
+        notifications.reserve(r.size());
         for (auto row : r) {
-            domain::Notification notif;
-            notif.id = row["id"].as<int>();
-            notif.product_id = row["product_id"].as<int>();
-            notif.user_id = row["user_id"].as<int>();
-            notif.type_str = row["notification_type"].as<std::string>();
-            notif.is_sent = row["is_sent"].as<bool>();
-            notif.created_at = row["created_at"].as<std::string>();
-            notif.updated_at = row["updated_at"].as<std::string>();
-            
-            if (!row["sent_at"].is_null()) {
-                notif.sent_at = row["sent_at"].as<std::string>();
-            }
-            
-            notifications.push_back(notif);
+            notifications.push_back(rowmap::decode<domain::Notification>(row));
         }
         
         std::cout << "✅ Retrieved " << notifications.size() << " notifications for user " << user_id << std::endl;
@@ -96,29 +143,16 @@ std::vector<domain::Notification> NotificationRepo::getUserNotifications(int use
     return notifications;
 }
 
-std::vector<domain::Notification> NotificationRepo::getProductSubscribers(int product_id) {
-    std::vector<domain::Notification> notifications;
+domain::NotificationList NotificationRepo::getProductSubscribers(int product_id) {
+    domain::NotificationList notifications(RequestArena::resource());
     try {
-        auto& conn = PostgresConnection::getConnection();
-        pqxx::work txn(conn);
-        
-        pqxx::result r = txn.exec_params(
-            "SELECT id, product_id, user_id, notification_type, is_sent, created_at, updated_at "
-            "FROM product_notifications WHERE product_id = $1 ORDER BY created_at DESC",
-            product_id
-        );
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(kNotificationsByProduct, product_id);
+        });
         
+        notifications.reserve(r.size());
         for (auto row : r) {
-            domain::Notification notif;
-            notif.id = row["id"].as<int>();
-            notif.product_id = row["product_id"].as<int>();
-            notif.user_id = row["user_id"].as<int>();
-            notif.type_str = row["notification_type"].as<std::string>();
-            notif.is_sent = row["is_sent"].as<bool>();
-            notif.created_at = row["created_at"].as<std::string>();
-            notif.updated_at = row["updated_at"].as<std::string>();
-            
-            notifications.push_back(notif);
+            notifications.push_back(rowmap::decode<domain::Notification>(row));
         }
         
         std::cout << "✅ Retrieved " << notifications.size() << " subscribers for product " << product_id << std::endl;
@@ -132,28 +166,12 @@ std::vector<domain::Notification> NotificationRepo::getProductSubscribers(int pr
 domain::Notification NotificationRepo::getNotificationById(int notification_id) {
     domain::Notification notif;
     try {
-        auto& conn = PostgresConnection::getConnection();
-        pqxx::work txn(conn);
-        
-        pqxx::result r = txn.exec_params(
-            "SELECT id, product_id, user_id, notification_type, is_sent, created_at, updated_at, sent_at "
-            "FROM product_notifications WHERE id = $1",
-            notification_id
-        );
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(kNotificationById, notification_id);
+        });
         
         if (!r.empty()) {
-            auto row = r[0];
-            notif.id = row["id"].as<int>();
-            notif.product_id = row["product_id"].as<int>();
-            notif.user_id = row["user_id"].as<int>();
-            notif.type_str = row["notification_type"].as<std::string>();
-            notif.is_sent = row["is_sent"].as<bool>();
-            notif.created_at = row["created_at"].as<std::string>();
-            notif.updated_at = row["updated_at"].as<std::string>();
-            
-            if (!row["sent_at"].is_null()) {
-                notif.sent_at = row["sent_at"].as<std::string>();
-            }
+            rowmap::decodeInto(r[0], notif);
         }
     } catch (const std::exception& e) {
         std::cerr << "❌ Error getting notification by id: " << e.what() << std::endl;
@@ -162,15 +180,45 @@ domain::Notification NotificationRepo::getNotificationById(int notification_id)
     return notif;
 }
 
-bool NotificationRepo::isUserSubscribed(int user_id, int product_id) {
+domain::NotificationList NotificationRepo::getNotificationsByIds(const std::vector<int>& notification_ids) {
+    domain::NotificationList notifications(RequestArena::resource());
+    if (notification_ids.empty()) {
+        return notifications;
+    }
     try {
-        auto& conn = PostgresConnection::getConnection();
-        pqxx::work txn(conn);
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(kNotificationsByIds, pgarray::ints(notification_ids));
+        });
         
-        pqxx::result r = txn.exec_params(
-            "SELECT id FROM product_notifications WHERE user_id = $1 AND product_id = $2 AND is_sent = FALSE",
-            user_id, product_id
-        );
+        std::pmr::unordered_map<int, domain::Notification> by_id(RequestArena::resource());
+        by_id.reserve(r.size());
+        for (auto row : r) {
+            domain::Notification notif = rowmap::decode<domain::Notification>(row);
+            by_id.emplace(notif.id, std::move(notif));
+        }
+        
+        notifications.reserve(by_id.size());
+        for (int id : notification_ids) {
+            auto it = by_id.find(id);
+            if (it != by_id.end()) {
+                notifications.push_back(it->second);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Error getting notifications by ids: " << e.what() << std::endl;
+    }
+    
+    return notifications;
+}
+
+bool NotificationRepo::isUserSubscribed(int user_id, int product_id) {
+    try {
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT id FROM product_notifications WHERE user_id = $1 AND product_id = $2 AND is_sent = FALSE",
+                user_id, product_id
+            );
+        });
         
         return !r.empty();
     } catch (const std::exception& e) {
@@ -181,13 +229,12 @@ bool NotificationRepo::isUserSubscribed(int user_id, int product_id) {
 
 int NotificationRepo::getSubscriptionId(int user_id, int product_id) {
     try {
-        auto& conn = PostgresConnection::getConnection();
-        pqxx::work txn(conn);
-        
-        pqxx::result r = txn.exec_params(
-            "SELECT id FROM product_notifications WHERE user_id = $1 AND product_id = $2",
-            user_id, product_id
-        );
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT id FROM product_notifications WHERE user_id = $1 AND product_id = $2",
+                user_id, product_id
+            );
+        });
         
         if (!r.empty()) {
             return r[0]["id"].as<int>();
@@ -204,13 +251,24 @@ bool NotificationRepo::markNotificationAsSent(int notification_id) {
         auto& conn = PostgresConnection::getConnection();
         pqxx::work txn(conn);
         
-        txn.exec_params(
-            "UPDATE product_notifications SET is_sent = TRUE, sent_at = CURRENT_TIMESTAMP, updated_at = CURRENT_TIMESTAMP "
-            "WHERE id = $1",
+        // The locked pre-update row tells whether this send ends a pending
+        // subscription (re-marking a sent one leaves the count alone)
+        pqxx::result r = txn.exec_params(
+            "UPDATE product_notifications n "
+            "SET is_sent = TRUE, sent_at = CURRENT_TIMESTAMP, updated_at = CURRENT_TIMESTAMP "
+            "FROM (SELECT id, is_sent FROM product_notifications WHERE id = $1 FOR UPDATE) old "
+            "WHERE n.id = old.id RETURNING n.product_id, old.is_sent",
             notification_id
         );
+        std::optional<SubscriberCounts::Row> count;
+        if (!r.empty() && !r[0][1].as<bool>(false)) {
+            count = adjustPendingCount(txn, r[0][0].as<int>(), -1);
+        }
         
         txn.commit();
+        if (count) {
+            SubscriberCounts::instance().apply(*count);
+        }
         std::cout << "✅ Notification " << notification_id << " marked as sent" << std::endl;
         return true;
     } catch (const std::exception& e) {
@@ -228,12 +286,14 @@ int NotificationRepo::createNotificationLog(const domain::NotificationLog& log)
             "INSERT INTO notification_logs (notification_id, user_id, product_id, notification_type, message, status, retry_count, max_retries, error_message, created_at, updated_at) "
             "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP) "
             "RETURNING id",
-            log.notification_id, log.user_id, log.product_id, log.notification_type,
-            log.message, log.status, log.retry_count, log.max_retries, log.error_message
+            log.notification_id, log.user_id, log.product_id, domain::toString(log.notification_type),
+            std::string_view(log.message), domain::toString(log.status), log.retry_count, log.max_retries,
+            std::string_view(log.error_message)
         );
         
         int log_id = r[0]["id"].as<int>();
         txn.commit();
+        DashboardCounters::instance().notificationLogCreated(std::string(domain::toString(log.status)));
         std::cout << "✅ Notification log " << log_id << " created" << std::endl;
         return log_id;
     } catch (const std::exception& e) {
@@ -247,19 +307,29 @@ bool NotificationRepo::updateNotificationLogStatus(int log_id, const std::string
         auto& conn = PostgresConnection::getConnection();
         pqxx::work txn(conn);
         
+        // The previous status comes back from the locked pre-update row so the
+        // dashboard's pending/failed counters can move by exactly this change
+        pqxx::result r;
         if (message.empty()) {
-            txn.exec_params(
-                "UPDATE notification_logs SET status = $1, updated_at = CURRENT_TIMESTAMP WHERE id = $2",
+            r = txn.exec_params(
+                "UPDATE notification_logs l SET status = $1, updated_at = CURRENT_TIMESTAMP "
+                "FROM (SELECT id, status FROM notification_logs WHERE id = $2 FOR UPDATE) old "
+                "WHERE l.id = old.id RETURNING old.status",
                 status, log_id
             );
         } else {
-            txn.exec_params(
-                "UPDATE notification_logs SET status = $1, error_message = $2, updated_at = CURRENT_TIMESTAMP WHERE id = $3",
+            r = txn.exec_params(
+                "UPDATE notification_logs l SET status = $1, error_message = $2, updated_at = CURRENT_TIMESTAMP "
+                "FROM (SELECT id, status FROM notification_logs WHERE id = $3 FOR UPDATE) old "
+                "WHERE l.id = old.id RETURNING old.status",
                 status, message, log_id
             );
         }
         
         txn.commit();
+        if (!r.empty()) {
+            DashboardCounters::instance().notificationLogStatusChanged(r[0][0].as<std::string>(std::string()), status);
+        }
         return true;
     } catch (const std::exception& e) {
         std::cerr << "❌ Error updating notification log status: " << e.what() << std::endl;
@@ -267,50 +337,20 @@ bool NotificationRepo::updateNotificationLogStatus(int log_id, const std::string
     }
 }
 
-std::vector<domain::NotificationLog> NotificationRepo::getNotificationLogs(int user_id, const std::string& status) {
-    std::vector<domain::NotificationLog> logs;
+domain::NotificationLogList NotificationRepo::getNotificationLogs(int user_id, const std::string& status) {
+    domain::NotificationLogList logs(RequestArena::resource());
     try {
-        auto& conn = PostgresConnection::getConnection();
-        pqxx::work txn(conn);
-        
-        pqxx::result r;
-        if (status.empty()) {
-            r = txn.exec_params(
-                "SELECT id, notification_id, user_id, product_id, notification_type, message, status, retry_count, max_retries, error_message, sent_at, created_at, updated_at "
-                "FROM notification_logs WHERE user_id = $1 ORDER BY created_at DESC",
-                user_id
-            );
-        } else {
-            r = txn.exec_params(
-                "SELECT id, notification_id, user_id, product_id, notification_type, message, status, retry_count, max_retries, error_message, sent_at, created_at, updated_at "
-                "FROM notification_logs WHERE user_id = $1 AND status = $2 ORDER BY created_at DESC",
-                user_id, status
-            );
-        }
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            if (status.empty()) {
+                return txn.exec_params(kLogsByUser, user_id);
+            }
+            return txn.exec_params(kLogsByUserAndStatus, user_id, status);
+        });
         
+        // Decoded in place so the log text lands in the list's resource
+        logs.reserve(r.size());
         for (auto row : r) {
-            domain::NotificationLog log;
-            log.id = row["id"].as<int>();
-            if (!row["notification_id"].is_null()) {
-                log.notification_id = row["notification_id"].as<int>();
-            }
-            log.user_id = row["user_id"].as<int>();
-            log.product_id = row["product_id"].as<int>();
-            log.notification_type = row["notification_type"].as<std::string>();
-            log.message = row["message"].as<std::string>();
-            log.status = row["status"].as<std::string>();
-            log.retry_count = row["retry_count"].as<int>();
-            log.max_retries = row["max_retries"].as<int>();
-            if (!row["error_message"].is_null()) {
-                log.error_message = row["error_message"].as<std::string>();
-            }
-            if (!row["sent_at"].is_null()) {
-                log.sent_at = row["sent_at"].as<std::string>();
-            }
-            log.created_at = row["created_at"].as<std::string>();
-            log.updated_at = row["updated_at"].as<std::string>();
-            
-            logs.push_back(log);
+            rowmap::decodeInto(row, logs.emplace_back());
         }
     } catch (const std::exception& e) {
         std::cerr << "❌ Error getting notification logs: " << e.what() << std::endl;
@@ -319,40 +359,16 @@ std::vector<domain::NotificationLog> NotificationRepo::getNotificationLogs(int u
     return logs;
 }
 
-std::vector<domain::NotificationLog> NotificationRepo::getFailedNotifications() {
-    std::vector<domain::NotificationLog> logs;
+domain::NotificationLogList NotificationRepo::getFailedNotifications() {
+    domain::NotificationLogList logs(RequestArena::resource());
     try {
-        auto& conn = PostgresConnection::getConnection();
-        pqxx::work txn(conn);
-        
-        pqxx::result r = txn.exec_params(
-            "SELECT id, notification_id, user_id, product_id, notification_type, message, status, retry_count, max_retries, error_message, sent_at, created_at, updated_at "
-            "FROM notification_logs WHERE status = 'failed' AND retry_count < max_retries ORDER BY created_at ASC"
-        );
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec(kRetryableLogs);
+        });
         
+        logs.reserve(r.size());
         for (auto row : r) {
-            domain::NotificationLog log;
-            log.id = row["id"].as<int>();
-            if (!row["notification_id"].is_null()) {
-                log.notification_id = row["notification_id"].as<int>();
-            }
-            log.user_id = row["user_id"].as<int>();
-            log.product_id = row["product_id"].as<int>();
-            log.notification_type = row["notification_type"].as<std::string>();
-            log.message = row["message"].as<std::string>();
-            log.status = row["status"].as<std::string>();
-            log.retry_count = row["retry_count"].as<int>();
-            log.max_retries = row["max_retries"].as<int>();
-            if (!row["error_message"].is_null()) {
-                log.error_message = row["error_message"].as<std::string>();
-            }
-            if (!row["sent_at"].is_null()) {
-                log.sent_at = row["sent_at"].as<std::string>();
-            }
-            log.created_at = row["created_at"].as<std::string>();
-            log.updated_at = row["updated_at"].as<std::string>();
-            
-            logs.push_back(log);
+            rowmap::decodeInto(row, logs.emplace_back());
         }
     } catch (const std::exception& e) {
         std::cerr << "❌ Error getting failed notifications: " << e.what() << std::endl;
@@ -399,6 +415,8 @@ bool NotificationRepo::createNotificationPreference(int user_id) {
         }
         
         txn.commit();
+        // Next read goes to the database and caches the row with its id/timestamps
+        PreferenceCache::instance().remove(user_id);
         std::cout << "✅ Notification preferences created for user " << user_id << std::endl;
         return true;
     } catch (const std::exception& e) {
@@ -408,27 +426,20 @@ bool NotificationRepo::createNotificationPreference(int user_id) {
 }
 
 domain::NotificationPreference NotificationRepo::getNotificationPreference(int user_id) {
+    if (auto cached = PreferenceCache::instance().find(user_id)) {
+        return *cached;
+    }
+    
     domain::NotificationPreference pref;
     try {
         auto& conn = PostgresConnection::getConnection();
         pqxx::work txn(conn);
         
-        pqxx::result r = txn.exec_params(
-            "SELECT id, user_id, email_enabled, push_enabled, sms_enabled, in_app_enabled, created_at, updated_at "
-            "FROM notification_preferences WHERE user_id = $1",
-            user_id
-        );
+        pqxx::result r = txn.exec_prepared("preference_by_user", user_id);
         
         if (!r.empty()) {
-            auto row = r[0];
-            pref.id = row["id"].as<int>();
-            pref.user_id = row["user_id"].as<int>();
-            pref.email_enabled = row["email_enabled"].as<bool>();
-            pref.push_enabled = row["push_enabled"].as<bool>();
-            pref.sms_enabled = row["sms_enabled"].as<bool>();
-            pref.in_app_enabled = row["in_app_enabled"].as<bool>();
-            pref.created_at = row["created_at"].as<std::string>();
-            pref.updated_at = row["updated_at"].as<std::string>();
+            rowmap::decodeInto(r[0], pref);
+            PreferenceCache::instance().put(pref);
         } else {
             // Create default preference if not found
             createNotificationPreference(user_id);
@@ -443,6 +454,62 @@ domain::NotificationPreference NotificationRepo::getNotificationPreference(int u
     return pref;
 }
 
+std::vector<domain::NotificationPreference> NotificationRepo::getNotificationPreferences(const std::vector<int>& user_ids) {
+    std::unordered_map<int, domain::NotificationPreference> by_user;
+    std::vector<int> misses;
+    for (int user_id : user_ids) {
+        if (by_user.count(user_id)) {
+            continue;
+        }
+        if (auto cached = PreferenceCache::instance().find(user_id)) {
+            by_user.emplace(user_id, *cached);
+        } else {
+            by_user.emplace(user_id, domain::NotificationPreference());
+            misses.push_back(user_id);
+        }
+    }
+    
+    if (!misses.empty()) {
+        try {
+            auto& conn = PostgresConnection::getConnection();
+            pqxx::work txn(conn);
+            
+            // Users without a row get the defaults, created in the same
+            // statement; RETURNING covers only those inserted
+            std::string ids = pgarray::ints(misses);
+            pqxx::result created = txn.exec_params(
+                "INSERT INTO notification_preferences (user_id, email_enabled, push_enabled, sms_enabled, in_app_enabled, created_at, updated_at) "
+                "SELECT u, TRUE, FALSE, FALSE, TRUE, CURRENT_TIMESTAMP, CURRENT_TIMESTAMP "
+                "FROM unnest($1::int[]) AS u WHERE EXISTS (SELECT 1 FROM users WHERE id = u) "
+                "ON CONFLICT (user_id) DO NOTHING",
+                ids
+            );
+            pqxx::result r = txn.exec_params(kPreferencesByUsers, ids);
+            txn.commit();
+            
+            for (auto row : r) {
+                domain::NotificationPreference pref = rowmap::decode<domain::NotificationPreference>(row);
+                PreferenceCache::instance().put(pref);
+                by_user[pref.user_id] = pref;
+            }
+            if (created.affected_rows() > 0) {
+                std::cout << "✅ Notification preferences created for " << created.affected_rows() << " users" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Error getting notification preferences: " << e.what() << std::endl;
+        }
+    }
+    
+    std::vector<domain::NotificationPreference> prefs;
+    prefs.reserve(user_ids.size());
+    for (int user_id : user_ids) {
+        domain::NotificationPreference& pref = by_user[user_id];
+        pref.user_id = user_id;
+        prefs.push_back(pref);
+    }
+    return prefs;
+}
+
 bool NotificationRepo::updateNotificationPreference(const domain::NotificationPreference& pref) {
     try {
         auto& conn = PostgresConnection::getConnection();
@@ -455,6 +522,8 @@ bool NotificationRepo::updateNotificationPreference(const domain::NotificationPr
         );
         
         txn.commit();
+        // updated_at moved server-side; drop the entry so the next read refreshes it
+        PreferenceCache::instance().remove(pref.user_id);
         std::cout << "✅ Notification preferences updated for user " << pref.user_id << std::endl;
         return true;
     } catch (const std::exception& e) {
@@ -463,28 +532,17 @@ bool NotificationRepo::updateNotificationPreference(const domain::NotificationPr
     }
 }
 
-std::vector<domain::Notification> NotificationRepo::getPendingNotifications() {
-    std::vector<domain::Notification> notifications;
+domain::NotificationList NotificationRepo::getPendingNotifications() {
+    domain::NotificationList notifications(RequestArena::resource());
     try {
         auto& conn = PostgresConnection::getConnection();
         pqxx::work txn(conn);
         
-        pqxx::result r = txn.exec_params(
-            "SELECT id, product_id, user_id, notification_type, is_sent, created_at, updated_at "
-            "FROM product_notifications WHERE is_sent = FALSE ORDER BY created_at ASC"
-        );
+        pqxx::result r = txn.exec(kPendingNotifications);
         
+        notifications.reserve(r.size());
         for (auto row : r) {
-            domain::Notification notif;
-            notif.id = row["id"].as<int>();
-            notif.product_id = row["product_id"].as<int>();
-            notif.user_id = row["user_id"].as<int>();
-            notif.type_str = row["notification_type"].as<std::string>();
-            notif.is_sent = row["is_sent"].as<bool>();
-            notif.created_at = row["created_at"].as<std::string>();
-            notif.updated_at = row["updated_at"].as<std::string>();
-            
-            notifications.push_back(notif);
+            notifications.push_back(rowmap::decode<domain::Notification>(row));
         }
         
         std::cout << "✅ Retrieved " << notifications.size() << " pending notifications" << std::endl;
@@ -0,0 +1,83 @@
+#pragma once
+#include <string_view>
+#include <tuple>
+#include "RowMapper.h"
+#include "../../domain/notification.h"
+
+// Column declarations for the notification tables (see RowMapper.h). The
+// order here is the SELECT order and therefore the decode order.
+//
+// Timestamp columns are selected as epoch microseconds (TIMESTAMP values
+// read in the session time zone, as for inventory.updated_at), and the
+// type/status names are decoded into their enums.
+#define NOTIFICATION_ROWS_MICROS(name) "(extract(epoch FROM " name "::timestamptz) * 1000000)::bigint"
+
+namespace rowmap {
+
+// An unknown name keeps the member's default
+template <>
+struct FieldDecoder<domain::NotificationType> {
+    template <typename PgField>
+    static void decode(const PgField& f, domain::NotificationType& out) {
+        domain::parse(std::string_view(f.c_str(), f.size()), out);
+    }
+};
+
+template <>
+struct FieldDecoder<domain::NotificationStatus> {
+    template <typename PgField>
+    static void decode(const PgField& f, domain::NotificationStatus& out) {
+        domain::parse(std::string_view(f.c_str(), f.size()), out);
+    }
+};
+
+template <>
+struct Columns<domain::Notification> {
+    using N = domain::Notification;
+    static constexpr auto value = std::make_tuple(
+        column("id", &N::id),
+        column("product_id", &N::product_id),
+        column("user_id", &N::user_id),
+        column("notification_type", &N::type),
+        column("is_sent", &N::is_sent),
+        column(NOTIFICATION_ROWS_MICROS("created_at"), &N::created_at_us),
+        column(NOTIFICATION_ROWS_MICROS("updated_at"), &N::updated_at_us),
+        column(NOTIFICATION_ROWS_MICROS("sent_at"), &N::sent_at_us));
+};
+
+template <>
+struct Columns<domain::NotificationLog> {
+    using L = domain::NotificationLog;
+    static constexpr auto value = std::make_tuple(
+        column("id", &L::id),
+        column("notification_id", &L::notification_id),
+        column("user_id", &L::user_id),
+        column("product_id", &L::product_id),
+        column("notification_type", &L::notification_type),
+        column("message", &L::message),
+        column("status", &L::status),
+        column("retry_count", &L::retry_count),
+        column("max_retries", &L::max_retries),
+        column("error_message", &L::error_message),
+        column(NOTIFICATION_ROWS_MICROS("sent_at"), &L::sent_at_us),
+        column(NOTIFICATION_ROWS_MICROS("created_at"), &L::created_at_us),
+        column(NOTIFICATION_ROWS_MICROS("updated_at"), &L::updated_at_us));
+};
+
+template <>
+struct Columns<domain::NotificationPreference> {
+    using P = domain::NotificationPreference;
+    static constexpr auto value = std::make_tuple(
+        column("id", &P::id),
+        column("user_id", &P::user_id),
+        column("email_enabled", &P::email_enabled),
+        column("push_enabled", &P::push_enabled),
+        column("sms_enabled", &P::sms_enabled),
+        column("in_app_enabled", &P::in_app_enabled),
+        column("created_at", &P::created_at),
+        column("updated_at", &P::updated_at));
+};
+
+} // namespace rowmap
+
+#undef NOTIFICATION_ROWS_MICROS
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Postgres array literal for an id list, e.g. {1,2,3}, bound as one text
+// parameter and cast in SQL (`WHERE id = ANY($1::int[])`). One statement
+// then resolves any number of ids instead of one round trip per id.
+namespace pgarray {
+
+inline std::string ints(const std::vector<int>& values) {
+    std::string out = "{";
+    out.reserve(values.size() * 8 + 2);
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        out += std::to_string(values[i]);
+    }
+    out += '}';
+    return out;
+}
+
+} // namespace pgarray
@@ -0,0 +1,51 @@
+#pragma once
+#include <pqxx/pqxx>
+#include <string_view>
+#include "../../util/ResponseWriter.h"
+
+// Helpers for streaming pqxx fields straight into a ResponseWriter without
+// converting them to std::string / int first. Postgres sends integers as
+// plain decimal text and booleans as 't'/'f', so both can be emitted
+// directly from the field's buffer.
+namespace pgjson {
+
+inline std::string_view view(const pqxx::field& f) {
+    return std::string_view(f.c_str(), f.size());
+}
+
+inline ResponseWriter& integer(ResponseWriter& w, std::string_view key, const pqxx::field& f) {
+    w.key(key);
+    if (f.is_null()) {
+        return w.null();
+    }
+    return w.raw(view(f));
+}
+
+inline ResponseWriter& text(ResponseWriter& w, std::string_view key, const pqxx::field& f) {
+    w.key(key);
+    if (f.is_null()) {
+        return w.null();
+    }
+    return w.value(view(f));
+}
+
+// Same as text() but emits "" for NULL. This is a deliberate change: the
+// handlers it replaced read these columns with as<std::string>(), which
+// throws on NULL, so such a row used to fail the whole request with 500.
+inline ResponseWriter& textOrEmpty(ResponseWriter& w, std::string_view key, const pqxx::field& f) {
+    w.key(key);
+    if (f.is_null()) {
+        return w.value(std::string_view());
+    }
+    return w.value(view(f));
+}
+
+inline ResponseWriter& boolean(ResponseWriter& w, std::string_view key, const pqxx::field& f) {
+    w.key(key);
+    if (f.is_null()) {
+        return w.null();
+    }
+    return w.value(f.c_str()[0] == 't');
+}
+
+} // namespace pgjson
@@ -1,15 +1,123 @@
 #include "PostgresConnection.h"
+#include "NotificationRows.h"
+#include "ReplicaRouter.h"
+#include "../../server/Config.h"
+#include "../../server/ConcurrencyLimit.h"
+#include <iostream>
+#include <string>
+#include <thread>
 
 // Define thread_local storage for each thread
 thread_local std::unique_ptr<pqxx::connection> PostgresConnection::threadConn = nullptr;
+thread_local std::unique_ptr<pqxx::connection> PostgresConnection::replicaConn = nullptr;
+
+std::mutex PostgresConnection::idleMutex;
+std::vector<std::unique_ptr<pqxx::connection>> PostgresConnection::idleConnections;
+
+namespace {
+
+// Hot read statements, prepared on every connection when it is opened.
+struct PreparedStatement {
+    const char* name;
+    std::string sql;
+};
+
+const PreparedStatement kPreparedStatements[] = {
+    {"product_by_id", "SELECT id, name, description FROM products WHERE id = $1"},
+    {"inventory_by_product", "SELECT product_id, stock, reorder_point, updated_at FROM inventory WHERE product_id = $1"},
+    // Decoded positionally by NotificationRepo, so the columns come from rowmap
+    {"preference_by_user",
+     rowmap::select<domain::NotificationPreference>("FROM notification_preferences WHERE user_id = $1")},
+};
+
+} // namespace
+
+const char* PostgresConnection::dsn() {
+    static const std::string primary = Config::envString(
+        "DATABASE_DSN", "host=localhost port=5432 dbname=inventory_db user=inventory_user password=inventory_pass");
+    return primary.c_str();
+}
+
+void PostgresConnection::prepareStatements(pqxx::connection& conn) {
+    for (const auto& stmt : kPreparedStatements) {
+        try {
+            conn.prepare(stmt.name, stmt.sql);
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Failed to prepare statement " << stmt.name << ": " << e.what() << std::endl;
+        }
+    }
+}
+
+std::unique_ptr<pqxx::connection> PostgresConnection::openConnection() {
+    auto conn = std::make_unique<pqxx::connection>(dsn());
+    prepareStatements(*conn);
+    return conn;
+}
 
 pqxx::connection& PostgresConnection::getConnection() {
+    // Requests take a database slot here, or are shed (server/ConcurrencyLimit.h)
+    ConcurrencyLimit::enterDatabase();
     // Create connection per thread (thread-local storage)
     if (!threadConn) {
-        threadConn = std::make_unique<pqxx::connection>(
-            "host=localhost port=5432 dbname=inventory_db "
-            "user=inventory_user password=inventory_pass"
-        );
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            if (!idleConnections.empty()) {
+                threadConn = std::move(idleConnections.back());
+                idleConnections.pop_back();
+            }
+        }
+        if (!threadConn) {
+            threadConn = openConnection();
+        }
     }
     return *threadConn;
 }
+
+pqxx::connection& PostgresConnection::getReadConnection() {
+    if (ReplicaRouter::readsFromReplica()) {
+        ConcurrencyLimit::enterDatabase();
+        try {
+            if (!replicaConn || !replicaConn->is_open()) {
+                replicaConn.reset();
+                auto conn = std::make_unique<pqxx::connection>(ReplicaRouter::instance().dsn());
+                prepareStatements(*conn);
+                replicaConn = std::move(conn);
+            }
+            return *replicaConn;
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Failed to open replica connection: " << e.what() << std::endl;
+            ReplicaRouter::instance().replicaFailed();
+        }
+    }
+    return getConnection();
+}
+
+void PostgresConnection::replicaBroken(const pqxx::broken_connection& e) {
+    std::cerr << "❌ Replica connection lost, retrying on the primary: " << e.what() << std::endl;
+    ReplicaRouter::instance().replicaFailed();
+    replicaConn.reset();
+}
+
+void PostgresConnection::prewarm(size_t count) {
+    std::vector<std::thread> openers;
+    openers.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        openers.emplace_back([] {
+            try {
+                auto conn = openConnection();
+                {
+                    // Round trip once so auth and server-side caches are settled
+                    pqxx::nontransaction txn(*conn);
+                    txn.exec("SELECT 1");
+                }
+                std::lock_guard<std::mutex> lock(idleMutex);
+                idleConnections.push_back(std::move(conn));
+            } catch (const std::exception& e) {
+                std::cerr << "❌ Failed to open warm connection: " << e.what() << std::endl;
+            }
+        });
+    }
+    for (auto& t : openers) {
+        t.join();
+    }
+}
@@ -2,11 +2,64 @@
 #include<pqxx/pqxx>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 class PostgresConnection {
 private:
     static thread_local std::unique_ptr<pqxx::connection> threadConn;
-    
+    static thread_local std::unique_ptr<pqxx::connection> replicaConn;
+
+    // Connections opened ahead of time by prewarm(); handed out to threads
+    // the first time they call getConnection().
+    static std::mutex idleMutex;
+    static std::vector<std::unique_ptr<pqxx::connection>> idleConnections;
+
+    static std::unique_ptr<pqxx::connection> openConnection();
+
+    // Logs the failure, reports it to ReplicaRouter and drops replicaConn so
+    // the next replica read reconnects.
+    static void replicaBroken(const pqxx::broken_connection& e);
+
+    template <typename Query>
+    static auto runRead(pqxx::connection& conn, Query& query) {
+        pqxx::work txn(conn);
+        auto result = query(txn);
+        txn.commit();
+        return result;
+    }
+
 public:
+    // DATABASE_DSN, defaulting to the local development database
+    static const char* dsn();
     static pqxx::connection& getConnection();
+
+    // For read-only queries: the thread's replica connection when
+    // ReplicaRouter allows it for the current request, else the primary
+    static pqxx::connection& getReadConnection();
+
+    // Runs `query(txn)` in a transaction on getReadConnection() and returns
+    // what it returns. If that was the replica and its connection breaks,
+    // the replica is marked failed and the query runs once more on the
+    // primary, so `query` must not have effects outside the transaction.
+    template <typename Query>
+    static auto read(Query&& query) {
+        pqxx::connection& conn = getReadConnection();
+        if (&conn == replicaConn.get()) {
+            try {
+                return runRead(conn, query);
+            } catch (const pqxx::broken_connection& e) {
+                replicaBroken(e);
+                return runRead(getConnection(), query);
+            }
+        }
+        return runRead(conn, query);
+    }
+
+    // Declares the shared prepared statements on a connection.
+    static void prepareStatements(pqxx::connection& conn);
+
+    // Opens, primes and parks `count` connections in parallel so the first
+    // requests on each worker thread do not pay connect + prepare latency.
+    static void prewarm(size_t count);
 };
@@ -1,55 +1,151 @@
 #include <pqxx/pqxx>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <unordered_map>
 using namespace std;
 #include "PostgresConnection.h"
+#include "PgArray.h"
+#include "ReplicaRouter.h"
+#include "../cache/CatalogCache.h"
+#include "../cache/DashboardCounters.h"
+#include "../cache/SubscriberCounts.h"
+#include "../../index/TrigramIndex.h"
+#include "../../index/PrefixIndex.h"
+#include "../../index/FullTextIndex.h"
+#include "../../index/StockIndex.h"
+#include "../../index/LowStockIndex.h"
+#include "../../index/StockHistory.h"
+#include "../../server/Config.h"
+#include "../../server/ConcurrencyLimit.h"
+#include "../../util/SingleFlight.h"
 #include "../interfaces/IproductRepo.h"
 #include "../../domain/product.h"
 
 class ProductRepo : public IproductRepo{
     public:
+    // Cache misses of find_by_id: concurrent lookups of one id share a query
+    static SingleFlight<int, product>& lookups() {
+        static SingleFlight<int, product> group("product_by_id", Config::envSize("SINGLE_FLIGHT_MAX_WAITERS", 64));
+        return group;
+    }
+    // The in-memory updates after a product write commit run one write at a
+    // time, so the indexes follow CatalogCache's verdict on each write
+    // without another write's updates landing in between
+    static std::mutex& hookMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
     int create(string name,string description) override{
         pqxx::work txn(PostgresConnection::getConnection());
 
         pqxx:: result r = txn.exec_params(
             "INSERT INTO products (name, description) "
-            "VALUES ($1, $2) RETURNING id",
+            "VALUES ($1, $2) RETURNING id, version",
             name,
             description
         );
         int productId = r[0][0].as<int>();
+        long long version = r[0][1].as<long long>();
         txn.commit();
+        {
+            std::lock_guard<std::mutex> lock(hookMutex());
+            if (CatalogCache::instance().addProduct(productId, name, description, version)) {
+                TrigramIndex::products().add(productId, name);
+                PrefixIndex::products().add(productId, name);
+                FullTextIndex::products().add(productId, name, description);
+            }
+        }
+        DashboardCounters::instance().productCreated();
         return productId;
     }
     product find_by_id(int prod_id)override{
-        pqxx::work txn(PostgresConnection::getConnection());
+        if (auto cached = CatalogCache::instance().findProduct(prod_id)) {
+            return *cached;
+        }
 
-        pqxx::result r = txn.exec_params(
-            "SELECT id, name, description "
-            "FROM products WHERE id = $1",
-            prod_id
-        );
+        auto query = [prod_id] {
+            pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                return txn.exec_prepared("product_by_id", prod_id);
+            });
+
+            if (r.empty()) {
+                throw std::runtime_error("Product not found");
+            }
 
-        if (r.empty()) {
-            throw std::runtime_error("Product not found");
+            return product(
+                r[0]["id"].as<int>(),
+                r[0]["name"].as<std::string>(),
+                r[0]["description"].as<std::string>(),
+                0
+            );
+        };
+        // A client reading its own write must not share a replica read
+        if (ReplicaRouter::pinnedToPrimary()) {
+            return query();
+        }
+        try {
+            return lookups().run(prod_id, query);
+        } catch (const Overloaded&) {
+            // Possibly the leader's; shed this request as well
+            ConcurrencyLimit::shed();
+            throw;
+        }
+    }
+    vector<product> find_by_ids(const vector<int>& prod_ids)override{
+        // Cached products are served from memory; the rest (all of them
+        // before warm-up) with one query
+        unordered_map<int, product> found;
+        vector<int> misses;
+        for (int id : prod_ids) {
+            if (found.count(id)) {
+                continue;
+            }
+            if (auto cached = CatalogCache::instance().findProduct(id)) {
+                found.emplace(id, *cached);
+            } else {
+                misses.push_back(id);
+            }
         }
 
-        return product(
-            r[0]["id"].as<int>(),
-            r[0]["name"].as<std::string>(),
-            r[0]["description"].as<std::string>(),
-            0
-        );
+        if (!misses.empty()) {
+            pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+                return txn.exec_params(
+                    "SELECT id, name, description "
+                    "FROM products WHERE id = ANY($1::int[])",
+                    pgarray::ints(misses)
+                );
+            });
+
+            for (const auto& row : r) {
+                int id = row["id"].as<int>();
+                found.emplace(id, product(
+                    id,
+                    row["name"].as<std::string>(),
+                    row["description"].as<std::string>("")
+                ));
+            }
+        }
+
+        std::vector<product> products;
+        products.reserve(found.size());
+        for (int id : prod_ids) {
+            auto it = found.find(id);
+            if (it != found.end()) {
+                products.push_back(it->second);
+            }
+        }
+        return products;
     }
     vector<product> find_by_name(string name)override{
-        pqxx::work txn(PostgresConnection::getConnection());
         std::vector<product> products;
-
-        pqxx::result r = txn.exec_params(
-            "SELECT id, name, description "
-            "FROM products WHERE name ILIKE '%' || $1 || '%'",
-            name
-        );
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT id, name, description "
+                "FROM products WHERE name ILIKE '%' || $1 || '%'",
+                name
+            );
+        });
 
         for (const auto& row : r) {
             products.emplace_back(
@@ -61,25 +157,168 @@ class ProductRepo : public IproductRepo{
 
         return products;
     }
+    vector<product> search_ranked(string name,size_t limit,double min_similarity)override{
+        std::vector<product> products;
+
+        // Escape LIKE metacharacters so the term is matched literally
+        std::string pattern = "%";
+        for (char c : name) {
+            if (c == '%' || c == '_' || c == '\\') {
+                pattern += '\\';
+            }
+            pattern += c;
+        }
+        pattern += '%';
+
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            // Threshold for the index-backed `%` operator, local to this transaction
+            txn.exec_params(
+                "SELECT set_config('pg_trgm.similarity_threshold', $1, true)",
+                std::to_string(min_similarity)
+            );
+
+            // Both predicates are served by idx_products_name_trgm (GIN, gin_trgm_ops)
+            return txn.exec_params(
+                "SELECT id, name, description "
+                "FROM products "
+                "WHERE name ILIKE $1 OR name % $2 "
+                "ORDER BY similarity(name, $2) DESC, id "
+                "LIMIT $3",
+                pattern, name, static_cast<long long>(limit)
+            );
+        });
+
+        products.reserve(r.size());
+        for (const auto& row : r) {
+            products.emplace_back(
+                row[0].as<int>(),
+                row[1].as<std::string>(),
+                row[2].is_null() ? std::string() : row[2].as<std::string>()
+            );
+        }
+
+        return products;
+    }
+    vector<product> search_fulltext(string query,size_t limit)override{
+        std::vector<product> products;
+        std::vector<std::string> terms = FullTextIndex::tokenize(query);
+        if (terms.empty()) {
+            return products;
+        }
+
+        // Tokens are alphanumeric, so joining them with '|' yields a safe
+        // OR-query, matching the in-process index's semantics
+        std::string tsquery;
+        for (const auto& term : terms) {
+            if (!tsquery.empty()) {
+                tsquery += " | ";
+            }
+            tsquery += term;
+        }
+
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT id, name, description, "
+                "ts_rank_cd(setweight(to_tsvector('simple', name), 'A') || "
+                "setweight(to_tsvector('simple', coalesce(description, '')), 'D'), q) AS score "
+                "FROM products, to_tsquery('simple', $1) q "
+                "WHERE to_tsvector('simple', name || ' ' || coalesce(description, '')) @@ q "
+                "ORDER BY score DESC, id "
+                "LIMIT $2",
+                tsquery, static_cast<long long>(limit)
+            );
+        });
+
+        products.reserve(r.size());
+        for (const auto& row : r) {
+            products.emplace_back(
+                row[0].as<int>(),
+                row[1].as<std::string>(),
+                row[2].is_null() ? std::string() : row[2].as<std::string>()
+            );
+        }
+
+        return products;
+    }
+    vector<product> find_by_prefix(string prefix,size_t limit)override{
+        std::vector<product> products;
+
+        std::string pattern;
+        for (char c : prefix) {
+            if (c == '%' || c == '_' || c == '\\') {
+                pattern += '\\';
+            }
+            pattern += c;
+        }
+        pattern += '%';
+
+        // Same order as PrefixIndex: lowercased name compared byte by byte
+        // (COLLATE "C", not the database's locale), then id
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT id, name, description "
+                "FROM products "
+                "WHERE name ILIKE $1 "
+                "ORDER BY lower(name) COLLATE \"C\", id "
+                "LIMIT $2",
+                pattern, static_cast<long long>(limit)
+            );
+        });
+
+        products.reserve(r.size());
+        for (const auto& row : r) {
+            products.emplace_back(
+                row[0].as<int>(),
+                row[1].as<std::string>(),
+                row[2].is_null() ? std::string() : row[2].as<std::string>()
+            );
+        }
+
+        return products;
+    }
     void update(int prod_id,string name, string description)override{
         pqxx::work txn(PostgresConnection::getConnection());
 
-        txn.exec_params(
-            "UPDATE products SET name=$1, description=$2 "
-            "WHERE id=$3",
+        // version is bumped under the row lock, so it orders the writes to
+        // one product the way they committed
+        pqxx::result r = txn.exec_params(
+            "UPDATE products SET name=$1, description=$2, version=version+1 "
+            "WHERE id=$3 RETURNING version",
             name, description, prod_id
         );
 
         txn.commit();
+        lookups().forget(prod_id);
+        if (!r.empty()) {
+            std::lock_guard<std::mutex> lock(hookMutex());
+            if (CatalogCache::instance().updateProduct(prod_id, name, description, r[0][0].as<long long>())) {
+                TrigramIndex::products().update(prod_id, name);
+                PrefixIndex::products().update(prod_id, name);
+                FullTextIndex::products().update(prod_id, name, description);
+            }
+        }
     }
     void remove(int prod_id)override{
         pqxx::work txn(PostgresConnection::getConnection());
 
-        txn.exec_params(
+        pqxx::result r = txn.exec_params(
             "DELETE FROM products WHERE id = $1",
             prod_id
         );
 
         txn.commit();
+        lookups().forget(prod_id);
+        if (r.affected_rows() > 0) {
+            DashboardCounters::instance().productRemoved();
+        }
+        std::lock_guard<std::mutex> lock(hookMutex());
+        CatalogCache::instance().removeProduct(prod_id);
+        TrigramIndex::products().remove(prod_id);
+        PrefixIndex::products().remove(prod_id);
+        FullTextIndex::products().remove(prod_id);
+        StockIndex::products().remove(prod_id);
+        LowStockIndex::products().remove(prod_id);
+        StockHistory::products().remove(prod_id);
+        SubscriberCounts::instance().remove(prod_id);
     }
 };
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "ReplicaRouter.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <pqxx/pqxx>
+#include "../../server/Config.h"
+
+namespace {
+
+thread_local bool t_read_only = false;
+thread_local bool t_writes = false;
+thread_local bool t_pinned = false;
+thread_local std::string t_client;
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Replay lag in milliseconds: 0 when the replica has replayed everything
+// it received (or is not a standby at all, e.g. a second local instance
+// used for testing), otherwise the age of the last replayed transaction
+const char* const kLagQuery =
+    "SELECT CASE WHEN NOT pg_is_in_recovery() THEN 0 "
+    "WHEN pg_last_wal_receive_lsn() = pg_last_wal_replay_lsn() THEN 0 "
+    "ELSE COALESCE(extract(epoch FROM now() - pg_last_xact_replay_timestamp()) * 1000, 0) END::bigint";
+
+} // namespace
+
+ReplicaRouter& ReplicaRouter::instance() {
+    static ReplicaRouter router;
+    return router;
+}
+
+ReplicaRouter::ReplicaRouter()
+    : replica_dsn(Config::envString("REPLICA_DSN", "")),
+      max_lag_ms(static_cast<int64_t>(Config::envSize("REPLICA_MAX_LAG_MS", 1000))),
+      check_interval(Config::envSize("REPLICA_LAG_CHECK_MS", 1000)),
+      // A healthy replica can be up to max lag plus one check interval
+      // behind; a shorter window would let a client miss its own write
+      read_your_writes_ns(std::max<int64_t>(
+          static_cast<int64_t>(Config::envSize("REPLICA_READ_YOUR_WRITES_MS", 5000)),
+          max_lag_ms + static_cast<int64_t>(check_interval.count())) * 1000000) {}
+
+ReplicaRouter::~ReplicaRouter() {
+    {
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        stopping = true;
+    }
+    monitor_wake.notify_one();
+    if (monitor.joinable()) {
+        monitor.join();
+    }
+}
+
+void ReplicaRouter::beginRequest(const std::string& method, const std::string& client) {
+    t_read_only = method == "GET" || method == "HEAD";
+    t_writes = !t_read_only && method != "OPTIONS";
+    t_pinned = false;
+    ReplicaRouter& router = instance();
+    if (!router.configured()) {
+        return;
+    }
+    t_client = client;
+    if (t_read_only && router.wroteRecently(client, nowNs())) {
+        t_pinned = true;
+        router.read_your_writes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ReplicaRouter::endRequest() {
+    ReplicaRouter& router = instance();
+    if (t_writes && router.configured()) {
+        router.recordWrite(t_client, nowNs());
+    }
+    t_read_only = false;
+    t_writes = false;
+    t_pinned = false;
+}
+
+bool ReplicaRouter::readsFromReplica() {
+    if (!t_read_only || t_pinned) {
+        return false;
+    }
+    ReplicaRouter& router = instance();
+    if (!router.configured()) {
+        return false;
+    }
+    if (!router.healthy.load(std::memory_order_relaxed)) {
+        router.unhealthy_fallbacks.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    router.replica_reads.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool ReplicaRouter::pinnedToPrimary() {
+    return t_pinned;
+}
+
+void ReplicaRouter::replicaFailed() {
+    if (healthy.exchange(false)) {
+        std::cerr << "❌ Read replica connection failed; reads go to the primary" << std::endl;
+    }
+}
+
+bool ReplicaRouter::wroteRecently(const std::string& client, int64_t now_ns) {
+    WriterShard& shard = writers[std::hash<std::string>()(client) % kShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.last_write_ns.find(client);
+    return it != shard.last_write_ns.end() && now_ns - it->second < read_your_writes_ns;
+}
+
+void ReplicaRouter::recordWrite(const std::string& client, int64_t now_ns) {
+    WriterShard& shard = writers[std::hash<std::string>()(client) % kShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.last_write_ns[client] = now_ns;
+    // Forget clients whose window has passed, at most once per doubling of
+    // the shard so the sweep stays amortised O(1)
+    if (shard.last_write_ns.size() >= shard.prune_at) {
+        for (auto it = shard.last_write_ns.begin(); it != shard.last_write_ns.end();) {
+            it = now_ns - it->second >= read_your_writes_ns ? shard.last_write_ns.erase(it) : std::next(it);
+        }
+        shard.prune_at = std::max<size_t>(1024, shard.last_write_ns.size() * 2);
+    }
+}
+
+void ReplicaRouter::startMonitor() {
+    std::lock_guard<std::mutex> lock(monitor_mutex);
+    if (!configured() || monitor.joinable()) {
+        return;
+    }
+    monitor = std::thread([this] {
+        std::unique_ptr<pqxx::connection> conn;
+        std::unique_lock<std::mutex> lock(monitor_mutex);
+        while (!stopping) {
+            lock.unlock();
+            try {
+                if (!conn) {
+                    conn = std::make_unique<pqxx::connection>(replica_dsn);
+                }
+                pqxx::nontransaction txn(*conn);
+                int64_t lag = txn.exec(kLagQuery)[0][0].as<long long>();
+                lag_ms.store(lag, std::memory_order_relaxed);
+                bool ok = lag <= max_lag_ms;
+                if (healthy.exchange(ok) != ok) {
+                    std::cout << (ok ? "✅ Read replica in use, lag " : "⚠️ Read replica lagging, reads go to the primary: lag ")
+                              << lag << " ms" << std::endl;
+                }
+            } catch (const std::exception& e) {
+                conn.reset();
+                if (healthy.exchange(false)) {
+                    std::cerr << "❌ Read replica unreachable, reads go to the primary: " << e.what() << std::endl;
+                }
+            }
+            lock.lock();
+            monitor_wake.wait_for(lock, check_interval, [&] { return stopping; });
+        }
+    });
+}
+
+ReplicaRouter::Stats ReplicaRouter::stats() const {
+    return Stats{configured(), healthy.load(std::memory_order_relaxed), lag_ms.load(std::memory_order_relaxed),
+                 replica_reads.load(std::memory_order_relaxed), unhealthy_fallbacks.load(std::memory_order_relaxed),
+                 read_your_writes.load(std::memory_order_relaxed)};
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// Decides whether PostgresConnection::getReadConnection() may use the read
+// replica (REPLICA_DSN; without it every read stays on the primary).
+//
+// A read goes to the replica only when
+//   - it belongs to a GET or HEAD request (writes, their read-backs,
+//     warm-up and background threads all stay on the primary),
+//   - the replica is healthy: a monitor thread measures its replay lag every
+//     REPLICA_LAG_CHECK_MS (default 1000) and the replica counts as healthy
+//     while that lag is at most REPLICA_MAX_LAG_MS (default 1000) and it
+//     answers at all, and
+//   - the client has not written within REPLICA_READ_YOUR_WRITES_MS
+//     (default 5000, never less than the largest lag the replica may have
+//     while healthy), so a client reads its own writes. Clients are
+//     identified as by the rate limiter (clientKey()).
+//
+// A replica read whose connection breaks is retried once on the primary by
+// PostgresConnection::read(), which also reports it through replicaFailed().
+class ReplicaRouter {
+public:
+    struct Stats {
+        bool configured;
+        bool healthy;
+        int64_t lag_ms;  // -1 before the first successful check
+        uint64_t replica_reads;
+        uint64_t unhealthy_fallbacks;
+        uint64_t read_your_writes;
+    };
+
+    static ReplicaRouter& instance();
+
+    bool configured() const { return !replica_dsn.empty(); }
+    const std::string& dsn() const { return replica_dsn; }
+
+    // Per-request bookkeeping on the handler thread, from the pre- and
+    // post-routing handlers
+    static void beginRequest(const std::string& method, const std::string& client);
+    static void endRequest();
+
+    // Whether the current request's reads go to the replica; counts the
+    // decision for GET /metrics/replica
+    static bool readsFromReplica();
+    // A read request held on the primary because its client wrote recently
+    static bool pinnedToPrimary();
+
+    // A replica connection failed; reads use the primary until the monitor
+    // sees the replica healthy again
+    void replicaFailed();
+
+    void startMonitor();
+    Stats stats() const;
+
+private:
+    struct WriterShard {
+        std::mutex mutex;
+        std::unordered_map<std::string, int64_t> last_write_ns;
+        size_t prune_at = 1024;
+    };
+
+    static constexpr size_t kShards = 16;
+
+    ReplicaRouter();
+    ~ReplicaRouter();
+
+    bool wroteRecently(const std::string& client, int64_t now_ns);
+    void recordWrite(const std::string& client, int64_t now_ns);
+
+    const std::string replica_dsn;
+    const int64_t max_lag_ms;
+    const std::chrono::milliseconds check_interval;
+    const int64_t read_your_writes_ns;
+
+    std::atomic<bool> healthy{false};
+    std::atomic<int64_t> lag_ms{-1};
+    std::atomic<uint64_t> replica_reads{0};
+    std::atomic<uint64_t> unhealthy_fallbacks{0};
+    std::atomic<uint64_t> read_your_writes{0};
+    std::array<WriterShard, kShards> writers;
+
+    std::mutex monitor_mutex;
+    std::condition_variable monitor_wake;
+    bool stopping = false;
+    std::thread monitor;
+};
@@ -0,0 +1,152 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+// Typed row decoding for the repositories. A struct declares its columns
+// once, in SELECT order, by specialising rowmap::Columns:
+//
+//   namespace rowmap {
+//   template <> struct Columns<domain::Notification> {
+//       static constexpr auto value = std::make_tuple(
+//           column("id", &domain::Notification::id),
+//           column("product_id", &domain::Notification::product_id));
+//   };
+//   }
+//
+// columnList<T>() is the "id, product_id" list for the SELECT, built at
+// compile time from that declaration, and decode<T>(row) reads field i into
+// the i-th member by position. Queries and decoders therefore cannot drift
+// apart, and no field is looked up by name (row["name"] costs a libpq
+// PQfnumber call: a case scan of the name plus a strcmp against each
+// column until it matches). A NULL field leaves its member at the struct's
+// default value.
+//
+// Works on any row type with operator[](int) returning a field that offers
+// is_null(), c_str(), size() and as<T>() - i.e. pqxx::row.
+namespace rowmap {
+
+template <typename Struct, typename Field>
+struct Column {
+    const char* name;
+    Field Struct::*member;
+};
+
+template <typename Struct, typename Field>
+constexpr Column<Struct, Field> column(const char* name, Field Struct::*member) {
+    return Column<Struct, Field>{name, member};
+}
+
+// Specialise per struct; see above
+template <typename T>
+struct Columns;
+
+// How a member of type Field is read from a non-NULL field. Specialise for
+// types pqxx cannot convert to directly.
+template <typename Field>
+struct FieldDecoder {
+    template <typename PgField>
+    static void decode(const PgField& f, Field& out) {
+        out = f.template as<Field>();
+    }
+};
+
+// std::string and std::pmr::string: copied straight from the field's text,
+// into the string's own allocator
+template <typename Alloc>
+struct FieldDecoder<std::basic_string<char, std::char_traits<char>, Alloc>> {
+    template <typename PgField>
+    static void decode(const PgField& f, std::basic_string<char, std::char_traits<char>, Alloc>& out) {
+        out.assign(f.c_str(), f.size());
+    }
+};
+
+template <typename T>
+constexpr size_t columnCount() {
+    return std::tuple_size<std::decay_t<decltype(Columns<T>::value)>>::value;
+}
+
+namespace detail {
+
+constexpr size_t length(const char* s) {
+    size_t n = 0;
+    while (s[n] != '\0') {
+        ++n;
+    }
+    return n;
+}
+
+template <typename T>
+constexpr size_t listLength() {
+    size_t n = 0;
+    std::apply([&n](const auto&... c) { ((n += length(c.name) + 2), ...); }, Columns<T>::value);
+    return n - 2;  // no separator before the first column
+}
+
+template <typename T>
+constexpr std::array<char, listLength<T>() + 1> buildList() {
+    std::array<char, listLength<T>() + 1> out{};
+    size_t pos = 0;
+    auto append = [&out, &pos](const char* name) {
+        if (pos > 0) {
+            out[pos++] = ',';
+            out[pos++] = ' ';
+        }
+        for (size_t i = 0; name[i] != '\0'; ++i) {
+            out[pos++] = name[i];
+        }
+    };
+    std::apply([&append](const auto&... c) { (append(c.name), ...); }, Columns<T>::value);
+    return out;
+}
+
+template <typename T>
+inline constexpr auto kColumnList = buildList<T>();
+
+template <typename PgField, typename Field>
+inline void decodeField(const PgField& f, Field& out) {
+    if (!f.is_null()) {
+        FieldDecoder<Field>::decode(f, out);
+    }
+}
+
+template <typename T, typename Row, size_t... I>
+inline void decodeColumns(const Row& row, T& out, std::index_sequence<I...>) {
+    (decodeField(row[static_cast<int>(I)], out.*(std::get<I>(Columns<T>::value).member)), ...);
+}
+
+} // namespace detail
+
+// "id, product_id, ..." for T, in declaration order
+template <typename T>
+constexpr std::string_view columnList() {
+    return std::string_view(detail::kColumnList<T>.data(), detail::kColumnList<T>.size() - 1);
+}
+
+// "SELECT <columnList<T>()> <rest>"; build once and keep (e.g. a static)
+template <typename T>
+std::string select(std::string_view rest) {
+    std::string sql = "SELECT ";
+    sql += columnList<T>();
+    sql += ' ';
+    sql += rest;
+    return sql;
+}
+
+// Decodes a row selected with columnList<T>() into `out`
+template <typename T, typename Row>
+inline void decodeInto(const Row& row, T& out) {
+    detail::decodeColumns(row, out, std::make_index_sequence<columnCount<T>()>{});
+}
+
+template <typename T, typename Row>
+inline T decode(const Row& row) {
+    T out;
+    decodeInto(row, out);
+    return out;
+}
+
+} // namespace rowmap
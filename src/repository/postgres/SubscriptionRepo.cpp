@@ -1,9 +1,12 @@
 #include <pqxx/pqxx>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "../interfaces/IsubscriptionRepo.h"
 #include "PostgresConnection.h"
+#include "PgArray.h"
+#include "../cache/DashboardCounters.h"
 
 class SubscriptionRepo : public IsubscriptionRepo {
 public:
@@ -15,26 +18,30 @@ public:
             user_id
         );
         txn.commit();
+        DashboardCounters::instance().subscriptionAdded(prod_id, true);
     }
 
     void unsubscribe(int prod_id, int user_id) override {
         pqxx::work txn(PostgresConnection::getConnection());
-        txn.exec_params(
-            "DELETE FROM subscriptions WHERE product_id = $1 AND user_id = $2",
+        pqxx::result r = txn.exec_params(
+            "DELETE FROM subscriptions WHERE product_id = $1 AND user_id = $2 RETURNING active",
             prod_id,
             user_id
         );
         txn.commit();
+        for (const auto& row : r) {
+            DashboardCounters::instance().subscriptionRemoved(prod_id, row[0].as<bool>(false));
+        }
     }
 
     std::vector<int> find_subscribers(int prod_id) override {
-        pqxx::work txn(PostgresConnection::getConnection());
         std::vector<int> subscribers;
-
-        pqxx::result r = txn.exec_params(
-            "SELECT user_id FROM subscriptions WHERE product_id = $1",
-            prod_id
-        );
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT user_id FROM subscriptions WHERE product_id = $1",
+                prod_id
+            );
+        });
 
         for (const auto& row : r) {
             subscribers.push_back(row["user_id"].as<int>());
@@ -42,4 +49,30 @@ public:
 
         return subscribers;
     }
+
+    std::vector<std::vector<int>> find_subscribers_by_ids(const std::vector<int>& prod_ids) override {
+        std::vector<std::vector<int>> subscribers(prod_ids.size());
+        if (prod_ids.empty()) {
+            return subscribers;
+        }
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT product_id, user_id FROM subscriptions WHERE product_id = ANY($1::int[])",
+                pgarray::ints(prod_ids)
+            );
+        });
+
+        std::unordered_map<int, std::vector<int>> by_product;
+        for (const auto& row : r) {
+            by_product[row["product_id"].as<int>()].push_back(row["user_id"].as<int>());
+        }
+        for (size_t i = 0; i < prod_ids.size(); ++i) {
+            auto it = by_product.find(prod_ids[i]);
+            if (it != by_product.end()) {
+                subscribers[i] = it->second;
+            }
+        }
+
+        return subscribers;
+    }
 };
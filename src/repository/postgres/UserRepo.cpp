@@ -1,7 +1,11 @@
 #include <pqxx/pqxx>
 #include <string>
+#include <unordered_map>
+#include <vector>
 using namespace std;
 #include "PostgresConnection.h"
+#include "PgArray.h"
+#include "../cache/DashboardCounters.h"
 
 #include "../../domain/product.h"
 #include "../../domain/user.h"
@@ -21,16 +25,17 @@ class UserRepo : public IuserRepo {
         );
         int userId = r[0][0].as<int>();
         txn.commit();
+        DashboardCounters::instance().userCreated();
         return userId;
     }
     user find_by_id(int user_id)override{
-       pqxx::work txn(PostgresConnection::getConnection());
-
-        pqxx:: result r = txn.exec_params(
-            "SELECT id, name, email, role "
-            "FROM users WHERE id = $1",
-            user_id
-        );
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT id, name, email, role "
+                "FROM users WHERE id = $1",
+                user_id
+            );
+        });
         if(r.empty()){
             throw std::runtime_error("User not found");
         }
@@ -42,14 +47,46 @@ class UserRepo : public IuserRepo {
         );
 
     }
+    vector<user> find_by_ids(const vector<int>& user_ids)override{
+        std::vector<user> users;
+        if (user_ids.empty()) {
+            return users;
+        }
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT id, name, email, role "
+                "FROM users WHERE id = ANY($1::int[])",
+                pgarray::ints(user_ids)
+            );
+        });
+        unordered_map<int, user> by_id;
+        by_id.reserve(r.size());
+        for (const auto& row : r) {
+            int id = row["id"].as<int>();
+            by_id.emplace(id, user(
+                id,
+                row["name"].as<string>(),
+                row["email"].as<string>(),
+                row["role"].as<string>()
+            ));
+        }
+        users.reserve(by_id.size());
+        for (int id : user_ids) {
+            auto it = by_id.find(id);
+            if (it != by_id.end()) {
+                users.push_back(it->second);
+            }
+        }
+        return users;
+    }
     user find_by_email(string email)override{
-        pqxx::work txn(PostgresConnection::getConnection());
-
-        pqxx:: result r = txn.exec_params(
-            "SELECT id, name, email, role "
-            "FROM users WHERE email = $1",
-            email
-        );
+        pqxx::result r = PostgresConnection::read([&](pqxx::work& txn) {
+            return txn.exec_params(
+                "SELECT id, name, email, role "
+                "FROM users WHERE email = $1",
+                email
+            );
+        });
         if(r.empty()){
             throw std::runtime_error("User not found");
         }
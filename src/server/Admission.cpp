@@ -0,0 +1,166 @@
+#include "Admission.h"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <unordered_set>
+#include <nlohmann/json.hpp>
+#include "Config.h"
+#include "ConcurrencyLimit.h"
+#include "RateLimiter.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+std::atomic<uint64_t> g_client_limited{0};
+std::atomic<uint64_t> g_route_limited{0};
+std::atomic<uint64_t> g_shed{0};
+
+RateLimiter& clientLimiter() {
+    static RateLimiter limiter(static_cast<double>(Config::envSize("RATE_LIMIT_CLIENT_RPS", 0)),
+                               static_cast<double>(Config::envSize("RATE_LIMIT_CLIENT_BURST",
+                                                                   2 * Config::envSize("RATE_LIMIT_CLIENT_RPS", 0))),
+                               Config::envSize("RATE_LIMIT_CLIENTS", 65536));
+    return limiter;
+}
+
+RateLimiter& routeLimiter() {
+    static RateLimiter limiter(static_cast<double>(Config::envSize("RATE_LIMIT_ROUTE_RPS", 0)),
+                               static_cast<double>(Config::envSize("RATE_LIMIT_ROUTE_BURST",
+                                                                   2 * Config::envSize("RATE_LIMIT_ROUTE_RPS", 0))),
+                               1024);
+    return limiter;
+}
+
+bool exempt(const httplib::Request& req) {
+    return req.method == "OPTIONS" || req.path == "/ready" || req.path.rfind("/metrics/", 0) == 0;
+}
+
+// "PUT /api/inventory/42" -> "PUT /api/inventory/:id"
+std::string routeKey(const httplib::Request& req) {
+    std::string key = req.method;
+    key += ' ';
+    size_t i = 0;
+    while (i < req.path.size()) {
+        size_t end = req.path.find('/', i + 1);
+        if (end == std::string::npos) {
+            end = req.path.size();
+        }
+        bool numeric = end > i + 1;
+        for (size_t j = i + 1; j < end && numeric; ++j) {
+            numeric = req.path[j] >= '0' && req.path[j] <= '9';
+        }
+        if (numeric) {
+            key += "/:id";
+        } else {
+            key.append(req.path, i, end - i);
+        }
+        i = end;
+    }
+    return key;
+}
+
+void reject(httplib::Response& res, int status, int64_t retry_after_s, const char* message) {
+    res.set_header("Retry-After", std::to_string(retry_after_s));
+    res.set_content(json{{"error", message}}.dump(), "application/json");
+    res.status = status;
+}
+
+int64_t toRetryAfter(int64_t wait_ns) {
+    return std::max<int64_t>(1, (wait_ns + 999999999) / 1000000000);
+}
+
+// RATE_LIMIT_TRUSTED_PROXIES: comma-separated peer addresses whose
+// X-Client-Id header is believed. Anyone else could rotate it at will.
+bool trustedProxy(const std::string& addr) {
+    static const std::unordered_set<std::string> proxies = [] {
+        std::unordered_set<std::string> set;
+        std::string list = Config::envString("RATE_LIMIT_TRUSTED_PROXIES", "");
+        size_t i = 0;
+        while (i <= list.size()) {
+            size_t end = std::min(list.find(',', i), list.size());
+            std::string entry = list.substr(i, end - i);
+            entry.erase(0, entry.find_first_not_of(' '));
+            entry.erase(entry.find_last_not_of(' ') + 1);
+            if (!entry.empty()) {
+                set.insert(entry);
+            }
+            i = end + 1;
+        }
+        return set;
+    }();
+    return !proxies.empty() && proxies.count(addr) > 0;
+}
+
+// An IPv6 host picks its own interface identifier, so its /64 is the client
+std::string peerKey(const std::string& addr) {
+    in6_addr ip6;
+    if (addr.find(':') == std::string::npos || inet_pton(AF_INET6, addr.c_str(), &ip6) != 1) {
+        return addr;
+    }
+    std::fill(ip6.s6_addr + 8, ip6.s6_addr + 16, 0);
+    char text[INET6_ADDRSTRLEN];
+    if (!inet_ntop(AF_INET6, &ip6, text, sizeof(text))) {
+        return addr;
+    }
+    return std::string(text) + "/64";
+}
+
+} // namespace
+
+std::string clientKey(const httplib::Request& req) {
+    if (trustedProxy(req.remote_addr)) {
+        std::string client = req.get_header_value("X-Client-Id");
+        if (!client.empty()) {
+            return client;
+        }
+    }
+    return peerKey(req.remote_addr);
+}
+
+bool admitRequest(const httplib::Request& req, httplib::Response& res) {
+    if (exempt(req)) {
+        return true;
+    }
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    if (clientLimiter().enabled()) {
+        if (int64_t wait = clientLimiter().take(clientKey(req), now)) {
+            g_client_limited.fetch_add(1, std::memory_order_relaxed);
+            reject(res, 429, toRetryAfter(wait), "Too many requests from this client");
+            return false;
+        }
+    }
+    if (routeLimiter().enabled()) {
+        if (int64_t wait = routeLimiter().take(routeKey(req), now)) {
+            g_route_limited.fetch_add(1, std::memory_order_relaxed);
+            reject(res, 429, toRetryAfter(wait), "Too many requests for this endpoint");
+            return false;
+        }
+    }
+    return true;
+}
+
+void finishRequest(httplib::Response& res) {
+    if (ConcurrencyLimit::end()) {
+        return;
+    }
+    g_shed.fetch_add(1, std::memory_order_relaxed);
+    reject(res, 503, 1, "Server is overloaded, retry later");
+
+    // Post-routing runs after httplib has set Content-Length
+    auto length = res.headers.equal_range("Content-Length");
+    if (length.first != length.second) {
+        res.headers.erase(length.first, length.second);
+        res.set_header("Content-Length", std::to_string(res.body.size()));
+    }
+}
+
+AdmissionStats admissionStats() {
+    return AdmissionStats{g_client_limited.load(std::memory_order_relaxed),
+                          g_route_limited.load(std::memory_order_relaxed),
+                          g_shed.load(std::memory_order_relaxed)};
+}
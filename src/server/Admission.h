@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "../external/httplib.h"
+
+// Load shedding around the routes, from the pre- and post-routing handlers.
+//
+// admitRequest() applies two token-bucket rate limits before routing: one
+// per client (see clientKey(); RATE_LIMIT_CLIENT_RPS /
+// RATE_LIMIT_CLIENT_BURST) and one per route (the
+// method and path with numeric segments as ":id"; RATE_LIMIT_ROUTE_RPS /
+// RATE_LIMIT_ROUTE_BURST). Both are off unless a rate is set. A request
+// over either gets 429 with Retry-After at once.
+//
+// finishRequest() turns the response of a request that ConcurrencyLimit
+// refused a database slot into 503 with Retry-After, whatever the handler
+// made of the Overloaded exception.
+//
+// GET /ready and /metrics/* are never limited.
+bool admitRequest(const httplib::Request& req, httplib::Response& res);
+void finishRequest(httplib::Response& res);
+
+// The client a request is attributed to: the peer address (an IPv6 peer by
+// its /64), or the X-Client-Id header when the peer is one of
+// RATE_LIMIT_TRUSTED_PROXIES
+std::string clientKey(const httplib::Request& req);
+
+struct AdmissionStats {
+    uint64_t client_limited = 0;
+    uint64_t route_limited = 0;
+    uint64_t shed = 0;
+};
+
+AdmissionStats admissionStats();
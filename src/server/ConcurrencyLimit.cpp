@@ -0,0 +1,117 @@
+#include "ConcurrencyLimit.h"
+#include <algorithm>
+#include <cmath>
+#include "Config.h"
+#include "../external/httplib.h"
+
+namespace {
+
+thread_local bool t_in_request = false;
+thread_local bool t_holds_slot = false;
+thread_local bool t_refused = false;
+thread_local std::chrono::steady_clock::time_point t_entered;
+
+size_t defaultMaxConcurrency() {
+    size_t pool = CPPHTTPLIB_THREAD_POOL_COUNT;
+    return pool > 2 ? pool - 2 : 1;
+}
+
+} // namespace
+
+ConcurrencyLimit& ConcurrencyLimit::instance() {
+    static ConcurrencyLimit limiter;
+    return limiter;
+}
+
+ConcurrencyLimit::ConcurrencyLimit()
+    : min_limit(static_cast<double>(std::max<size_t>(Config::envSize("ADMISSION_MIN_CONCURRENCY", 1), 1))),
+      max_limit(std::max(min_limit,
+                         static_cast<double>(Config::envSize("ADMISSION_MAX_CONCURRENCY", defaultMaxConcurrency())))),
+      target(std::chrono::milliseconds(Config::envSize("ADMISSION_LATENCY_TARGET_MS", 250))),
+      limit(max_limit) {}
+
+void ConcurrencyLimit::begin() {
+    // The previous request on this thread never reached end() (connection
+    // dropped mid-way); give its slot back
+    if (t_holds_slot) {
+        instance().release(Clock::now() - t_entered);
+    }
+    t_in_request = true;
+    t_holds_slot = false;
+    t_refused = false;
+}
+
+bool ConcurrencyLimit::end() {
+    if (t_holds_slot) {
+        instance().release(Clock::now() - t_entered);
+    }
+    bool refused = t_refused;
+    t_in_request = false;
+    t_holds_slot = false;
+    t_refused = false;
+    return !refused;
+}
+
+void ConcurrencyLimit::enterDatabase() {
+    if (!t_in_request || t_holds_slot) {
+        return;
+    }
+    // A handler that caught the first Overloaded and tried again is
+    // refused again
+    if (t_refused || !instance().tryAcquire()) {
+        t_refused = true;
+        throw Overloaded();
+    }
+    t_holds_slot = true;
+    t_entered = Clock::now();
+}
+
+void ConcurrencyLimit::shed() {
+    if (t_in_request) {
+        t_refused = true;
+    }
+}
+
+bool ConcurrencyLimit::tryAcquire() {
+    int current = in_flight.load(std::memory_order_relaxed);
+    while (true) {
+        if (current >= static_cast<int>(std::floor(limit.load(std::memory_order_relaxed)))) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (in_flight.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel)) {
+            admitted.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+}
+
+void ConcurrencyLimit::release(Clock::duration elapsed) {
+    int busy = in_flight.fetch_sub(1, std::memory_order_acq_rel);
+    double current = limit.load(std::memory_order_relaxed);
+
+    if (elapsed > target) {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+        int64_t last = last_decrease_ns.load(std::memory_order_relaxed);
+        int64_t window = std::chrono::duration_cast<std::chrono::nanoseconds>(target).count();
+        if (now - last < window || !last_decrease_ns.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            return;
+        }
+        while (!limit.compare_exchange_weak(current, std::max(min_limit, current * 0.9), std::memory_order_relaxed)) {
+        }
+        return;
+    }
+
+    if (busy * 2 < current) {
+        return;
+    }
+    while (current < max_limit &&
+           !limit.compare_exchange_weak(current, std::min(max_limit, current + 1.0 / current),
+                                        std::memory_order_relaxed)) {
+    }
+}
+
+ConcurrencyLimit::Stats ConcurrencyLimit::stats() const {
+    return Stats{limit.load(std::memory_order_relaxed), in_flight.load(std::memory_order_relaxed),
+                 admitted.load(std::memory_order_relaxed), rejected.load(std::memory_order_relaxed)};
+}
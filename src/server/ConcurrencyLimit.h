@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+
+// Thrown by PostgresConnection::getConnection() when a request would take
+// the database past the concurrency limit. Handlers report it like any
+// other failure; the post-routing handler turns the response into a 503.
+class Overloaded : public std::runtime_error {
+public:
+    Overloaded() : std::runtime_error("server overloaded, retry later") {}
+};
+
+// Adaptive limit on the number of requests using the database at once.
+//
+// A request counts from its first getConnection() until it ends, so
+// requests answered from the caches and indexes are never counted or
+// refused. The limit starts at ADMISSION_MAX_CONCURRENCY (default: the
+// handler pool size minus 2, which keeps threads free for those cheap
+// requests while the database is slow) and adapts by AIMD on the time each
+// request spent after reaching the database:
+//   - slower than ADMISSION_LATENCY_TARGET_MS (default 250): the limit is
+//     multiplied by 0.9, at most once per target interval so one slow
+//     burst does not collapse it;
+//   - otherwise, while at least half the limit is in use, it grows by
+//     1/limit, i.e. by one after a limit's worth of fast requests.
+// It never drops below ADMISSION_MIN_CONCURRENCY (default 1).
+class ConcurrencyLimit {
+public:
+    struct Stats {
+        double limit;
+        int in_flight;
+        uint64_t admitted;
+        uint64_t rejected;
+    };
+
+    static ConcurrencyLimit& instance();
+
+    // Per-request bookkeeping on the handler thread, from the pre- and
+    // post-routing handlers. end() returns false when the request was
+    // refused a slot.
+    static void begin();
+    static bool end();
+
+    // Called before the database is used: takes a slot for the current
+    // request (once) or throws Overloaded. Does nothing outside a request,
+    // so warm-up and background threads are not limited.
+    static void enterDatabase();
+
+    // Marks the current request as refused, for one that received another
+    // request's Overloaded (a coalesced lookup, util/SingleFlight.h)
+    static void shed();
+
+    Stats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ConcurrencyLimit();
+
+    bool tryAcquire();
+    void release(Clock::duration elapsed);
+
+    const double min_limit;
+    const double max_limit;
+    const Clock::duration target;
+    std::atomic<double> limit;
+    std::atomic<int> in_flight{0};
+    std::atomic<int64_t> last_decrease_ns{0};
+    std::atomic<uint64_t> admitted{0};
+    std::atomic<uint64_t> rejected{0};
+};
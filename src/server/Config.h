@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdlib>
+#include <string>
+
+// Process configuration read from environment variables.
+namespace Config {
+
+inline std::string envString(const char* name, const std::string& fallback) {
+    const char* value = std::getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return fallback;
+    }
+    return value;
+}
+
+inline size_t envSize(const char* name, size_t fallback) {
+    const char* value = std::getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return fallback;
+    }
+    return static_cast<size_t>(std::stoul(value));
+}
+
+// SEARCH_BACKEND=postgres answers /api/products/search with pg_trgm
+// (db/search_migration.sql) instead of the in-process trigram index, for
+// deployments that should not hold the catalog's search index in memory.
+inline bool useDatabaseSearch() {
+    static const bool database = envString("SEARCH_BACKEND", "memory") == "postgres";
+    return database;
+}
+
+} // namespace Config
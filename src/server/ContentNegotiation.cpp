@@ -0,0 +1,30 @@
+#include "ContentNegotiation.h"
+#include <cstdint>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../util/ResponseWriter.h"
+
+using json = nlohmann::json;
+
+void applyResponseFormat(const httplib::Request& req, httplib::Response& res) {
+    res.set_header("Vary", "Accept");
+
+    ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+    if (format == ResponseFormat::Json || res.body.empty() ||
+        res.get_header_value("Content-Type") != "application/json" || res.has_header("Content-Encoding")) {
+        return;
+    }
+
+    json tree = json::parse(res.body, nullptr, false);
+    if (tree.is_discarded()) {
+        return;
+    }
+    std::vector<uint8_t> encoded = format == ResponseFormat::MsgPack ? json::to_msgpack(tree) : json::to_cbor(tree);
+    res.set_content(std::string(encoded.begin(), encoded.end()), responseformat::contentType(format));
+
+    auto length = res.headers.equal_range("Content-Length");
+    if (length.first != length.second) {
+        res.headers.erase(length.first, length.second);
+        res.set_header("Content-Length", std::to_string(res.body.size()));
+    }
+}
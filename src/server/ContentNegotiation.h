@@ -0,0 +1,13 @@
+#pragma once
+#include "../external/httplib.h"
+
+// Called from the post-routing handler. List handlers already encode their
+// rows in the format the Accept header asks for (util/ResponseWriter.h);
+// the remaining responses - single objects, errors, /ready - are built as
+// nlohmann trees and arrive here as JSON text, which is converted to
+// MessagePack / CBOR when the client asked for one of those. Also adds
+// "Vary: Accept", since the same URL now has several representations.
+//
+// Post-routing runs after httplib has set Content-Length, so a converted
+// body gets its Content-Length replaced here.
+void applyResponseFormat(const httplib::Request& req, httplib::Response& res);
@@ -0,0 +1,754 @@
+#include "EventLoopServer.h"
+#include <algorithm>
+#include <iostream>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+constexpr size_t kMaxHeaderBytes = CPPHTTPLIB_HEADER_MAX_LENGTH;
+constexpr size_t kReadChunk = 16 * 1024;
+constexpr int kMaxEvents = 256;
+constexpr int kSweepIntervalMs = 1000;
+
+// httplib::Stream over a request that has already been read in full. The
+// handler thread never touches the socket: reads come from the buffer and
+// the response is collected for the I/O thread to send.
+class BufferedRequestStream final : public httplib::Stream {
+private:
+    const std::string& request;
+    std::string& response;
+    size_t position = 0;
+    int sock;
+    const EventLoopServer::Peer& peer;
+
+public:
+    BufferedRequestStream(const std::string& request, std::string& response,
+                          int sock, const EventLoopServer::Peer& peer)
+        : request(request), response(response), sock(sock), peer(peer) {}
+
+    bool is_readable() const override { return position < request.size(); }
+    bool wait_readable() const override { return true; }
+    bool wait_writable() const override { return true; }
+
+    ssize_t read(char* ptr, size_t size) override {
+        size_t n = std::min(size, request.size() - position);
+        std::memcpy(ptr, request.data() + position, n);
+        position += n;
+        return static_cast<ssize_t>(n);
+    }
+
+    ssize_t write(const char* ptr, size_t size) override {
+        response.append(ptr, size);
+        return static_cast<ssize_t>(size);
+    }
+
+    void get_remote_ip_and_port(std::string& ip, int& port) const override {
+        ip = peer.remote_addr;
+        port = peer.remote_port;
+    }
+
+    void get_local_ip_and_port(std::string& ip, int& port) const override {
+        ip = peer.local_addr;
+        port = peer.local_port;
+    }
+
+    socket_t socket() const override { return sock; }
+    time_t duration() const override { return 0; }
+};
+
+enum class Framing { Incomplete, Complete, TooLarge, Invalid };
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Looks up a header in the raw header block (request line included).
+std::string_view headerValue(std::string_view headers, std::string_view name) {
+    size_t line_start = headers.find("\r\n");
+    while (line_start != std::string_view::npos) {
+        line_start += 2;
+        size_t line_end = headers.find("\r\n", line_start);
+        std::string_view line = headers.substr(line_start, line_end == std::string_view::npos
+                                                              ? std::string_view::npos
+                                                              : line_end - line_start);
+        size_t colon = line.find(':');
+        if (colon != std::string_view::npos && equalsIgnoreCase(line.substr(0, colon), name)) {
+            std::string_view value = line.substr(colon + 1);
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+            return value;
+        }
+        line_start = line_end;
+    }
+    return {};
+}
+
+// Walks a chunked body to find where the message ends; decoding is left to
+// httplib once the whole message is buffered.
+Framing frameChunked(const std::string& in, size_t pos, size_t max_body, size_t& length) {
+    size_t body_bytes = 0;
+    for (;;) {
+        size_t line_end = in.find("\r\n", pos);
+        if (line_end == std::string::npos) {
+            return in.size() - pos > kMaxHeaderBytes ? Framing::Invalid : Framing::Incomplete;
+        }
+        size_t chunk_size = 0;
+        auto [end, ec] = std::from_chars(in.data() + pos, in.data() + line_end, chunk_size, 16);
+        if (ec != std::errc() || end == in.data() + pos) {
+            return Framing::Invalid;
+        }
+        if (chunk_size == 0) {
+            // Optional trailers, terminated by an empty line
+            size_t trailer_start = line_end + 2;
+            if (in.size() < trailer_start + 2) {
+                return Framing::Incomplete;
+            }
+            if (in.compare(trailer_start, 2, "\r\n") == 0) {
+                length = trailer_start + 2;
+                return Framing::Complete;
+            }
+            size_t trailers_end = in.find("\r\n\r\n", trailer_start);
+            if (trailers_end == std::string::npos) {
+                return Framing::Incomplete;
+            }
+            length = trailers_end + 4;
+            return Framing::Complete;
+        }
+        body_bytes += chunk_size;
+        if (body_bytes > max_body) {
+            return Framing::TooLarge;
+        }
+        pos = line_end + 2 + chunk_size + 2;
+        if (pos > in.size()) {
+            return Framing::Incomplete;
+        }
+    }
+}
+
+// Decides whether `in` starts with one complete HTTP/1.x request and, if
+// so, how many bytes it spans.
+Framing frameRequest(const std::string& in, size_t max_body, size_t& length) {
+    size_t header_end = in.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+        return in.size() > kMaxHeaderBytes ? Framing::TooLarge : Framing::Incomplete;
+    }
+    if (header_end > kMaxHeaderBytes) {
+        return Framing::TooLarge;
+    }
+    size_t body_start = header_end + 4;
+    std::string_view headers(in.data(), header_end);
+
+    std::string_view transfer_encoding = headerValue(headers, "Transfer-Encoding");
+    if (!transfer_encoding.empty()) {
+        if (transfer_encoding.find("chunked") == std::string_view::npos) {
+            return Framing::Invalid;
+        }
+        return frameChunked(in, body_start, max_body, length);
+    }
+
+    size_t content_length = 0;
+    std::string_view cl = headerValue(headers, "Content-Length");
+    if (!cl.empty()) {
+        auto [end, ec] = std::from_chars(cl.data(), cl.data() + cl.size(), content_length);
+        if (ec != std::errc() || end != cl.data() + cl.size()) {
+            return Framing::Invalid;
+        }
+    }
+    if (content_length > max_body) {
+        return Framing::TooLarge;
+    }
+    if (in.size() - body_start < content_length) {
+        return Framing::Incomplete;
+    }
+    length = body_start + content_length;
+    return Framing::Complete;
+}
+
+// True when `in` holds the complete headers of an HTTP/1.1 request that
+// asks for "Expect: 100-continue" and none of its body yet: the client is
+// waiting for the interim response before it sends the body.
+bool expectsContinue(const std::string& in) {
+    size_t header_end = in.find("\r\n\r\n");
+    if (header_end == std::string::npos || in.size() != header_end + 4) {
+        return false;
+    }
+    std::string_view headers(in.data(), header_end);
+    std::string_view request_line = headers.substr(0, headers.find("\r\n"));
+    if (request_line.size() < 8 || request_line.substr(request_line.size() - 8) != "HTTP/1.1") {
+        return false;
+    }
+    return equalsIgnoreCase(headerValue(headers, "Expect"), "100-continue");
+}
+
+constexpr std::string_view kContinueResponse = "HTTP/1.1 100 Continue\r\n\r\n";
+
+std::string cannedResponse(int status, const char* reason) {
+    return "HTTP/1.1 " + std::to_string(status) + " " + reason +
+           "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+}
+
+void addressOf(const sockaddr_storage& addr, std::string& ip, int& port) {
+    char buf[INET6_ADDRSTRLEN] = {0};
+    if (addr.ss_family == AF_INET) {
+        auto* in4 = reinterpret_cast<const sockaddr_in*>(&addr);
+        inet_ntop(AF_INET, &in4->sin_addr, buf, sizeof(buf));
+        port = ntohs(in4->sin_port);
+    } else if (addr.ss_family == AF_INET6) {
+        auto* in6 = reinterpret_cast<const sockaddr_in6*>(&addr);
+        inet_ntop(AF_INET6, &in6->sin6_addr, buf, sizeof(buf));
+        port = ntohs(in6->sin6_port);
+    }
+    ip = buf;
+}
+
+} // namespace
+
+// One epoll instance and the connections it owns. All Connection state is
+// touched only by the loop thread; handler threads talk back through post().
+class EventLoopServer::IoLoop {
+private:
+    struct Connection {
+        int fd;
+        uint64_t serial;
+        EventLoopServer::Peer peer;
+        std::string in;
+        std::string out;
+        size_t out_offset = 0;
+        uint32_t events = 0;
+        size_t requests_served = 0;
+        bool busy = false;
+        bool peer_closed = false;
+        bool hung_up = false;
+        bool close_after_write = false;
+        bool continue_sent = false;  // 100 Continue already sent for the buffered request
+        std::chrono::steady_clock::time_point last_active;
+        std::chrono::steady_clock::time_point last_write;  // last send progress on `out`
+    };
+
+    struct Completion {
+        int fd;
+        uint64_t serial;
+        std::string response;
+        bool close;
+    };
+
+    EventLoopServer& server;
+    int listen_fd;
+    int epoll_fd = -1;
+    int wake_fd = -1;
+    uint64_t next_serial = 1;
+    std::thread thread;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+
+    std::mutex completions_mutex;
+    std::vector<Completion> completions;
+
+public:
+    IoLoop(EventLoopServer& server, int listen_fd) : server(server), listen_fd(listen_fd) {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wake_fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+
+        // EPOLLEXCLUSIVE: a new connection wakes one loop, not all of them
+        ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+        ev.data.fd = listen_fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    }
+
+    ~IoLoop() {
+        for (auto& entry : connections) {
+            ::close(entry.first);
+        }
+        if (wake_fd >= 0) ::close(wake_fd);
+        if (epoll_fd >= 0) ::close(epoll_fd);
+    }
+
+    void start() { thread = std::thread([this] { run(); }); }
+
+    void join() {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t n = ::write(wake_fd, &one, sizeof(one));
+        (void)n;
+    }
+
+    // Called from handler threads when a response is ready.
+    void post(int fd, uint64_t serial, std::string response, bool close) {
+        {
+            std::lock_guard<std::mutex> lock(completions_mutex);
+            completions.push_back(Completion{fd, serial, std::move(response), close});
+        }
+        wake();
+    }
+
+private:
+    void run() {
+        epoll_event events[kMaxEvents];
+        auto last_sweep = std::chrono::steady_clock::now();
+
+        while (server.running.load(std::memory_order_acquire)) {
+            int n = epoll_wait(epoll_fd, events, kMaxEvents, kSweepIntervalMs);
+            if (n < 0 && errno != EINTR) {
+                std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+                break;
+            }
+
+            for (int i = 0; i < n; ++i) {
+                int fd = events[i].data.fd;
+                uint32_t ev = events[i].events;
+
+                if (fd == wake_fd) {
+                    uint64_t value;
+                    while (::read(wake_fd, &value, sizeof(value)) > 0) {}
+                    continue;
+                }
+                if (fd == listen_fd) {
+                    acceptAll();
+                    continue;
+                }
+
+                auto it = connections.find(fd);
+                if (it == connections.end()) {
+                    continue;
+                }
+                Connection& conn = *it->second;
+
+                if (ev & (EPOLLERR | EPOLLHUP) && !(ev & EPOLLIN)) {
+                    if (!conn.busy) {
+                        closeConnection(conn);
+                        continue;
+                    }
+                    // HUP is level-triggered regardless of interest; stop
+                    // watching and drop the connection once its handler returns
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+                    conn.peer_closed = true;
+                    conn.hung_up = true;
+                    continue;
+                }
+                if ((ev & EPOLLOUT) && !flush(conn)) {
+                    continue;
+                }
+                if (ev & EPOLLIN) {
+                    onReadable(conn);
+                }
+            }
+
+            drainCompletions();
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_sweep >= std::chrono::milliseconds(kSweepIntervalMs)) {
+                sweepIdle(now);
+                last_sweep = now;
+            }
+        }
+    }
+
+    void acceptAll() {
+        for (;;) {
+            sockaddr_storage addr{};
+            socklen_t len = sizeof(addr);
+            int fd = accept4(listen_fd, reinterpret_cast<sockaddr*>(&addr), &len,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+                }
+                return;
+            }
+
+            int yes = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+            auto conn = std::make_unique<Connection>();
+            conn->fd = fd;
+            conn->serial = next_serial++;
+            conn->last_active = std::chrono::steady_clock::now();
+            addressOf(addr, conn->peer.remote_addr, conn->peer.remote_port);
+
+            sockaddr_storage local{};
+            socklen_t local_len = sizeof(local);
+            if (getsockname(fd, reinterpret_cast<sockaddr*>(&local), &local_len) == 0) {
+                addressOf(local, conn->peer.local_addr, conn->peer.local_port);
+            }
+
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                ::close(fd);
+                continue;
+            }
+            conn->events = EPOLLIN;
+            connections.emplace(fd, std::move(conn));
+        }
+    }
+
+    void onReadable(Connection& conn) {
+        for (;;) {
+            size_t old_size = conn.in.size();
+            conn.in.resize(old_size + kReadChunk);
+            ssize_t n = ::read(conn.fd, &conn.in[old_size], kReadChunk);
+            conn.in.resize(old_size + (n > 0 ? static_cast<size_t>(n) : 0));
+            if (n > 0) {
+                continue;
+            }
+            if (n == 0) {
+                conn.peer_closed = true;
+                break;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            closeConnection(conn);
+            return;
+        }
+        conn.last_active = std::chrono::steady_clock::now();
+        dispatchNext(conn);
+    }
+
+    // Starts the next buffered request if the connection is idle. Returns
+    // false if the connection was closed.
+    bool dispatchNext(Connection& conn) {
+        if (conn.busy || conn.out_offset < conn.out.size()) {
+            return true;
+        }
+
+        size_t length = 0;
+        Framing framing = frameRequest(conn.in, server.payload_max_length_, length);
+        switch (framing) {
+            case Framing::Incomplete:
+                if (conn.peer_closed) {
+                    closeConnection(conn);
+                    return false;
+                }
+                // The handler only runs once the body is here, so answer the
+                // Expect header now or the client waits out its own timeout
+                if (!conn.continue_sent && expectsContinue(conn.in)) {
+                    conn.continue_sent = true;
+                    conn.out += kContinueResponse;
+                    return flush(conn);
+                }
+                updateInterest(conn);
+                return true;
+            case Framing::TooLarge:
+                return respondAndClose(conn, conn.in.find("\r\n\r\n") == std::string::npos
+                                                 ? cannedResponse(431, "Request Header Fields Too Large")
+                                                 : cannedResponse(413, "Payload Too Large"));
+            case Framing::Invalid:
+                return respondAndClose(conn, cannedResponse(400, "Bad Request"));
+            case Framing::Complete:
+                break;
+        }
+
+        std::string request = conn.in.substr(0, length);
+        conn.in.erase(0, length);
+        bool continue_sent = conn.continue_sent;
+        conn.continue_sent = false;
+        conn.busy = true;
+        updateInterest(conn);
+
+        bool close_connection = ++conn.requests_served >= server.keep_alive_max_count_;
+        IoLoop* loop = this;
+        EventLoopServer* srv = &server;
+        int fd = conn.fd;
+        uint64_t serial = conn.serial;
+        EventLoopServer::Peer peer = conn.peer;
+
+        bool queued = server.handler_pool->enqueue(
+            [loop, srv, fd, serial, peer, close_connection, continue_sent, request = std::move(request)]() {
+                bool connection_closed = false;
+                std::string response = srv->handleRequest(request, peer, fd, close_connection, continue_sent,
+                                                          connection_closed);
+                loop->post(fd, serial, std::move(response), close_connection || connection_closed);
+            });
+        if (!queued) {
+            conn.busy = false;
+            return respondAndClose(conn, cannedResponse(503, "Service Unavailable"));
+        }
+        return true;
+    }
+
+    bool respondAndClose(Connection& conn, std::string response) {
+        conn.in.clear();
+        conn.out += response;
+        conn.close_after_write = true;
+        return flush(conn);
+    }
+
+    // Sends as much pending output as the socket accepts. Returns false if
+    // the connection was closed.
+    bool flush(Connection& conn) {
+        if (conn.out_offset == 0) {
+            conn.last_write = std::chrono::steady_clock::now();
+        }
+        while (conn.out_offset < conn.out.size()) {
+            ssize_t n = ::send(conn.fd, conn.out.data() + conn.out_offset,
+                               conn.out.size() - conn.out_offset, MSG_NOSIGNAL);
+            if (n > 0) {
+                conn.out_offset += static_cast<size_t>(n);
+                conn.last_write = std::chrono::steady_clock::now();
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                updateInterest(conn);
+                return true;
+            }
+            closeConnection(conn);
+            return false;
+        }
+
+        conn.out.clear();
+        conn.out_offset = 0;
+        conn.last_active = std::chrono::steady_clock::now();
+        if (conn.close_after_write) {
+            closeConnection(conn);
+            return false;
+        }
+        // Pipelined requests may already be buffered
+        return dispatchNext(conn);
+    }
+
+    void updateInterest(Connection& conn) {
+        uint32_t wanted = 0;
+        if (!conn.busy && !conn.peer_closed) {
+            wanted |= EPOLLIN;
+        }
+        if (conn.out_offset < conn.out.size()) {
+            wanted |= EPOLLOUT;
+        }
+        if (wanted == conn.events) {
+            return;
+        }
+        epoll_event ev{};
+        ev.events = wanted;
+        ev.data.fd = conn.fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &ev);
+        conn.events = wanted;
+    }
+
+    void drainCompletions() {
+        std::vector<Completion> ready;
+        {
+            std::lock_guard<std::mutex> lock(completions_mutex);
+            ready.swap(completions);
+        }
+        for (auto& done : ready) {
+            auto it = connections.find(done.fd);
+            if (it == connections.end() || it->second->serial != done.serial) {
+                continue;
+            }
+            Connection& conn = *it->second;
+            conn.busy = false;
+            if (conn.hung_up) {
+                closeConnection(conn);
+                continue;
+            }
+            conn.out += done.response;
+            conn.close_after_write = conn.close_after_write || done.close;
+            flush(conn);
+        }
+    }
+
+    // Closes connections idle past the keep-alive timeout, and those whose
+    // peer has not taken any pending output within the write timeout: a
+    // client that stops reading would otherwise hold its response forever.
+    void sweepIdle(std::chrono::steady_clock::time_point now) {
+        auto timeout = std::chrono::seconds(server.keep_alive_timeout_sec_);
+        auto write_timeout = std::chrono::seconds(server.write_timeout_sec_) +
+                             std::chrono::microseconds(server.write_timeout_usec_);
+        std::vector<Connection*> expired;
+        for (auto& entry : connections) {
+            Connection& conn = *entry.second;
+            if (conn.busy) {
+                continue;
+            }
+            bool pending = conn.out_offset < conn.out.size();
+            if (pending ? now - conn.last_write > write_timeout : now - conn.last_active > timeout) {
+                expired.push_back(&conn);
+            }
+        }
+        for (Connection* conn : expired) {
+            closeConnection(*conn);
+        }
+    }
+
+    void closeConnection(Connection& conn) {
+        int fd = conn.fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections.erase(fd);
+    }
+};
+
+EventLoopServer::EventLoopServer(size_t io_threads)
+    : io_thread_count(std::max<size_t>(1, io_threads)) {}
+
+EventLoopServer::~EventLoopServer() {
+    stopEventLoop();
+}
+
+std::string EventLoopServer::handleRequest(const std::string& raw, const Peer& peer, int sock,
+                                           bool close_connection, bool continue_sent,
+                                           bool& connection_closed) {
+    std::string response;
+    BufferedRequestStream strm(raw, response, sock, peer);
+    connection_closed = false;
+    if (!process_request(strm, peer.remote_addr, peer.remote_port, peer.local_addr,
+                         peer.local_port, close_connection, connection_closed, nullptr)) {
+        connection_closed = true;
+    }
+    // process_request() writes its own 100 Continue ahead of the response;
+    // the loop already sent one while the body was on its way
+    if (continue_sent && response.compare(0, kContinueResponse.size(), kContinueResponse) == 0) {
+        response.erase(0, kContinueResponse.size());
+    }
+    return response;
+}
+
+bool EventLoopServer::listenEventLoop(const std::string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* result = nullptr;
+    std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &result) != 0) {
+        std::cerr << "Failed to resolve " << host << std::endl;
+        return false;
+    }
+
+    for (addrinfo* rp = result; rp != nullptr; rp = rp->ai_next) {
+        int fd = socket(rp->ai_family, rp->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, rp->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int yes = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        if (bind(fd, rp->ai_addr, rp->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0) {
+            listen_fd = fd;
+            break;
+        }
+        ::close(fd);
+    }
+    freeaddrinfo(result);
+
+    if (listen_fd < 0) {
+        std::cerr << "Failed to bind " << host << ":" << port << std::endl;
+        return false;
+    }
+
+    handler_pool.reset(new_task_queue());
+    running.store(true, std::memory_order_release);
+
+    std::vector<std::unique_ptr<IoLoop>> created;
+    for (size_t i = 0; i < io_thread_count; ++i) {
+        created.push_back(std::make_unique<IoLoop>(*this, listen_fd));
+    }
+    {
+        // stopEventLoop() sees either none of the loops or all of them. A
+        // stop that came in while they were being created found none to
+        // wake, so they are not started.
+        std::lock_guard<std::mutex> lock(loops_mutex);
+        loops = std::move(created);
+        if (running.load(std::memory_order_acquire)) {
+            for (auto& loop : loops) {
+                loop->start();
+            }
+        }
+    }
+    // Only this thread replaces `loops`, so it can be read here unlocked
+    for (auto& loop : loops) {
+        loop->join();
+    }
+
+    // Handlers still in flight post into loops that are no longer running;
+    // keep the loops alive until the pool has drained.
+    handler_pool->shutdown();
+    handler_pool.reset();
+    {
+        std::lock_guard<std::mutex> lock(loops_mutex);
+        loops.clear();
+    }
+    ::close(listen_fd);
+    listen_fd = -1;
+    return true;
+}
+
+void EventLoopServer::stopEventLoop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(loops_mutex);
+    for (auto& loop : loops) {
+        loop->wake();
+    }
+}
+
+#else // !__linux__
+
+// epoll is Linux-only; elsewhere (e.g. macOS dev machines) the event-loop
+// mode degrades to httplib's own thread-per-connection listener.
+class EventLoopServer::IoLoop {};
+
+EventLoopServer::EventLoopServer(size_t io_threads)
+    : io_thread_count(std::max<size_t>(1, io_threads)) {}
+
+EventLoopServer::~EventLoopServer() = default;
+
+std::string EventLoopServer::handleRequest(const std::string&, const Peer&, int, bool, bool,
+                                           bool& connection_closed) {
+    connection_closed = true;
+    return {};
+}
+
+bool EventLoopServer::listenEventLoop(const std::string& host, int port) {
+    std::cerr << "Event-loop mode requires epoll (Linux); using thread-per-connection listener" << std::endl;
+    return listen(host, port);
+}
+
+void EventLoopServer::stopEventLoop() {
+    stop();
+}
+
+#endif
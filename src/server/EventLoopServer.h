@@ -0,0 +1,58 @@
+#pragma once
+#include "../external/httplib.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Alternative front end for httplib::Server built on epoll.
+//
+// httplib::Server::listen() parks one pool thread on every keep-alive
+// connection for as long as it stays open. EventLoopServer instead
+// multiplexes all sockets over a few non-blocking I/O threads, buffers each
+// request until it is complete, and only then hands it to the handler pool
+// (created through httplib's `new_task_queue`). Idle connections therefore
+// cost a file descriptor and a small buffer, not a thread. A connection
+// whose peer stops reading its response is closed after the server's write
+// timeout, and "Expect: 100-continue" is answered as soon as the headers are
+// in, since the handler only sees the request once the body has arrived.
+//
+// Routes, pre/post routing handlers and error handlers are registered on
+// this object exactly as on httplib::Server, so existing register*Routes()
+// functions work unchanged; only the listen call differs.
+class EventLoopServer : public httplib::Server {
+public:
+    struct Peer {
+        std::string remote_addr;
+        int remote_port = 0;
+        std::string local_addr;
+        int local_port = 0;
+    };
+
+    explicit EventLoopServer(size_t io_threads = 2);
+    ~EventLoopServer() override;
+
+    // Blocks until stopEventLoop() is called, like httplib::Server::listen().
+    bool listenEventLoop(const std::string& host, int port);
+    void stopEventLoop();
+
+private:
+    class IoLoop;
+    friend class IoLoop;
+
+    // Runs one fully buffered request through httplib's routing and returns
+    // the serialized response. Called on handler pool threads.
+    // `continue_sent`: the I/O loop already answered "Expect: 100-continue".
+    std::string handleRequest(const std::string& raw, const Peer& peer, int sock,
+                              bool close_connection, bool continue_sent, bool& connection_closed);
+
+    size_t io_thread_count;
+    int listen_fd = -1;
+    std::atomic<bool> running{false};
+    std::unique_ptr<httplib::TaskQueue> handler_pool;
+    // Set by listenEventLoop() once all loops exist; stopEventLoop() may
+    // read it from another thread at any time
+    std::mutex loops_mutex;
+    std::vector<std::unique_ptr<IoLoop>> loops;
+};
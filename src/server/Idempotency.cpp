@@ -0,0 +1,164 @@
+#include "Idempotency.h"
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <nlohmann/json.hpp>
+#include "../repository/cache/IdempotencyCache.h"
+#include "../repository/postgres/IdempotencyStore.h"
+#include "Admission.h"
+#include "ConcurrencyLimit.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+const size_t kMaxKeyLength = 255;
+
+bool validKey(const std::string& key) {
+    if (key.size() > kMaxKeyLength) {
+        return false;
+    }
+    for (char c : key) {
+        if (c < 0x21 || c > 0x7e) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void sendError(httplib::Response& res, int status, const char* message) {
+    res.set_content(json{{"error", message}}.dump(), "application/json");
+    res.status = status;
+}
+
+void sendInFlight(httplib::Response& res) {
+    res.set_header("Retry-After", "1");
+    sendError(res, 409, "A request with this Idempotency-Key is still being processed");
+}
+
+void sendMismatch(httplib::Response& res) {
+    sendError(res, 422, "Idempotency-Key was already used for a different request");
+}
+
+void replay(httplib::Response& res, const IdempotencyCache::Response& stored) {
+    res.set_header("Idempotent-Replayed", "true");
+    res.set_content(stored.body, stored.content_type);
+    res.status = stored.status;
+}
+
+// A request's hold on its key: the cache entry and, once the table
+// granted it, the table row, each identified by its claim token
+struct Claim {
+    std::string client;
+    std::string key;
+    std::string cache_key;
+    uint64_t cache_token = 0;
+    std::optional<int64_t> table_token;
+};
+
+// Gives up the claim on both levels after a failed or aborted request
+void releaseClaim(const Claim& claim) {
+    IdempotencyCache::instance().release(claim.cache_key, claim.cache_token);
+    if (!claim.table_token) {
+        return;
+    }
+    try {
+        IdempotencyStore::instance().release(claim.client, claim.key, *claim.table_token);
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: failed to release idempotency key: " << e.what() << "\n";
+    }
+}
+
+} // namespace
+
+std::string idempotency::fingerprint(const httplib::Request& req) {
+    // FNV-1a; the method and path are compared verbatim
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : req.body) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    char digest[48];
+    std::snprintf(digest, sizeof(digest), " %zu:%016llx", req.body.size(), static_cast<unsigned long long>(hash));
+    return req.method + ' ' + req.path + digest;
+}
+
+httplib::Server::Handler idempotent(httplib::Server::Handler handler) {
+    return [handler = std::move(handler)](const httplib::Request& req, httplib::Response& res) {
+        const std::string key = req.get_header_value("Idempotency-Key");
+        if (key.empty()) {
+            handler(req, res);
+            return;
+        }
+        if (!validKey(key)) {
+            sendError(res, 400, "Idempotency-Key must be 1-255 visible ASCII characters");
+            return;
+        }
+
+        IdempotencyCache& cache = IdempotencyCache::instance();
+        IdempotencyStore& store = IdempotencyStore::instance();
+        const std::string fp = idempotency::fingerprint(req);
+
+        Claim claim;
+        claim.client = clientKey(req);
+        claim.key = key;
+        // Keys hold no spaces, so splitting at the last one recovers both parts
+        claim.cache_key = claim.client + ' ' + key;
+
+        IdempotencyCache::Lookup cached = cache.claim(claim.cache_key, fp, store.lockTimeout());
+        switch (cached.outcome) {
+            case IdempotencyCache::Outcome::Replay: replay(res, cached.response); return;
+            case IdempotencyCache::Outcome::InFlight: sendInFlight(res); return;
+            case IdempotencyCache::Outcome::Mismatch: sendMismatch(res); return;
+            case IdempotencyCache::Outcome::Claimed: break;
+        }
+        claim.cache_token = cached.token;
+
+        // Not in this process's cache: another process, or this one before
+        // a restart or an eviction, may have seen the key
+        try {
+            IdempotencyStore::Existing existing;
+            claim.table_token = store.claim(claim.client, key, fp, existing);
+            if (!claim.table_token) {
+                if (existing.fingerprint != fp) {
+                    cache.release(claim.cache_key, claim.cache_token);
+                    sendMismatch(res);
+                } else if (!existing.response) {
+                    cache.release(claim.cache_key, claim.cache_token);
+                    sendInFlight(res);
+                } else {
+                    cache.complete(claim.cache_key, claim.cache_token, *existing.response, existing.remaining);
+                    replay(res, *existing.response);
+                }
+                return;
+            }
+        } catch (const Overloaded&) {
+            // Shed before anything ran; the post-routing handler answers 503
+            cache.release(claim.cache_key, claim.cache_token);
+            return;
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: idempotency table unavailable, deduplicating in memory only: " << e.what() << "\n";
+        }
+
+        try {
+            handler(req, res);
+        } catch (...) {
+            releaseClaim(claim);
+            throw;
+        }
+        if (res.status >= 500) {
+            releaseClaim(claim);
+            return;
+        }
+
+        IdempotencyCache::Response stored{res.status, res.get_header_value("Content-Type"), res.body};
+        if (claim.table_token) {
+            try {
+                store.complete(claim.client, key, *claim.table_token, stored);
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: failed to store idempotent response: " << e.what() << "\n";
+            }
+        }
+        cache.complete(claim.cache_key, claim.cache_token, std::move(stored), store.ttl());
+    };
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include "../external/httplib.h"
+
+// Wraps a write handler so that a request carrying an Idempotency-Key
+// header executes at most once per key. Keys are scoped to the client
+// (clientKey() in Admission.h), so clients cannot collide on, or replay,
+// each other's keys. A retry of the same request (same method, path and
+// body) gets the stored status and body back, with
+// "Idempotent-Replayed: true", instead of running the handler again:
+//
+//   server.Post("/api/products", idempotent([](const httplib::Request& req, httplib::Response& res) { ... }));
+//
+// Keys are looked up in IdempotencyCache and then in the idempotency_keys
+// table, which is where a key claimed by another process or before a
+// restart is found. While the first request with a key is still running a
+// retry gets 409 with Retry-After; a key reused for a different request
+// gets 422. Responses with a 5xx status are not stored, so those requests
+// can be retried. When the table is unreachable the cache alone is used.
+//
+// Requests without the header run as before.
+httplib::Server::Handler idempotent(httplib::Server::Handler handler);
+
+namespace idempotency {
+
+// Method, path and a hash of the body; a key may only be replayed for a
+// request with the same fingerprint
+std::string fingerprint(const httplib::Request& req);
+
+} // namespace idempotency
@@ -0,0 +1,53 @@
+#include "RateLimiter.h"
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <mutex>
+
+RateLimiter::RateLimiter(double rate_per_second, double burst, size_t max_buckets)
+    : interval_ns(rate_per_second > 0 ? static_cast<int64_t>(1e9 / rate_per_second) : 0),
+      burst_ns(static_cast<int64_t>(std::max(burst, 1.0) * static_cast<double>(interval_ns))),
+      shard_capacity(std::max<size_t>(max_buckets / kShards, 1)) {}
+
+int64_t RateLimiter::take(const std::string& name, int64_t now_ns) {
+    if (!enabled()) {
+        return 0;
+    }
+    Shard& shard = shards[std::hash<std::string>()(name) % kShards];
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.buckets.find(name);
+        if (it != shard.buckets.end()) {
+            return it->second.take(now_ns, interval_ns, burst_ns);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.buckets.find(name);
+    if (it == shard.buckets.end()) {
+        if (shard.buckets.size() >= shard_capacity) {
+            evictOne(shard, now_ns);
+        }
+        it = shard.buckets.try_emplace(name).first;
+        shard.arrivals.push_back(name);
+    }
+    return it->second.take(now_ns, interval_ns, burst_ns);
+}
+
+// Caller holds the shard exclusively. Full buckets go first: dropping one
+// loses nothing. A bucket still in debt is moved to the back, and once
+// kEvictProbes have found none full the next in line goes regardless.
+void RateLimiter::evictOne(Shard& shard, int64_t now_ns) {
+    for (size_t probe = 0; probe < kEvictProbes && !shard.arrivals.empty(); ++probe) {
+        auto it = shard.buckets.find(shard.arrivals.front());
+        if (it->second.full(now_ns)) {
+            break;
+        }
+        shard.arrivals.push_back(std::move(shard.arrivals.front()));
+        shard.arrivals.pop_front();
+    }
+    if (!shard.arrivals.empty()) {
+        shard.buckets.erase(shard.arrivals.front());
+        shard.arrivals.pop_front();
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+// Token bucket kept as a single atomic word: the time at which the bucket
+// would be full again (GCRA, the "generic cell rate algorithm"). Taking a
+// token advances that time by one token's worth with a CAS loop; a take
+// that would push it more than `burst` tokens past now is refused. No
+// locks, and an idle bucket needs no refill step.
+class TokenBucket {
+public:
+    // 0 when a token was taken, otherwise the nanoseconds until one is
+    // available
+    int64_t take(int64_t now_ns, int64_t interval_ns, int64_t burst_ns) {
+        int64_t full_at = full_at_ns.load(std::memory_order_relaxed);
+        while (true) {
+            int64_t next = (full_at > now_ns ? full_at : now_ns) + interval_ns;
+            if (next - now_ns > burst_ns) {
+                return next - now_ns - burst_ns;
+            }
+            if (full_at_ns.compare_exchange_weak(full_at, next, std::memory_order_relaxed)) {
+                return 0;
+            }
+        }
+    }
+
+    // A full bucket is indistinguishable from a new one
+    bool full(int64_t now_ns) const { return full_at_ns.load(std::memory_order_relaxed) <= now_ns; }
+
+private:
+    std::atomic<int64_t> full_at_ns{0};
+};
+
+// Token buckets by name (a client or a route), all with the same rate and
+// burst. Buckets live in 16 shards; finding one takes the shard's shared
+// lock and taking a token is lock-free, so only a name's first request
+// takes a shard exclusively. A shard that reaches its share of
+// `max_buckets` evicts in arrival order, giving a bucket that still holds
+// debt a second chance for up to kEvictProbes probes, so a new name costs
+// O(1) and is always metered.
+class RateLimiter {
+public:
+    // rate_per_second == 0 disables the limiter
+    RateLimiter(double rate_per_second, double burst, size_t max_buckets);
+
+    bool enabled() const { return interval_ns > 0; }
+
+    // 0 when the request may proceed, otherwise the nanoseconds to wait
+    int64_t take(const std::string& name, int64_t now_ns);
+
+private:
+    struct Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<std::string, TokenBucket> buckets;
+        std::deque<std::string> arrivals;  // the names in `buckets`, oldest first
+    };
+
+    static constexpr size_t kShards = 16;
+    static constexpr size_t kEvictProbes = 8;
+
+    void evictOne(Shard& shard, int64_t now_ns);
+
+    int64_t interval_ns;
+    int64_t burst_ns;
+    size_t shard_capacity;
+    std::array<Shard, kShards> shards;
+};
@@ -0,0 +1,212 @@
+#include "RequestArena.h"
+#include <cstdlib>
+#include <new>
+#include "Config.h"
+
+namespace {
+
+// Plain counter so it needs no dynamic initialisation: operator new can run
+// before any other static in the program is constructed. Stays 0 unless
+// the counting operator new below is compiled in.
+thread_local uint64_t t_heap_allocations = 0;
+
+// Upstream of the monotonic resource: counts the blocks a request takes
+// once it has filled the thread's own block
+class OverflowResource final : public std::pmr::memory_resource {
+public:
+    uint64_t blocks = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++blocks;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+class ThreadArena final : public std::pmr::memory_resource {
+public:
+    explicit ThreadArena(size_t size)
+        : block(new std::byte[size]), arena(block.get(), size, &overflow) {}
+
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    OverflowResource overflow;
+
+    void reset() {
+        arena.release();
+        allocations = 0;
+        bytes = 0;
+        overflow.blocks = 0;
+    }
+
+private:
+    std::unique_ptr<std::byte[]> block;
+    std::pmr::monotonic_buffer_resource arena;
+
+    void* do_allocate(size_t n, size_t alignment) override {
+        ++allocations;
+        bytes += n;
+        return arena.allocate(n, alignment);
+    }
+
+    // Monotonic: memory comes back all at once in reset()
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+thread_local std::unique_ptr<ThreadArena> t_arena;
+thread_local bool t_in_request = false;
+thread_local uint64_t t_heap_at_begin = 0;
+
+} // namespace
+
+#ifdef REQUEST_ARENA_COUNT_HEAP
+
+void* operator new(size_t n) {
+    ++t_heap_allocations;
+    if (void* p = std::malloc(n == 0 ? 1 : n)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned forms
+void* operator new(size_t n, std::align_val_t alignment) {
+    ++t_heap_allocations;
+    size_t align = static_cast<size_t>(alignment);
+    size_t rounded = (n + align - 1) / align * align;
+    if (void* p = std::aligned_alloc(align, rounded == 0 ? align : rounded)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+#endif // REQUEST_ARENA_COUNT_HEAP
+
+size_t RequestArena::blockBytes() {
+    static const size_t bytes = Config::envSize("REQUEST_ARENA_KB", 256) * 1024;
+    return bytes;
+}
+
+std::pmr::memory_resource* RequestArena::resource() {
+    if (t_in_request && t_arena) {
+        return t_arena.get();
+    }
+    return std::pmr::new_delete_resource();
+}
+
+void RequestArena::begin() {
+    if (!t_arena && blockBytes() > 0) {
+        t_arena = std::make_unique<ThreadArena>(blockBytes());
+    }
+    // A request that never reached end() (connection dropped mid-way)
+    // leaves its allocations behind; start from an empty block regardless
+    if (t_arena) {
+        t_arena->reset();
+    }
+    t_in_request = true;
+    t_heap_at_begin = t_heap_allocations;
+}
+
+RequestArena::Usage RequestArena::end() {
+    Usage usage;
+    usage.heap_allocations = t_heap_allocations - t_heap_at_begin;
+    if (t_arena) {
+        usage.arena_allocations = t_arena->allocations;
+        usage.arena_bytes = t_arena->bytes;
+        usage.overflow_blocks = t_arena->overflow.blocks;
+        t_arena->reset();
+    }
+    t_in_request = false;
+    return usage;
+}
+
+RouteAllocations& RouteAllocations::instance() {
+    static RouteAllocations stats;
+    return stats;
+}
+
+RouteAllocations::Shard& RouteAllocations::localShard() {
+    thread_local Shard* shard = nullptr;
+    if (shard == nullptr) {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        shards.push_back(std::make_unique<Shard>());
+        shard = shards.back().get();
+    }
+    return *shard;
+}
+
+void RouteAllocations::record(const std::string& method, const std::string& pattern,
+                              const RequestArena::Usage& usage) {
+    Shard& shard = localShard();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto by_method = shard.routes.find(method);
+    if (by_method == shard.routes.end()) {
+        by_method = shard.routes.emplace(method, Table::mapped_type()).first;
+    }
+    auto route = by_method->second.find(pattern);
+    if (route == by_method->second.end()) {
+        route = by_method->second.emplace(pattern, Totals()).first;
+    }
+    Totals& totals = route->second;
+    ++totals.requests;
+    totals.heap_allocations += usage.heap_allocations;
+    totals.arena_allocations += usage.arena_allocations;
+    totals.arena_bytes += usage.arena_bytes;
+    totals.overflow_blocks += usage.overflow_blocks;
+}
+
+std::vector<RouteAllocations::Route> RouteAllocations::snapshot() const {
+    Table merged;
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        for (const auto& shard : shards) {
+            std::lock_guard<std::mutex> shard_lock(shard->mutex);
+            for (const auto& [method, patterns] : shard->routes) {
+                for (const auto& [pattern, totals] : patterns) {
+                    Totals& sum = merged[method][pattern];
+                    sum.requests += totals.requests;
+                    sum.heap_allocations += totals.heap_allocations;
+                    sum.arena_allocations += totals.arena_allocations;
+                    sum.arena_bytes += totals.arena_bytes;
+                    sum.overflow_blocks += totals.overflow_blocks;
+                }
+            }
+        }
+    }
+
+    std::vector<Route> routes;
+    for (auto& [method, patterns] : merged) {
+        for (auto& [pattern, totals] : patterns) {
+            routes.push_back(Route{method, pattern, totals});
+        }
+    }
+    return routes;
+}
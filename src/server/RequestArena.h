@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Per-request bump allocation for handler temporaries.
+//
+// Every handler thread owns one reusable block (REQUEST_ARENA_KB, default
+// 256; 0 turns the arena off). begin() at the start of a request makes a
+// std::pmr::monotonic_buffer_resource over that block the thread's current
+// resource; code on the request path that allocates through resource()
+// (repository result vectors, for one) bumps a pointer in it instead of
+// going through the global allocator all worker threads share. end()
+// releases the resource, which rewinds it to the start of the block, so
+// the block is reused rather than freed. Requests that outgrow the block
+// spill into blocks from new/delete, which end() hands back.
+//
+// Outside begin()/end() - warm-up, background workers, streamed response
+// bodies - resource() is the plain new/delete resource, so the same code
+// is safe anywhere. Memory from resource() must not outlive the request:
+// anything cached or handed to another thread has to be copied into an
+// ordinary container first.
+//
+// Built with -DREQUEST_ARENA_COUNT_HEAP (make COUNT_HEAP_ALLOCATIONS=1;
+// bench_request_arena always is), this translation unit also replaces the
+// global operator new to count heap allocations per thread, which end()
+// then reports alongside the arena's own counts. Production builds leave
+// the process allocator alone and report heap_allocations as 0.
+class RequestArena {
+public:
+    struct Usage {
+        uint64_t heap_allocations = 0;   // global operator new calls
+        uint64_t arena_allocations = 0;
+        uint64_t arena_bytes = 0;
+        uint64_t overflow_blocks = 0;    // blocks taken from new/delete
+    };
+
+#ifdef REQUEST_ARENA_COUNT_HEAP
+    static constexpr bool kCountsHeapAllocations = true;
+#else
+    static constexpr bool kCountsHeapAllocations = false;
+#endif
+
+    static size_t blockBytes();
+
+    // The current request's arena on this thread, or new/delete
+    static std::pmr::memory_resource* resource();
+
+    static void begin();
+    static Usage end();
+};
+
+// Allocation counts per route, summed from RequestArena::end(). Each
+// thread records into its own shard, so recording takes an uncontended
+// lock; snapshot() merges the shards.
+class RouteAllocations {
+public:
+    struct Totals {
+        uint64_t requests = 0;
+        uint64_t heap_allocations = 0;
+        uint64_t arena_allocations = 0;
+        uint64_t arena_bytes = 0;
+        uint64_t overflow_blocks = 0;
+    };
+
+    struct Route {
+        std::string method;
+        std::string pattern;
+        Totals totals;
+    };
+
+    static RouteAllocations& instance();
+
+    // `pattern` is the matched route's pattern, "" when nothing matched
+    void record(const std::string& method, const std::string& pattern, const RequestArena::Usage& usage);
+
+    // Sorted by method, then pattern
+    std::vector<Route> snapshot() const;
+
+private:
+    // method -> pattern -> totals; std::less<> so lookups take the
+    // request's strings without copying them
+    using Table = std::map<std::string, std::map<std::string, Totals, std::less<>>, std::less<>>;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        Table routes;
+    };
+
+    RouteAllocations() = default;
+    Shard& localShard();
+
+    mutable std::mutex shards_mutex;
+    std::vector<std::unique_ptr<Shard>> shards;  // one per thread, never removed
+};
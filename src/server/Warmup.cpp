@@ -0,0 +1,75 @@
+#include "Warmup.h"
+#include <chrono>
+#include <iostream>
+
+Warmup& Warmup::instance() {
+    static Warmup warmup;
+    return warmup;
+}
+
+Warmup::~Warmup() {
+    wait();
+}
+
+void Warmup::addPhase(const std::string& name, std::function<void()> fn) {
+    std::lock_guard<std::mutex> lock(mutex);
+    phases.push_back(Phase{name, std::move(fn)});
+}
+
+void Warmup::start() {
+    worker = std::thread([this] { run(); });
+}
+
+void Warmup::wait() {
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void Warmup::run() {
+    std::vector<Phase> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = phases;
+    }
+
+    for (const auto& phase : pending) {
+        PhaseResult result;
+        result.name = phase.name;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            phase.fn();
+            result.ok = true;
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        result.millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (result.ok) {
+            std::cout << "⏱️  Warm-up phase '" << result.name << "' took " << result.millis << " ms" << std::endl;
+        } else {
+            std::cerr << "❌ Warm-up phase '" << result.name << "' failed after " << result.millis
+                      << " ms: " << result.error << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.push_back(result);
+    }
+
+    std::cout << "✅ Warm-up finished in " << totalMillis() << " ms, server ready" << std::endl;
+    ready.store(true, std::memory_order_release);
+}
+
+std::vector<Warmup::PhaseResult> Warmup::results() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return finished;
+}
+
+double Warmup::totalMillis() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    double total = 0;
+    for (const auto& r : finished) {
+        total += r.millis;
+    }
+    return total;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Startup warm-up sequence. Phases are registered before start() and run
+// in order on a background thread while the server is already listening;
+// GET /ready reports not-ready until every phase has finished. A phase
+// that throws is logged and recorded as failed, and warm-up continues:
+// caches that did not load simply keep serving from the database.
+class Warmup {
+public:
+    struct PhaseResult {
+        std::string name;
+        double millis = 0;
+        bool ok = false;
+        std::string error;
+    };
+
+    static Warmup& instance();
+
+    void addPhase(const std::string& name, std::function<void()> fn);
+
+    void start();
+    void wait();
+
+    bool isReady() const { return ready.load(std::memory_order_acquire); }
+    std::vector<PhaseResult> results() const;
+    double totalMillis() const;
+
+private:
+    struct Phase {
+        std::string name;
+        std::function<void()> fn;
+    };
+
+    Warmup() = default;
+    ~Warmup();
+    void run();
+
+    std::vector<Phase> phases;
+    std::vector<PhaseResult> finished;
+    mutable std::mutex mutex;
+    std::atomic<bool> ready{false};
+    std::thread worker;
+};
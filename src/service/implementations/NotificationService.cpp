@@ -1,6 +1,7 @@
 #include "NotificationService.h"
 #include "../repository/postgres/NotificationRepo.h"
 #include "../repository/postgres/PostgresConnection.h"
+#include "../server/RequestArena.h"
 #include <iostream>
 #include <sstream>
 
@@ -48,11 +49,11 @@ bool NotificationService::unsubscribeUser(int notification_id) {
     return notification_repo->unsubscribeFromNotification(notification_id);
 }
 
-std::vector<domain::Notification> NotificationService::getUserNotifications(int user_id) {
+domain::NotificationList NotificationService::getUserNotifications(int user_id) {
     return notification_repo->getUserNotifications(user_id);
 }
 
-std::vector<domain::Notification> NotificationService::getProductSubscribers(int product_id) {
+domain::NotificationList NotificationService::getProductSubscribers(int product_id) {
     return notification_repo->getProductSubscribers(product_id);
 }
 
@@ -64,7 +65,7 @@ bool NotificationService::sendRestockNotifications(int product_id, int stock) {
         }
         
         // Get all subscribers for this product who haven't been notified yet
-        std::vector<domain::Notification> subscribers = notification_repo->getProductSubscribers(product_id);
+        domain::NotificationList subscribers = notification_repo->getProductSubscribers(product_id);
         
         if (subscribers.empty()) {
             std::cout << "ℹ️  No subscribers for product " << product_id << std::endl;
@@ -73,16 +74,23 @@ bool NotificationService::sendRestockNotifications(int product_id, int stock) {
         
         std::cout << "📢 Sending restock notifications to " << subscribers.size() << " subscribers of product " << product_id << std::endl;
         
-        auto& conn = PostgresConnection::getConnection();
-        
+        // The subscriber rows already carry what delivery needs; preferences
+        // for all of them come from one lookup instead of one per subscriber
+        std::pmr::vector<const domain::Notification*> pending(RequestArena::resource());
+        std::vector<int> user_ids;
         for (const auto& sub : subscribers) {
             if (sub.is_sent) {
                 continue; // Skip already notified subscribers
             }
-            
-            std::string message = "Product back in stock! Check it out now.";
-            
-            if (!sendNotification(sub.id, message)) {
+            pending.push_back(&sub);
+            user_ids.push_back(sub.user_id);
+        }
+        std::vector<domain::NotificationPreference> prefs = notification_repo->getNotificationPreferences(user_ids);
+        
+        std::string message = "Product back in stock! Check it out now.";
+        for (size_t i = 0; i < pending.size(); ++i) {
+            const domain::Notification& sub = *pending[i];
+            if (!deliverNotification(sub, message, prefs[i])) {
                 std::cerr << "Failed to send notification " << sub.id << " to user " << sub.user_id << std::endl;
             }
         }
@@ -106,14 +114,26 @@ bool NotificationService::sendNotification(int notification_id, const std::strin
         // Get user preferences
         domain::NotificationPreference prefs = notification_repo->getNotificationPreference(notif.user_id);
         
+        return deliverNotification(notif, message, prefs);
+    } catch (const std::exception& e) {
+        std::cerr << "Error in sendNotification: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool NotificationService::deliverNotification(const domain::Notification& notif, const std::string& message,
+                                              const domain::NotificationPreference& prefs) {
+    try {
+        const int notification_id = notif.id;
+        
         // Create notification log entry
         domain::NotificationLog log;
         log.notification_id = notification_id;
         log.user_id = notif.user_id;
         log.product_id = notif.product_id;
-        log.notification_type = notif.type_str;
+        log.notification_type = notif.type;
         log.message = message;
-        log.status = "pending";
+        log.status = domain::NotificationStatus::PENDING;
         log.retry_count = 0;
         log.max_retries = 3;
         
@@ -142,7 +162,7 @@ bool NotificationService::sendNotification(int notification_id, const std::strin
             return false;
         }
     } catch (const std::exception& e) {
-        std::cerr << "Error in sendNotification: " << e.what() << std::endl;
+        std::cerr << "Error delivering notification: " << e.what() << std::endl;
         return false;
     }
 }
@@ -175,17 +195,17 @@ bool NotificationService::simulateSendNotification(int user_id, int product_id,
     }
 }
 
-std::vector<domain::NotificationLog> NotificationService::getNotificationLogs(int user_id) {
+domain::NotificationLogList NotificationService::getNotificationLogs(int user_id) {
     return notification_repo->getNotificationLogs(user_id);
 }
 
-std::vector<domain::NotificationLog> NotificationService::getFailedNotifications() {
+domain::NotificationLogList NotificationService::getFailedNotifications() {
     return notification_repo->getFailedNotifications();
 }
 
 bool NotificationService::retryFailedNotification(int log_id) {
     try {
-        std::vector<domain::NotificationLog> logs = notification_repo->getFailedNotifications();
+        domain::NotificationLogList logs = notification_repo->getFailedNotifications();
         
         domain::NotificationLog target_log;
         for (const auto& log : logs) {
@@ -209,7 +229,7 @@ bool NotificationService::retryFailedNotification(int log_id) {
         notification_repo->incrementRetryCount(log_id);
         
         // Try sending again
-        std::string message = target_log.message;
+        std::string message(target_log.message);
         if (sendNotification(target_log.notification_id, message)) {
             notification_repo->updateNotificationLogStatus(log_id, "retried");
             std::cout << "Notification " << log_id << " retried successfully" << std::endl;
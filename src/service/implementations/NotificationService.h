@@ -7,6 +7,11 @@ class NotificationService : public InotificationService {
 private:
     std::unique_ptr<InotificationRepo> notification_repo;
     
+    // Logs, sends and marks one notification whose row and preferences the
+    // caller already has
+    bool deliverNotification(const domain::Notification& notif, const std::string& message,
+                             const domain::NotificationPreference& prefs);
+    
     // Helper method to simulate sending notifications
     bool simulateSendNotification(int user_id, int product_id, 
                                  const std::string& message,
@@ -20,16 +25,16 @@ public:
     bool unsubscribeUser(int notification_id) override;
     
     // Get notifications
-    std::vector<domain::Notification> getUserNotifications(int user_id) override;
-    std::vector<domain::Notification> getProductSubscribers(int product_id) override;
+    domain::NotificationList getUserNotifications(int user_id) override;
+    domain::NotificationList getProductSubscribers(int product_id) override;
     
     // Notification sending
     bool sendRestockNotifications(int product_id, int stock) override;
     bool sendNotification(int notification_id, const std::string& message) override;
     
     // Get notification logs
-    std::vector<domain::NotificationLog> getNotificationLogs(int user_id) override;
-    std::vector<domain::NotificationLog> getFailedNotifications() override;
+    domain::NotificationLogList getNotificationLogs(int user_id) override;
+    domain::NotificationLogList getFailedNotifications() override;
     
     // Retry failed notifications
     bool retryFailedNotification(int log_id) override;
@@ -12,16 +12,16 @@ public:
     virtual bool unsubscribeUser(int notification_id) = 0;
     
     // Get notifications
-    virtual std::vector<domain::Notification> getUserNotifications(int user_id) = 0;
-    virtual std::vector<domain::Notification> getProductSubscribers(int product_id) = 0;
+    virtual domain::NotificationList getUserNotifications(int user_id) = 0;
+    virtual domain::NotificationList getProductSubscribers(int product_id) = 0;
     
     // Notification sending
     virtual bool sendRestockNotifications(int product_id, int stock) = 0;
     virtual bool sendNotification(int notification_id, const std::string& message) = 0;
     
     // Get notification logs
-    virtual std::vector<domain::NotificationLog> getNotificationLogs(int user_id) = 0;
-    virtual std::vector<domain::NotificationLog> getFailedNotifications() = 0;
+    virtual domain::NotificationLogList getNotificationLogs(int user_id) = 0;
+    virtual domain::NotificationLogList getFailedNotifications() = 0;
     
     // Retry failed notifications
     virtual bool retryFailedNotification(int log_id) = 0;
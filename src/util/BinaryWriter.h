@@ -0,0 +1,290 @@
+#pragma once
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Streaming MessagePack / CBOR writer with the same interface as
+// JsonWriter: values are encoded straight into a caller-owned buffer, no
+// document tree is built.
+//
+// Both formats put the element count in front of an array or map. Since
+// the count is only known when the container is closed, begin*() reserves
+// the widest header (5 bytes) and end*() writes the real one, moving the
+// container's bytes down when a shorter header fits. Containers that are
+// closed soon after they are opened (every row object) move a few dozen
+// bytes; the outer array of a list moves once. Headers are the narrowest
+// that fit (fixarray/fixmap or the 1-byte CBOR heads for small
+// containers, likewise for integers and strings); doubles are always
+// written as 64-bit floats.
+class BinaryWriter {
+public:
+    enum class Format { MsgPack, Cbor };
+
+    BinaryWriter(std::string& out, Format format) : out(out), format(format) {}
+
+    BinaryWriter& beginObject() { return open(true); }
+    BinaryWriter& endObject() { return close(); }
+    BinaryWriter& beginArray() { return open(false); }
+    BinaryWriter& endArray() { return close(); }
+
+    BinaryWriter& key(std::string_view k) {
+        ++containers[depth - 1].count;
+        appendString(k);
+        return *this;
+    }
+
+    BinaryWriter& value(std::string_view s) {
+        element();
+        appendString(s);
+        return *this;
+    }
+
+    BinaryWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    BinaryWriter& value(const char* s) { return value(std::string_view(s)); }
+
+    BinaryWriter& value(bool b) {
+        element();
+        if (format == Format::MsgPack) {
+            out.push_back(static_cast<char>(b ? 0xc3 : 0xc2));
+        } else {
+            out.push_back(static_cast<char>(b ? 0xf5 : 0xf4));
+        }
+        return *this;
+    }
+
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, BinaryWriter&>
+    value(T v) {
+        element();
+        if constexpr (std::is_signed_v<T>) {
+            if (v < 0) {
+                appendNegative(static_cast<int64_t>(v));
+                return *this;
+            }
+        }
+        appendUnsigned(static_cast<uint64_t>(v));
+        return *this;
+    }
+
+    // Non-finite values are written as nil/null, as JsonWriter does
+    BinaryWriter& value(double d) {
+        element();
+        if (!std::isfinite(d)) {
+            appendNull();
+            return *this;
+        }
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        out.push_back(static_cast<char>(format == Format::MsgPack ? 0xcb : 0xfb));
+        appendBigEndian(bits, 8);
+        return *this;
+    }
+
+    BinaryWriter& null() {
+        element();
+        appendNull();
+        return *this;
+    }
+
+    // JsonWriter::raw() takes JSON literal text; the callers pass the
+    // decimal text of integer columns, which is encoded as that integer.
+    // Anything that does not parse as one is kept as a string.
+    BinaryWriter& raw(std::string_view literal) {
+        const char* end = literal.data() + literal.size();
+        int64_t v = 0;
+        auto [ptr, ec] = std::from_chars(literal.data(), end, v);
+        if (ec == std::errc() && ptr == end) {
+            return value(v);
+        }
+        return value(literal);
+    }
+
+    template <typename T>
+    BinaryWriter& field(std::string_view k, const T& v) {
+        key(k);
+        return value(v);
+    }
+
+    BinaryWriter& nullField(std::string_view k) {
+        key(k);
+        return null();
+    }
+
+    std::string& buffer() { return out; }
+
+private:
+    struct Open {
+        size_t header_pos;
+        uint32_t count;
+        bool is_map;
+    };
+
+    static constexpr size_t kMaxDepth = 16;
+    static constexpr size_t kReservedHeader = 5;
+
+    std::string& out;
+    Format format;
+    std::array<Open, kMaxDepth> containers{};
+    size_t depth = 0;
+
+    // A value inside an array counts towards it; inside a map the key did
+    void element() {
+        if (depth > 0 && !containers[depth - 1].is_map) {
+            ++containers[depth - 1].count;
+        }
+    }
+
+    BinaryWriter& open(bool is_map) {
+        element();
+        if (depth == kMaxDepth) {
+            throw std::length_error("BinaryWriter: containers nested too deeply");
+        }
+        containers[depth++] = Open{out.size(), 0, is_map};
+        out.append(kReservedHeader, '\0');
+        return *this;
+    }
+
+    BinaryWriter& close() {
+        const Open c = containers[--depth];
+        char header[kReservedHeader];
+        size_t length = containerHeader(header, c.count, c.is_map);
+        size_t content = c.header_pos + kReservedHeader;
+        if (length < kReservedHeader) {
+            std::memmove(&out[c.header_pos + length], &out[content], out.size() - content);
+            out.resize(out.size() - (kReservedHeader - length));
+        }
+        std::memcpy(&out[c.header_pos], header, length);
+        return *this;
+    }
+
+    // Writes the narrowest header for `count` elements into `header`
+    size_t containerHeader(char* header, uint32_t count, bool is_map) const {
+        if (format == Format::Cbor) {
+            return cborHead(header, is_map ? 5 : 4, count);
+        }
+        if (count <= 15) {
+            header[0] = static_cast<char>((is_map ? 0x80 : 0x90) | count);
+            return 1;
+        }
+        if (count <= 0xffff) {
+            header[0] = static_cast<char>(is_map ? 0xde : 0xdc);
+            storeBigEndian(header + 1, count, 2);
+            return 3;
+        }
+        header[0] = static_cast<char>(is_map ? 0xdf : 0xdd);
+        storeBigEndian(header + 1, count, 4);
+        return 5;
+    }
+
+    static size_t cborHead(char* head, unsigned major, uint64_t v) {
+        const auto type = static_cast<unsigned char>(major << 5);
+        if (v < 24) {
+            head[0] = static_cast<char>(type | v);
+            return 1;
+        }
+        if (v <= 0xff) {
+            head[0] = static_cast<char>(type | 24);
+            storeBigEndian(head + 1, v, 1);
+            return 2;
+        }
+        if (v <= 0xffff) {
+            head[0] = static_cast<char>(type | 25);
+            storeBigEndian(head + 1, v, 2);
+            return 3;
+        }
+        if (v <= 0xffffffff) {
+            head[0] = static_cast<char>(type | 26);
+            storeBigEndian(head + 1, v, 4);
+            return 5;
+        }
+        head[0] = static_cast<char>(type | 27);
+        storeBigEndian(head + 1, v, 8);
+        return 9;
+    }
+
+    static void storeBigEndian(char* dst, uint64_t v, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            dst[i] = static_cast<char>(v >> (8 * (bytes - 1 - i)));
+        }
+    }
+
+    void appendBigEndian(uint64_t v, size_t bytes) {
+        char buf[8];
+        storeBigEndian(buf, v, bytes);
+        out.append(buf, bytes);
+    }
+
+    void appendCborHead(unsigned major, uint64_t v) {
+        char head[9];
+        out.append(head, cborHead(head, major, v));
+    }
+
+    void appendNull() {
+        out.push_back(static_cast<char>(format == Format::MsgPack ? 0xc0 : 0xf6));
+    }
+
+    void appendUnsigned(uint64_t v) {
+        if (format == Format::Cbor) {
+            appendCborHead(0, v);
+        } else if (v <= 0x7f) {
+            out.push_back(static_cast<char>(v));
+        } else if (v <= 0xff) {
+            out.push_back(static_cast<char>(0xcc));
+            appendBigEndian(v, 1);
+        } else if (v <= 0xffff) {
+            out.push_back(static_cast<char>(0xcd));
+            appendBigEndian(v, 2);
+        } else if (v <= 0xffffffff) {
+            out.push_back(static_cast<char>(0xce));
+            appendBigEndian(v, 4);
+        } else {
+            out.push_back(static_cast<char>(0xcf));
+            appendBigEndian(v, 8);
+        }
+    }
+
+    void appendNegative(int64_t v) {
+        if (format == Format::Cbor) {
+            // Major type 1 holds -1 - v
+            appendCborHead(1, static_cast<uint64_t>(-(v + 1)));
+        } else if (v >= -32) {
+            out.push_back(static_cast<char>(v));
+        } else if (v >= INT8_MIN) {
+            out.push_back(static_cast<char>(0xd0));
+            appendBigEndian(static_cast<uint64_t>(v), 1);
+        } else if (v >= INT16_MIN) {
+            out.push_back(static_cast<char>(0xd1));
+            appendBigEndian(static_cast<uint64_t>(v), 2);
+        } else if (v >= INT32_MIN) {
+            out.push_back(static_cast<char>(0xd2));
+            appendBigEndian(static_cast<uint64_t>(v), 4);
+        } else {
+            out.push_back(static_cast<char>(0xd3));
+            appendBigEndian(static_cast<uint64_t>(v), 8);
+        }
+    }
+
+    void appendString(std::string_view s) {
+        if (format == Format::Cbor) {
+            appendCborHead(3, s.size());
+        } else if (s.size() <= 31) {
+            out.push_back(static_cast<char>(0xa0 | s.size()));
+        } else if (s.size() <= 0xff) {
+            out.push_back(static_cast<char>(0xd9));
+            appendBigEndian(s.size(), 1);
+        } else if (s.size() <= 0xffff) {
+            out.push_back(static_cast<char>(0xda));
+            appendBigEndian(s.size(), 2);
+        } else {
+            out.push_back(static_cast<char>(0xdb));
+            appendBigEndian(s.size(), 4);
+        }
+        out.append(s.data(), s.size());
+    }
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// ISO-8601 UTC text for timestamps held as microseconds since the Unix
+// epoch, e.g. 2026-01-16T12:00:00.000123Z. Formatting is pure arithmetic
+// (days-to-civil conversion plus a two-digit table) into a fixed buffer:
+// no gmtime_r, strftime or heap allocation per value, so list responses
+// can format every row's timestamps at the serialization boundary.
+// Valid for years 0000-9999.
+namespace isotime {
+
+constexpr size_t kLength = 27;  // YYYY-MM-DDTHH:MM:SS.ffffffZ
+
+struct Text {
+    char buf[kLength];
+
+    std::string_view view() const { return std::string_view(buf, kLength); }
+    std::string str() const { return std::string(buf, kLength); }
+};
+
+namespace detail {
+
+struct TwoDigits {
+    char pairs[200];
+
+    constexpr TwoDigits() : pairs() {
+        for (int i = 0; i < 100; ++i) {
+            pairs[2 * i] = static_cast<char>('0' + i / 10);
+            pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+        }
+    }
+};
+
+inline constexpr TwoDigits kTwoDigits{};
+
+inline void put2(char* out, unsigned v) {
+    out[0] = kTwoDigits.pairs[2 * v];
+    out[1] = kTwoDigits.pairs[2 * v + 1];
+}
+
+inline int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+} // namespace detail
+
+inline Text format(int64_t micros) {
+    const int64_t seconds = detail::floorDiv(micros, 1000000);
+    const auto fraction = static_cast<unsigned>(micros - seconds * 1000000);
+    const int64_t days = detail::floorDiv(seconds, 86400);
+    const auto second_of_day = static_cast<unsigned>(seconds - days * 86400);
+
+    // Days since 1970-01-01 to year/month/day (proleptic Gregorian), after
+    // H. Hinnant's civil_from_days
+    const int64_t z = days + 719468;
+    const int64_t era = detail::floorDiv(z, 146097);
+    const auto doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    const auto year = static_cast<unsigned>(static_cast<int64_t>(yoe) + era * 400 + (month <= 2 ? 1 : 0));
+
+    Text t;
+    char* p = t.buf;
+    detail::put2(p, (year / 100) % 100);
+    detail::put2(p + 2, year % 100);
+    p[4] = '-';
+    detail::put2(p + 5, month);
+    p[7] = '-';
+    detail::put2(p + 8, day);
+    p[10] = 'T';
+    detail::put2(p + 11, second_of_day / 3600);
+    p[13] = ':';
+    detail::put2(p + 14, (second_of_day / 60) % 60);
+    p[16] = ':';
+    detail::put2(p + 17, second_of_day % 60);
+    p[19] = '.';
+    detail::put2(p + 20, fraction / 10000);
+    detail::put2(p + 22, (fraction / 100) % 100);
+    detail::put2(p + 24, fraction % 100);
+    p[26] = 'Z';
+    return t;
+}
+
+} // namespace isotime
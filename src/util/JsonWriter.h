@@ -0,0 +1,182 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+// Streaming JSON writer that appends directly into a caller-owned buffer.
+// No intermediate tree is built: keys and values are escaped/formatted
+// straight into `out`, so a list response costs one growing string instead
+// of one allocation per key and value. Callers are expected to reserve()
+// the buffer up front when the row count is known.
+//
+//   std::string body;
+//   body.reserve(rows * 64);
+//   JsonWriter w(body);
+//   w.beginArray();
+//   w.beginObject().field("id", 1).field("name", "Laptop").endObject();
+//   w.endArray();
+class JsonWriter {
+private:
+    std::string& out;
+    bool need_comma = false;
+
+    void separator() {
+        if (need_comma) {
+            out.push_back(',');
+        }
+    }
+
+    static bool needsEscape(unsigned char c) {
+        return c < 0x20 || c == '"' || c == '\\';
+    }
+
+    void appendEscaped(std::string_view s) {
+        static const char hex[] = "0123456789abcdef";
+        size_t run_start = 0;
+        for (size_t i = 0; i < s.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            if (!needsEscape(c)) {
+                continue;
+            }
+            out.append(s.data() + run_start, i - run_start);
+            run_start = i + 1;
+            switch (c) {
+                case '"':  out.append("\\\"", 2); break;
+                case '\\': out.append("\\\\", 2); break;
+                case '\n': out.append("\\n", 2); break;
+                case '\r': out.append("\\r", 2); break;
+                case '\t': out.append("\\t", 2); break;
+                case '\b': out.append("\\b", 2); break;
+                case '\f': out.append("\\f", 2); break;
+                default: {
+                    char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0f]};
+                    out.append(esc, sizeof(esc));
+                }
+            }
+        }
+        out.append(s.data() + run_start, s.size() - run_start);
+    }
+
+    template <typename T>
+    void appendNumber(T v) {
+        char buf[32];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+        (void)ec;
+        out.append(buf, static_cast<size_t>(end - buf));
+    }
+
+public:
+    explicit JsonWriter(std::string& out) : out(out) {}
+
+    JsonWriter& beginObject() {
+        separator();
+        out.push_back('{');
+        need_comma = false;
+        return *this;
+    }
+
+    JsonWriter& endObject() {
+        out.push_back('}');
+        need_comma = true;
+        return *this;
+    }
+
+    JsonWriter& beginArray() {
+        separator();
+        out.push_back('[');
+        need_comma = false;
+        return *this;
+    }
+
+    JsonWriter& endArray() {
+        out.push_back(']');
+        need_comma = true;
+        return *this;
+    }
+
+    // Keys are escaped like any other string; call sites almost always pass
+    // literals, so the scan is a handful of bytes.
+    JsonWriter& key(std::string_view k) {
+        separator();
+        out.push_back('"');
+        appendEscaped(k);
+        out.append("\":", 2);
+        need_comma = false;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view s) {
+        separator();
+        out.push_back('"');
+        appendEscaped(s);
+        out.push_back('"');
+        need_comma = true;
+        return *this;
+    }
+
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+
+    JsonWriter& value(bool b) {
+        separator();
+        if (b) {
+            out.append("true", 4);
+        } else {
+            out.append("false", 5);
+        }
+        need_comma = true;
+        return *this;
+    }
+
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, JsonWriter&>
+    value(T v) {
+        separator();
+        appendNumber(v);
+        need_comma = true;
+        return *this;
+    }
+
+    JsonWriter& value(double d) {
+        separator();
+        if (std::isfinite(d)) {
+            appendNumber(d);
+        } else {
+            out.append("null", 4);
+        }
+        need_comma = true;
+        return *this;
+    }
+
+    JsonWriter& null() {
+        separator();
+        out.append("null", 4);
+        need_comma = true;
+        return *this;
+    }
+
+    // Emit an already-formatted JSON literal (e.g. the decimal text of an
+    // integer column as sent by Postgres) without re-parsing it.
+    JsonWriter& raw(std::string_view literal) {
+        separator();
+        out.append(literal.data(), literal.size());
+        need_comma = true;
+        return *this;
+    }
+
+    template <typename T>
+    JsonWriter& field(std::string_view k, const T& v) {
+        key(k);
+        return value(v);
+    }
+
+    JsonWriter& nullField(std::string_view k) {
+        key(k);
+        return null();
+    }
+
+    std::string& buffer() { return out; }
+};
@@ -0,0 +1,164 @@
+#pragma once
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "BinaryWriter.h"
+#include "JsonWriter.h"
+
+// Response body formats chosen by the request's Accept header. JSON stays
+// the default; internal callers that parse many list responses ask for
+// application/msgpack or application/cbor instead.
+enum class ResponseFormat { Json, MsgPack, Cbor };
+
+namespace responseformat {
+
+inline const char* contentType(ResponseFormat format) {
+    switch (format) {
+        case ResponseFormat::MsgPack: return "application/msgpack";
+        case ResponseFormat::Cbor: return "application/cbor";
+        default: return "application/json";
+    }
+}
+
+namespace detail {
+
+inline std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+inline bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i] >= 'A' && a[i] <= 'Z' ? static_cast<char>(a[i] - 'A' + 'a') : a[i];
+        if (x != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The format a media range names, or false for one we do not produce.
+// Wildcards mean the client takes anything, i.e. JSON.
+inline bool formatOf(std::string_view type, ResponseFormat& format) {
+    if (equalsIgnoreCase(type, "application/json") || equalsIgnoreCase(type, "*/*") ||
+        equalsIgnoreCase(type, "application/*")) {
+        format = ResponseFormat::Json;
+        return true;
+    }
+    if (equalsIgnoreCase(type, "application/msgpack") || equalsIgnoreCase(type, "application/x-msgpack") ||
+        equalsIgnoreCase(type, "application/vnd.msgpack")) {
+        format = ResponseFormat::MsgPack;
+        return true;
+    }
+    if (equalsIgnoreCase(type, "application/cbor")) {
+        format = ResponseFormat::Cbor;
+        return true;
+    }
+    return false;
+}
+
+} // namespace detail
+
+// The highest-q format among the Accept header's media ranges (the first
+// one on a tie). JSON when the header is absent or names nothing we
+// produce, so existing clients are unaffected.
+inline ResponseFormat negotiate(std::string_view accept) {
+    ResponseFormat best = ResponseFormat::Json;
+    double best_q = 0.0;
+    while (!accept.empty()) {
+        size_t comma = accept.find(',');
+        std::string_view range = accept.substr(0, comma);
+        accept = comma == std::string_view::npos ? std::string_view() : accept.substr(comma + 1);
+
+        size_t semicolon = range.find(';');
+        ResponseFormat format;
+        if (!detail::formatOf(detail::trim(range.substr(0, semicolon)), format)) {
+            continue;
+        }
+        double q = 1.0;
+        while (semicolon != std::string_view::npos) {
+            range = range.substr(semicolon + 1);
+            semicolon = range.find(';');
+            std::string_view param = detail::trim(range.substr(0, semicolon));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                q = std::strtod(std::string(param.substr(2)).c_str(), nullptr);
+            }
+        }
+        if (q > best_q) {
+            best = format;
+            best_q = q;
+        }
+    }
+    return best;
+}
+
+} // namespace responseformat
+
+// JsonWriter's interface over the negotiated format: handlers write rows
+// once and get JSON, MessagePack or CBOR from the same calls, each encoded
+// straight into the response buffer.
+//
+//   ResponseFormat format = responseformat::negotiate(req.get_header_value("Accept"));
+//   std::string body;
+//   ResponseWriter w(body, format);
+//   w.beginArray();
+//   w.beginObject().field("id", 1).field("name", "Laptop").endObject();
+//   w.endArray();
+//   res.set_content(std::move(body), responseformat::contentType(format));
+class ResponseWriter {
+public:
+    ResponseWriter(std::string& out, ResponseFormat format)
+        : json(out),
+          binary(out, format == ResponseFormat::Cbor ? BinaryWriter::Format::Cbor : BinaryWriter::Format::MsgPack),
+          is_json(format == ResponseFormat::Json) {}
+
+    ResponseWriter& beginObject() { return forward([](auto& w) { w.beginObject(); }); }
+    ResponseWriter& endObject() { return forward([](auto& w) { w.endObject(); }); }
+    ResponseWriter& beginArray() { return forward([](auto& w) { w.beginArray(); }); }
+    ResponseWriter& endArray() { return forward([](auto& w) { w.endArray(); }); }
+    ResponseWriter& key(std::string_view k) { return forward([k](auto& w) { w.key(k); }); }
+    ResponseWriter& null() { return forward([](auto& w) { w.null(); }); }
+    ResponseWriter& raw(std::string_view literal) { return forward([literal](auto& w) { w.raw(literal); }); }
+
+    template <typename T>
+    ResponseWriter& value(const T& v) {
+        return forward([&v](auto& w) { w.value(v); });
+    }
+
+    template <typename T>
+    ResponseWriter& field(std::string_view k, const T& v) {
+        key(k);
+        return value(v);
+    }
+
+    ResponseWriter& nullField(std::string_view k) {
+        key(k);
+        return null();
+    }
+
+    std::string& buffer() { return json.buffer(); }
+
+private:
+    JsonWriter json;
+    BinaryWriter binary;
+    bool is_json;
+
+    template <typename Fn>
+    ResponseWriter& forward(Fn&& fn) {
+        if (is_json) {
+            fn(json);
+        } else {
+            fn(binary);
+        }
+        return *this;
+    }
+};
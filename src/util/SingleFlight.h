@@ -0,0 +1,144 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Counters of one SingleFlight group; every group registers itself so
+// GET /metrics/coalescing can list them.
+class SingleFlightStats {
+public:
+    struct Snapshot {
+        std::string name;
+        uint64_t queries;     // lookups that ran (leaders and over-limit callers)
+        uint64_t coalesced;   // callers that received another caller's result
+        uint64_t over_limit;  // callers that found a full call and ran their own
+    };
+
+    explicit SingleFlightStats(std::string name) : name(std::move(name)) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(this);
+    }
+
+    SingleFlightStats(const SingleFlightStats&) = delete;
+    SingleFlightStats& operator=(const SingleFlightStats&) = delete;
+
+    Snapshot snapshot() const {
+        return Snapshot{name, queries.load(std::memory_order_relaxed), coalesced.load(std::memory_order_relaxed),
+                        over_limit.load(std::memory_order_relaxed)};
+    }
+
+    static std::vector<Snapshot> all() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        std::vector<Snapshot> groups;
+        for (const SingleFlightStats* group : registry()) {
+            groups.push_back(group->snapshot());
+        }
+        return groups;
+    }
+
+protected:
+    std::atomic<uint64_t> queries{0};
+    std::atomic<uint64_t> coalesced{0};
+    std::atomic<uint64_t> over_limit{0};
+
+private:
+    std::string name;
+
+    // Groups are function-local statics that live until exit
+    static std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+    static std::vector<const SingleFlightStats*>& registry() {
+        static std::vector<const SingleFlightStats*> groups;
+        return groups;
+    }
+};
+
+// Collapses concurrent identical lookups into one: the first caller for a
+// key runs the lookup, callers arriving while it runs wait for it and get a
+// copy of its result, or its exception rethrown. The call is forgotten as
+// soon as it finishes, so nothing is cached; a later caller runs a new
+// lookup.
+//
+// A call accepts at most `max_waiters` waiters. Callers past that run
+// their own lookup instead of piling more threads onto one result; the
+// database is still protected by ConcurrencyLimit.
+//
+// Writers call forget(key) after committing, so readers arriving after the
+// write start a fresh lookup instead of joining one that may have read the
+// old row.
+template <typename Key, typename Value>
+class SingleFlight : public SingleFlightStats {
+public:
+    SingleFlight(std::string name, size_t max_waiters)
+        : SingleFlightStats(std::move(name)), max_waiters(max_waiters) {}
+
+    template <typename Fn>
+    Value run(const Key& key, Fn&& lookup) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = calls.find(key);
+        if (it != calls.end()) {
+            std::shared_ptr<Call> call = it->second;
+            if (call->waiters < max_waiters) {
+                ++call->waiters;
+                lock.unlock();
+                coalesced.fetch_add(1, std::memory_order_relaxed);
+                return call->result.get();
+            }
+            lock.unlock();
+            over_limit.fetch_add(1, std::memory_order_relaxed);
+            queries.fetch_add(1, std::memory_order_relaxed);
+            return lookup();
+        }
+
+        auto call = std::make_shared<Call>();
+        std::promise<Value> promise;
+        call->result = promise.get_future().share();
+        calls.emplace(key, call);
+        lock.unlock();
+        queries.fetch_add(1, std::memory_order_relaxed);
+
+        try {
+            Value value = lookup();
+            finish(key, call);
+            promise.set_value(value);
+            return value;
+        } catch (...) {
+            finish(key, call);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    void forget(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        calls.erase(key);
+    }
+
+private:
+    struct Call {
+        std::shared_future<Value> result;
+        size_t waiters = 0;
+    };
+
+    // Removes the call unless forget() already replaced it with a newer one
+    void finish(const Key& key, const std::shared_ptr<Call>& call) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = calls.find(key);
+        if (it != calls.end() && it->second == call) {
+            calls.erase(it);
+        }
+    }
+
+    const size_t max_waiters;
+    std::mutex mutex;
+    std::unordered_map<Key, std::shared_ptr<Call>> calls;
+};
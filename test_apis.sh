@@ -105,6 +105,20 @@ curl -X PUT "$BASE_URL/api/inventory/1" \
   }' \
   -w "\nHTTP Status: %{http_code}\n\n"
 
+# 4. Retried stock update with an Idempotency-Key (second call replays the first response)
+IDEMPOTENCY_KEY="test-$(date +%s)-$$"
+echo -e "${YELLOW}4. Update Stock With Idempotency-Key (sent twice)${NC}"
+for attempt in 1 2; do
+  curl -X PUT "$BASE_URL/api/inventory/1" \
+    -H "Content-Type: application/json" \
+    -H "Idempotency-Key: $IDEMPOTENCY_KEY" \
+    -d '{
+      "stock": 80
+    }' \
+    -D - \
+    -w "\nHTTP Status: %{http_code}\n\n"
+done
+
 # ==========================================
 # USERS API TESTS
 # ==========================================
@@ -0,0 +1,98 @@
+// CatalogCache: writes that land while the bulk load is running must survive
+// it and only replace the fields they wrote, a write that arrives after a
+// newer one must not overwrite it, and a write that arrives after the
+// product's delete must not bring it back.
+//
+//   make test
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "repository/cache/CatalogCache.h"
+
+namespace {
+
+int g_failures = 0;
+
+void check(bool ok, const char* what) {
+    std::printf("%s %s\n", ok ? "✅" : "❌", what);
+    if (!ok) {
+        ++g_failures;
+    }
+}
+
+CatalogCache::Entry productRow(int id, const std::string& name) {
+    CatalogCache::Entry e;
+    e.id = id;
+    e.name = name;
+    e.description = name + " description";
+    e.product_version = 1;
+    return e;
+}
+
+} // namespace
+
+int main() {
+    CatalogCache& cache = CatalogCache::instance();
+    cache.beginLoad();
+
+    // Before the bulk rows arrive: a stock write for a product the load has
+    // not reached, a product write, and a delete
+    cache.putStock(1, 7, 3, "2026-01-02 00:00:00", 2000);
+    cache.updateProduct(2, "renamed", "renamed description", 2);
+    cache.addProduct(3, "deleted", "deleted description", 1);
+    cache.removeProduct(3);
+
+    cache.loadProducts({productRow(1, "one"), productRow(2, "two"), productRow(3, "three"), productRow(4, "four")});
+
+    // Between the products and the stock query
+    cache.putStock(4, 9, 2, "2026-01-02 00:00:01", 2001);
+
+    cache.loadStock({
+        {1, 100, 10, "2026-01-01 00:00:00", 1000},
+        {2, 200, 20, "2026-01-01 00:00:00", 1000},
+        {3, 300, 30, "2026-01-01 00:00:00", 1000},
+        {4, 400, 40, "2026-01-01 00:00:00", 1000},
+    });
+    cache.finishLoad();
+
+    auto one = cache.findEntry(1);
+    check(one.has_value(), "product with a stock write mid-load is kept");
+    check(one && one->name == "one", "its product row comes from the load");
+    check(one && one->has_stock && one->stock == 7 && one->reorder_point == 3,
+          "its stock comes from the write, not the load");
+
+    auto two = cache.findEntry(2);
+    check(two && two->name == "renamed", "product write mid-load wins over the bulk row");
+    check(two && two->has_stock && two->stock == 200, "its stock still comes from the load");
+
+    check(!cache.findEntry(3).has_value(), "product deleted mid-load stays deleted");
+
+    auto four = cache.findEntry(4);
+    check(four && four->name == "four" && four->stock == 9,
+          "stock write between the product and stock queries wins");
+
+    check(cache.size() == 3, "no other entries");
+
+    // Two updates to one product whose hooks run in the opposite order
+    cache.putStock(4, 12, 2, "2026-01-03 00:00:02", 3002);
+    cache.putStock(4, 11, 2, "2026-01-03 00:00:01", 3001);
+    four = cache.findEntry(4);
+    check(four && four->stock == 12 && four->stock_version == 3002, "older stock write arriving late is dropped");
+
+    // Two renames whose hooks run in the opposite order
+    check(cache.updateProduct(4, "four v3", "", 3), "newer rename is applied");
+    check(!cache.updateProduct(4, "four v2", "", 2), "older rename arriving late is dropped");
+    four = cache.findEntry(4);
+    check(four && four->name == "four v3", "the newer name stays");
+
+    // Hooks of a rename and a stock write that run after the delete's
+    cache.removeProduct(4);
+    check(!cache.updateProduct(4, "four v4", "", 4), "rename after the delete is dropped");
+    cache.putStock(4, 13, 2, "2026-01-03 00:00:03", 3003);
+    check(!cache.addProduct(4, "four", "", 5), "a deleted product cannot be added back");
+    check(!cache.findEntry(4).has_value(), "deleted product stays deleted");
+
+    check(!cache.updateProduct(99, "unknown", "", 1), "update of an unknown product does not insert it");
+    check(!cache.findEntry(99).has_value(), "unknown product stays absent");
+    return g_failures == 0 ? 0 : 1;
+}